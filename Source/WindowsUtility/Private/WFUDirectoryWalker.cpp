@@ -0,0 +1,308 @@
+#include "WFUDirectoryWalker.h"
+#include "WindowsFileUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/Event.h"
+#include "WFULambdaRunnable.h"
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+#include <sys/stat.h>
+#elif PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+namespace
+{
+	//Listing is I/O bound, more workers than this mostly queue up on the same disk
+	const int32 MaxWalkWorkers = 16;
+
+	bool MatchesAnyGlob(const TArray<FString>& Globs, const FString& RelativePath, const FString& Name)
+	{
+		for (const FString& Glob : Globs)
+		{
+			if (RelativePath.MatchesWildcard(Glob) || Name.MatchesWildcard(Glob))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//The stat visitor follows links, so a folder that is really a symlink or junction is only found by asking again
+	bool IsLinkedDirectory(const TCHAR* Path)
+	{
+#if PLATFORM_LINUX || PLATFORM_MAC
+		struct stat StatBuffer;
+		return lstat(TCHAR_TO_UTF8(Path), &StatBuffer) == 0 && S_ISLNK(StatBuffer.st_mode);
+#elif PLATFORM_WINDOWS
+		const uint32 Attributes = ::GetFileAttributesW(Path);
+		return Attributes != INVALID_FILE_ATTRIBUTES && (Attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+#else
+		return false;
+#endif
+	}
+
+	class FLevelVisitor : public IPlatformFile::FDirectoryStatVisitor
+	{
+	public:
+		FLevelVisitor(const FString& InRelativeDirectory, const TArray<FString>& InExcludeGlobs, TArray<FWFUDirectoryEntry>& InEntries)
+			: RelativeDirectory(InRelativeDirectory), ExcludeGlobs(InExcludeGlobs), Entries(InEntries)
+		{
+		}
+
+		virtual bool Visit(const TCHAR* FilenameOrDirectory, const FFileStatData& StatData) override
+		{
+			const FString Name = FPaths::GetCleanFilename(FilenameOrDirectory);
+			FString RelativePath = RelativeDirectory.IsEmpty() ? Name : RelativeDirectory / Name;
+
+			//Dropping an excluded folder here is what keeps it from ever being queued
+			if (MatchesAnyGlob(ExcludeGlobs, RelativePath, Name))
+			{
+				return true;
+			}
+
+			FWFUDirectoryEntry& Entry = Entries[Entries.AddDefaulted()];
+			Entry.Path = FilenameOrDirectory;
+			Entry.RelativePath = MoveTemp(RelativePath);
+			Entry.Size = StatData.bIsDirectory ? 0 : StatData.FileSize;
+			Entry.ModifiedTime = StatData.ModificationTime;
+			Entry.bIsDirectory = StatData.bIsDirectory;
+			Entry.bIsLink = StatData.bIsDirectory && IsLinkedDirectory(FilenameOrDirectory);
+			return true;
+		}
+
+	private:
+		const FString& RelativeDirectory;
+		const TArray<FString>& ExcludeGlobs;
+		TArray<FWFUDirectoryEntry>& Entries;
+	};
+}
+
+WFUDirectoryWalker::WFUDirectoryWalker()
+{
+	WorkAvailable = FPlatformProcess::GetSynchEventFromPool(false);
+	ResultsAvailable = FPlatformProcess::GetSynchEventFromPool(false);
+	bRecursive = true;
+	NumBusy = 0;
+	NumFiles = 0;
+	TotalBytes = 0;
+	bFinished = false;
+	bCancelled = false;
+	bHadErrors = false;
+}
+
+WFUDirectoryWalker::~WFUDirectoryWalker()
+{
+	Cancel();
+	for (TFuture<void>& Worker : Workers)
+	{
+		Worker.Wait();
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkAvailable);
+	FPlatformProcess::ReturnSynchEventToPool(ResultsAvailable);
+}
+
+bool WFUDirectoryWalker::Start(const FString& InRoot)
+{
+	Root = InRoot.Replace(TEXT("\\"), TEXT("/"));
+	Root.RemoveFromEnd(TEXT("/"));
+
+	if (!FPlatformFileManager::Get().GetPlatformFile().DirectoryExists(*Root))
+	{
+		return false;
+	}
+
+	//The empty relative path is the root itself
+	Pending.Add(FString());
+
+	//A non recursive walk only ever lists the root
+	const int32 NumWorkers = bRecursive ? FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1, MaxWalkWorkers) : 1;
+	for (int32 Index = 0; Index < NumWorkers; Index++)
+	{
+		Workers.Add(WFULambdaRunnable::RunLambdaOnBackGroundThread([this]
+		{
+			RunWorker();
+		}));
+	}
+	return true;
+}
+
+void WFUDirectoryWalker::SetRecursive(bool bInRecursive)
+{
+	bRecursive = bInRecursive;
+}
+
+void WFUDirectoryWalker::SetFilters(const TArray<FString>& InIncludeGlobs, const TArray<FString>& InExcludeGlobs)
+{
+	IncludeGlobs = InIncludeGlobs;
+	ExcludeGlobs = InExcludeGlobs;
+}
+
+bool WFUDirectoryWalker::NextBatch(TArray<FWFUDirectoryEntry>& OutEntries)
+{
+	OutEntries.Reset();
+
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (Results.Num() > 0)
+			{
+				Swap(OutEntries, Results);
+				return true;
+			}
+			if (bFinished || bCancelled)
+			{
+				return false;
+			}
+		}
+		ResultsAvailable->Wait();
+	}
+}
+
+void WFUDirectoryWalker::Cancel()
+{
+	FScopeLock ScopeLock(&Lock);
+	bCancelled = true;
+	Pending.Empty();
+	WorkAvailable->Trigger();
+	ResultsAvailable->Trigger();
+}
+
+bool WFUDirectoryWalker::IsFinished() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return bFinished;
+}
+
+int32 WFUDirectoryWalker::GetNumFiles() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumFiles;
+}
+
+int64 WFUDirectoryWalker::GetTotalBytes() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return TotalBytes;
+}
+
+bool WFUDirectoryWalker::HadErrors() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return bHadErrors;
+}
+
+void WFUDirectoryWalker::RunWorker()
+{
+	FString RelativeDirectory;
+	while (PopDirectory(RelativeDirectory))
+	{
+		ListDirectory(RelativeDirectory);
+
+		FScopeLock ScopeLock(&Lock);
+		NumBusy--;
+		if (NumBusy == 0 && Pending.Num() == 0)
+		{
+			bFinished = true;
+			WorkAvailable->Trigger();
+			ResultsAvailable->Trigger();
+		}
+	}
+}
+
+bool WFUDirectoryWalker::PopDirectory(FString& OutRelativeDirectory)
+{
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (bCancelled || bFinished)
+			{
+				//Events only wake one waiter, pass it on so every idle worker gets to leave
+				WorkAvailable->Trigger();
+				return false;
+			}
+			if (Pending.Num() > 0)
+			{
+				OutRelativeDirectory = Pending.Pop(false);
+				NumBusy++;
+				return true;
+			}
+		}
+		WorkAvailable->Wait();
+	}
+}
+
+void WFUDirectoryWalker::ListDirectory(const FString& RelativeDirectory)
+{
+	const FString Directory = RelativeDirectory.IsEmpty() ? Root : Root / RelativeDirectory;
+
+	TArray<FWFUDirectoryEntry> Entries;
+	FLevelVisitor Visitor(RelativeDirectory, ExcludeGlobs, Entries);
+	const bool bListed = FPlatformFileManager::Get().GetPlatformFile().IterateDirectoryStat(*Directory, Visitor);
+	if (!bListed)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("WFUDirectoryWalker: Failed to list %s"), *Directory);
+	}
+
+	Entries.Sort([](const FWFUDirectoryEntry& A, const FWFUDirectoryEntry& B)
+	{
+		return A.RelativePath < B.RelativePath;
+	});
+
+	//Folders that don't match the include globs are still walked, their contents might
+	TArray<FString> Subfolders;
+	if (bRecursive)
+	{
+		for (const FWFUDirectoryEntry& Entry : Entries)
+		{
+			if (Entry.bIsDirectory && !Entry.bIsLink)
+			{
+				Subfolders.Add(Entry.RelativePath);
+			}
+		}
+	}
+	if (IncludeGlobs.Num() > 0)
+	{
+		Entries.RemoveAll([this](const FWFUDirectoryEntry& Entry)
+		{
+			return !IsIncluded(Entry.RelativePath);
+		});
+	}
+
+	const int32 NumFolders = Subfolders.Num();
+	{
+		//Publishing a folder and queueing it under one lock is what keeps every folder ahead of its contents
+		FScopeLock ScopeLock(&Lock);
+		bHadErrors |= !bListed;
+		if (bCancelled)
+		{
+			return;
+		}
+
+		for (const FWFUDirectoryEntry& Entry : Entries)
+		{
+			if (!Entry.bIsDirectory)
+			{
+				NumFiles++;
+				TotalBytes += Entry.Size;
+			}
+		}
+		Pending.Append(MoveTemp(Subfolders));
+		Results.Append(MoveTemp(Entries));
+	}
+
+	ResultsAvailable->Trigger();
+	for (int32 Index = 0; Index < NumFolders; Index++)
+	{
+		WorkAvailable->Trigger();
+	}
+}
+
+bool WFUDirectoryWalker::IsIncluded(const FString& RelativePath) const
+{
+	return MatchesAnyGlob(IncludeGlobs, RelativePath, FPaths::GetCleanFilename(RelativePath));
+}
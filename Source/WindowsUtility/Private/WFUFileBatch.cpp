@@ -0,0 +1,320 @@
+#include "WFUFileBatch.h"
+#include "WindowsFileUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/ParallelFor.h"
+
+#if PLATFORM_LINUX
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+
+namespace
+{
+	const int64 CopyBufferSize = 1024 * 1024;
+
+	//Straight through the kernel, 0 once done and -1 if the file systems can't do it between them
+	int64 CopyFileRange(int SourceFd, int DestinationFd, int64 Count)
+	{
+#if defined(__NR_copy_file_range)
+		return syscall(__NR_copy_file_range, SourceFd, nullptr, DestinationFd, nullptr, (size_t)Count, 0u);
+#else
+		errno = ENOSYS;
+		return -1;
+#endif
+	}
+
+	bool CopyOpenFile(int SourceFd, int DestinationFd, int64 Size)
+	{
+#if defined(FICLONE)
+		if (ioctl(DestinationFd, FICLONE, SourceFd) == 0)
+		{
+			return true;
+		}
+#endif
+
+		int64 Copied = 0;
+		while (Copied < Size)
+		{
+			const int64 Result = CopyFileRange(SourceFd, DestinationFd, Size - Copied);
+			if (Result <= 0)
+			{
+				//Nothing copied yet means the route isn't supported here, e.g. across file systems on older kernels
+				if (Result < 0 && Copied == 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+				{
+					break;
+				}
+				return Result == 0 && Copied == Size;
+			}
+			Copied += Result;
+		}
+		if (Copied == Size)
+		{
+			return true;
+		}
+
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(CopyBufferSize);
+		while (true)
+		{
+			const ssize_t Read = read(SourceFd, Buffer.GetData(), Buffer.Num());
+			if (Read == 0)
+			{
+				return true;
+			}
+			if (Read < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+
+			for (ssize_t Written = 0; Written < Read;)
+			{
+				const ssize_t Result = write(DestinationFd, Buffer.GetData() + Written, Read - Written);
+				if (Result < 0 && errno != EINTR)
+				{
+					return false;
+				}
+				Written += FMath::Max<ssize_t>(Result, 0);
+			}
+		}
+	}
+
+	bool PlatformCopy(const FString& From, const FString& To)
+	{
+		const int SourceFd = open(TCHAR_TO_UTF8(*From), O_RDONLY | O_CLOEXEC);
+		if (SourceFd < 0)
+		{
+			return false;
+		}
+
+		struct stat StatBuffer;
+		if (fstat(SourceFd, &StatBuffer) != 0 || !S_ISREG(StatBuffer.st_mode))
+		{
+			close(SourceFd);
+			return false;
+		}
+
+		const int DestinationFd = open(TCHAR_TO_UTF8(*To), O_WRONLY | O_CREAT | O_CLOEXEC, StatBuffer.st_mode & 0777);
+		if (DestinationFd < 0)
+		{
+			close(SourceFd);
+			return false;
+		}
+
+		//Truncating only once it's known not to be the source under another name
+		struct stat DestinationStat;
+		if (fstat(DestinationFd, &DestinationStat) != 0 || (DestinationStat.st_dev == StatBuffer.st_dev && DestinationStat.st_ino == StatBuffer.st_ino) || ftruncate(DestinationFd, 0) != 0)
+		{
+			close(DestinationFd);
+			close(SourceFd);
+			return false;
+		}
+
+		bool bSuccess = CopyOpenFile(SourceFd, DestinationFd, StatBuffer.st_size);
+		bSuccess &= close(DestinationFd) == 0;
+		close(SourceFd);
+
+		if (!bSuccess)
+		{
+			unlink(TCHAR_TO_UTF8(*To));
+		}
+		return bSuccess;
+	}
+
+	//False with bCrossDevice set when the rename has to become a copy
+	bool PlatformMove(const FString& From, const FString& To, bool& bCrossDevice)
+	{
+		if (rename(TCHAR_TO_UTF8(*From), TCHAR_TO_UTF8(*To)) == 0)
+		{
+			return true;
+		}
+		bCrossDevice = errno == EXDEV;
+		return false;
+	}
+
+	bool PlatformDelete(const FString& Path)
+	{
+		return unlink(TCHAR_TO_UTF8(*Path)) == 0;
+	}
+
+	bool PlatformExists(const FString& Path)
+	{
+		struct stat StatBuffer;
+		return stat(TCHAR_TO_UTF8(*Path), &StatBuffer) == 0;
+	}
+}
+
+#elif PLATFORM_WINDOWS
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+
+namespace
+{
+	//CopyFileW already clones blocks where the volume supports it, e.g. ReFS and Dev Drives
+	bool PlatformCopy(const FString& From, const FString& To)
+	{
+		return CopyFileW(*From, *To, FALSE) != 0;
+	}
+
+	bool PlatformMove(const FString& From, const FString& To, bool& bCrossDevice)
+	{
+		//MOVEFILE_COPY_ALLOWED already handles other volumes
+		bCrossDevice = false;
+		return MoveFileExW(*From, *To, MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED) != 0;
+	}
+
+	bool PlatformDelete(const FString& Path)
+	{
+		if (DeleteFileW(*Path) != 0)
+		{
+			return true;
+		}
+
+		//Read-only files refuse to be deleted until the flag is cleared
+		const DWORD Attributes = GetFileAttributesW(*Path);
+		if (Attributes == INVALID_FILE_ATTRIBUTES || (Attributes & FILE_ATTRIBUTE_READONLY) == 0)
+		{
+			return false;
+		}
+		return SetFileAttributesW(*Path, Attributes & ~FILE_ATTRIBUTE_READONLY) != 0 && DeleteFileW(*Path) != 0;
+	}
+
+	bool PlatformExists(const FString& Path)
+	{
+		return GetFileAttributesW(*Path) != INVALID_FILE_ATTRIBUTES;
+	}
+}
+
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#else
+
+namespace
+{
+	bool PlatformCopy(const FString& From, const FString& To)
+	{
+		return FPlatformFileManager::Get().GetPlatformFile().CopyFile(*To, *From);
+	}
+
+	bool PlatformMove(const FString& From, const FString& To, bool& bCrossDevice)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (PlatformFile.FileExists(*From))
+		{
+			PlatformFile.DeleteFile(*To);
+		}
+
+		//A failed move is retried as copy and delete, which covers other volumes
+		bCrossDevice = !PlatformFile.MoveFile(*To, *From);
+		return !bCrossDevice;
+	}
+
+	bool PlatformDelete(const FString& Path)
+	{
+		return FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Path);
+	}
+
+	bool PlatformExists(const FString& Path)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		return PlatformFile.FileExists(*Path) || PlatformFile.DirectoryExists(*Path);
+	}
+}
+
+#endif
+
+namespace
+{
+	bool MakeParentFolder(const FString& Path)
+	{
+		const FString Parent = FPaths::GetPath(Path);
+		return Parent.IsEmpty() || FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Parent);
+	}
+}
+
+FWFUFileBatchResult WFUFileBatch::Run(EWFUFileBatchOperation Operation, const TArray<FString>& Paths, const TArray<FString>& Destinations)
+{
+	FWFUFileBatchResult Result;
+	Result.Operation = Operation;
+	Result.Paths = Paths;
+	Result.Succeeded.SetNumZeroed(Paths.Num());
+
+	const bool bNeedsDestinations = Operation == EWFUFileBatchOperation::Move || Operation == EWFUFileBatchOperation::Copy;
+	if (bNeedsDestinations)
+	{
+		Result.Destinations = Destinations;
+		if (Destinations.Num() != Paths.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUFileBatch: %d paths but %d destinations, nothing done."), Paths.Num(), Destinations.Num());
+			Result.NumFailed = Paths.Num();
+			return Result;
+		}
+	}
+
+	//Every item is its own file system call, workers mostly overlap waiting on the disk
+	ParallelFor(Paths.Num(), [&Result, &Paths, &Destinations, Operation](int32 Index)
+	{
+		bool bSucceeded = false;
+		switch (Operation)
+		{
+		case EWFUFileBatchOperation::Move:
+			bSucceeded = MoveFileTo(Paths[Index], Destinations[Index]);
+			break;
+		case EWFUFileBatchOperation::Copy:
+			bSucceeded = CopyFileTo(Paths[Index], Destinations[Index]);
+			break;
+		case EWFUFileBatchOperation::Delete:
+			bSucceeded = DeleteFileAt(Paths[Index]);
+			break;
+		case EWFUFileBatchOperation::Exists:
+			bSucceeded = Exists(Paths[Index]);
+			break;
+		}
+		Result.Succeeded[Index] = bSucceeded;
+	});
+
+	for (bool bSucceeded : Result.Succeeded)
+	{
+		Result.NumFailed += bSucceeded ? 0 : 1;
+	}
+	return Result;
+}
+
+bool WFUFileBatch::CopyFileTo(const FString& From, const FString& To)
+{
+	return MakeParentFolder(To) && PlatformCopy(From, To);
+}
+
+bool WFUFileBatch::MoveFileTo(const FString& From, const FString& To)
+{
+	if (!MakeParentFolder(To))
+	{
+		return false;
+	}
+
+	bool bCrossDevice = false;
+	if (PlatformMove(From, To, bCrossDevice))
+	{
+		return true;
+	}
+	return bCrossDevice && PlatformCopy(From, To) && PlatformDelete(From);
+}
+
+bool WFUFileBatch::DeleteFileAt(const FString& Path)
+{
+	return PlatformDelete(Path);
+}
+
+bool WFUFileBatch::Exists(const FString& Path)
+{
+	return PlatformExists(Path);
+}
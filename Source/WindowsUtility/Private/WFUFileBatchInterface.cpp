@@ -0,0 +1,10 @@
+#include "WFUFileBatchInterface.h"
+#include "WindowsFileUtilityPrivatePCH.h"
+
+
+UWFUFileBatchInterface::UWFUFileBatchInterface(const class FObjectInitializer& PCIP)
+	: Super(PCIP)
+{
+
+}
+
@@ -0,0 +1,20 @@
+#include "WFUFileBatchLambdaDelegate.h"
+#include "WindowsFileUtilityPrivatePCH.h"
+
+UWFUFileBatchLambdaDelegate::UWFUFileBatchLambdaDelegate()
+{
+	OnDoneCallback = nullptr;
+}
+
+void UWFUFileBatchLambdaDelegate::SetOnDoneCallback(TFunction<void(const FWFUFileBatchResult&)> InOnDoneCallback)
+{
+	OnDoneCallback = InOnDoneCallback;
+}
+
+void UWFUFileBatchLambdaDelegate::OnBatchDone_Implementation(const FWFUFileBatchResult& Result)
+{
+	if (OnDoneCallback != nullptr)
+	{
+		OnDoneCallback(Result);
+	}
+}
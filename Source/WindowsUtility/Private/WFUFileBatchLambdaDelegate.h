@@ -0,0 +1,21 @@
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "WFUFileBatchLambdaDelegate.generated.h"
+
+UCLASS()
+class WINDOWSFILEUTILITY_API UWFUFileBatchLambdaDelegate : public UObject, public IWFUFileBatchInterface
+{
+	GENERATED_BODY()
+
+	UWFUFileBatchLambdaDelegate();
+public:
+	void SetOnDoneCallback(TFunction<void(const FWFUFileBatchResult&)> InOnDoneCallback);
+
+protected:
+	//File Batch Interface
+	virtual void OnBatchDone_Implementation(const FWFUFileBatchResult& Result) override;
+
+	TFunction<void(const FWFUFileBatchResult&)> OnDoneCallback;
+};
@@ -23,6 +23,11 @@ void UWFUFileListLambdaDelegate::OnListDirectoryFound_Implementation(const FStri
 
 }
 
+void UWFUFileListLambdaDelegate::OnListResults_Implementation(const FString& DirectoryPath, const FWFUFolderListing& Listing)
+{
+
+}
+
 void UWFUFileListLambdaDelegate::OnListDone_Implementation(const FString& DirectoryPath, const TArray<FString>& Files, const TArray<FString>& Folders)
 {
 	if (OnDoneCallback != nullptr)
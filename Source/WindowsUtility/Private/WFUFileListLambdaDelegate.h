@@ -18,6 +18,7 @@ protected:
 
 	virtual void OnListFileFound_Implementation(const FString& FileName, int32 ByteCount, const FString& FilePath) override;
 	virtual void OnListDirectoryFound_Implementation(const FString& DirectoryName, const FString& FilePath) override;
+	virtual void OnListResults_Implementation(const FString& DirectoryPath, const FWFUFolderListing& Listing) override;
 	virtual void OnListDone_Implementation(const FString& DirectoryPath, const TArray<FString>& Files, const TArray<FString>& Folders) override;
 
 	TFunction<void(const TArray<FString>&, const TArray<FString>&)> OnDoneCallback;
@@ -29,4 +29,9 @@ void UWFUFolderWatchLambdaDelegate::OnDirectoryChanged_Implementation(const FStr
 	{
 		OnFileChangedCallback(DirectoryName, DirectoryPath);
 	}
+}
+
+void UWFUFolderWatchLambdaDelegate::OnFolderChanges_Implementation(const FString& DirectoryPath, const TArray<FWFUFolderChange>& Changes)
+{
+
 }
\ No newline at end of file
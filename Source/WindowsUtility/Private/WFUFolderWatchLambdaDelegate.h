@@ -19,4 +19,5 @@ protected:
 	//IWFUFolderWatchInterface
 	virtual void OnFileChanged_Implementation(const FString& FileName, const FString& FilePath) override;
 	virtual void OnDirectoryChanged_Implementation(const FString& DirectoryName, const FString& DirectoryPath) override;
+	virtual void OnFolderChanges_Implementation(const FString& DirectoryPath, const TArray<FWFUFolderChange>& Changes) override;
 };
\ No newline at end of file
@@ -0,0 +1,485 @@
+#include "WFUTreeDeleter.h"
+#include "WindowsFileUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/Event.h"
+#include "WFULambdaRunnable.h"
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+namespace
+{
+	/*
+	Unlinks every file, link and special file directly in Directory and lists its subfolders. The folder is
+	opened without following a link, everything else is relative to that descriptor.
+	*/
+	bool EmptyLevel(const FString& Directory, TArray<FString>& OutSubfolders, int32& OutNumDeleted, int32& OutNumFailed)
+	{
+		const int DirectoryFd = open(TCHAR_TO_UTF8(*Directory), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+		if (DirectoryFd < 0)
+		{
+			return false;
+		}
+
+		DIR* Dir = fdopendir(DirectoryFd);
+		if (Dir == nullptr)
+		{
+			close(DirectoryFd);
+			return false;
+		}
+
+		while (const dirent* Entry = readdir(Dir))
+		{
+			if (strcmp(Entry->d_name, ".") == 0 || strcmp(Entry->d_name, "..") == 0)
+			{
+				continue;
+			}
+
+			bool bIsDirectory = Entry->d_type == DT_DIR;
+			if (Entry->d_type == DT_UNKNOWN)
+			{
+				struct stat StatBuffer;
+				bIsDirectory = fstatat(DirectoryFd, Entry->d_name, &StatBuffer, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(StatBuffer.st_mode);
+			}
+
+			if (bIsDirectory)
+			{
+				OutSubfolders.Add(UTF8_TO_TCHAR(Entry->d_name));
+			}
+			else if (unlinkat(DirectoryFd, Entry->d_name, 0) == 0)
+			{
+				OutNumDeleted++;
+			}
+			else
+			{
+				OutNumFailed++;
+			}
+		}
+
+		//Closes DirectoryFd as well
+		closedir(Dir);
+		return true;
+	}
+
+	bool RemoveEmptyFolder(const FString& Directory)
+	{
+		return rmdir(TCHAR_TO_UTF8(*Directory)) == 0;
+	}
+
+	FString ResolvePath(const FString& FullPath)
+	{
+		char* Resolved = realpath(TCHAR_TO_UTF8(*FullPath), nullptr);
+		if (Resolved == nullptr)
+		{
+			return FString();
+		}
+
+		const FString Result = UTF8_TO_TCHAR(Resolved);
+		free(Resolved);
+		return Result;
+	}
+}
+
+#elif PLATFORM_WINDOWS
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+
+namespace
+{
+	bool EmptyLevel(const FString& Directory, TArray<FString>& OutSubfolders, int32& OutNumDeleted, int32& OutNumFailed)
+	{
+		const FString WindowsDirectory = Directory.Replace(TEXT("/"), TEXT("\\"));
+
+		WIN32_FIND_DATAW FindData;
+		HANDLE Find = FindFirstFileExW(*(WindowsDirectory + TEXT("\\*")), FindExInfoBasic, &FindData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+		if (Find == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		do
+		{
+			if (FCString::Strcmp(FindData.cFileName, TEXT(".")) == 0 || FCString::Strcmp(FindData.cFileName, TEXT("..")) == 0)
+			{
+				continue;
+			}
+
+			const FString EntryPath = WindowsDirectory + TEXT("\\") + FindData.cFileName;
+			const bool bIsLink = (FindData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+			const bool bIsDirectory = (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+
+			if (bIsDirectory && !bIsLink)
+			{
+				OutSubfolders.Add(FindData.cFileName);
+				continue;
+			}
+
+			//Read-only files refuse to be deleted until the flag is cleared
+			if ((FindData.dwFileAttributes & FILE_ATTRIBUTE_READONLY) != 0)
+			{
+				SetFileAttributesW(*EntryPath, FindData.dwFileAttributes & ~FILE_ATTRIBUTE_READONLY);
+			}
+
+			//Junctions and directory links are removed as folders, their target is left alone
+			const bool bDeleted = bIsDirectory ? RemoveDirectoryW(*EntryPath) != 0 : DeleteFileW(*EntryPath) != 0;
+			if (bDeleted)
+			{
+				OutNumDeleted++;
+			}
+			else
+			{
+				OutNumFailed++;
+			}
+		} while (FindNextFileW(Find, &FindData));
+
+		FindClose(Find);
+		return true;
+	}
+
+	bool RemoveEmptyFolder(const FString& Directory)
+	{
+		const FString WindowsDirectory = Directory.Replace(TEXT("/"), TEXT("\\"));
+
+		//Files still held open, e.g. by a virus scanner or the indexer, only go away once the last handle closes
+		for (int32 Attempt = 0; Attempt < 5; Attempt++)
+		{
+			if (RemoveDirectoryW(*WindowsDirectory) != 0)
+			{
+				return true;
+			}
+			if (GetLastError() != ERROR_DIR_NOT_EMPTY)
+			{
+				return false;
+			}
+			FPlatformProcess::Sleep(0.01f * (Attempt + 1));
+		}
+		return false;
+	}
+
+	FString ResolvePath(const FString& FullPath)
+	{
+		HANDLE File = CreateFileW(*FullPath, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			return FString();
+		}
+
+		TArray<TCHAR> Buffer;
+		Buffer.SetNumZeroed(GetFinalPathNameByHandleW(File, nullptr, 0, FILE_NAME_NORMALIZED) + 1);
+		const DWORD Length = GetFinalPathNameByHandleW(File, Buffer.GetData(), Buffer.Num(), FILE_NAME_NORMALIZED);
+		CloseHandle(File);
+		if (Length == 0 || Length >= (DWORD)Buffer.Num())
+		{
+			return FString();
+		}
+
+		FString Result = Buffer.GetData();
+		if (Result.RemoveFromStart(TEXT("\\\\?\\UNC\\")))
+		{
+			Result = TEXT("\\\\") + Result;
+		}
+		else
+		{
+			Result.RemoveFromStart(TEXT("\\\\?\\"));
+		}
+		return Result;
+	}
+}
+
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#else
+
+namespace
+{
+	class FLevelDeleter : public IPlatformFile::FDirectoryStatVisitor
+	{
+	public:
+		FLevelDeleter(TArray<FString>& InSubfolders, int32& InNumDeleted, int32& InNumFailed)
+			: Subfolders(InSubfolders), NumDeleted(InNumDeleted), NumFailed(InNumFailed)
+		{
+		}
+
+		virtual bool Visit(const TCHAR* FilenameOrDirectory, const FFileStatData& StatData) override
+		{
+			if (StatData.bIsDirectory)
+			{
+				Subfolders.Add(FPaths::GetCleanFilename(FilenameOrDirectory));
+			}
+			else if (FPlatformFileManager::Get().GetPlatformFile().DeleteFile(FilenameOrDirectory))
+			{
+				NumDeleted++;
+			}
+			else
+			{
+				NumFailed++;
+			}
+			return true;
+		}
+
+	private:
+		TArray<FString>& Subfolders;
+		int32& NumDeleted;
+		int32& NumFailed;
+	};
+
+	bool EmptyLevel(const FString& Directory, TArray<FString>& OutSubfolders, int32& OutNumDeleted, int32& OutNumFailed)
+	{
+		FLevelDeleter Visitor(OutSubfolders, OutNumDeleted, OutNumFailed);
+		return FPlatformFileManager::Get().GetPlatformFile().IterateDirectoryStat(*Directory, Visitor);
+	}
+
+	bool RemoveEmptyFolder(const FString& Directory)
+	{
+		return FPlatformFileManager::Get().GetPlatformFile().DeleteDirectory(*Directory);
+	}
+
+	FString ResolvePath(const FString& FullPath)
+	{
+		FString Result = FullPath;
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (!FPaths::CollapseRelativeDirectories(Result) || (!PlatformFile.DirectoryExists(*Result) && !PlatformFile.FileExists(*Result)))
+		{
+			return FString();
+		}
+		return Result;
+	}
+}
+
+#endif
+
+namespace
+{
+	//Deleting is metadata bound, past this many workers they mostly wait on the same file system locks
+	const int32 MaxDeleteWorkers = 16;
+}
+
+WFUTreeDeleter::WFUTreeDeleter()
+{
+	WorkAvailable = FPlatformProcess::GetSynchEventFromPool(false);
+	NumFilesDeleted = 0;
+	NumFoldersDeleted = 0;
+	NumFailed = 0;
+	bFinished = false;
+}
+
+WFUTreeDeleter::~WFUTreeDeleter()
+{
+	for (TFuture<void>& Worker : Workers)
+	{
+		Worker.Wait();
+	}
+	FPlatformProcess::ReturnSynchEventToPool(WorkAvailable);
+}
+
+bool WFUTreeDeleter::Delete(const FString& InRoot)
+{
+	FString Root = InRoot.Replace(TEXT("\\"), TEXT("/"));
+	Root.RemoveFromEnd(TEXT("/"));
+
+	const FFileStatData StatData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*Root);
+	if (!StatData.bIsValid || !StatData.bIsDirectory)
+	{
+		return false;
+	}
+
+	NumFilesDeleted = 0;
+	NumFoldersDeleted = 0;
+	NumFailed = 0;
+	bFinished = false;
+	Folders.Reset();
+
+	FFolder& RootFolder = Folders[Folders.AddDefaulted()];
+	RootFolder.Path = Root;
+	RootFolder.Parent = INDEX_NONE;
+	RootFolder.NumRemaining = 1;
+	Pending.Add(0);
+
+	const int32 NumWorkers = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1, MaxDeleteWorkers);
+	for (int32 Index = 0; Index < NumWorkers; Index++)
+	{
+		Workers.Add(WFULambdaRunnable::RunLambdaOnBackGroundThread([this]
+		{
+			RunWorker();
+		}));
+	}
+	for (TFuture<void>& Worker : Workers)
+	{
+		Worker.Wait();
+	}
+	Workers.Reset();
+
+	FScopeLock ScopeLock(&Lock);
+	if (NumFailed > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("WFUTreeDeleter: %d entries in %s couldn't be deleted"), NumFailed, *Root);
+	}
+	return NumFailed == 0;
+}
+
+int32 WFUTreeDeleter::GetNumFilesDeleted() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumFilesDeleted;
+}
+
+int32 WFUTreeDeleter::GetNumFoldersDeleted() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumFoldersDeleted;
+}
+
+int32 WFUTreeDeleter::GetNumFailed() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumFailed;
+}
+
+bool WFUTreeDeleter::IsInsideFolder(const FString& Path, const FString& Folder)
+{
+	const FString CanonicalPath = GetCanonicalPath(Path);
+	FString CanonicalFolder = GetCanonicalPath(Folder);
+	if (CanonicalPath.IsEmpty() || CanonicalFolder.IsEmpty())
+	{
+		return false;
+	}
+
+	//Whole path components only, /Game/Saved is not inside /Game/Save
+	if (!CanonicalFolder.EndsWith(TEXT("/")))
+	{
+		CanonicalFolder += TEXT("/");
+	}
+
+#if PLATFORM_WINDOWS
+	const ESearchCase::Type SearchCase = ESearchCase::IgnoreCase;
+#else
+	const ESearchCase::Type SearchCase = ESearchCase::CaseSensitive;
+#endif
+	return CanonicalPath.Len() > CanonicalFolder.Len() && CanonicalPath.StartsWith(CanonicalFolder, SearchCase);
+}
+
+FString WFUTreeDeleter::GetCanonicalPath(const FString& Path)
+{
+	FString Result = ResolvePath(FPaths::ConvertRelativePathToFull(Path));
+	Result.ReplaceInline(TEXT("\\"), TEXT("/"));
+	if (Result.Len() > 1)
+	{
+		Result.RemoveFromEnd(TEXT("/"));
+	}
+	return Result;
+}
+
+void WFUTreeDeleter::RunWorker()
+{
+	int32 Index;
+	FString Path;
+	while (PopFolder(Index, Path))
+	{
+		EmptyFolder(Index, Path);
+	}
+}
+
+bool WFUTreeDeleter::PopFolder(int32& OutIndex, FString& OutPath)
+{
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (bFinished)
+			{
+				//Events only wake one waiter, pass it on so every idle worker gets to leave
+				WorkAvailable->Trigger();
+				return false;
+			}
+			if (Pending.Num() > 0)
+			{
+				OutIndex = Pending.Pop(false);
+				OutPath = Folders[OutIndex].Path;
+				return true;
+			}
+		}
+		WorkAvailable->Wait();
+	}
+}
+
+void WFUTreeDeleter::EmptyFolder(int32 Index, const FString& Path)
+{
+	TArray<FString> Subfolders;
+	int32 NumDeleted = 0;
+	int32 NumLevelFailed = 0;
+	if (!EmptyLevel(Path, Subfolders, NumDeleted, NumLevelFailed))
+	{
+		//The folder itself won't go either, counted when removing it fails
+		UE_LOG(LogTemp, Warning, TEXT("WFUTreeDeleter: Failed to list %s"), *Path);
+	}
+
+	bool bEmptied = false;
+	{
+		FScopeLock ScopeLock(&Lock);
+		NumFilesDeleted += NumDeleted;
+		NumFailed += NumLevelFailed;
+
+		//The folder waits on each subfolder plus its own listing, which is done now
+		Folders[Index].NumRemaining += Subfolders.Num() - 1;
+		bEmptied = Folders[Index].NumRemaining == 0;
+
+		for (const FString& Subfolder : Subfolders)
+		{
+			const int32 ChildIndex = Folders.AddDefaulted();
+			FFolder& Child = Folders[ChildIndex];
+			Child.Path = Path / Subfolder;
+			Child.Parent = Index;
+			Child.NumRemaining = 1;
+			Pending.Add(ChildIndex);
+		}
+	}
+
+	//Each trigger wakes a single waiting worker, one per queued folder
+	for (int32 SubfolderIndex = 0; SubfolderIndex < Subfolders.Num(); SubfolderIndex++)
+	{
+		WorkAvailable->Trigger();
+	}
+	if (bEmptied)
+	{
+		RemoveFolders(Index, Path);
+	}
+}
+
+void WFUTreeDeleter::RemoveFolders(int32 Index, FString Path)
+{
+	//Each removed folder may have been the last thing its parent was waiting on
+	while (true)
+	{
+		const bool bRemoved = RemoveEmptyFolder(Path);
+
+		FScopeLock ScopeLock(&Lock);
+		if (bRemoved)
+		{
+			NumFoldersDeleted++;
+		}
+		else
+		{
+			NumFailed++;
+		}
+
+		const int32 Parent = Folders[Index].Parent;
+		if (Parent == INDEX_NONE)
+		{
+			bFinished = true;
+			WorkAvailable->Trigger();
+			return;
+		}
+
+		if (--Folders[Parent].NumRemaining > 0)
+		{
+			return;
+		}
+		Index = Parent;
+		Path = Folders[Parent].Path;
+	}
+}
@@ -0,0 +1,919 @@
+#include "WFUWatchService.h"
+#include "WindowsFileUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+
+#if PLATFORM_LINUX
+
+#include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace
+{
+	const uint32 WatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+	class FEntryCollector : public IPlatformFile::FDirectoryVisitor
+	{
+	public:
+		FEntryCollector(TArray<TPair<FString, bool>>& InEntries)
+			: Entries(InEntries)
+		{
+		}
+
+		virtual bool Visit(const TCHAR* FilenameOrDirectory, bool bIsDirectory) override
+		{
+			Entries.Emplace(FPaths::GetCleanFilename(FilenameOrDirectory), bIsDirectory);
+			return true;
+		}
+
+	private:
+		TArray<TPair<FString, bool>>& Entries;
+	};
+}
+
+/*
+inotify only watches a single folder, so every folder in the tree gets its own descriptor and new
+folders are picked up as they appear. Descriptors are shared when watches overlap, the kernel hands
+out the same one for the same folder.
+*/
+struct WFUWatchService::FBackend
+{
+	struct FWatchedDirectory
+	{
+		int32 Handle;
+		FString RelativePath;
+	};
+
+	int InotifyFd = -1;
+	int WakeFd = -1;
+	int EpollFd = -1;
+	TArray<uint8> Buffer;
+
+	//A move out of a folder, paired with the move in that carries the same cookie
+	struct FMoveFrom
+	{
+		uint32 Cookie;
+		int32 Handle;
+		FString RelativePath;
+		bool bIsDirectory;
+	};
+
+	TMap<int32, FString> Roots;
+	TMap<int, TArray<FWatchedDirectory>> Directories;
+	TArray<FMoveFrom> MovesFrom;
+
+	bool Init()
+	{
+		InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		EpollFd = epoll_create1(EPOLL_CLOEXEC);
+		if (InotifyFd < 0 || WakeFd < 0 || EpollFd < 0)
+		{
+			return false;
+		}
+
+		epoll_event Event = {};
+		Event.events = EPOLLIN;
+		Event.data.fd = InotifyFd;
+		epoll_ctl(EpollFd, EPOLL_CTL_ADD, InotifyFd, &Event);
+		Event.data.fd = WakeFd;
+		epoll_ctl(EpollFd, EPOLL_CTL_ADD, WakeFd, &Event);
+
+		Buffer.SetNumUninitialized(64 * 1024);
+		return true;
+	}
+
+	~FBackend()
+	{
+		//Closing the inotify descriptor drops every watch on it
+		for (int Fd : { EpollFd, WakeFd, InotifyFd })
+		{
+			if (Fd >= 0)
+			{
+				close(Fd);
+			}
+		}
+	}
+
+	void Wake()
+	{
+		const uint64 One = 1;
+		if (write(WakeFd, &One, sizeof(One)) < 0)
+		{
+			//Counter is already pending, the watch thread is waking up anyway
+		}
+	}
+
+	void AddWatch(WFUWatchService& Service, int32 Handle, const FString& Path)
+	{
+		FString Root = Path.Replace(TEXT("\\"), TEXT("/"));
+		Root.RemoveFromEnd(TEXT("/"));
+		Roots.Add(Handle, Root);
+
+		if (!AddTree(Service, Handle, FString(), false))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Can't watch %s"), *Path);
+			Roots.Remove(Handle);
+		}
+	}
+
+	void RemoveWatch(int32 Handle)
+	{
+		Forget(Handle, [](const FString&)
+		{
+			return true;
+		});
+		Roots.Remove(Handle);
+	}
+
+	void Wait(WFUWatchService& Service, int32 TimeoutMilliseconds)
+	{
+		epoll_event Events[2];
+		const int Count = epoll_wait(EpollFd, Events, 2, TimeoutMilliseconds);
+		if (Count < 0 && errno != EINTR)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: epoll_wait failed (%d)"), errno);
+		}
+
+		for (int Index = 0; Index < Count; Index++)
+		{
+			if (Events[Index].data.fd == WakeFd)
+			{
+				uint64 Value;
+				if (read(WakeFd, &Value, sizeof(Value)) < 0)
+				{
+					//Already reset
+				}
+			}
+			else
+			{
+				ReadEvents(Service);
+			}
+		}
+	}
+
+private:
+	/*
+	Watches RelativeDirectory and every folder below it. Folders that turn up while the watch is running
+	report what they already hold, as those files were created before their folder was watched.
+	*/
+	bool AddTree(WFUWatchService& Service, int32 Handle, const FString& RelativeDirectory, bool bReportContents)
+	{
+		const FString& Root = Roots[Handle];
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		TArray<FString> Stack;
+		Stack.Add(RelativeDirectory);
+		bool bWatchedAny = false;
+
+		while (Stack.Num() > 0)
+		{
+			const FString Relative = Stack.Pop(false);
+			const FString Directory = Relative.IsEmpty() ? Root : Root / Relative;
+
+			const int Descriptor = inotify_add_watch(InotifyFd, TCHAR_TO_UTF8(*Directory), WatchMask);
+			if (Descriptor < 0)
+			{
+				//Gone again or unreadable, there is nothing to report from it either way
+				continue;
+			}
+			bWatchedAny = true;
+
+			TArray<FWatchedDirectory>& Watched = Directories.FindOrAdd(Descriptor);
+			if (Watched.ContainsByPredicate([Handle](const FWatchedDirectory& Entry) { return Entry.Handle == Handle; }))
+			{
+				//Already seen through another event or a link back up the tree
+				continue;
+			}
+			Watched.Add({ Handle, Relative });
+
+			TArray<TPair<FString, bool>> Entries;
+			FEntryCollector Collector(Entries);
+			PlatformFile.IterateDirectory(*Directory, Collector);
+
+			for (const TPair<FString, bool>& Entry : Entries)
+			{
+				const FString EntryPath = Relative.IsEmpty() ? Entry.Key : Relative / Entry.Key;
+				if (bReportContents)
+				{
+					Service.Record(Handle, EWFUFolderChangeType::Created, EntryPath, Entry.Value);
+				}
+				if (Entry.Value)
+				{
+					Stack.Add(EntryPath);
+				}
+			}
+		}
+		return bWatchedAny;
+	}
+
+	//Drops Handle from every folder whose relative path passes ShouldForget, closing descriptors nobody else uses
+	void Forget(int32 Handle, TFunctionRef<bool(const FString&)> ShouldForget)
+	{
+		TArray<int> Unused;
+		for (TPair<int, TArray<FWatchedDirectory>>& Pair : Directories)
+		{
+			Pair.Value.RemoveAll([Handle, &ShouldForget](const FWatchedDirectory& Entry)
+			{
+				return Entry.Handle == Handle && ShouldForget(Entry.RelativePath);
+			});
+			if (Pair.Value.Num() == 0)
+			{
+				Unused.Add(Pair.Key);
+			}
+		}
+
+		for (int Descriptor : Unused)
+		{
+			inotify_rm_watch(InotifyFd, Descriptor);
+			Directories.Remove(Descriptor);
+		}
+	}
+
+	void ReadEvents(WFUWatchService& Service)
+	{
+		while (true)
+		{
+			const ssize_t Length = read(InotifyFd, Buffer.GetData(), Buffer.Num());
+			if (Length <= 0)
+			{
+				break;
+			}
+
+			const uint8* Cursor = Buffer.GetData();
+			const uint8* End = Cursor + Length;
+			while (Cursor < End)
+			{
+				const inotify_event* Event = (const inotify_event*)Cursor;
+				Cursor += sizeof(inotify_event) + Event->len;
+				HandleEvent(Service, *Event);
+			}
+		}
+
+		//Both halves of a move arrive in the same read, a half left alone went out of the watched tree
+		for (const FMoveFrom& Move : MovesFrom)
+		{
+			Service.Record(Move.Handle, EWFUFolderChangeType::Deleted, Move.RelativePath, Move.bIsDirectory);
+		}
+		MovesFrom.Reset();
+	}
+
+	void HandleEvent(WFUWatchService& Service, const inotify_event& Event)
+	{
+		if (Event.mask & IN_Q_OVERFLOW)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Too many changes at once, some were dropped"));
+			return;
+		}
+		if (Event.mask & IN_IGNORED)
+		{
+			//The folder itself is gone
+			Directories.Remove(Event.wd);
+			return;
+		}
+
+		const TArray<FWatchedDirectory>* Watched = Directories.Find(Event.wd);
+		if (Watched == nullptr || Event.len == 0)
+		{
+			return;
+		}
+
+		const FString Name = UTF8_TO_TCHAR(Event.name);
+		const bool bIsDirectory = (Event.mask & IN_ISDIR) != 0;
+
+		//Copied, adding a new folder below can grow Directories
+		const TArray<FWatchedDirectory> Targets = *Watched;
+		for (const FWatchedDirectory& Target : Targets)
+		{
+			const FString RelativePath = Target.RelativePath.IsEmpty() ? Name : Target.RelativePath / Name;
+
+			if (Event.mask & IN_MOVED_FROM)
+			{
+				MovesFrom.Add({ Event.cookie, Target.Handle, RelativePath, bIsDirectory });
+				if (bIsDirectory)
+				{
+					//Its descriptors would keep reporting under the old name
+					const FString Prefix = RelativePath + TEXT("/");
+					Forget(Target.Handle, [&RelativePath, &Prefix](const FString& Path)
+					{
+						return Path == RelativePath || Path.StartsWith(Prefix);
+					});
+				}
+			}
+			else if (Event.mask & IN_MOVED_TO)
+			{
+				const int32 MoveIndex = MovesFrom.IndexOfByPredicate([&Event, &Target](const FMoveFrom& Move)
+				{
+					return Move.Cookie == Event.cookie && Move.Handle == Target.Handle;
+				});
+
+				if (MoveIndex != INDEX_NONE)
+				{
+					Service.Record(Target.Handle, EWFUFolderChangeType::Renamed, RelativePath, bIsDirectory, MovesFrom[MoveIndex].RelativePath);
+					MovesFrom.RemoveAt(MoveIndex);
+				}
+				else
+				{
+					Service.Record(Target.Handle, EWFUFolderChangeType::Created, RelativePath, bIsDirectory);
+				}
+
+				if (bIsDirectory)
+				{
+					//A renamed folder's contents aren't new, one moved in from outside brings new files along
+					AddTree(Service, Target.Handle, RelativePath, MoveIndex == INDEX_NONE);
+				}
+			}
+			else if (Event.mask & IN_CREATE)
+			{
+				Service.Record(Target.Handle, EWFUFolderChangeType::Created, RelativePath, bIsDirectory);
+				if (bIsDirectory)
+				{
+					AddTree(Service, Target.Handle, RelativePath, true);
+				}
+			}
+			else if (Event.mask & IN_DELETE)
+			{
+				Service.Record(Target.Handle, EWFUFolderChangeType::Deleted, RelativePath, bIsDirectory);
+			}
+			else
+			{
+				Service.Record(Target.Handle, EWFUFolderChangeType::Modified, RelativePath, bIsDirectory);
+			}
+		}
+	}
+};
+
+#elif PLATFORM_WINDOWS
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+
+namespace
+{
+	const DWORD WatchFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+		FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_SIZE;
+
+	//ReadDirectoryChangesW fails on network shares with anything larger
+	const int32 NotifyBufferSize = 64 * 1024;
+}
+
+/*
+Every watch is one directory handle bound to a single completion port with a read always pending on it.
+Completion keys carry the watch, a null overlapped is a wake up.
+*/
+struct WFUWatchService::FBackend
+{
+	struct FDirectoryWatch
+	{
+		int32 Handle;
+		FString Root;
+		HANDLE Directory;
+		OVERLAPPED Overlapped;
+		TArray<uint8> Buffer;
+	};
+
+	HANDLE Port = nullptr;
+	TMap<int32, FDirectoryWatch*> Watches;
+
+	//A cancelled read still completes once, the watch is freed then
+	int32 NumClosing = 0;
+
+	bool Init()
+	{
+		Port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+		return Port != nullptr;
+	}
+
+	~FBackend()
+	{
+		for (TPair<int32, FDirectoryWatch*>& Pair : Watches)
+		{
+			Close(Pair.Value);
+		}
+		Watches.Empty();
+
+		while (NumClosing > 0)
+		{
+			DWORD Bytes = 0;
+			ULONG_PTR Key = 0;
+			LPOVERLAPPED Overlapped = nullptr;
+			if (!GetQueuedCompletionStatus(Port, &Bytes, &Key, &Overlapped, 1000) && Overlapped == nullptr)
+			{
+				//Buffers of reads that never completed are leaked rather than freed under the kernel
+				break;
+			}
+			if (Overlapped != nullptr)
+			{
+				delete (FDirectoryWatch*)Key;
+				NumClosing--;
+			}
+		}
+
+		if (Port != nullptr)
+		{
+			CloseHandle(Port);
+		}
+	}
+
+	void Wake()
+	{
+		PostQueuedCompletionStatus(Port, 0, 0, nullptr);
+	}
+
+	void AddWatch(WFUWatchService& Service, int32 Handle, const FString& Path)
+	{
+		HANDLE Directory = CreateFileW(*Path, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (Directory == INVALID_HANDLE_VALUE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Can't watch %s (%d)"), *Path, GetLastError());
+			return;
+		}
+
+		FDirectoryWatch* Watch = new FDirectoryWatch();
+		Watch->Handle = Handle;
+		Watch->Root = Path;
+		Watch->Directory = Directory;
+		Watch->Buffer.SetNumUninitialized(NotifyBufferSize);
+
+		if (CreateIoCompletionPort(Directory, Port, (ULONG_PTR)Watch, 0) == nullptr || !Issue(*Watch))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Can't watch %s (%d)"), *Path, GetLastError());
+			CloseHandle(Directory);
+			delete Watch;
+			return;
+		}
+		Watches.Add(Handle, Watch);
+	}
+
+	void RemoveWatch(int32 Handle)
+	{
+		FDirectoryWatch* Watch = nullptr;
+		if (Watches.RemoveAndCopyValue(Handle, Watch))
+		{
+			Close(Watch);
+		}
+	}
+
+	void Wait(WFUWatchService& Service, int32 TimeoutMilliseconds)
+	{
+		DWORD Bytes = 0;
+		ULONG_PTR Key = 0;
+		LPOVERLAPPED Overlapped = nullptr;
+		const DWORD Timeout = TimeoutMilliseconds < 0 ? INFINITE : (DWORD)TimeoutMilliseconds;
+		const bool bCompleted = GetQueuedCompletionStatus(Port, &Bytes, &Key, &Overlapped, Timeout) != 0;
+		if (Overlapped == nullptr)
+		{
+			return;
+		}
+
+		FDirectoryWatch* Watch = (FDirectoryWatch*)Key;
+		if (Watch->Directory == INVALID_HANDLE_VALUE)
+		{
+			delete Watch;
+			NumClosing--;
+			return;
+		}
+
+		if (!bCompleted)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Stopped watching %s (%d)"), *Watch->Root, GetLastError());
+			Watches.Remove(Watch->Handle);
+			CloseHandle(Watch->Directory);
+			delete Watch;
+			return;
+		}
+
+		if (Bytes == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Too many changes at once in %s, some were dropped"), *Watch->Root);
+		}
+		else
+		{
+			ReadEvents(Service, *Watch);
+		}
+
+		if (!Issue(*Watch))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Stopped watching %s (%d)"), *Watch->Root, GetLastError());
+			Watches.Remove(Watch->Handle);
+			CloseHandle(Watch->Directory);
+			delete Watch;
+		}
+	}
+
+private:
+	bool Issue(FDirectoryWatch& Watch)
+	{
+		FMemory::Memzero(Watch.Overlapped);
+		return ReadDirectoryChangesW(Watch.Directory, Watch.Buffer.GetData(), Watch.Buffer.Num(), TRUE, WatchFilter, nullptr, &Watch.Overlapped, nullptr) != 0;
+	}
+
+	void Close(FDirectoryWatch* Watch)
+	{
+		CancelIoEx(Watch->Directory, nullptr);
+		CloseHandle(Watch->Directory);
+		Watch->Directory = INVALID_HANDLE_VALUE;
+		NumClosing++;
+	}
+
+	void ReadEvents(WFUWatchService& Service, const FDirectoryWatch& Watch)
+	{
+		//A rename comes as the old name directly followed by the new one
+		FString RenamedFrom;
+		bool bRenameStarted = false;
+
+		const uint8* Cursor = Watch.Buffer.GetData();
+		while (true)
+		{
+			const FILE_NOTIFY_INFORMATION* Info = (const FILE_NOTIFY_INFORMATION*)Cursor;
+			const FString RelativePath = FString((int32)(Info->FileNameLength / sizeof(WCHAR)), Info->FileName).Replace(TEXT("\\"), TEXT("/"));
+
+			//Records don't say what changed, removed entries come out as files
+			const DWORD Attributes = GetFileAttributesW(*(Watch.Root / RelativePath));
+			const bool bIsDirectory = Attributes != INVALID_FILE_ATTRIBUTES && (Attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+
+			switch (Info->Action)
+			{
+			case FILE_ACTION_ADDED:
+				Service.Record(Watch.Handle, EWFUFolderChangeType::Created, RelativePath, bIsDirectory);
+				break;
+			case FILE_ACTION_REMOVED:
+				Service.Record(Watch.Handle, EWFUFolderChangeType::Deleted, RelativePath, bIsDirectory);
+				break;
+			case FILE_ACTION_RENAMED_OLD_NAME:
+				if (bRenameStarted)
+				{
+					Service.Record(Watch.Handle, EWFUFolderChangeType::Deleted, RenamedFrom, false);
+				}
+				RenamedFrom = RelativePath;
+				bRenameStarted = true;
+				break;
+			case FILE_ACTION_RENAMED_NEW_NAME:
+				if (bRenameStarted)
+				{
+					Service.Record(Watch.Handle, EWFUFolderChangeType::Renamed, RelativePath, bIsDirectory, RenamedFrom);
+					bRenameStarted = false;
+				}
+				else
+				{
+					Service.Record(Watch.Handle, EWFUFolderChangeType::Created, RelativePath, bIsDirectory);
+				}
+				break;
+			default:
+				Service.Record(Watch.Handle, EWFUFolderChangeType::Modified, RelativePath, bIsDirectory);
+				break;
+			}
+
+			if (Info->NextEntryOffset == 0)
+			{
+				break;
+			}
+			Cursor += Info->NextEntryOffset;
+		}
+
+		if (bRenameStarted)
+		{
+			Service.Record(Watch.Handle, EWFUFolderChangeType::Deleted, RenamedFrom, false);
+		}
+	}
+};
+
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#else
+
+struct WFUWatchService::FBackend
+{
+	bool Init()
+	{
+		UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Folder watching isn't supported on this platform"));
+		return false;
+	}
+
+	void Wake()
+	{
+	}
+
+	void AddWatch(WFUWatchService& Service, int32 Handle, const FString& Path)
+	{
+	}
+
+	void RemoveWatch(int32 Handle)
+	{
+	}
+
+	void Wait(WFUWatchService& Service, int32 TimeoutMilliseconds)
+	{
+	}
+};
+
+#endif
+
+namespace
+{
+	//A steady stream of changes still goes out after this many debounce windows
+	const double MaxDebounceWindows = 5.0;
+}
+
+WFUWatchService& WFUWatchService::Get()
+{
+	static WFUWatchService Service;
+	return Service;
+}
+
+WFUWatchService::WFUWatchService()
+{
+	NextHandle = 0;
+	bStopping = false;
+}
+
+WFUWatchService::~WFUWatchService()
+{
+	Shutdown();
+}
+
+int32 WFUWatchService::AddWatch(const FString& Path, FWFUWatchCallback Callback, float DebounceSeconds)
+{
+	FScopeLock ScopeLock(&Lock);
+	const int32 Handle = NextHandle++;
+
+	if (!Backend.IsValid())
+	{
+		Backend = MakeUnique<FBackend>();
+		if (!Backend->Init())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WFUWatchService: Can't start watching, %s won't report changes"), *Path);
+			Backend.Reset();
+			return Handle;
+		}
+
+		bStopping = false;
+		Thread = WFULambdaRunnable::RunLambdaOnBackGroundThread([this]
+		{
+			Run();
+		});
+	}
+
+	Callbacks.Add(Handle, MoveTemp(Callback));
+	Commands.Add({ Handle, Path, FMath::Max(DebounceSeconds, 0.f), true });
+	Backend->Wake();
+	return Handle;
+}
+
+void WFUWatchService::RemoveWatch(int32 Handle)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (Callbacks.Remove(Handle) == 0)
+	{
+		return;
+	}
+
+	Commands.Add({ Handle, FString(), 0.f, false });
+	Backend->Wake();
+}
+
+void WFUWatchService::Shutdown()
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (!Backend.IsValid())
+		{
+			return;
+		}
+		bStopping = true;
+		Backend->Wake();
+	}
+
+	Thread.Wait();
+
+	FScopeLock ScopeLock(&Lock);
+	Backend.Reset();
+	Commands.Empty();
+	Callbacks.Empty();
+	Pending.Empty();
+}
+
+void WFUWatchService::Run()
+{
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (bStopping)
+			{
+				return;
+			}
+		}
+
+		ApplyCommands();
+		Backend->Wait(*this, GetWaitMilliseconds());
+		FlushChanges();
+	}
+}
+
+void WFUWatchService::ApplyCommands()
+{
+	TArray<FCommand> Queued;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Swap(Queued, Commands);
+	}
+
+	for (const FCommand& Command : Queued)
+	{
+		if (Command.bAdd)
+		{
+			Pending.Add(Command.Handle).DebounceSeconds = Command.DebounceSeconds;
+			Backend->AddWatch(*this, Command.Handle, Command.Path);
+		}
+		else
+		{
+			Backend->RemoveWatch(Command.Handle);
+			Pending.Remove(Command.Handle);
+		}
+	}
+}
+
+void WFUWatchService::Record(int32 Handle, EWFUFolderChangeType Type, const FString& RelativePath, bool bIsDirectory, const FString& OldRelativePath)
+{
+	FPendingChanges* Changes = Pending.Find(Handle);
+	if (Changes == nullptr)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (Changes->IndexByPath.Num() == 0)
+	{
+		//Anything left in there was folded away to nothing
+		Changes->Changes.Reset();
+		Changes->FirstChangeTime = Now;
+	}
+	Changes->LastChangeTime = Now;
+
+	Changes->Merge(Type, RelativePath, bIsDirectory, OldRelativePath);
+}
+
+int32 WFUWatchService::GetWaitMilliseconds() const
+{
+	double DueTime = -1.0;
+	for (const TPair<int32, FPendingChanges>& Pair : Pending)
+	{
+		if (Pair.Value.IndexByPath.Num() > 0 && (DueTime < 0.0 || Pair.Value.GetDueTime() < DueTime))
+		{
+			DueTime = Pair.Value.GetDueTime();
+		}
+	}
+
+	if (DueTime < 0.0)
+	{
+		return -1;
+	}
+	return FMath::Max(FMath::CeilToInt((DueTime - FPlatformTime::Seconds()) * 1000.0), 0);
+}
+
+void WFUWatchService::FlushChanges()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	for (TPair<int32, FPendingChanges>& Pair : Pending)
+	{
+		FPendingChanges& Changes = Pair.Value;
+		if (Changes.IndexByPath.Num() == 0 || Changes.GetDueTime() > Now)
+		{
+			continue;
+		}
+
+		TArray<FWFUFolderChange> ChangeSet;
+		ChangeSet.Reserve(Changes.IndexByPath.Num());
+		for (FWFUFolderChange& Change : Changes.Changes)
+		{
+			//Folded away entries are left behind with an empty path
+			if (!Change.RelativePath.IsEmpty())
+			{
+				ChangeSet.Add(MoveTemp(Change));
+			}
+		}
+		Changes.Changes.Reset();
+		Changes.IndexByPath.Reset();
+
+		//Held while calling, so nothing runs for a watch once RemoveWatch has returned
+		FScopeLock ScopeLock(&Lock);
+		if (const FWFUWatchCallback* Callback = Callbacks.Find(Pair.Key))
+		{
+			(*Callback)(ChangeSet);
+		}
+	}
+}
+
+void WFUWatchService::FPendingChanges::Merge(EWFUFolderChangeType Type, const FString& RelativePath, bool bIsDirectory, const FString& OldRelativePath)
+{
+	if (Type == EWFUFolderChangeType::Renamed)
+	{
+		//Whatever already happened under the old name moves over to the new one
+		EWFUFolderChangeType MergedType = EWFUFolderChangeType::Renamed;
+		FString OriginalPath = OldRelativePath;
+		if (const int32* Index = IndexByPath.Find(OldRelativePath))
+		{
+			const FWFUFolderChange& Earlier = Changes[*Index];
+			if (Earlier.Type == EWFUFolderChangeType::Created)
+			{
+				MergedType = EWFUFolderChangeType::Created;
+			}
+			else if (Earlier.Type == EWFUFolderChangeType::Renamed)
+			{
+				OriginalPath = Earlier.OldRelativePath;
+			}
+			Drop(OldRelativePath);
+		}
+
+		if (MergedType == EWFUFolderChangeType::Renamed && OriginalPath == RelativePath)
+		{
+			//Renamed back, modified covers anything that might have happened in between
+			Set(EWFUFolderChangeType::Modified, RelativePath, bIsDirectory, FString());
+			return;
+		}
+		Set(MergedType, RelativePath, bIsDirectory, MergedType == EWFUFolderChangeType::Renamed ? OriginalPath : FString());
+		return;
+	}
+
+	const int32* Index = IndexByPath.Find(RelativePath);
+	if (Index == nullptr)
+	{
+		Set(Type, RelativePath, bIsDirectory, FString());
+		return;
+	}
+
+	FWFUFolderChange& Existing = Changes[*Index];
+	Existing.bIsDirectory |= bIsDirectory;
+
+	switch (Type)
+	{
+	case EWFUFolderChangeType::Created:
+	case EWFUFolderChangeType::Modified:
+		//Deleted and back again is a rewrite, anything else already says enough
+		if (Existing.Type == EWFUFolderChangeType::Deleted)
+		{
+			Existing.Type = EWFUFolderChangeType::Modified;
+		}
+		break;
+
+	case EWFUFolderChangeType::Deleted:
+		if (Existing.Type == EWFUFolderChangeType::Created)
+		{
+			Drop(RelativePath);
+		}
+		else if (Existing.Type == EWFUFolderChangeType::Renamed)
+		{
+			//Renamed then deleted, as far as anyone outside knows the original is gone
+			const FString OriginalPath = Existing.OldRelativePath;
+			const bool bWasDirectory = Existing.bIsDirectory;
+			Drop(RelativePath);
+			Merge(EWFUFolderChangeType::Deleted, OriginalPath, bWasDirectory, FString());
+		}
+		else
+		{
+			Existing.Type = EWFUFolderChangeType::Deleted;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void WFUWatchService::FPendingChanges::Set(EWFUFolderChangeType Type, const FString& RelativePath, bool bIsDirectory, const FString& OldRelativePath)
+{
+	int32 Index;
+	if (const int32* Existing = IndexByPath.Find(RelativePath))
+	{
+		Index = *Existing;
+	}
+	else
+	{
+		Index = Changes.AddDefaulted();
+		IndexByPath.Add(RelativePath, Index);
+	}
+
+	FWFUFolderChange& Change = Changes[Index];
+	Change.Type = Type;
+	Change.RelativePath = RelativePath;
+	Change.OldRelativePath = OldRelativePath;
+	Change.bIsDirectory = bIsDirectory;
+}
+
+void WFUWatchService::FPendingChanges::Drop(const FString& RelativePath)
+{
+	int32 Index;
+	if (IndexByPath.RemoveAndCopyValue(RelativePath, Index))
+	{
+		Changes[Index].RelativePath.Empty();
+	}
+}
+
+double WFUWatchService::FPendingChanges::GetDueTime() const
+{
+	return FMath::Min(LastChangeTime + DebounceSeconds, FirstChangeTime + DebounceSeconds * MaxDebounceWindows);
+}
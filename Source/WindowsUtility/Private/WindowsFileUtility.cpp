@@ -1,4 +1,5 @@
 #include "WindowsFileUtilityPrivatePCH.h"
+#include "WFUWatchService.h"
 
 class FWindowsFileUtility : public IWindowsFileUtility
 {
@@ -10,7 +11,7 @@ class FWindowsFileUtility : public IWindowsFileUtility
 
 	virtual void ShutdownModule() override
 	{
-
+		WFUWatchService::Get().Shutdown();
 	}
 };
 
@@ -2,412 +2,332 @@
 #include "WindowsFileUtilityPrivatePCH.h"
 #include "WFUFolderWatchInterface.h"
 #include "WFUFileListInterface.h"
+#include "WFUFileListLambdaDelegate.h"
+#include "WFUDirectoryWalker.h"
+#include "WFUWatchService.h"
+#include "WFUTreeDeleter.h"
+#include "WFUFileBatch.h"
+#include "WFUFileBatchLambdaDelegate.h"
+#include "HAL/PlatformFilemanager.h"
 
 
 //static TMAP definition
 TMap<FString, TArray<FWatcher>> UWindowsFileUtilityFunctionLibrary::Watchers = TMap<FString, TArray<FWatcher>>();
-int TotalWatchers = 0;
 
 UWindowsFileUtilityFunctionLibrary::UWindowsFileUtilityFunctionLibrary(const class FObjectInitializer& PCIP)
 	: Super(PCIP)
 {
 }
 
-#if PLATFORM_WINDOWS
-
-#include "Windows/AllowWindowsPlatformTypes.h"
-#include <shellapi.h>
-#include <Shlwapi.h>
-
-#pragma comment(lib, "Shlwapi.lib")
-
-bool UWindowsFileUtilityFunctionLibrary::DoesFileExist(const FString& FullPath)
+void UWindowsFileUtilityFunctionLibrary::ListContentsOfFolder(const FString& FullPath, UObject* Delegate)
 {
-	return 0 != PathFileExistsW(*FullPath);
+	ListContentsOfFolderFiltered(FullPath, Delegate, false, TArray<FString>(), TArray<FString>());
 }
 
-bool UWindowsFileUtilityFunctionLibrary::MoveFileTo(const FString& From, const FString& To)
+void UWindowsFileUtilityFunctionLibrary::ListContentsOfFolderFiltered(const FString& FullPath, UObject* Delegate, bool bRecursive, const TArray<FString>& IncludeGlobs, const TArray<FString>& ExcludeGlobs)
 {
-	//Using windows api
-	return 0 != MoveFileW(*From, *To);
-}
+	TWeakObjectPtr<UObject> WeakDelegate = Delegate;
 
+	//Everything is captured by value, the caller's strings are long gone by the time the walk runs
+	WFULambdaRunnable::RunLambdaOnBackGroundThread([FullPath, WeakDelegate, bRecursive, IncludeGlobs, ExcludeGlobs]()
+	{
+		WFUDirectoryWalker Walker;
+		Walker.SetRecursive(bRecursive);
+		Walker.SetFilters(IncludeGlobs, ExcludeGlobs);
 
-bool UWindowsFileUtilityFunctionLibrary::CreateDirectoryAt(const FString& FullPath)
-{
-	//Using windows api
-	return 0 != CreateDirectoryW(*FullPath, NULL);
-}
+		//A folder that can't be walked still ends in OnListDone, with nothing in it
+		const bool bStarted = Walker.Start(FullPath);
+		if (!bStarted)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::ListContentsOfFolder Error, %s is not a folder, listing aborted."), *FullPath);
+		}
 
-bool UWindowsFileUtilityFunctionLibrary::DeleteFileAt(const FString& FullPath)
-{
-	//Using windows api
-	return 0 != DeleteFileW(*FullPath);
-}
+		FWFUFolderListing Listing;
+		TArray<FWFUDirectoryEntry> Batch;
+		while (bStarted && Walker.NextBatch(Batch))
+		{
+			Listing.Reserve(Listing.Num() + Batch.Num());
+			for (FWFUDirectoryEntry& Entry : Batch)
+			{
+				Listing.Add(MoveTemp(Entry.RelativePath), Entry.Size, Entry.ModifiedTime, Entry.bIsDirectory);
+			}
+		}
 
-bool UWindowsFileUtilityFunctionLibrary::DeleteEmptyFolder(const FString& FullPath)
-{
-	//Using windows api
-	return 0 != RemoveDirectoryW(*FullPath);
-}
+		if (Walker.HadErrors())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::ListContentsOfFolder Some folders in %s couldn't be listed."), *FullPath);
+		}
 
-bool IsSubPathOf(const FString& path, const FString& basePath)
-{
-	return path.Contains(basePath);
+		//A single hop to the game thread for the whole listing
+		WFULambdaRunnable::RunShortLambdaOnGameThread([WeakDelegate, FullPath, Listing]
+		{
+			UObject* Delegate = WeakDelegate.Get();
+			if (Delegate == nullptr || !Delegate->GetClass()->ImplementsInterface(UWFUFileListInterface::StaticClass()))
+			{
+				return;
+			}
+
+			//Per entry events are still sent for existing listeners, from the same payload
+			TArray<FString> FileNames;
+			TArray<FString> FolderNames;
+			for (int32 Index = 0; Index < Listing.Num(); Index++)
+			{
+				const FString& RelativePath = Listing.RelativePaths[Index];
+				const FString ItemPath = FullPath / RelativePath;
+
+				if (Listing.IsDirectory[Index])
+				{
+					FolderNames.Add(RelativePath);
+					IWFUFileListInterface::Execute_OnListDirectoryFound(Delegate, RelativePath, ItemPath);
+				}
+				else
+				{
+					FileNames.Add(RelativePath);
+					const int32 ClampedSize = (int32)FMath::Min<int64>(Listing.Sizes[Index], MAX_int32);
+					IWFUFileListInterface::Execute_OnListFileFound(Delegate, RelativePath, ClampedSize, ItemPath);
+				}
+			}
+
+			IWFUFileListInterface::Execute_OnListResults(Delegate, FullPath, Listing);
+			IWFUFileListInterface::Execute_OnListDone(Delegate, FullPath, FileNames, FolderNames);
+		});
+	});
 }
 
-//Dangerous function not recommended to be exposed to blueprint 
-bool UWindowsFileUtilityFunctionLibrary::DeleteFolderRecursively(const FString& FullPath)
+void UWindowsFileUtilityFunctionLibrary::ListContentsOfFolderToCallback(const FString& FullPath, TFunction<void(const TArray<FString>&, const TArray<FString>&)> OnListCompleteCallback)
 {
-	//Only allow user to delete folders sub-class to game folder
-	if (!IsSubPathOf(FullPath, FPaths::ProjectDir()))
+	//Nothing else references the delegate, it stays rooted until the listing reports back
+	UWFUFileListLambdaDelegate* LambdaDelegate = NewObject<UWFUFileListLambdaDelegate>();
+	LambdaDelegate->AddToRoot();
+	LambdaDelegate->SetOnDoneCallback([LambdaDelegate, OnListCompleteCallback](const TArray<FString>& Files, const TArray<FString>& Folders)
 	{
-		return false;
-	}
+		LambdaDelegate->RemoveFromRoot();
+		if (OnListCompleteCallback != nullptr)
+		{
+			OnListCompleteCallback(Files, Folders);
+		}
+	});
 
-	int len = _tcslen(*FullPath);
-	TCHAR *pszFrom = new TCHAR[len + 2];
-	wcscpy_s(pszFrom, len + 2, *FullPath);
-	pszFrom[len] = 0;
-	pszFrom[len + 1] = 0;
-
-	SHFILEOPSTRUCT fileop;
-	fileop.hwnd = NULL;    // no status display
-	fileop.wFunc = FO_DELETE;  // delete operation
-	fileop.pFrom = pszFrom;  // source file name as double null terminated string
-	fileop.pTo = NULL;    // no destination needed
-	fileop.fFlags = FOF_NOCONFIRMATION | FOF_SILENT;  // do not prompt the user
-
-	fileop.fAnyOperationsAborted = FALSE;
-	fileop.lpszProgressTitle = NULL;
-	fileop.hNameMappings = NULL;
-
-	int ret = SHFileOperation(&fileop);
-	delete[] pszFrom;
-	return (ret == 0);
+	ListContentsOfFolder(FullPath, LambdaDelegate);
 }
 
-void UWindowsFileUtilityFunctionLibrary::WatchFolder(const FString& FullPath, UObject* WatcherDelegate)
+void UWindowsFileUtilityFunctionLibrary::WatchFolder(const FString& FullPath, UObject* WatcherDelegate, float DebounceSeconds)
 {
-	//Do we have an entry for this path?
-	if (!Watchers.Contains(FullPath))
-	{
-		//Make an entry
-		TArray<FWatcher> FreshList;
-		Watchers.Add(FullPath, FreshList);
-		Watchers[FullPath] = FreshList;
-	}
-	else
+	//Do we already watch from this object?
+	TArray<FWatcher>& PathWatchers = Watchers.FindOrAdd(FullPath);
+	for (const FWatcher& Watcher : PathWatchers)
 	{
-		//if we do do we already watch from this object?
-		TArray<FWatcher>& PathWatchers = Watchers[FullPath];
-
-		for (auto Watcher : PathWatchers)
+		if (Watcher.Delegate == WatcherDelegate)
 		{
-			if (Watcher.Delegate == WatcherDelegate)
-			{
-				//Already accounted for
-				UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::WatchFolder Duplicate watcher ignored!"));
-				return;
-			}
+			//Already accounted for
+			UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::WatchFolder Duplicate watcher ignored!"));
+			return;
 		}
 	}
 
-
-	//Add to watchers
 	FWatcher FreshWatcher;
 	FreshWatcher.Delegate = WatcherDelegate;
 	FreshWatcher.Path = FullPath;
 
-	const FWatcher* WatcherPtr = &FreshWatcher;
-
-	//fork this off to another process
-	FreshWatcher.ThreadFuture = WFULambdaRunnable::RunLambdaOnBackGroundThread([FullPath, WatcherDelegate, WatcherPtr]()
+	//All watches share one service thread, each debounced change set hops to the game thread once
+	TWeakObjectPtr<UObject> WeakDelegate = WatcherDelegate;
+	FreshWatcher.WatchHandle = WFUWatchService::Get().AddWatch(FullPath, [FullPath, WeakDelegate](const TArray<FWFUFolderChange>& Changes)
 	{
-		 UWindowsFileUtilityFunctionLibrary::WatchFolderOnBgThread(FullPath, WatcherPtr);
-	});
+		WFULambdaRunnable::RunShortLambdaOnGameThread([FullPath, WeakDelegate, Changes]
+		{
+			UObject* Delegate = WeakDelegate.Get();
+			if (Delegate == nullptr || !Delegate->GetClass()->ImplementsInterface(UWFUFolderWatchInterface::StaticClass()))
+			{
+				return;
+			}
+
+			IWFUFolderWatchInterface::Execute_OnFolderChanges(Delegate, FullPath, Changes);
+
+			//Per path events for existing listeners, from the same folded set
+			for (const FWFUFolderChange& Change : Changes)
+			{
+				const FString ChangedPath = FullPath / Change.RelativePath;
+				if (Change.bIsDirectory)
+				{
+					IWFUFolderWatchInterface::Execute_OnDirectoryChanged(Delegate, Change.RelativePath, ChangedPath);
+				}
+				else
+				{
+					IWFUFolderWatchInterface::Execute_OnFileChanged(Delegate, Change.RelativePath, ChangedPath);
+				}
+			}
+		});
+	}, DebounceSeconds);
 
-	TArray<FWatcher>& PathWatchers = Watchers[FullPath];
 	PathWatchers.Add(FreshWatcher);
 }
 
 void UWindowsFileUtilityFunctionLibrary::StopWatchingFolder(const FString& FullPath, UObject* WatcherDelegate)
 {
 	//Do we have an entry?
-	if (!Watchers.Contains(FullPath))
+	TArray<FWatcher>* PathWatchers = Watchers.Find(FullPath);
+	if (PathWatchers == nullptr)
 	{
 		return;
 	}
 
 	//We have an entry for this path, remove our watcher
-	TArray<FWatcher> PathWatchers = Watchers[FullPath];
-	for (int i = 0; i < PathWatchers.Num();i++)
+	for (int32 i = 0; i < PathWatchers->Num(); i++)
 	{
-		FWatcher& PathWatcher = PathWatchers[i];
+		const FWatcher& PathWatcher = (*PathWatchers)[i];
 		if (PathWatcher.Delegate == WatcherDelegate)
 		{
-			//Stop the runnable
-			PathWatcher.ShouldRun = false;
-			//PathWatcher.Runnable->Stop();
-
-			//Remove the watcher and we're done
-			PathWatchers.RemoveAt(i);
+			WFUWatchService::Get().RemoveWatch(PathWatcher.WatchHandle);
+			PathWatchers->RemoveAt(i);
 			break;
 		}
 	}
-}
 
-void UWindowsFileUtilityFunctionLibrary::ListContentsOfFolder(const FString& FullPath, UObject* Delegate)
-{
-	//Longer than max path? throw error
-	if (FullPath.Len() > MAX_PATH)
+	if (PathWatchers->Num() == 0)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::ListContentsOfFolder Error, path too long, listing aborted."));
-		return;
+		Watchers.Remove(FullPath);
 	}
+}
 
-	WFULambdaRunnable::RunLambdaOnBackGroundThread([&FullPath, Delegate]()
-	{
-		WIN32_FIND_DATA ffd;
-		LARGE_INTEGER filesize;
-		HANDLE hFind = INVALID_HANDLE_VALUE;
-		DWORD dwError = 0;
+void UWindowsFileUtilityFunctionLibrary::MoveFilesTo(const TArray<FString>& From, const TArray<FString>& To, UObject* BatchDelegate)
+{
+	RunFileBatch(EWFUFileBatchOperation::Move, From, To, BatchDelegate);
+}
+
+void UWindowsFileUtilityFunctionLibrary::CopyFilesTo(const TArray<FString>& From, const TArray<FString>& To, UObject* BatchDelegate)
+{
+	RunFileBatch(EWFUFileBatchOperation::Copy, From, To, BatchDelegate);
+}
 
-		FString SearchPath = FullPath + TEXT("\\*");
+void UWindowsFileUtilityFunctionLibrary::DeleteFilesAt(const TArray<FString>& FullPaths, UObject* BatchDelegate)
+{
+	RunFileBatch(EWFUFileBatchOperation::Delete, FullPaths, TArray<FString>(), BatchDelegate);
+}
 
-		hFind = FindFirstFile(*SearchPath, &ffd);
+void UWindowsFileUtilityFunctionLibrary::DoFilesExist(const TArray<FString>& FullPaths, UObject* BatchDelegate)
+{
+	RunFileBatch(EWFUFileBatchOperation::Exists, FullPaths, TArray<FString>(), BatchDelegate);
+}
 
-		if (INVALID_HANDLE_VALUE == hFind)
+void UWindowsFileUtilityFunctionLibrary::RunFileBatchToCallback(EWFUFileBatchOperation Operation, const TArray<FString>& Paths, const TArray<FString>& Destinations, TFunction<void(const FWFUFileBatchResult&)> OnBatchDoneCallback)
+{
+	//Nothing else references the delegate, it stays rooted until the batch reports back
+	UWFUFileBatchLambdaDelegate* LambdaDelegate = NewObject<UWFUFileBatchLambdaDelegate>();
+	LambdaDelegate->AddToRoot();
+	LambdaDelegate->SetOnDoneCallback([LambdaDelegate, OnBatchDoneCallback](const FWFUFileBatchResult& Result)
+	{
+		LambdaDelegate->RemoveFromRoot();
+		if (OnBatchDoneCallback != nullptr)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::ListContentsOfFolder Error, invalid handle, listing aborted."));
-			return;
+			OnBatchDoneCallback(Result);
 		}
+	});
 
-		//Arrays to hold full information on Done
-		TArray<FString> FileNames;
-		TArray<FString> FolderNames;
+	RunFileBatch(Operation, Paths, Destinations, LambdaDelegate);
+}
 
-		//List loop, callback on game thread
-		do
-		{
-			FString Name = FString(ffd.cFileName);
-			FString ItemPath = FullPath + TEXT("\\") + Name;
+void UWindowsFileUtilityFunctionLibrary::RunFileBatch(EWFUFileBatchOperation Operation, const TArray<FString>& Paths, const TArray<FString>& Destinations, UObject* BatchDelegate)
+{
+	//Like listings, the whole batch comes back to the game thread in a single hop
+	TWeakObjectPtr<UObject> WeakDelegate = BatchDelegate;
+	WFULambdaRunnable::RunLambdaOnBackGroundThread([Operation, Paths, Destinations, WeakDelegate]
+	{
+		FWFUFileBatchResult Result = WFUFileBatch::Run(Operation, Paths, Destinations);
 
-			//UE_LOG(LogTemp, Log, TEXT("Name: <%s>"), *Name);
-			
-			if (Name.Equals(FString(TEXT("."))) ||
-				Name.Equals(FString(TEXT(".."))) )
-			{
-				//ignore these first
-			}
-			//Folder
-			else if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-			{
-				FolderNames.Add(Name);
-				WFULambdaRunnable::RunShortLambdaOnGameThread([Delegate, ItemPath, Name]
-				{
-					((IWFUFileListInterface*)Delegate)->Execute_OnListDirectoryFound((UObject*)Delegate, Name, ItemPath);
-				});
-			}
-			//File
-			else
+		WFULambdaRunnable::RunShortLambdaOnGameThread([WeakDelegate, Result]
+		{
+			UObject* Delegate = WeakDelegate.Get();
+			if (Delegate == nullptr || !Delegate->GetClass()->ImplementsInterface(UWFUFileBatchInterface::StaticClass()))
 			{
-				FileNames.Add(Name);
-
-				filesize.LowPart = ffd.nFileSizeLow;
-				filesize.HighPart = ffd.nFileSizeHigh;
-				int32 TruncatedFileSize = filesize.QuadPart;
-
-				WFULambdaRunnable::RunShortLambdaOnGameThread([Delegate, ItemPath, Name, TruncatedFileSize]
-				{
-					((IWFUFileListInterface*)Delegate)->Execute_OnListFileFound((UObject*)Delegate, Name, TruncatedFileSize, ItemPath);
-				});
+				return;
 			}
-
-		} while (FindNextFile(hFind, &ffd) != 0);
-
-		dwError = GetLastError();
-		if (dwError != ERROR_NO_MORE_FILES)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::ListContentsOfFolder Error while listing."));
-			return;
-		}
-
-		FindClose(hFind);
-
-		//Done callback with full list of names found
-		WFULambdaRunnable::RunShortLambdaOnGameThread([Delegate, FullPath, FileNames, FolderNames]
-		{
-			((IWFUFileListInterface*)Delegate)->Execute_OnListDone((UObject*)Delegate, FullPath, FileNames, FolderNames);
+			IWFUFileBatchInterface::Execute_OnBatchDone(Delegate, Result);
 		});
 	});
 }
 
-void UWindowsFileUtilityFunctionLibrary::ListContentsOfFolderToCallback(const FString& FullPath, TFunction<void(const TArray<FString>&, const TArray<FString>&)> OnListCompleteCallback)
-{
-	UWFUFileListLambdaDelegate* LambdaDelegate = NewObject<UWFUFileListLambdaDelegate>();
-	LambdaDelegate->SetOnDoneCallback(OnListCompleteCallback);
-
-	ListContentsOfFolder(FullPath, LambdaDelegate);
-}
-
-void UWindowsFileUtilityFunctionLibrary::WatchFolderOnBgThread(const FString& FullPath, const FWatcher* WatcherPtr)
+//Dangerous function not recommended to be exposed to blueprint 
+bool UWindowsFileUtilityFunctionLibrary::DeleteFolderRecursively(const FString& FullPath)
 {
-	//mostly from https://msdn.microsoft.com/en-us/library/windows/desktop/aa365261(v=vs.85).aspx
-	//call the delegate when the folder changes
-
-	//TODO: find out which file changed
-	
-	DWORD dwWaitStatus;
-	HANDLE dwChangeHandles[2];
-	TCHAR lpDrive[4];
-	TCHAR lpFile[_MAX_FNAME];
-	TCHAR lpExt[_MAX_EXT];
-
-	//finding out about the notification
-	FILE_NOTIFY_INFORMATION strFileNotifyInfo[1024];
-	DWORD dwBytesReturned = 0;
-
-	_tsplitpath_s(*FullPath, lpDrive, 4, NULL, 0, lpFile, _MAX_FNAME, lpExt, _MAX_EXT);
-	lpDrive[2] = (TCHAR)'\\';
-	lpDrive[3] = (TCHAR)'\0';
-
-	// Watch the directory for file creation and deletion. 
-
-	dwChangeHandles[0] = FindFirstChangeNotification(
-		*FullPath,                     // directory to watch 
-		TRUE,						   // watch the subtree 
-		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | 
-		FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_ATTRIBUTES	| FILE_NOTIFY_CHANGE_SIZE// watch for generic file changes
-		); // watch last write or file size change
-
-	if (dwChangeHandles[0] == INVALID_HANDLE_VALUE)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("\n ERROR: FindFirstChangeNotification function failed.\n"));
-		//ExitProcess(GetLastError());
-	}
-
-	// Watch the subtree for directory creation and deletion. 
-
-	dwChangeHandles[1] = FindFirstChangeNotification(
-		lpDrive,                       // directory to watch 
-		TRUE,                          // watch the subtree 
-		FILE_NOTIFY_CHANGE_DIR_NAME);  // watch dir name changes 
-
-	if (dwChangeHandles[1] == INVALID_HANDLE_VALUE)
+	//Only allow user to delete folders sub-class to game folder, compared on resolved paths so '..' or links can't step outside
+	if (!WFUTreeDeleter::IsInsideFolder(FullPath, FPaths::ProjectDir()))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("\n ERROR: FindFirstChangeNotification function failed.\n"));
-		//ExitProcess(GetLastError());
-	}
-
-	// Make a final validation check on our handles.
-	if ((dwChangeHandles[0] == NULL) || (dwChangeHandles[1] == NULL))
-	{
-		UE_LOG(LogTemp, Warning, TEXT("\n ERROR: Unexpected NULL from FindFirstChangeNotification.\n"));
-		//ExitProcess(GetLastError());
+		UE_LOG(LogTemp, Warning, TEXT("UWindowsFileUtilityFunctionLibrary::DeleteFolderRecursively %s is not inside the project folder, nothing deleted."), *FullPath);
+		return false;
 	}
-	const FString DrivePath = FString(lpDrive);
-	FString FileString;
-	FString DirectoryString;
-	const UObject* WatcherDelegate = WatcherPtr->Delegate;
 
-	//Wait while the runnable pointer hasn't been set
-
-	TotalWatchers++;
-	UE_LOG(LogTemp, Log, TEXT("\nStarting Watcher loop %d...\n"), TotalWatchers);
-
-	while (WatcherPtr->ShouldRun)	//Watcher.Runnable->Finished == false
-	{
-		// Wait for notification.
-		//UE_LOG(LogTemp, Log, TEXT("\nWaiting for notification...\n"));
-
-		dwWaitStatus = WaitForMultipleObjects(2, dwChangeHandles,
-			FALSE, INFINITE);
-
-		if (!WatcherPtr->ShouldRun)
-		{
-			UE_LOG(LogTemp, Log, TEXT("\nStop called while sleeping\n"));
-			break;
-		}
-		if (!WatcherDelegate->IsValidLowLevel())
-		{
-			UE_LOG(LogTemp, Warning, TEXT("\nInvalid Watcher Delegate, exiting watch\n"));
-			break;
-		}
+	WFUTreeDeleter Deleter;
+	return Deleter.Delete(FullPath);
+}
 
-		switch (dwWaitStatus)
-		{
-		case WAIT_OBJECT_0:
+#if PLATFORM_WINDOWS
 
-			ReadDirectoryChangesW(dwChangeHandles[0], (LPVOID)&strFileNotifyInfo, sizeof(strFileNotifyInfo), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE, &dwBytesReturned, NULL, NULL);
-			//UE_LOG(LogTemp, Warning, TEXT("Received info about: %s"), strFileNotifyInfo->FileName);
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <shellapi.h>
+#include <Shlwapi.h>
 
-			FileString = FString(strFileNotifyInfo[0].FileNameLength, strFileNotifyInfo[0].FileName);
+#pragma comment(lib, "Shlwapi.lib")
 
-			// A file was created, renamed, or deleted in the directory.
-			// Refresh this directory and restart the notification.
+bool UWindowsFileUtilityFunctionLibrary::DoesFileExist(const FString& FullPath)
+{
+	return 0 != PathFileExistsW(*FullPath);
+}
 
-			
+bool UWindowsFileUtilityFunctionLibrary::MoveFileTo(const FString& From, const FString& To)
+{
+	//Using windows api
+	return 0 != MoveFileW(*From, *To);
+}
 
-			WFULambdaRunnable::RunShortLambdaOnGameThread([FullPath, FileString, WatcherDelegate]()
-			{
-				if (WatcherDelegate->GetClass()->ImplementsInterface(UWFUFolderWatchInterface::StaticClass()))
-				{
-					FString FilePath = FString::Printf(TEXT("%s\\%s"), *FullPath, *FileString);
-					((IWFUFolderWatchInterface*)WatcherDelegate)->Execute_OnFileChanged((UObject*)WatcherDelegate, FileString, FilePath);
-				}
-			});
-			if (FindNextChangeNotification(dwChangeHandles[0]) == FALSE)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("\n ERROR: FindNextChangeNotification function failed.\n"));
-				return;
-			}
-			break;
 
-		case WAIT_OBJECT_0 + 1:
+bool UWindowsFileUtilityFunctionLibrary::CreateDirectoryAt(const FString& FullPath)
+{
+	//Using windows api
+	return 0 != CreateDirectoryW(*FullPath, NULL);
+}
 
-			// A directory was created, renamed, or deleted.
-			// Refresh the tree and restart the notification.
+bool UWindowsFileUtilityFunctionLibrary::DeleteFileAt(const FString& FullPath)
+{
+	//Using windows api
+	return 0 != DeleteFileW(*FullPath);
+}
 
-			ReadDirectoryChangesW(dwChangeHandles[1], (LPVOID)&strFileNotifyInfo, sizeof(strFileNotifyInfo), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE, &dwBytesReturned, NULL, NULL);
-			DirectoryString = FString(strFileNotifyInfo[0].FileNameLength, strFileNotifyInfo[0].FileName);
+bool UWindowsFileUtilityFunctionLibrary::DeleteEmptyFolder(const FString& FullPath)
+{
+	//Using windows api
+	return 0 != RemoveDirectoryW(*FullPath);
+}
 
-			WFULambdaRunnable::RunShortLambdaOnGameThread([FullPath, WatcherDelegate, DirectoryString]()
-			{
-				if (WatcherDelegate->GetClass()->ImplementsInterface(UWFUFolderWatchInterface::StaticClass()))
-				{
-					FString ChangedDirectoryPath = FString::Printf(TEXT("%s\\%s"), *FullPath, *DirectoryString);
-					((IWFUFolderWatchInterface*)WatcherDelegate)->Execute_OnDirectoryChanged((UObject*)WatcherDelegate, DirectoryString, ChangedDirectoryPath);
-				}
-			});
-			if (FindNextChangeNotification(dwChangeHandles[1]) == FALSE)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("\n ERROR: FindNextChangeNotification function failed.\n"));
-				return;
-			}
-			break;
+#include "Windows/HideWindowsPlatformTypes.h"
 
-		case WAIT_TIMEOUT:
+#else
 
-			// A timeout occurred, this would happen if some value other 
-			// than INFINITE is used in the Wait call and no changes occur.
-			// In a single-threaded environment you might not want an
-			// INFINITE wait.
+//Elsewhere the engine's platform file does the same, including directories where the Win32 calls accept them
+bool UWindowsFileUtilityFunctionLibrary::DoesFileExist(const FString& FullPath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	return PlatformFile.FileExists(*FullPath) || PlatformFile.DirectoryExists(*FullPath);
+}
 
-			UE_LOG(LogTemp, Warning, TEXT("\nNo changes in the timeout period.\n"));
-			break;
+bool UWindowsFileUtilityFunctionLibrary::MoveFileTo(const FString& From, const FString& To)
+{
+	return FPlatformFileManager::Get().GetPlatformFile().MoveFile(*To, *From);
+}
 
-		default:
-			UE_LOG(LogTemp, Warning, TEXT("\n ERROR: Unhandled dwWaitStatus.\n"));
-			return;
-			break;
-		}
-	}
+bool UWindowsFileUtilityFunctionLibrary::CreateDirectoryAt(const FString& FullPath)
+{
+	return FPlatformFileManager::Get().GetPlatformFile().CreateDirectory(*FullPath);
+}
 
-	TotalWatchers--;
-	UE_LOG(LogTemp, Log, TEXT("\n Watcher loop stopped, total now: %d.\n"), TotalWatchers);
+bool UWindowsFileUtilityFunctionLibrary::DeleteFileAt(const FString& FullPath)
+{
+	return FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FullPath);
 }
 
-#include "Windows/HideWindowsPlatformTypes.h"
+bool UWindowsFileUtilityFunctionLibrary::DeleteEmptyFolder(const FString& FullPath)
+{
+	//Only removes the folder if it is empty, same as RemoveDirectoryW
+	return FPlatformFileManager::Get().GetPlatformFile().DeleteDirectory(*FullPath);
+}
 
 #endif
\ No newline at end of file
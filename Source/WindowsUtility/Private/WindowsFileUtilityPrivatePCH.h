@@ -8,3 +8,4 @@
 #include "WFULambdaRunnable.h"
 #include "WFUFileListInterface.h"
 #include "WFUFolderWatchInterface.h"
+#include "WFUFileBatchInterface.h"
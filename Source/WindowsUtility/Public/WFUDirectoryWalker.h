@@ -0,0 +1,102 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class FEvent;
+
+/** A file or folder found by WFUDirectoryWalker. */
+struct FWFUDirectoryEntry
+{
+	FString Path;
+
+	//Relative to the walked root, '/' separated
+	FString RelativePath;
+
+	int64 Size = 0;
+	FDateTime ModifiedTime;
+	bool bIsDirectory = false;
+
+	//A symlinked folder or junction, listed but not walked into
+	bool bIsLink = false;
+};
+
+/*
+Parallel recursive directory walk. Every worker takes a folder off a shared queue, lists that one
+level and queues the subfolders it found, so wide trees on slow or network storage are listed by
+several workers at once. Entries are handed out in batches while the walk is still running, a
+folder always ahead of its contents.
+
+Filters are applied while walking, so an excluded folder is never listed at all. Symlinked folders and
+junctions are reported but not descended into, so a link back up the tree can't loop.
+*/
+class WINDOWSFILEUTILITY_API WFUDirectoryWalker
+{
+public:
+	WFUDirectoryWalker();
+
+	//Cancels the walk and waits for the workers
+	~WFUDirectoryWalker();
+
+	/*
+	Starts walking Root on dedicated background threads and returns right away, the workers block on I/O
+	and would otherwise hold up task graph work. Returns false if Root isn't a folder.
+	*/
+	bool Start(const FString& InRoot);
+
+	//Set before Start. When off only the root itself is listed
+	void SetRecursive(bool bInRecursive);
+
+	/*
+	Set before Start. Globs use '*' and '?' and are tested against both the relative path and the bare name,
+	case insensitive. Excluded entries are dropped and excluded folders aren't descended into. When include
+	globs are given only matching entries are handed out, but every folder not excluded is still walked.
+	*/
+	void SetFilters(const TArray<FString>& InIncludeGlobs, const TArray<FString>& InExcludeGlobs);
+
+	/*
+	Waits for entries found since the last call. Returns false once the walk is done and everything has been handed out.
+	*/
+	bool NextBatch(TArray<FWFUDirectoryEntry>& OutEntries);
+
+	void Cancel();
+
+	//Once finished the totals below are final
+	bool IsFinished() const;
+
+	//Running totals over files found so far, folders aren't counted
+	int32 GetNumFiles() const;
+	int64 GetTotalBytes() const;
+
+	//True if any folder couldn't be listed, the walk carries on past it
+	bool HadErrors() const;
+
+private:
+	void RunWorker();
+	bool PopDirectory(FString& OutRelativeDirectory);
+	void ListDirectory(const FString& RelativeDirectory);
+	bool IsIncluded(const FString& RelativePath) const;
+
+	FString Root;
+	bool bRecursive;
+	TArray<FString> IncludeGlobs;
+	TArray<FString> ExcludeGlobs;
+
+	mutable FCriticalSection Lock;
+	FEvent* WorkAvailable;
+	FEvent* ResultsAvailable;
+
+	//Folders still to list, taken newest first so the queue stays shallow
+	TArray<FString> Pending;
+	int32 NumBusy;
+
+	TArray<FWFUDirectoryEntry> Results;
+	int32 NumFiles;
+	int64 TotalBytes;
+
+	bool bFinished;
+	bool bCancelled;
+	bool bHadErrors;
+
+	TArray<TFuture<void>> Workers;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WFUFileBatchInterface.h"
+
+/*
+Runs a move, copy, delete or exists check over many paths at once, spread over task graph workers.
+
+Copies try the cheapest route first. On Linux that is a FICLONE reflink, which shares the data blocks
+on btrfs, XFS and similar, then copy_file_range, which copies inside the kernel and lets network file
+systems copy server side, and only then a read/write loop. Moves rename and fall back to copy and delete
+across volumes. Destination folders are created as needed and existing destinations are replaced.
+*/
+class WINDOWSFILEUTILITY_API WFUFileBatch
+{
+public:
+	//Blocks until every item is done. Destinations are only read for Move and Copy and must match Paths one to one
+	static FWFUFileBatchResult Run(EWFUFileBatchOperation Operation, const TArray<FString>& Paths, const TArray<FString>& Destinations);
+
+	//Single items, also safe to call from any thread
+	static bool CopyFileTo(const FString& From, const FString& To);
+	static bool MoveFileTo(const FString& From, const FString& To);
+	static bool DeleteFileAt(const FString& Path);
+
+	//Files and folders both count
+	static bool Exists(const FString& Path);
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "WFUFileBatchInterface.generated.h"
+
+UENUM(BlueprintType)
+enum class EWFUFileBatchOperation : uint8
+{
+	Move,
+	Copy,
+	Delete,
+	Exists
+};
+
+/**
+* Outcome of a whole batch, Succeeded[i] belongs to Paths[i]. For Exists it tells whether the path exists.
+*/
+USTRUCT(BlueprintType)
+struct WINDOWSFILEUTILITY_API FWFUFileBatchResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = FileBatch)
+	EWFUFileBatchOperation Operation = EWFUFileBatchOperation::Exists;
+
+	//Sources for moves and copies, in the order they were given
+	UPROPERTY(BlueprintReadOnly, Category = FileBatch)
+	TArray<FString> Paths;
+
+	//Destinations for moves and copies, empty otherwise
+	UPROPERTY(BlueprintReadOnly, Category = FileBatch)
+	TArray<FString> Destinations;
+
+	UPROPERTY(BlueprintReadOnly, Category = FileBatch)
+	TArray<bool> Succeeded;
+
+	UPROPERTY(BlueprintReadOnly, Category = FileBatch)
+	int32 NumFailed = 0;
+};
+
+UINTERFACE(MinimalAPI)
+class UWFUFileBatchInterface : public UInterface
+{
+	GENERATED_UINTERFACE_BODY()
+};
+
+class WINDOWSFILEUTILITY_API IWFUFileBatchInterface
+{
+	GENERATED_IINTERFACE_BODY()
+
+public:
+
+	/**
+	* Called once when every item of a batch has been handled
+	* @param Result status of each item, in the order the paths were given
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = FileBatchEvent)
+	void OnBatchDone(const FWFUFileBatchResult& Result);
+};
@@ -4,6 +4,51 @@
 
 #include "WFUFileListInterface.generated.h"
 
+/**
+* Everything a listing found, one array per field so large listings cross to the game thread in a single payload.
+* Entry i is RelativePaths[i], Sizes[i], ModifiedTimes[i] and IsDirectory[i].
+*/
+USTRUCT(BlueprintType)
+struct WINDOWSFILEUTILITY_API FWFUFolderListing
+{
+	GENERATED_BODY()
+
+	//Relative to the listed folder, '/' separated
+	UPROPERTY(BlueprintReadOnly, Category = FileList)
+	TArray<FString> RelativePaths;
+
+	//Size in bytes, 0 for folders
+	UPROPERTY(BlueprintReadOnly, Category = FileList)
+	TArray<int64> Sizes;
+
+	UPROPERTY(BlueprintReadOnly, Category = FileList)
+	TArray<FDateTime> ModifiedTimes;
+
+	UPROPERTY(BlueprintReadOnly, Category = FileList)
+	TArray<bool> IsDirectory;
+
+	int32 Num() const
+	{
+		return RelativePaths.Num();
+	}
+
+	void Reserve(int32 Number)
+	{
+		RelativePaths.Reserve(Number);
+		Sizes.Reserve(Number);
+		ModifiedTimes.Reserve(Number);
+		IsDirectory.Reserve(Number);
+	}
+
+	void Add(FString&& RelativePath, int64 Size, const FDateTime& ModifiedTime, bool bIsDirectory)
+	{
+		RelativePaths.Add(MoveTemp(RelativePath));
+		Sizes.Add(Size);
+		ModifiedTimes.Add(ModifiedTime);
+		IsDirectory.Add(bIsDirectory);
+	}
+};
+
 UINTERFACE(MinimalAPI)
 class UWFUFileListInterface : public UInterface
 {
@@ -33,6 +78,14 @@ public:
 	UFUNCTION(BlueprintNativeEvent, Category = FolderWatchEvent)
 	void OnListDirectoryFound(const FString& DirectoryName, const FString& FilePath);
 
+	/**
+	* Called once with everything the listing found, right before OnListDone.
+	* @param DirectoryPath Path of the listed directory
+	* @param Listing every file and folder found, with 64 bit sizes and modification times
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = FolderWatchEvent)
+	void OnListResults(const FString& DirectoryPath, const FWFUFolderListing& Listing);
+
 	/**
 	* Called when the listing operation has completed.
 	* @param DirectoryPath Path of the directory
@@ -4,6 +4,39 @@
 
 #include "WFUFolderWatchInterface.generated.h"
 
+UENUM(BlueprintType)
+enum class EWFUFolderChangeType : uint8
+{
+	Created,
+	Modified,
+	Deleted,
+	Renamed
+};
+
+/**
+* One entry of a change set, every path shows up at most once per set.
+*/
+USTRUCT(BlueprintType)
+struct WINDOWSFILEUTILITY_API FWFUFolderChange
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = FolderWatch)
+	EWFUFolderChangeType Type = EWFUFolderChangeType::Modified;
+
+	//Relative to the watched folder, '/' separated. The new name for renames
+	UPROPERTY(BlueprintReadOnly, Category = FolderWatch)
+	FString RelativePath;
+
+	//Name before a rename, empty otherwise
+	UPROPERTY(BlueprintReadOnly, Category = FolderWatch)
+	FString OldRelativePath;
+
+	//Deleted entries can't be checked anymore and may come out as files on Windows
+	UPROPERTY(BlueprintReadOnly, Category = FolderWatch)
+	bool bIsDirectory = false;
+};
+
 UINTERFACE(MinimalAPI)
 class UWFUFolderWatchInterface : public UInterface
 {
@@ -29,4 +62,13 @@ public:
 	*/
 	UFUNCTION(BlueprintNativeEvent, Category = FolderWatchEvent)
 	void OnDirectoryChanged(const FString& DirectoryName, const FString& DirectoryPath);
+
+	/**
+	* Called once things have been quiet for the debounce window, with everything that changed in it.
+	* Repeated changes to a path are folded into one entry, e.g. created then modified is a single Created.
+	* @param DirectoryPath Path of the watched folder
+	* @param Changes Every path that changed, in the order they were first seen
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = FolderWatchEvent)
+	void OnFolderChanges(const FString& DirectoryPath, const TArray<FWFUFolderChange>& Changes);
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class FEvent;
+
+/*
+Parallel recursive delete. Workers take folders off a shared queue, unlink the files of that one level
+right away and queue its subfolders, so a wide tree is emptied by several workers at once. A folder is
+removed as soon as its last subfolder is gone, bottom-up, without a second pass over the tree.
+
+On Linux files are unlinked relative to the open folder with unlinkat, on Windows through FindFirstFileEx
+with large fetches. Symbolic links and junctions are removed themselves, never followed.
+*/
+class WINDOWSFILEUTILITY_API WFUTreeDeleter
+{
+public:
+	WFUTreeDeleter();
+	~WFUTreeDeleter();
+
+	/*
+	Deletes Root and everything below it on worker threads of its own, blocks until done. Returns false if
+	Root isn't a folder or anything in it couldn't be removed, the rest is still deleted.
+	*/
+	bool Delete(const FString& InRoot);
+
+	int32 GetNumFilesDeleted() const;
+	int32 GetNumFoldersDeleted() const;
+	int32 GetNumFailed() const;
+
+	/*
+	True if Path lies strictly below Folder once both are made absolute and symbolic links, '..' and
+	separators are resolved. Both have to exist.
+	*/
+	static bool IsInsideFolder(const FString& Path, const FString& Folder);
+
+	//Absolute path with links resolved and '/' separators, empty if Path doesn't exist
+	static FString GetCanonicalPath(const FString& Path);
+
+private:
+	//A folder being emptied, removed once its own files and all subfolders are gone
+	struct FFolder
+	{
+		FString Path;
+		int32 Parent;
+		int32 NumRemaining;
+	};
+
+	void RunWorker();
+	bool PopFolder(int32& OutIndex, FString& OutPath);
+	void EmptyFolder(int32 Index, const FString& Path);
+	void RemoveFolders(int32 Index, FString Path);
+
+	mutable FCriticalSection Lock;
+	FEvent* WorkAvailable;
+
+	TArray<FFolder> Folders;
+	TArray<int32> Pending;
+
+	int32 NumFilesDeleted;
+	int32 NumFoldersDeleted;
+	int32 NumFailed;
+	bool bFinished;
+
+	//Dedicated threads, the workers block on WorkAvailable and mustn't hold up task graph or pool threads
+	TArray<TFuture<void>> Workers;
+};
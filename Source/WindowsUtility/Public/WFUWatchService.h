@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "WFUFolderWatchInterface.h"
+
+/*
+Called on the watch thread with one debounced change set per watch.
+*/
+typedef TFunction<void(const TArray<FWFUFolderChange>& Changes)> FWFUWatchCallback;
+
+/*
+One thread serving every folder watch. Watches are multiplexed on inotify + epoll on Linux and on an
+I/O completion port with overlapped ReadDirectoryChangesW on Windows, so the thread count stays at
+one however many folders are watched. Watches cover the whole subtree of the folder.
+
+Adding and removing watches is queued to the watch thread, which wakes up right away to apply it.
+
+Every change record is kept, folded per path and held until the watch has been quiet for its debounce
+window, then handed out as one change set. A steady stream of changes still goes out every few windows.
+*/
+class WINDOWSFILEUTILITY_API WFUWatchService
+{
+public:
+	static WFUWatchService& Get();
+
+	/*
+	Starts watching Path, the thread is started on first use. Returns a handle for RemoveWatch. A folder that
+	can't be watched is logged from the watch thread and simply never reports anything.
+	*/
+	int32 AddWatch(const FString& Path, FWFUWatchCallback Callback, float DebounceSeconds = 0.2f);
+
+	//No callbacks are started for the handle once this returns
+	void RemoveWatch(int32 Handle);
+
+	//Drops every watch and joins the thread. Called on module shutdown, a later AddWatch starts over
+	void Shutdown();
+
+	~WFUWatchService();
+
+private:
+	WFUWatchService();
+
+	void Run();
+	void ApplyCommands();
+
+	//Watch thread only, called by the backends for every change record
+	void Record(int32 Handle, EWFUFolderChangeType Type, const FString& RelativePath, bool bIsDirectory, const FString& OldRelativePath = FString());
+
+	//Milliseconds until the next change set is due, -1 when nothing is pending
+	int32 GetWaitMilliseconds() const;
+	void FlushChanges();
+
+	struct FCommand
+	{
+		int32 Handle;
+		FString Path;
+		float DebounceSeconds;
+		bool bAdd;
+	};
+
+	//Changes of one watch waiting out the debounce window
+	struct FPendingChanges
+	{
+		float DebounceSeconds = 0.f;
+		TArray<FWFUFolderChange> Changes;
+		TMap<FString, int32> IndexByPath;
+		double FirstChangeTime = 0.0;
+		double LastChangeTime = 0.0;
+
+		void Merge(EWFUFolderChangeType Type, const FString& RelativePath, bool bIsDirectory, const FString& OldRelativePath);
+		void Set(EWFUFolderChangeType Type, const FString& RelativePath, bool bIsDirectory, const FString& OldRelativePath);
+		void Drop(const FString& RelativePath);
+		double GetDueTime() const;
+	};
+
+	//Platform specific half, lives on the watch thread apart from waking it
+	struct FBackend;
+	TUniquePtr<FBackend> Backend;
+
+	FCriticalSection Lock;
+	TArray<FCommand> Commands;
+	TMap<int32, FWFUWatchCallback> Callbacks;
+	int32 NextHandle;
+	bool bStopping;
+
+	TFuture<void> Thread;
+
+	//Watch thread only
+	TMap<int32, FPendingChanges> Pending;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "WFULambdaRunnable.h"
+#include "WFUFileBatchInterface.h"
 #include "WindowsFileUtilityFunctionLibrary.generated.h"
 
 //Struct to Track which delegate is watching files
@@ -10,10 +11,8 @@ struct FWatcher
 	
 	FString Path;
 
-	TSharedFuture<void> ThreadFuture = nullptr;
-	
-	FThreadSafeBool ShouldRun = true;
-	
+	//Handle from WFUWatchService
+	int32 WatchHandle = INDEX_NONE;
 };
 
 inline bool operator==(const FWatcher& lhs, const FWatcher& rhs)
@@ -46,13 +45,37 @@ class WINDOWSFILEUTILITY_API UWindowsFileUtilityFunctionLibrary : public UBluepr
 	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
 	static bool DeleteEmptyFolder(const FString& FullPath);
 
+	/**
+	* Batch versions of the single file functions above. Every item runs on background workers and BatchDelegate, a
+	* FileBatchInterface, gets one OnBatchDone with the status of each path in order. Moves and copies create missing
+	* destination folders and replace existing files. From and To have to be the same length.
+	*/
+	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
+	static void MoveFilesTo(const TArray<FString>& From, const TArray<FString>& To, UObject* BatchDelegate);
+
+	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
+	static void CopyFilesTo(const TArray<FString>& From, const TArray<FString>& To, UObject* BatchDelegate);
+
+	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
+	static void DeleteFilesAt(const TArray<FString>& FullPaths, UObject* BatchDelegate);
+
+	//OnBatchDone reports true for every path that exists, file or folder
+	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
+	static void DoFilesExist(const TArray<FString>& FullPaths, UObject* BatchDelegate);
+
+	//Convenience C++ callback, Destinations are only used for Move and Copy
+	static void RunFileBatchToCallback(EWFUFileBatchOperation Operation, const TArray<FString>& Paths, const TArray<FString>& Destinations, TFunction<void(const FWFUFileBatchResult&)> OnBatchDoneCallback);
+
 	/*Dangerous function, not exposed to blueprint. */
 	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
 	static bool DeleteFolderRecursively(const FString& FullPath);
 
-	/** Watch a folder for change. WatcherDelegate should respond to FolderWatchInterface*/
+	/**
+	* Watch a folder for change. WatcherDelegate should respond to FolderWatchInterface. Changes are collected until the
+	* folder has been quiet for DebounceSeconds and then delivered together through OnFolderChanges.
+	*/
 	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
-	static void WatchFolder(const FString& FullPath, UObject* WatcherDelegate);
+	static void WatchFolder(const FString& FullPath, UObject* WatcherDelegate, float DebounceSeconds = 0.2f);
 
 	/** Stop watching a folder for change. WatcherDelegate should respond to FolderWatchInterface*/
 	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
@@ -62,6 +85,14 @@ class WINDOWSFILEUTILITY_API UWindowsFileUtilityFunctionLibrary : public UBluepr
 	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility)
 	static void ListContentsOfFolder(const FString& FullPath, UObject* ListDelegate);
 
+	/**
+	* List the contents, expects UFileListInterface. Walks the folder on background workers and reports everything in one go,
+	* OnListResults gets the whole listing at once. Subfolders are only walked when bRecursive is set. IncludeGlobs and
+	* ExcludeGlobs (e.g. *.png, Saved) are matched against each entry's relative path and name while walking.
+	*/
+	UFUNCTION(BlueprintCallable, Category = WindowsFileUtility, meta = (AutoCreateRefTerm = "IncludeGlobs,ExcludeGlobs"))
+	static void ListContentsOfFolderFiltered(const FString& FullPath, UObject* ListDelegate, bool bRecursive, const TArray<FString>& IncludeGlobs, const TArray<FString>& ExcludeGlobs);
+
 	//Convenience C++ callback
 	static void ListContentsOfFolderToCallback(const FString& FullPath, TFunction<void(const TArray<FString>&, const TArray<FString>&)> OnListCompleteCallback);
 
@@ -69,6 +100,7 @@ class WINDOWSFILEUTILITY_API UWindowsFileUtilityFunctionLibrary : public UBluepr
 	//static void ListContentsOfFolderToCallback(const FString& FullPath, TFunction<void(const TArray<FString>&, const TArray<FString>&)> OnListCompleteCallback);
 
 private:
-	static void WatchFolderOnBgThread(const FString& FullPath, const FWatcher* Watcher);
+	static void RunFileBatch(EWFUFileBatchOperation Operation, const TArray<FString>& Paths, const TArray<FString>& Destinations, UObject* BatchDelegate);
+
 	static TMap<FString, TArray<FWatcher>> Watchers;
 };
\ No newline at end of file
@@ -1,100 +1,146 @@
 #include "SevenZipCallbackHandler.h"
 #include "ZipUtilityPrivatePCH.h"
 #include "ZipFileFunctionLibrary.h"
+#include "ZUSharedOperation.h"
 
 void SevenZipCallbackHandler::OnProgress(const TString& archivePath, uint64 bytes)
 {
-	const UObject* interfaceDelegate = ProgressDelegate;
 	const uint64 bytesConst = bytes;
 	const FString pathConst = FString(archivePath.c_str());
 
 	if (bytes > 0) {
 		const float ProgressPercentage = ((double)((TotalBytes)-(BytesLeft - bytes)) / (double)TotalBytes) * 100;
 
-		UZipFileFunctionLibrary::RunLambdaOnGameThread([interfaceDelegate, pathConst, ProgressPercentage, bytesConst] 
+		SendEvent([pathConst, ProgressPercentage, bytesConst](UObject* interfaceDelegate)
 		{
 			//UE_LOG(LogClass, Log, TEXT("Progress: %d bytes"), progress);
-			((IZipUtilityInterface*)interfaceDelegate)->Execute_OnProgress((UObject*)interfaceDelegate, pathConst, ProgressPercentage, bytesConst);
-		});
+			IZipUtilityInterface::Execute_OnProgress(interfaceDelegate, pathConst, ProgressPercentage, bytesConst);
+		}, EZUSharedEvent::Progress);
 	}
 }
 
 void SevenZipCallbackHandler::OnDone(const TString& archivePath)
 {
-	const UObject* interfaceDelegate = ProgressDelegate;
+	OnDoneWithState(archivePath, EZipUtilityCompletionState::SUCCESS);
+}
+
+void SevenZipCallbackHandler::OnDoneWithState(const TString& archivePath, EZipUtilityCompletionState CompletionState)
+{
 	const FString pathConst = FString(archivePath.c_str());
 
-	UZipFileFunctionLibrary::RunLambdaOnGameThread([pathConst, interfaceDelegate] 
+	SendEvent([pathConst, CompletionState](UObject* interfaceDelegate)
 	{
 		//UE_LOG(LogClass, Log, TEXT("All Done!"));
-		((IZipUtilityInterface*)interfaceDelegate)->Execute_OnDone((UObject*)interfaceDelegate, pathConst, EZipUtilityCompletionState::SUCCESS);
-	});
+		IZipUtilityInterface::Execute_OnDone(interfaceDelegate, pathConst, CompletionState);
+	}, EZUSharedEvent::Done);
 }
 
 void SevenZipCallbackHandler::OnFileDone(const TString& archivePath, const TString& filePath, uint64 bytes)
 {
-	const UObject* interfaceDelegate = ProgressDelegate;
 	const FString pathConst = FString(archivePath.c_str());
 	const FString filePathConst = FString(filePath.c_str());
-	const uint64 bytesConst = bytes;
 
-	UZipFileFunctionLibrary::RunLambdaOnGameThread([interfaceDelegate, pathConst, filePathConst, bytesConst]
+	SendEvent([pathConst, filePathConst](UObject* interfaceDelegate)
 	{
 		//UE_LOG(LogClass, Log, TEXT("File Done: %s, %d bytes"), filePathConst.c_str(), bytesConst);
-		((IZipUtilityInterface*)interfaceDelegate)->Execute_OnFileDone((UObject*)interfaceDelegate, pathConst, filePathConst);
-	});
+		IZipUtilityInterface::Execute_OnFileDone(interfaceDelegate, pathConst, filePathConst);
+	}, EZUSharedEvent::Regular);
 
 	//Handle byte decrementing
 	if (bytes > 0) {
 		BytesLeft -= bytes;
 		const float ProgressPercentage = ((double)(TotalBytes - BytesLeft) / (double)TotalBytes) * 100;
 
-		UZipFileFunctionLibrary::RunLambdaOnGameThread([interfaceDelegate, pathConst, ProgressPercentage, bytes]
+		SendEvent([pathConst, ProgressPercentage, bytes](UObject* interfaceDelegate)
 		{
 			//UE_LOG(LogClass, Log, TEXT("Progress: %d bytes"), progress);
-			((IZipUtilityInterface*)interfaceDelegate)->Execute_OnProgress((UObject*)interfaceDelegate, pathConst, ProgressPercentage, bytes);
-		});
+			IZipUtilityInterface::Execute_OnProgress(interfaceDelegate, pathConst, ProgressPercentage, bytes);
+		}, EZUSharedEvent::Progress);
 	}
 }
-void SevenZipCallbackHandler::OnStartWithTotal(const TString& archivePath, unsigned __int64 totalBytes)
+void SevenZipCallbackHandler::OnStartWithTotal(const TString& archivePath, uint64 totalBytes)
 {
 	TotalBytes = totalBytes;
 	BytesLeft = TotalBytes;
 
-	const UObject* interfaceDelegate = ProgressDelegate;
 	const uint64 bytesConst = TotalBytes;
 	const FString pathConst = FString(archivePath.c_str());
 
-	UZipFileFunctionLibrary::RunLambdaOnGameThread([interfaceDelegate, pathConst, bytesConst] 
+	SendEvent([pathConst, bytesConst](UObject* interfaceDelegate)
 	{
 		//UE_LOG(LogClass, Log, TEXT("Starting with %d bytes"), bytesConst);
-		((IZipUtilityInterface*)interfaceDelegate)->Execute_OnStartProcess((UObject*)interfaceDelegate, pathConst, bytesConst);
-	});
+		IZipUtilityInterface::Execute_OnStartProcess(interfaceDelegate, pathConst, bytesConst);
+	}, EZUSharedEvent::Regular);
 }
 void SevenZipCallbackHandler::OnFileFound(const TString& archivePath, const TString& filePath, int size)
 {
-	const UObject* interfaceDelegate = ProgressDelegate;
-	const uint64 bytesConst = TotalBytes;
+	//7zpp truncates sizes to int, reading them back unsigned at least covers entries up to 4gb
+	OnEntryFound(archivePath, FStringView(filePath.c_str(), (int32)filePath.size()), (uint32)size);
+}
+
+void SevenZipCallbackHandler::OnEntryFound(const TString& archivePath, FStringView filePath, uint64 size)
+{
+	const int64 bytesConst = size;
 	const FString pathString = FString(archivePath.c_str());
-	const FString fileString = FString(filePath.c_str());
+	const FString fileString = FString(filePath.Len(), filePath.GetData());
 
-	UZipFileFunctionLibrary::RunLambdaOnGameThread([interfaceDelegate, pathString, fileString, bytesConst] 
+	SendEvent([pathString, fileString, bytesConst](UObject* interfaceDelegate)
 	{
-		((IZipUtilityInterface*)interfaceDelegate)->Execute_OnFileFound((UObject*)interfaceDelegate, pathString, fileString, bytesConst);
-	});
+		IZipUtilityInterface::Execute_OnFileFound(interfaceDelegate, pathString, fileString, bytesConst);
+	}, EZUSharedEvent::Regular);
 }
 void SevenZipCallbackHandler::OnListingDone(const TString& archivePath)
 {
-	const UObject* interfaceDelegate = ProgressDelegate;
 	const FString pathString = FString(archivePath.c_str());
 
-	UZipFileFunctionLibrary::RunLambdaOnGameThread([interfaceDelegate, pathString] 
+	SendEvent([pathString](UObject* interfaceDelegate)
 	{
-		((IZipUtilityInterface*)interfaceDelegate)->Execute_OnDone((UObject*)interfaceDelegate, pathString, EZipUtilityCompletionState::SUCCESS);
-	});
+		IZipUtilityInterface::Execute_OnDone(interfaceDelegate, pathString, EZipUtilityCompletionState::SUCCESS);
+	}, EZUSharedEvent::Done);
+}
+
+void SevenZipCallbackHandler::OnFileFailed(const TString& archivePath, const TString& filePath)
+{
+	const FString pathString = FString(archivePath.c_str());
+	const FString fileString = FString(filePath.c_str());
+
+	SendEvent([pathString, fileString](UObject* interfaceDelegate)
+	{
+		IZipUtilityInterface::Execute_OnFileFailed(interfaceDelegate, pathString, fileString);
+	}, EZUSharedEvent::Regular);
+}
+
+void SevenZipCallbackHandler::OnTestResult(const TString& archivePath, const FZipUtilityTestResult& result)
+{
+	const FString pathString = FString(archivePath.c_str());
+
+	SendEvent([pathString, result](UObject* interfaceDelegate)
+	{
+		IZipUtilityInterface::Execute_OnTestResult(interfaceDelegate, pathString, result);
+	}, EZUSharedEvent::Regular);
 }
 
 bool SevenZipCallbackHandler::OnCheckBreak()
 {
 	return bCancelOperation;
 }
+
+void SevenZipCallbackHandler::SendEvent(TFunction<void(UObject*)>&& Event, EZUSharedEvent Type)
+{
+	//Shared runs deliver to their listeners on the game thread, so the listener list is only read once the event gets there
+	if (SharedOperation.IsValid())
+	{
+		TSharedPtr<ZUSharedOperation, ESPMode::ThreadSafe> Shared = SharedOperation;
+		UZipFileFunctionLibrary::RunLambdaOnGameThread([Shared, Event = MoveTemp(Event), Type]() mutable
+		{
+			Shared->Broadcast(MoveTemp(Event), Type);
+		});
+		return;
+	}
+
+	UObject* interfaceDelegate = ProgressDelegate;
+	UZipFileFunctionLibrary::RunLambdaOnGameThread([interfaceDelegate, Event = MoveTemp(Event)]
+	{
+		Event(interfaceDelegate);
+	});
+}
@@ -0,0 +1,86 @@
+#include "ZUBlockPipe.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "HAL/Event.h"
+
+ZUBlockPipe::ZUBlockPipe(int32 InCapacity)
+{
+	NotEmpty = FPlatformProcess::GetSynchEventFromPool(false);
+	NotFull = FPlatformProcess::GetSynchEventFromPool(false);
+	Capacity = FMath::Max(InCapacity, 1);
+	bClosed = false;
+	bCancelled = false;
+}
+
+ZUBlockPipe::~ZUBlockPipe()
+{
+	FPlatformProcess::ReturnSynchEventToPool(NotEmpty);
+	FPlatformProcess::ReturnSynchEventToPool(NotFull);
+}
+
+bool ZUBlockPipe::Push(TArray<uint8>&& Block)
+{
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (bCancelled || bClosed)
+			{
+				return false;
+			}
+			if (Blocks.Num() < Capacity)
+			{
+				Blocks.Add(MoveTemp(Block));
+				NotEmpty->Trigger();
+				return true;
+			}
+		}
+		NotFull->Wait();
+	}
+}
+
+bool ZUBlockPipe::Pop(TArray<uint8>& OutBlock)
+{
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (bCancelled)
+			{
+				return false;
+			}
+			if (Blocks.Num() > 0)
+			{
+				OutBlock = MoveTemp(Blocks[0]);
+				Blocks.RemoveAt(0, 1, false);
+				NotFull->Trigger();
+				return true;
+			}
+			if (bClosed)
+			{
+				return false;
+			}
+		}
+		NotEmpty->Wait();
+	}
+}
+
+void ZUBlockPipe::Close()
+{
+	FScopeLock ScopeLock(&Lock);
+	bClosed = true;
+	NotEmpty->Trigger();
+}
+
+void ZUBlockPipe::Cancel()
+{
+	FScopeLock ScopeLock(&Lock);
+	bCancelled = true;
+	NotEmpty->Trigger();
+	NotFull->Trigger();
+}
+
+bool ZUBlockPipe::IsCancelled() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return bCancelled;
+}
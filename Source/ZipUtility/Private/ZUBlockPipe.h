@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FEvent;
+
+/**
+ * Bounded hand-off of data blocks from one pipeline stage to another running on a different thread.
+ * The producer blocks while the pipe is full and the consumer while it is empty, so two stages of a
+ * stream (e.g. tar packing and gzip) run side by side without either running far ahead.
+ */
+class ZUBlockPipe
+{
+public:
+	ZUBlockPipe(int32 InCapacity = 8);
+	~ZUBlockPipe();
+
+	// Waits for room. Returns false if the consuming side cancelled.
+	bool Push(TArray<uint8>&& Block);
+
+	// Waits for a block. Returns false once the pipe is closed and drained, or was cancelled.
+	bool Pop(TArray<uint8>& OutBlock);
+
+	// Producer is done, the consumer drains what is left
+	void Close();
+
+	// Either side gave up, wakes and fails the other one
+	void Cancel();
+
+	bool IsCancelled() const;
+
+private:
+	mutable FCriticalSection Lock;
+	FEvent* NotEmpty;
+	FEvent* NotFull;
+
+	TArray<TArray<uint8>> Blocks;
+	int32 Capacity;
+	bool bClosed;
+	bool bCancelled;
+};
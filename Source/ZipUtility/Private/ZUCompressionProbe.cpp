@@ -0,0 +1,187 @@
+#include "ZUCompressionProbe.h"
+#include "ZipUtilityPrivatePCH.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	struct FExtensionHint
+	{
+		const TCHAR* Extension;
+		EZUFileClass FileClass;
+		bool bPrecompressed;
+	};
+
+	//Raw formats (bmp, wav, dds, ...) are listed for reporting only, the sample decides for them
+	const FExtensionHint ExtensionHints[] =
+	{
+		{ TEXT("png"), EZUFileClass::Image, true },
+		{ TEXT("jpg"), EZUFileClass::Image, true },
+		{ TEXT("jpeg"), EZUFileClass::Image, true },
+		{ TEXT("gif"), EZUFileClass::Image, true },
+		{ TEXT("webp"), EZUFileClass::Image, true },
+		{ TEXT("bmp"), EZUFileClass::Image, false },
+		{ TEXT("tga"), EZUFileClass::Image, false },
+		{ TEXT("tif"), EZUFileClass::Image, false },
+		{ TEXT("tiff"), EZUFileClass::Image, false },
+		{ TEXT("psd"), EZUFileClass::Image, false },
+		{ TEXT("exr"), EZUFileClass::Image, false },
+		{ TEXT("hdr"), EZUFileClass::Image, false },
+		{ TEXT("dds"), EZUFileClass::Image, false },
+
+		{ TEXT("ogg"), EZUFileClass::Audio, true },
+		{ TEXT("opus"), EZUFileClass::Audio, true },
+		{ TEXT("mp3"), EZUFileClass::Audio, true },
+		{ TEXT("aac"), EZUFileClass::Audio, true },
+		{ TEXT("m4a"), EZUFileClass::Audio, true },
+		{ TEXT("flac"), EZUFileClass::Audio, true },
+		{ TEXT("wem"), EZUFileClass::Audio, true },
+		{ TEXT("wav"), EZUFileClass::Audio, false },
+
+		{ TEXT("mp4"), EZUFileClass::Video, true },
+		{ TEXT("m4v"), EZUFileClass::Video, true },
+		{ TEXT("mov"), EZUFileClass::Video, true },
+		{ TEXT("mkv"), EZUFileClass::Video, true },
+		{ TEXT("webm"), EZUFileClass::Video, true },
+		{ TEXT("bk2"), EZUFileClass::Video, true },
+		{ TEXT("bik"), EZUFileClass::Video, true },
+
+		{ TEXT("zip"), EZUFileClass::Archive, true },
+		{ TEXT("7z"), EZUFileClass::Archive, true },
+		{ TEXT("rar"), EZUFileClass::Archive, true },
+		{ TEXT("gz"), EZUFileClass::Archive, true },
+		{ TEXT("tgz"), EZUFileClass::Archive, true },
+		{ TEXT("bz2"), EZUFileClass::Archive, true },
+		{ TEXT("xz"), EZUFileClass::Archive, true },
+		{ TEXT("zst"), EZUFileClass::Archive, true },
+		{ TEXT("cab"), EZUFileClass::Archive, true },
+		{ TEXT("jar"), EZUFileClass::Archive, true },
+		{ TEXT("apk"), EZUFileClass::Archive, true },
+
+		//Paks may or may not have been cooked with compression, so they always get sampled
+		{ TEXT("pak"), EZUFileClass::Pak, false },
+		{ TEXT("ucas"), EZUFileClass::Pak, false },
+		{ TEXT("utoc"), EZUFileClass::Pak, false }
+	};
+
+	//Above this the bytes are close enough to uniform that deflate's huffman stage can't win anything
+	const double IncompressibleEntropy = 7.9;
+
+	//Below this deflate always pays off
+	const double CompressibleEntropy = 6.5;
+
+	//Trial output has to beat the sample by at least this much
+	const double RequiredRatio = 0.95;
+
+	const FExtensionHint* FindHint(const FString& Path)
+	{
+		const FString Extension = FPaths::GetExtension(Path);
+		for (const FExtensionHint& Hint : ExtensionHints)
+		{
+			if (Extension.Equals(Hint.Extension, ESearchCase::IgnoreCase))
+			{
+				return &Hint;
+			}
+		}
+		return nullptr;
+	}
+
+	double ByteEntropy(const uint8* Data, int64 Size)
+	{
+		uint32 Counts[256] = { 0 };
+		for (int64 Index = 0; Index < Size; Index++)
+		{
+			Counts[Data[Index]]++;
+		}
+
+		double Entropy = 0.0;
+		for (uint32 Count : Counts)
+		{
+			if (Count > 0)
+			{
+				const double Probability = (double)Count / Size;
+				Entropy -= Probability * FMath::Log2(Probability);
+			}
+		}
+		return Entropy;
+	}
+
+	int64 TrialDeflateSize(const uint8* Data, int64 Size)
+	{
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+
+		if (deflateInit2(&Stream, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			return Size;
+		}
+
+		TArray<uint8> Output;
+		Output.SetNumUninitialized(deflateBound(&Stream, (uLong)Size));
+
+		Stream.next_in = (Bytef*)Data;
+		Stream.avail_in = (uInt)Size;
+		Stream.next_out = Output.GetData();
+		Stream.avail_out = (uInt)Output.Num();
+
+		const int Result = deflate(&Stream, Z_FINISH);
+		const int64 CompressedSize = (Result == Z_STREAM_END) ? (int64)Stream.total_out : Size;
+		deflateEnd(&Stream);
+		return CompressedSize;
+	}
+}
+
+EZUFileClass ZUCompressionProbe::Classify(const FString& Path)
+{
+	const FExtensionHint* Hint = FindHint(Path);
+	return Hint != nullptr ? Hint->FileClass : EZUFileClass::Other;
+}
+
+const TCHAR* ZUCompressionProbe::GetClassName(EZUFileClass FileClass)
+{
+	switch (FileClass)
+	{
+	case EZUFileClass::Image:
+		return TEXT("Image");
+	case EZUFileClass::Audio:
+		return TEXT("Audio");
+	case EZUFileClass::Video:
+		return TEXT("Video");
+	case EZUFileClass::Archive:
+		return TEXT("Archive");
+	case EZUFileClass::Pak:
+		return TEXT("Pak");
+	default:
+		return TEXT("Other");
+	}
+}
+
+bool ZUCompressionProbe::IsPrecompressed(const FString& Path)
+{
+	const FExtensionHint* Hint = FindHint(Path);
+	return Hint != nullptr && Hint->bPrecompressed;
+}
+
+bool ZUCompressionProbe::IsWorthCompressing(const uint8* Sample, int64 SampleSize)
+{
+	//Too small to judge, and too small for a wrong guess to matter
+	if (SampleSize < 512)
+	{
+		return true;
+	}
+
+	const double Entropy = ByteEntropy(Sample, SampleSize);
+	if (Entropy >= IncompressibleEntropy)
+	{
+		return false;
+	}
+	if (Entropy < CompressibleEntropy)
+	{
+		return true;
+	}
+
+	//Entropy doesn't see repeats, let a fast deflate settle the middle ground
+	return TrialDeflateSize(Sample, SampleSize) < SampleSize * RequiredRatio;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Rough content class of a file, judged from its extension. */
+enum class EZUFileClass : uint8
+{
+	Image,
+	Audio,
+	Video,
+	Archive,
+	Pak,
+	Other,
+
+	Count
+};
+
+/**
+ * Decides per file whether deflate is worth running. Extensions of formats that are already
+ * compressed are stored outright, everything else is judged from a sample: byte entropy first,
+ * then a fast trial deflate when the entropy is inconclusive.
+ */
+class ZUCompressionProbe
+{
+public:
+	// Bytes of the head (and middle, for larger files) that make up a sample
+	static const int64 SampleBlockSize = 64 * 1024;
+
+	static EZUFileClass Classify(const FString& Path);
+	static const TCHAR* GetClassName(EZUFileClass FileClass);
+
+	// True if the extension belongs to a format with its own codec, e.g. png or ogg but not bmp or wav
+	static bool IsPrecompressed(const FString& Path);
+
+	static bool IsWorthCompressing(const uint8* Sample, int64 SampleSize);
+};
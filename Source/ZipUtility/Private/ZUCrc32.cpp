@@ -0,0 +1,294 @@
+#include "ZUCrc32.h"
+#include "ZipUtilityPrivatePCH.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ZU_CRC32_X86 1
+#else
+#define ZU_CRC32_X86 0
+#endif
+
+#if ZU_CRC32_X86
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ZU_TARGET_PCLMUL
+#else
+#include <cpuid.h>
+#define ZU_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#endif
+#endif
+
+namespace
+{
+	const uint32 ReflectedPolynomial = 0xEDB88320;
+
+	struct FSliceTables
+	{
+		uint32 Table[16][256];
+
+		FSliceTables()
+		{
+			for (uint32 Index = 0; Index < 256; Index++)
+			{
+				uint32 Crc = Index;
+				for (int32 Bit = 0; Bit < 8; Bit++)
+				{
+					Crc = (Crc >> 1) ^ ((Crc & 1) ? ReflectedPolynomial : 0);
+				}
+				Table[0][Index] = Crc;
+			}
+
+			for (uint32 Index = 0; Index < 256; Index++)
+			{
+				for (int32 Slice = 1; Slice < 16; Slice++)
+				{
+					const uint32 Previous = Table[Slice - 1][Index];
+					Table[Slice][Index] = (Previous >> 8) ^ Table[0][Previous & 0xFF];
+				}
+			}
+		}
+	};
+
+	const FSliceTables& GetSliceTables()
+	{
+		static const FSliceTables Tables;
+		return Tables;
+	}
+
+	uint32 ReadLittleEndian32(const uint8* Data)
+	{
+		return (uint32)Data[0] | ((uint32)Data[1] << 8) | ((uint32)Data[2] << 16) | ((uint32)Data[3] << 24);
+	}
+
+	// Works on the non-inverted crc register
+	uint32 SliceBy16(uint32 Crc, const uint8* Data, int64 Size)
+	{
+		const uint32 (&T)[16][256] = GetSliceTables().Table;
+
+		while (Size >= 16)
+		{
+			const uint32 A = ReadLittleEndian32(Data) ^ Crc;
+			const uint32 B = ReadLittleEndian32(Data + 4);
+			const uint32 C = ReadLittleEndian32(Data + 8);
+			const uint32 D = ReadLittleEndian32(Data + 12);
+
+			Crc = T[15][A & 0xFF] ^ T[14][(A >> 8) & 0xFF] ^ T[13][(A >> 16) & 0xFF] ^ T[12][A >> 24] ^
+				T[11][B & 0xFF] ^ T[10][(B >> 8) & 0xFF] ^ T[9][(B >> 16) & 0xFF] ^ T[8][B >> 24] ^
+				T[7][C & 0xFF] ^ T[6][(C >> 8) & 0xFF] ^ T[5][(C >> 16) & 0xFF] ^ T[4][C >> 24] ^
+				T[3][D & 0xFF] ^ T[2][(D >> 8) & 0xFF] ^ T[1][(D >> 16) & 0xFF] ^ T[0][D >> 24];
+
+			Data += 16;
+			Size -= 16;
+		}
+
+		while (Size-- > 0)
+		{
+			Crc = (Crc >> 8) ^ T[0][(Crc ^ *Data++) & 0xFF];
+		}
+		return Crc;
+	}
+
+#if ZU_CRC32_X86
+
+	bool CpuHasPclmul()
+	{
+		//CPUID leaf 1, ecx bit 1 is PCLMULQDQ and bit 19 is SSE4.1
+#if defined(_MSC_VER)
+		int Registers[4];
+		__cpuid(Registers, 1);
+		const uint32 Ecx = (uint32)Registers[2];
+#else
+		unsigned int Eax, Ebx, Ecx, Edx;
+		if (!__get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx))
+		{
+			return false;
+		}
+#endif
+		return (Ecx & (1 << 1)) && (Ecx & (1 << 19));
+	}
+
+	/**
+	 * Folds 64 bytes per iteration with carry-less multiplies, then Barrett reduces to 32 bits.
+	 * Constants are the bit-reflected ones from Intel's "Fast CRC Computation for Generic
+	 * Polynomials Using PCLMULQDQ Instruction". Needs Size >= 64 and a multiple of 16.
+	 */
+	ZU_TARGET_PCLMUL uint32 FoldPclmul(uint32 Crc, const uint8* Data, int64 Size)
+	{
+		alignas(16) static const uint64 K1K2[2] = { 0x0154442bd4, 0x01c6e41596 };
+		alignas(16) static const uint64 K3K4[2] = { 0x01751997d0, 0x00ccaa009e };
+		alignas(16) static const uint64 K5K0[2] = { 0x0163cd6124, 0x0000000000 };
+		alignas(16) static const uint64 Poly[2] = { 0x01db710641, 0x01f7011641 };
+
+		__m128i X0, X1, X2, X3, X4, X5, X6, X7, X8, Y5, Y6, Y7, Y8;
+
+		X1 = _mm_loadu_si128((const __m128i*)(Data + 0x00));
+		X2 = _mm_loadu_si128((const __m128i*)(Data + 0x10));
+		X3 = _mm_loadu_si128((const __m128i*)(Data + 0x20));
+		X4 = _mm_loadu_si128((const __m128i*)(Data + 0x30));
+
+		X1 = _mm_xor_si128(X1, _mm_cvtsi32_si128((int)Crc));
+		X0 = _mm_load_si128((const __m128i*)K1K2);
+
+		Data += 64;
+		Size -= 64;
+
+		//Four independent folding lanes
+		while (Size >= 64)
+		{
+			X5 = _mm_clmulepi64_si128(X1, X0, 0x00);
+			X6 = _mm_clmulepi64_si128(X2, X0, 0x00);
+			X7 = _mm_clmulepi64_si128(X3, X0, 0x00);
+			X8 = _mm_clmulepi64_si128(X4, X0, 0x00);
+
+			X1 = _mm_clmulepi64_si128(X1, X0, 0x11);
+			X2 = _mm_clmulepi64_si128(X2, X0, 0x11);
+			X3 = _mm_clmulepi64_si128(X3, X0, 0x11);
+			X4 = _mm_clmulepi64_si128(X4, X0, 0x11);
+
+			Y5 = _mm_loadu_si128((const __m128i*)(Data + 0x00));
+			Y6 = _mm_loadu_si128((const __m128i*)(Data + 0x10));
+			Y7 = _mm_loadu_si128((const __m128i*)(Data + 0x20));
+			Y8 = _mm_loadu_si128((const __m128i*)(Data + 0x30));
+
+			X1 = _mm_xor_si128(_mm_xor_si128(X1, X5), Y5);
+			X2 = _mm_xor_si128(_mm_xor_si128(X2, X6), Y6);
+			X3 = _mm_xor_si128(_mm_xor_si128(X3, X7), Y7);
+			X4 = _mm_xor_si128(_mm_xor_si128(X4, X8), Y8);
+
+			Data += 64;
+			Size -= 64;
+		}
+
+		//Fold the four lanes into one
+		X0 = _mm_load_si128((const __m128i*)K3K4);
+
+		X5 = _mm_clmulepi64_si128(X1, X0, 0x00);
+		X1 = _mm_clmulepi64_si128(X1, X0, 0x11);
+		X1 = _mm_xor_si128(_mm_xor_si128(X1, X2), X5);
+
+		X5 = _mm_clmulepi64_si128(X1, X0, 0x00);
+		X1 = _mm_clmulepi64_si128(X1, X0, 0x11);
+		X1 = _mm_xor_si128(_mm_xor_si128(X1, X3), X5);
+
+		X5 = _mm_clmulepi64_si128(X1, X0, 0x00);
+		X1 = _mm_clmulepi64_si128(X1, X0, 0x11);
+		X1 = _mm_xor_si128(_mm_xor_si128(X1, X4), X5);
+
+		while (Size >= 16)
+		{
+			X2 = _mm_loadu_si128((const __m128i*)Data);
+
+			X5 = _mm_clmulepi64_si128(X1, X0, 0x00);
+			X1 = _mm_clmulepi64_si128(X1, X0, 0x11);
+			X1 = _mm_xor_si128(_mm_xor_si128(X1, X2), X5);
+
+			Data += 16;
+			Size -= 16;
+		}
+
+		//128 -> 64 bits
+		X2 = _mm_clmulepi64_si128(X1, X0, 0x10);
+		X3 = _mm_setr_epi32(~0, 0, ~0, 0);
+		X1 = _mm_srli_si128(X1, 8);
+		X1 = _mm_xor_si128(X1, X2);
+
+		X0 = _mm_loadl_epi64((const __m128i*)K5K0);
+
+		X2 = _mm_srli_si128(X1, 4);
+		X1 = _mm_and_si128(X1, X3);
+		X1 = _mm_clmulepi64_si128(X1, X0, 0x00);
+		X1 = _mm_xor_si128(X1, X2);
+
+		//Barrett reduction to 32 bits
+		X0 = _mm_load_si128((const __m128i*)Poly);
+
+		X2 = _mm_and_si128(X1, X3);
+		X2 = _mm_clmulepi64_si128(X2, X0, 0x10);
+		X2 = _mm_and_si128(X2, X3);
+		X2 = _mm_clmulepi64_si128(X2, X0, 0x00);
+		X1 = _mm_xor_si128(X1, X2);
+
+		return (uint32)_mm_extract_epi32(X1, 1);
+	}
+
+	uint32 UpdatePclmul(uint32 Crc, const uint8* Data, int64 Size)
+	{
+		Crc = ~Crc;
+
+		if (Size >= 64)
+		{
+			const int64 FoldSize = Size & ~(int64)15;
+			Crc = FoldPclmul(Crc, Data, FoldSize);
+			Data += FoldSize;
+			Size -= FoldSize;
+		}
+		return ~SliceBy16(Crc, Data, Size);
+	}
+
+#endif //ZU_CRC32_X86
+
+	uint32 UpdateSliceBy16(uint32 Crc, const uint8* Data, int64 Size)
+	{
+		return ~SliceBy16(~Crc, Data, Size);
+	}
+
+	typedef uint32(*FCrcUpdateFunction)(uint32, const uint8*, int64);
+
+	struct FCrcDispatch
+	{
+		EZUCrc32Implementation Implementation;
+		FCrcUpdateFunction Function;
+
+		FCrcDispatch()
+		{
+			Implementation = EZUCrc32Implementation::SliceBy16;
+			Function = &UpdateSliceBy16;
+
+#if ZU_CRC32_X86
+			if (CpuHasPclmul())
+			{
+				Implementation = EZUCrc32Implementation::Pclmul;
+				Function = &UpdatePclmul;
+			}
+#endif
+		}
+	};
+
+	const FCrcDispatch& GetDispatch()
+	{
+		static const FCrcDispatch Dispatch;
+		return Dispatch;
+	}
+}
+
+uint32 ZUCrc32::Update(uint32 Crc, const void* Data, int64 Size)
+{
+	return GetDispatch().Function(Crc, (const uint8*)Data, Size);
+}
+
+uint32 ZUCrc32::UpdateWith(EZUCrc32Implementation Implementation, uint32 Crc, const void* Data, int64 Size)
+{
+#if ZU_CRC32_X86
+	if (Implementation == EZUCrc32Implementation::Pclmul && IsSupported(Implementation))
+	{
+		return UpdatePclmul(Crc, (const uint8*)Data, Size);
+	}
+#endif
+	return UpdateSliceBy16(Crc, (const uint8*)Data, Size);
+}
+
+bool ZUCrc32::IsSupported(EZUCrc32Implementation Implementation)
+{
+	if (Implementation == EZUCrc32Implementation::SliceBy16)
+	{
+		return true;
+	}
+	return GetDispatch().Implementation == Implementation;
+}
+
+EZUCrc32Implementation ZUCrc32::GetActiveImplementation()
+{
+	return GetDispatch().Implementation;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EZUCrc32Implementation : uint8
+{
+	SliceBy16,
+	Pclmul
+};
+
+/**
+ * CRC-32 (zip/gzip polynomial) with runtime CPU dispatch. x86 CPUs with PCLMULQDQ use carry-less
+ * multiply folding, everything else a portable slice-by-16 table walk. SSE4.2's crc32 instruction
+ * computes CRC-32C and can't be used for zip.
+ */
+class ZUCrc32
+{
+public:
+	// Continues a running crc, start with 0. Same convention as zlib's crc32().
+	static uint32 Update(uint32 Crc, const void* Data, int64 Size);
+
+	// Forces one implementation, e.g. for comparing them. Falls back to SliceBy16 if unsupported.
+	static uint32 UpdateWith(EZUCrc32Implementation Implementation, uint32 Crc, const void* Data, int64 Size);
+
+	static bool IsSupported(EZUCrc32Implementation Implementation);
+	static EZUCrc32Implementation GetActiveImplementation();
+};
@@ -0,0 +1,113 @@
+#include "ZUDirectoryCache.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/ParallelFor.h"
+
+ZUDirectoryCache::ZUDirectoryCache(const FString& InRoot)
+{
+	Root = InRoot;
+}
+
+void ZUDirectoryCache::AddEntry(const FString& RelativePath, bool bIsDirectory)
+{
+	if (bIsDirectory)
+	{
+		FString Directory = RelativePath;
+		Directory.RemoveFromEnd(TEXT("/"));
+		AddDirectory(Directory);
+		return;
+	}
+
+	int32 SlashIndex = INDEX_NONE;
+	if (RelativePath.FindLastChar(TEXT('/'), SlashIndex))
+	{
+		AddDirectory(RelativePath.Left(SlashIndex));
+	}
+}
+
+void ZUDirectoryCache::AddDirectory(const FString& RelativeDirectory)
+{
+	FString Directory = RelativeDirectory;
+
+	//Walk up until we hit a directory we've already registered
+	while (!Directory.IsEmpty())
+	{
+		bool bAlreadyKnown = false;
+		Known.Add(Directory, &bAlreadyKnown);
+		if (bAlreadyKnown)
+		{
+			return;
+		}
+
+		int32 Depth = 0;
+		for (const TCHAR* Character = *Directory; *Character; Character++)
+		{
+			Depth += (*Character == TEXT('/'));
+		}
+		if (Levels.Num() <= Depth)
+		{
+			Levels.SetNum(Depth + 1);
+		}
+		Levels[Depth].Add(Directory);
+
+		int32 SlashIndex = INDEX_NONE;
+		if (!Directory.FindLastChar(TEXT('/'), SlashIndex))
+		{
+			return;
+		}
+		Directory = Directory.Left(SlashIndex);
+	}
+}
+
+bool ZUDirectoryCache::Materialize()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PlatformFile.CreateDirectoryTree(*Root))
+	{
+		return false;
+	}
+
+	//Parents are always one level up, so a plain create per directory is enough
+	FThreadSafeBool bSuccess = true;
+	for (const TArray<FString>& Level : Levels)
+	{
+		ParallelFor(Level.Num(), [this, &PlatformFile, &Level, &bSuccess](int32 Index)
+		{
+			const FString Path = FPaths::Combine(Root, Level[Index]);
+			if (!PlatformFile.CreateDirectory(*Path))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to create directory %s"), *Path);
+				bSuccess = false;
+			}
+		});
+	}
+
+	//Keep Known so directories registered later don't get created twice
+	Levels.Empty();
+	return bSuccess;
+}
+
+bool ZUDirectoryCache::MakeRelativePath(const FString& EntryName, FString& OutRelativePath)
+{
+	FString Name = EntryName.Replace(TEXT("\\"), TEXT("/"));
+
+	if (Name.StartsWith(TEXT("/")) || Name.Contains(TEXT(":")))
+	{
+		return false;
+	}
+
+	TArray<FString> Parts;
+	Name.ParseIntoArray(Parts, TEXT("/"), true);
+
+	for (const FString& Part : Parts)
+	{
+		if (Part == TEXT(".."))
+		{
+			return false;
+		}
+	}
+
+	OutRelativePath = FString::Join(Parts, TEXT("/"));
+	return Parts.Num() > 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Collects the unique directories an extraction needs up front and creates each of them exactly once.
+ * Paths are relative to Root and use '/' separators.
+ */
+class ZUDirectoryCache
+{
+public:
+	ZUDirectoryCache(const FString& InRoot);
+
+	// Registers the parent chain of a file, or the directory itself plus its parents
+	void AddEntry(const FString& RelativePath, bool bIsDirectory);
+
+	// Creates all registered directories shallowest first, each depth level in parallel
+	bool Materialize();
+
+	// Rejects absolute names and parent references so archive entries can't escape the destination
+	static bool MakeRelativePath(const FString& EntryName, FString& OutRelativePath);
+
+private:
+	void AddDirectory(const FString& RelativeDirectory);
+
+	FString Root;
+
+	// Every directory seen so far, a hit means its whole parent chain is already registered
+	TSet<FString> Known;
+
+	// Known directories bucketed by depth, Levels[0] holds direct children of Root
+	TArray<TArray<FString>> Levels;
+};
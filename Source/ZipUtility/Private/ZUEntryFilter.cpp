@@ -0,0 +1,180 @@
+#include "ZUEntryFilter.h"
+#include "ZipUtilityPrivatePCH.h"
+
+ZUEntryFilter::ZUEntryFilter(const TArray<FString>& IncludeGlobs, const TArray<FString>& ExcludeGlobs)
+{
+	for (const FString& Glob : IncludeGlobs)
+	{
+		if (!Glob.IsEmpty())
+		{
+			Includes.Add(Compile(Glob));
+		}
+	}
+	for (const FString& Glob : ExcludeGlobs)
+	{
+		if (!Glob.IsEmpty())
+		{
+			Excludes.Add(Compile(Glob));
+		}
+	}
+}
+
+bool ZUEntryFilter::Matches(FStringView EntryName) const
+{
+	FString Path(EntryName.Len(), EntryName.GetData());
+	Path.ReplaceInline(TEXT("\\"), TEXT("/"));
+	while (Path.RemoveFromEnd(TEXT("/")))
+	{
+	}
+
+	const TCHAR* Text = *Path;
+	const int32 Length = Path.Len();
+
+	int32 LastSeparator = INDEX_NONE;
+	const int32 NameStart = Path.FindLastChar(TEXT('/'), LastSeparator) ? LastSeparator + 1 : 0;
+
+	TArray<uint8> Scratch;
+
+	for (const FGlob& Glob : Excludes)
+	{
+		//Every folder on the way down counts, by its path or its own name
+		int32 SegmentStart = 0;
+		for (int32 Index = 0; Index <= Length; Index++)
+		{
+			if (Index < Length && Text[Index] != TEXT('/'))
+			{
+				continue;
+			}
+
+			const bool bExcluded = Glob.bMatchesName ?
+				MatchesGlob(Glob, Text + SegmentStart, Index - SegmentStart, Scratch) :
+				MatchesGlob(Glob, Text, Index, Scratch);
+			if (bExcluded)
+			{
+				return false;
+			}
+			SegmentStart = Index + 1;
+		}
+	}
+
+	if (Includes.Num() == 0)
+	{
+		return true;
+	}
+
+	for (const FGlob& Glob : Includes)
+	{
+		const bool bIncluded = Glob.bMatchesName ?
+			MatchesGlob(Glob, Text + NameStart, Length - NameStart, Scratch) :
+			MatchesGlob(Glob, Text, Length, Scratch);
+		if (bIncluded)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+ZUEntryFilter::FGlob ZUEntryFilter::Compile(const FString& Glob)
+{
+	FGlob Compiled;
+	Compiled.bMatchesName = true;
+
+	const FString Pattern = Glob.Replace(TEXT("\\"), TEXT("/"));
+	for (int32 Index = 0; Index < Pattern.Len(); Index++)
+	{
+		const TCHAR Character = Pattern[Index];
+		FToken Token = { ETokenType::Literal, FChar::ToLower(Character) };
+
+		if (Character == TEXT('?'))
+		{
+			Token.Type = ETokenType::AnyCharacter;
+		}
+		else if (Character == TEXT('*'))
+		{
+			Token.Type = ETokenType::AnyInFolder;
+			if (Index + 1 < Pattern.Len() && Pattern[Index + 1] == TEXT('*'))
+			{
+				//Any further stars add nothing
+				while (Index + 1 < Pattern.Len() && Pattern[Index + 1] == TEXT('*'))
+				{
+					Index++;
+				}
+
+				Token.Type = ETokenType::AnyAcrossFolders;
+				if (Index + 1 < Pattern.Len() && Pattern[Index + 1] == TEXT('/'))
+				{
+					Token.Type = ETokenType::AnyFolders;
+					Compiled.bMatchesName = false;
+					Index++;
+				}
+			}
+		}
+		else if (Character == TEXT('/'))
+		{
+			Compiled.bMatchesName = false;
+		}
+
+		Compiled.Tokens.Add(Token);
+	}
+	return Compiled;
+}
+
+bool ZUEntryFilter::MatchesGlob(const FGlob& Glob, const TCHAR* Text, int32 Length, TArray<uint8>& Scratch)
+{
+	//One row per side of a token, Row[i] is set when the tokens so far can end right before Text[i].
+	//Every token is one pass over the text, so no glob backtracks however many stars it has
+	Scratch.SetNumUninitialized((Length + 1) * 2, false);
+	uint8* Current = Scratch.GetData();
+	uint8* Next = Current + Length + 1;
+
+	FMemory::Memzero(Current, Length + 1);
+	Current[0] = 1;
+
+	for (const FToken& Token : Glob.Tokens)
+	{
+		FMemory::Memzero(Next, Length + 1);
+		bool bAny = false;
+
+		switch (Token.Type)
+		{
+		case ETokenType::Literal:
+			for (int32 Index = 0; Index < Length; Index++)
+			{
+				Next[Index + 1] = Current[Index] && FChar::ToLower(Text[Index]) == Token.Character;
+			}
+			break;
+		case ETokenType::AnyCharacter:
+			for (int32 Index = 0; Index < Length; Index++)
+			{
+				Next[Index + 1] = Current[Index] && Text[Index] != TEXT('/');
+			}
+			break;
+		case ETokenType::AnyInFolder:
+			for (int32 Index = 0; Index <= Length; Index++)
+			{
+				bAny = (bAny && Text[Index - 1] != TEXT('/')) || Current[Index];
+				Next[Index] = bAny;
+			}
+			break;
+		case ETokenType::AnyAcrossFolders:
+			for (int32 Index = 0; Index <= Length; Index++)
+			{
+				bAny = bAny || Current[Index];
+				Next[Index] = bAny;
+			}
+			break;
+		case ETokenType::AnyFolders:
+			//Either no folder at all, or any run of them ending in a separator
+			for (int32 Index = 0; Index <= Length; Index++)
+			{
+				Next[Index] = Current[Index] || (bAny && Text[Index - 1] == TEXT('/'));
+				bAny = bAny || Current[Index];
+			}
+			break;
+		}
+
+		Swap(Current, Next);
+	}
+	return Current[Length] != 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+/**
+ * Include and exclude globs for picking archive entries by name, compiled once and then tested against
+ * every entry. '?' matches one character and '*' any run of them within a folder, '**' crosses folders,
+ * and '**' followed by '/' also matches no folder at all, so one glob finds both Maps/Entry.umap and
+ * Maps/Sub/Entry.umap. Matching ignores case, like WFUDirectoryWalker's filters.
+ *
+ * A glob without '/' is tested against the bare name, e.g. *.umap anywhere in the archive. Excludes are also
+ * tested against every folder the entry is in, so excluding Saved or Content/Dev drops everything below them.
+ * No include globs means every entry is included, and an exclude always wins over an include.
+ */
+class ZUEntryFilter
+{
+public:
+	ZUEntryFilter(const TArray<FString>& IncludeGlobs, const TArray<FString>& ExcludeGlobs);
+
+	// Entry names are zip or tar names, '/' or '\' separated, with a trailing separator on folders
+	bool Matches(FStringView EntryName) const;
+
+private:
+	enum class ETokenType : uint8
+	{
+		Literal,
+		AnyCharacter,
+		AnyInFolder,
+		AnyAcrossFolders,
+		AnyFolders
+	};
+
+	struct FToken
+	{
+		ETokenType Type;
+		TCHAR Character;
+	};
+
+	struct FGlob
+	{
+		TArray<FToken> Tokens;
+		bool bMatchesName;
+	};
+
+	static FGlob Compile(const FString& Glob);
+	static bool MatchesGlob(const FGlob& Glob, const TCHAR* Text, int32 Length, TArray<uint8>& Scratch);
+
+	TArray<FGlob> Includes;
+	TArray<FGlob> Excludes;
+};
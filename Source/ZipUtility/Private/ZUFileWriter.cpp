@@ -0,0 +1,1071 @@
+#include "ZUFileWriter.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/ParallelFor.h"
+
+#if PLATFORM_LINUX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+
+//The bundled toolchain sysroot predates io_uring, the kernel ABI is stable so it's declared here
+namespace ZUIoUringAbi
+{
+	const long SetupSyscall = 425;
+	const long EnterSyscall = 426;
+
+	const uint8 OpFsync = 3;
+	const uint8 OpOpenAt = 18;
+	const uint8 OpClose = 19;
+	const uint8 OpWrite = 23;
+
+	const uint8 SqeIoLink = 1 << 2;
+	const uint32 EnterGetEvents = 1 << 0;
+	const uint32 FeatSingleMmap = 1 << 0;
+
+	const off_t OffSqRing = 0;
+	const off_t OffCqRing = 0x8000000;
+	const off_t OffSqes = 0x10000000;
+
+	struct FSqe
+	{
+		uint8 Opcode;
+		uint8 Flags;
+		uint16 IoPriority;
+		int32 Fd;
+		uint64 Offset;
+		uint64 Address;
+		uint32 Length;
+		uint32 OpFlags;
+		uint64 UserData;
+		uint16 BufferIndex;
+		uint16 Personality;
+		int32 SpliceFdIn;
+		uint64 Padding[2];
+	};
+	static_assert(sizeof(FSqe) == 64, "io_uring sqe layout mismatch");
+
+	struct FCqe
+	{
+		uint64 UserData;
+		int32 Result;
+		uint32 Flags;
+	};
+
+	struct FSqRingOffsets
+	{
+		uint32 Head, Tail, RingMask, RingEntries, Flags, Dropped, Array, Reserved1;
+		uint64 Reserved2;
+	};
+
+	struct FCqRingOffsets
+	{
+		uint32 Head, Tail, RingMask, RingEntries, Overflow, Cqes, Flags, Reserved1;
+		uint64 Reserved2;
+	};
+
+	struct FParams
+	{
+		uint32 SqEntries, CqEntries, Flags, SqThreadCpu, SqThreadIdle, Features, WqFd, Reserved[3];
+		FSqRingOffsets SqOffsets;
+		FCqRingOffsets CqOffsets;
+	};
+}
+
+/** Minimal single-threaded io_uring wrapper, submissions and completions both happen on the owning thread. */
+class FZUIoUring
+{
+public:
+	FZUIoUring()
+	{
+		RingFd = -1;
+		SqRing = CqRing = MAP_FAILED;
+		Sqes = (ZUIoUringAbi::FSqe*)MAP_FAILED;
+		SqRingSize = CqRingSize = SqesSize = 0;
+		Capacity = 0;
+		LocalTail = 0;
+		Unsubmitted = 0;
+	}
+
+	~FZUIoUring()
+	{
+		if ((void*)Sqes != MAP_FAILED)
+		{
+			munmap(Sqes, SqesSize);
+		}
+		if (CqRing != MAP_FAILED && CqRing != SqRing)
+		{
+			munmap(CqRing, CqRingSize);
+		}
+		if (SqRing != MAP_FAILED)
+		{
+			munmap(SqRing, SqRingSize);
+		}
+		if (RingFd >= 0)
+		{
+			close(RingFd);
+		}
+	}
+
+	bool Init(uint32 Entries)
+	{
+		using namespace ZUIoUringAbi;
+
+		FParams Params;
+		FMemory::Memzero(Params);
+
+		RingFd = (int)syscall(SetupSyscall, Entries, &Params);
+		if (RingFd < 0)
+		{
+			return false;
+		}
+
+		SqRingSize = Params.SqOffsets.Array + Params.SqEntries * sizeof(uint32);
+		CqRingSize = Params.CqOffsets.Cqes + Params.CqEntries * sizeof(FCqe);
+
+		if (Params.Features & FeatSingleMmap)
+		{
+			SqRingSize = CqRingSize = FMath::Max(SqRingSize, CqRingSize);
+		}
+
+		SqRing = mmap(nullptr, SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, OffSqRing);
+		if (SqRing == MAP_FAILED)
+		{
+			return false;
+		}
+
+		CqRing = (Params.Features & FeatSingleMmap) ? SqRing :
+			mmap(nullptr, CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, OffCqRing);
+		if (CqRing == MAP_FAILED)
+		{
+			return false;
+		}
+
+		SqesSize = Params.SqEntries * sizeof(FSqe);
+		Sqes = (FSqe*)mmap(nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, OffSqes);
+		if ((void*)Sqes == MAP_FAILED)
+		{
+			return false;
+		}
+
+		uint8* Sq = (uint8*)SqRing;
+		SqTail = (uint32*)(Sq + Params.SqOffsets.Tail);
+		SqMask = *(uint32*)(Sq + Params.SqOffsets.RingMask);
+		SqArray = (uint32*)(Sq + Params.SqOffsets.Array);
+
+		uint8* Cq = (uint8*)CqRing;
+		CqHead = (uint32*)(Cq + Params.CqOffsets.Head);
+		CqTail = (uint32*)(Cq + Params.CqOffsets.Tail);
+		CqMask = *(uint32*)(Cq + Params.CqOffsets.RingMask);
+		Cqes = (FCqe*)(Cq + Params.CqOffsets.Cqes);
+
+		Capacity = Params.SqEntries;
+		LocalTail = *SqTail;
+		return true;
+	}
+
+	uint32 GetFreeSlots() const
+	{
+		return Capacity - Unsubmitted;
+	}
+
+	ZUIoUringAbi::FSqe* GetSqe()
+	{
+		if (Unsubmitted >= Capacity)
+		{
+			return nullptr;
+		}
+
+		const uint32 Index = LocalTail & SqMask;
+		ZUIoUringAbi::FSqe* Sqe = &Sqes[Index];
+		FMemory::Memzero(*Sqe);
+		SqArray[Index] = Index;
+
+		LocalTail++;
+		Unsubmitted++;
+		return Sqe;
+	}
+
+	// Submits everything prepared so far and blocks until all of it has completed. A ring that fails here is left
+	// in an unknown state and has to be torn down.
+	bool SubmitAndWait()
+	{
+		using namespace ZUIoUringAbi;
+
+		__atomic_store_n(SqTail, LocalTail, __ATOMIC_RELEASE);
+
+		uint32 ToSubmit = Unsubmitted;
+		uint32 ToComplete = Unsubmitted;
+		while (ToSubmit > 0 || ToComplete > InFlightCompleted())
+		{
+			const int Result = (int)syscall(EnterSyscall, RingFd, ToSubmit, ToComplete, EnterGetEvents, nullptr, 0);
+			if (Result < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+
+			//Nothing taken and nothing left to wait for would only spin
+			if (Result == 0 && (ToSubmit > 0 || InFlightCompleted() < ToComplete))
+			{
+				return false;
+			}
+			ToSubmit -= FMath::Min<uint32>(ToSubmit, (uint32)Result);
+		}
+		Unsubmitted = 0;
+		return true;
+	}
+
+	template<typename FunctorType>
+	void ReapCompletions(FunctorType&& Callback)
+	{
+		uint32 Head = *CqHead;
+		const uint32 Tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+
+		while (Head != Tail)
+		{
+			const ZUIoUringAbi::FCqe& Cqe = Cqes[Head & CqMask];
+			Callback(Cqe.UserData, Cqe.Result);
+			Head++;
+		}
+		__atomic_store_n(CqHead, Head, __ATOMIC_RELEASE);
+	}
+
+private:
+	uint32 InFlightCompleted() const
+	{
+		return __atomic_load_n(CqTail, __ATOMIC_ACQUIRE) - *CqHead;
+	}
+
+	int RingFd;
+
+	void* SqRing;
+	void* CqRing;
+	ZUIoUringAbi::FSqe* Sqes;
+	size_t SqRingSize;
+	size_t CqRingSize;
+	size_t SqesSize;
+
+	uint32* SqTail;
+	uint32* SqArray;
+	uint32 SqMask;
+
+	uint32* CqHead;
+	uint32* CqTail;
+	uint32 CqMask;
+	ZUIoUringAbi::FCqe* Cqes;
+
+	uint32 Capacity;
+	uint32 LocalTail;
+	uint32 Unsubmitted;
+};
+
+namespace
+{
+	const uint32 RingEntries = 256;
+
+	enum class EZURingOp : uint64
+	{
+		Open = 0,
+		Write = 1,
+		Fsync = 2,
+		Close = 3
+	};
+
+	uint64 MakeUserData(int32 Index, EZURingOp Op)
+	{
+		return ((uint64)Index << 2) | (uint64)Op;
+	}
+
+	bool WriteAll(int Fd, const uint8* Data, int64 Size, int64 FileOffset)
+	{
+		int64 Offset = 0;
+		while (Offset < Size)
+		{
+			const ssize_t Written = pwrite(Fd, Data + Offset, Size - Offset, FileOffset + Offset);
+			if (Written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (Written <= 0)
+			{
+				return false;
+			}
+			Offset += Written;
+		}
+		return true;
+	}
+}
+
+#endif //PLATFORM_LINUX
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+namespace
+{
+	//Sector/page granularity that unbuffered writes have to respect
+	const int64 UnbufferedAlignment = 4096;
+}
+
+ZUBatchedFileWriter::ZUBatchedFileWriter(bool bInFsync, int32 InMaxBatchFiles, int64 InMaxBatchBytes)
+{
+	bFsync = bInFsync;
+	MaxBatchFiles = FMath::Max(1, InMaxBatchFiles);
+	MaxBatchBytes = FMath::Max<int64>(1, InMaxBatchBytes);
+	PendingBytes = 0;
+
+#if PLATFORM_LINUX
+	Ring = nullptr;
+#endif
+}
+
+ZUBatchedFileWriter::~ZUBatchedFileWriter()
+{
+	Flush();
+
+#if PLATFORM_LINUX
+	delete Ring;
+#endif
+}
+
+bool ZUBatchedFileWriter::Enqueue(const FString& Path, TArray<uint8>&& Data)
+{
+	PendingBytes += Data.Num();
+
+	FZUFileWrite& File = Pending[Pending.AddDefaulted()];
+	File.Path = Path;
+	File.Data = MoveTemp(Data);
+
+	if (Pending.Num() >= MaxBatchFiles || PendingBytes >= MaxBatchBytes)
+	{
+		return Flush();
+	}
+	return true;
+}
+
+bool ZUBatchedFileWriter::Flush()
+{
+	if (Pending.Num() == 0)
+	{
+		return true;
+	}
+
+	const int32 FailedBefore = FailedPaths.Num();
+
+#if PLATFORM_LINUX
+	if (Ring != nullptr)
+	{
+		FlushWithIoUring();
+	}
+	else
+	{
+		FlushWithThreadPool();
+	}
+#else
+	FlushWithThreadPool();
+#endif
+
+	Pending.Reset();
+	PendingBytes = 0;
+
+	return FailedPaths.Num() == FailedBefore;
+}
+
+bool ZUBatchedFileWriter::SetUseIoUring(bool bInUseIoUring)
+{
+#if PLATFORM_LINUX
+	//Batches are written out completely on each flush, nothing in the ring outlives one
+	delete Ring;
+	Ring = nullptr;
+
+	if (bInUseIoUring)
+	{
+		Ring = new FZUIoUring();
+		if (!Ring->Init(RingEntries))
+		{
+			//Old kernel or a sandbox blocking io_uring, keep the thread pool path
+			delete Ring;
+			Ring = nullptr;
+			return false;
+		}
+	}
+	return true;
+#else
+	return !bInUseIoUring;
+#endif
+}
+
+void ZUBatchedFileWriter::FinishFile(const FZUFileWrite& File, bool bSuccess)
+{
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to write %s"), *File.Path);
+		FailedPaths.Add(File.Path);
+	}
+	else if (OnFileWritten)
+	{
+		OnFileWritten(File.Path, File.Data.Num());
+	}
+}
+
+void ZUBatchedFileWriter::FlushWithThreadPool()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TArray<bool> Results;
+	Results.SetNumZeroed(Pending.Num());
+
+	ParallelFor(Pending.Num(), [this, &PlatformFile, &Results](int32 Index)
+	{
+		const FZUFileWrite& File = Pending[Index];
+
+		IFileHandle* Handle = PlatformFile.OpenWrite(*File.Path);
+		if (Handle == nullptr)
+		{
+			return;
+		}
+
+		bool bSuccess = Handle->Write(File.Data.GetData(), File.Data.Num());
+		if (bSuccess && bFsync)
+		{
+			bSuccess = Handle->Flush(true);
+		}
+		delete Handle;
+
+		Results[Index] = bSuccess;
+	});
+
+	//Report back on the calling thread so callbacks don't need to be thread safe
+	for (int32 Index = 0; Index < Pending.Num(); Index++)
+	{
+		FinishFile(Pending[Index], Results[Index]);
+	}
+}
+
+#if PLATFORM_LINUX
+
+void ZUBatchedFileWriter::FlushWithIoUring()
+{
+	using namespace ZUIoUringAbi;
+
+	struct FFileState
+	{
+		TArray<ANSICHAR> Utf8Path;
+		int32 Fd = -1;
+		bool bWritten = false;
+		bool bSynced = false;
+		bool bCloseCompleted = false;
+		bool bClosed = false;
+	};
+
+	const int32 FileCount = Pending.Num();
+	TArray<FFileState> States;
+	States.SetNum(FileCount);
+
+	auto OnCompletion = [this, &States](uint64 UserData, int32 Result)
+	{
+		const int32 Index = (int32)(UserData >> 2);
+		FFileState& State = States[Index];
+		switch ((EZURingOp)(UserData & 3))
+		{
+		case EZURingOp::Open:
+			State.Fd = Result;
+			break;
+		case EZURingOp::Write:
+			State.bWritten = (Result == Pending[Index].Data.Num());
+			break;
+		case EZURingOp::Fsync:
+			State.bSynced = (Result == 0);
+			break;
+		case EZURingOp::Close:
+			State.bCloseCompleted = (Result != -ECANCELED);
+			State.bClosed = (Result == 0);
+			break;
+		}
+	};
+
+	auto Submit = [this, &OnCompletion]()
+	{
+		const bool bSubmitted = Ring->SubmitAndWait();
+		Ring->ReapCompletions(OnCompletion);
+		return bSubmitted;
+	};
+
+	//Drops the ring for good and writes the whole batch again through the thread pool, which truncates whatever the ring got to
+	auto FallBackToThreadPool = [this, &States]()
+	{
+		for (const FFileState& State : States)
+		{
+			if (State.Fd >= 0 && !State.bCloseCompleted)
+			{
+				close(State.Fd);
+			}
+		}
+		delete Ring;
+		Ring = nullptr;
+		FlushWithThreadPool();
+	};
+
+	//Phase 1: open every file of the batch, one submission per ring's worth
+	for (int32 Index = 0; Index < FileCount; Index++)
+	{
+		FTCHARToUTF8 Converter(*Pending[Index].Path);
+		States[Index].Utf8Path.Append(Converter.Get(), Converter.Length());
+		States[Index].Utf8Path.Add('\0');
+
+		FSqe* Sqe = Ring->GetSqe();
+		if (Sqe == nullptr)
+		{
+			if (!Submit())
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: io_uring submission failed, writing through the thread pool from now on"));
+				FallBackToThreadPool();
+				return;
+			}
+			Sqe = Ring->GetSqe();
+		}
+
+		Sqe->Opcode = OpOpenAt;
+		Sqe->Fd = AT_FDCWD;
+		Sqe->Address = (uint64)States[Index].Utf8Path.GetData();
+		Sqe->Length = 0644;
+		Sqe->OpFlags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+		Sqe->UserData = MakeUserData(Index, EZURingOp::Open);
+	}
+	if (!Submit())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: io_uring submission failed, writing through the thread pool from now on"));
+		FallBackToThreadPool();
+		return;
+	}
+
+	//Kernels before 5.6 don't know the opcode, hand the whole batch to the thread pool
+	for (const FFileState& State : States)
+	{
+		if (State.Fd == -EINVAL || State.Fd == -EOPNOTSUPP)
+		{
+			FallBackToThreadPool();
+			return;
+		}
+	}
+
+	//Phase 2: linked write -> fsync -> close chains, a chain never straddles two submissions
+	const uint32 ChainLength = bFsync ? 3 : 2;
+	for (int32 Index = 0; Index < FileCount; Index++)
+	{
+		const FFileState& State = States[Index];
+		if (State.Fd < 0)
+		{
+			continue;
+		}
+
+		if (Ring->GetFreeSlots() < ChainLength && !Submit())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: io_uring submission failed, writing through the thread pool from now on"));
+			FallBackToThreadPool();
+			return;
+		}
+
+		const TArray<uint8>& Data = Pending[Index].Data;
+
+		FSqe* Sqe = Ring->GetSqe();
+		Sqe->Opcode = OpWrite;
+		Sqe->Flags = SqeIoLink;
+		Sqe->Fd = State.Fd;
+		Sqe->Address = (uint64)Data.GetData();
+		Sqe->Length = Data.Num();
+		Sqe->Offset = 0;
+		Sqe->UserData = MakeUserData(Index, EZURingOp::Write);
+
+		if (bFsync)
+		{
+			Sqe = Ring->GetSqe();
+			Sqe->Opcode = OpFsync;
+			Sqe->Flags = SqeIoLink;
+			Sqe->Fd = State.Fd;
+			Sqe->UserData = MakeUserData(Index, EZURingOp::Fsync);
+		}
+
+		Sqe = Ring->GetSqe();
+		Sqe->Opcode = OpClose;
+		Sqe->Fd = State.Fd;
+		Sqe->UserData = MakeUserData(Index, EZURingOp::Close);
+	}
+	if (!Submit())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: io_uring submission failed, writing through the thread pool from now on"));
+		FallBackToThreadPool();
+		return;
+	}
+
+	for (int32 Index = 0; Index < FileCount; Index++)
+	{
+		FFileState& State = States[Index];
+		if (State.Fd < 0)
+		{
+			FinishFile(Pending[Index], false);
+			continue;
+		}
+
+		//A short write cancels the rest of its chain, finish those files synchronously
+		if (!State.bCloseCompleted)
+		{
+			const TArray<uint8>& Data = Pending[Index].Data;
+			bool bSuccess = WriteAll(State.Fd, Data.GetData(), Data.Num(), 0);
+			if (bSuccess && bFsync)
+			{
+				bSuccess = (fsync(State.Fd) == 0);
+			}
+			bSuccess = (close(State.Fd) == 0) && bSuccess;
+
+			FinishFile(Pending[Index], bSuccess);
+			continue;
+		}
+
+		FinishFile(Pending[Index], State.bClosed && State.bWritten && (State.bSynced || !bFsync));
+	}
+}
+
+#endif //PLATFORM_LINUX
+
+ZULargeFileWriter::ZULargeFileWriter(int64 InBufferSize)
+{
+	//Whole alignment blocks, so every staged write is also valid for unbuffered handles
+	BufferSize = Align(FMath::Max(InBufferSize, UnbufferedAlignment), UnbufferedAlignment);
+	Buffer = (uint8*)FMemory::Malloc(BufferSize, UnbufferedAlignment);
+	BufferUsed = 0;
+	FileOffset = 0;
+	bUnbuffered = false;
+
+#if PLATFORM_LINUX
+	Fd = -1;
+#elif PLATFORM_WINDOWS
+	FileHandle = nullptr;
+#else
+	Handle = nullptr;
+#endif
+}
+
+ZULargeFileWriter::~ZULargeFileWriter()
+{
+	if (IsOpen())
+	{
+		Close(false);
+	}
+	FMemory::Free(Buffer);
+}
+
+bool ZULargeFileWriter::Append(const uint8* Data, int64 Size)
+{
+	while (Size > 0)
+	{
+		const int64 Count = FMath::Min(Size, BufferSize - BufferUsed);
+		FMemory::Memcpy(Buffer + BufferUsed, Data, Count);
+
+		BufferUsed += Count;
+		Data += Count;
+		Size -= Count;
+
+		if (BufferUsed == BufferSize && !WriteStaged())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ZULargeFileWriter::Close(bool bFsync)
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	const int64 FinalSize = FileOffset + BufferUsed;
+	bool bSuccess = true;
+
+	if (BufferUsed > 0)
+	{
+		//Unbuffered writes have to cover whole blocks, pad the tail and trim it off below
+		if (bUnbuffered)
+		{
+			const int64 PaddedSize = Align(BufferUsed, UnbufferedAlignment);
+			FMemory::Memzero(Buffer + BufferUsed, PaddedSize - BufferUsed);
+			BufferUsed = PaddedSize;
+		}
+		bSuccess = WriteStaged();
+	}
+
+	//Also drops whatever the preallocation reserved beyond the written data
+	bSuccess = SetEndOfFile(FinalSize) && bSuccess;
+
+#if PLATFORM_LINUX
+	if (bFsync)
+	{
+		bSuccess = (fsync(Fd) == 0) && bSuccess;
+	}
+#elif PLATFORM_WINDOWS
+	if (bFsync)
+	{
+		bSuccess = (FlushFileBuffers((HANDLE)FileHandle) != 0) && bSuccess;
+	}
+#else
+	if (bFsync)
+	{
+		bSuccess = Handle->Flush(true) && bSuccess;
+	}
+#endif
+
+	ReleaseHandle();
+	BufferUsed = 0;
+	FileOffset = 0;
+	return bSuccess;
+}
+
+bool ZULargeFileWriter::WriteStaged()
+{
+	if (!WriteAt(Buffer, BufferUsed, FileOffset))
+	{
+		return false;
+	}
+	FileOffset += BufferUsed;
+	BufferUsed = 0;
+	return true;
+}
+
+#if PLATFORM_LINUX
+
+bool ZULargeFileWriter::Open(const FString& Path, int64 FinalSize, bool bInUnbuffered)
+{
+	const int Flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+	Fd = open(TCHAR_TO_UTF8(*Path), Flags | (bInUnbuffered ? O_DIRECT : 0), 0644);
+	if (Fd < 0 && bInUnbuffered && errno == EINVAL)
+	{
+		//tmpfs and friends refuse O_DIRECT
+		bInUnbuffered = false;
+		Fd = open(TCHAR_TO_UTF8(*Path), Flags, 0644);
+	}
+	if (Fd < 0)
+	{
+		return false;
+	}
+
+	bUnbuffered = bInUnbuffered;
+	BufferUsed = 0;
+	FileOffset = 0;
+
+	//Filesystems without fallocate simply grow the file as it is written
+	if (FinalSize > 0)
+	{
+		fallocate(Fd, 0, 0, FinalSize);
+	}
+	return true;
+}
+
+bool ZULargeFileWriter::IsOpen() const
+{
+	return Fd >= 0;
+}
+
+bool ZULargeFileWriter::WriteAt(const uint8* Data, int64 Size, int64 Offset)
+{
+	return WriteAll(Fd, Data, Size, Offset);
+}
+
+bool ZULargeFileWriter::SetEndOfFile(int64 Size)
+{
+	return ftruncate(Fd, Size) == 0;
+}
+
+void ZULargeFileWriter::ReleaseHandle()
+{
+	close(Fd);
+	Fd = -1;
+}
+
+#elif PLATFORM_WINDOWS
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+
+bool ZULargeFileWriter::Open(const FString& Path, int64 FinalSize, bool bInUnbuffered)
+{
+	DWORD Flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN;
+	if (bInUnbuffered)
+	{
+		Flags |= FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH;
+	}
+
+	HANDLE NewHandle = CreateFileW(*Path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, Flags, nullptr);
+	if (NewHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	FileHandle = NewHandle;
+	bUnbuffered = bInUnbuffered;
+	BufferUsed = 0;
+	FileOffset = 0;
+
+	if (FinalSize > 0)
+	{
+		FILE_ALLOCATION_INFO AllocationInfo;
+		AllocationInfo.AllocationSize.QuadPart = FinalSize;
+		SetFileInformationByHandle(NewHandle, FileAllocationInfo, &AllocationInfo, sizeof(AllocationInfo));
+	}
+	return true;
+}
+
+bool ZULargeFileWriter::IsOpen() const
+{
+	return FileHandle != nullptr;
+}
+
+bool ZULargeFileWriter::WriteAt(const uint8* Data, int64 Size, int64 Offset)
+{
+	while (Size > 0)
+	{
+		//Stays a multiple of the alignment for unbuffered handles
+		const DWORD Chunk = (DWORD)FMath::Min<int64>(Size, 1 << 30);
+
+		OVERLAPPED Overlapped;
+		FMemory::Memzero(Overlapped);
+		Overlapped.Offset = (DWORD)(Offset & 0xFFFFFFFF);
+		Overlapped.OffsetHigh = (DWORD)(Offset >> 32);
+
+		DWORD Written = 0;
+		if (!WriteFile((HANDLE)FileHandle, Data, Chunk, &Written, &Overlapped) || Written == 0)
+		{
+			return false;
+		}
+
+		Data += Written;
+		Size -= Written;
+		Offset += Written;
+	}
+	return true;
+}
+
+bool ZULargeFileWriter::SetEndOfFile(int64 Size)
+{
+	FILE_END_OF_FILE_INFO EndOfFileInfo;
+	EndOfFileInfo.EndOfFile.QuadPart = Size;
+	return SetFileInformationByHandle((HANDLE)FileHandle, FileEndOfFileInfo, &EndOfFileInfo, sizeof(EndOfFileInfo)) != 0;
+}
+
+void ZULargeFileWriter::ReleaseHandle()
+{
+	::CloseHandle((HANDLE)FileHandle);
+	FileHandle = nullptr;
+}
+
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#else
+
+bool ZULargeFileWriter::Open(const FString& Path, int64 FinalSize, bool bInUnbuffered)
+{
+	//No preallocation or unbuffered mode through IPlatformFile, staging still coalesces the writes
+	Handle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path);
+	bUnbuffered = false;
+	BufferUsed = 0;
+	FileOffset = 0;
+	return Handle != nullptr;
+}
+
+bool ZULargeFileWriter::IsOpen() const
+{
+	return Handle != nullptr;
+}
+
+bool ZULargeFileWriter::WriteAt(const uint8* Data, int64 Size, int64 Offset)
+{
+	return Handle->Seek(Offset) && Handle->Write(Data, Size);
+}
+
+bool ZULargeFileWriter::SetEndOfFile(int64 Size)
+{
+	return Handle->Size() == Size;
+}
+
+void ZULargeFileWriter::ReleaseHandle()
+{
+	delete Handle;
+	Handle = nullptr;
+}
+
+#endif
+
+#if PLATFORM_LINUX
+
+namespace
+{
+	//Shares the source blocks instead of copying them, only works on whole blocks of the same file system
+	bool CloneRange(int SourceFd, uint64 SourceOffset, uint64 Size, int DestinationFd)
+	{
+#if defined(FICLONERANGE)
+		struct stat StatBuffer;
+		if (fstat(SourceFd, &StatBuffer) != 0 || StatBuffer.st_blksize <= 0)
+		{
+			return false;
+		}
+		const uint64 BlockSize = StatBuffer.st_blksize;
+		if (SourceOffset % BlockSize != 0 || (Size % BlockSize != 0 && SourceOffset + Size != (uint64)StatBuffer.st_size))
+		{
+			return false;
+		}
+
+		struct file_clone_range Range;
+		Range.src_fd = SourceFd;
+		Range.src_offset = SourceOffset;
+		Range.src_length = Size;
+		Range.dest_offset = 0;
+		return ioctl(DestinationFd, FICLONERANGE, &Range) == 0;
+#else
+		return false;
+#endif
+	}
+
+	int64 CopyFileRange(int SourceFd, loff_t& SourceOffset, int DestinationFd, uint64 Count)
+	{
+#if defined(__NR_copy_file_range)
+		return syscall(__NR_copy_file_range, SourceFd, &SourceOffset, DestinationFd, nullptr, (size_t)Count, 0u);
+#else
+		errno = ENOSYS;
+		return -1;
+#endif
+	}
+
+	int64 SendFile(int SourceFd, loff_t& SourceOffset, int DestinationFd, uint64 Count)
+	{
+		off_t Offset = SourceOffset;
+		const ssize_t Result = sendfile(DestinationFd, SourceFd, &Offset, (size_t)FMath::Min<uint64>(Count, 0x7ffff000));
+		SourceOffset = Offset;
+		return Result;
+	}
+
+	int64 ReadWrite(int SourceFd, loff_t& SourceOffset, int DestinationFd, uint64 Count)
+	{
+		//Last resort only, a small stack buffer saves allocating per call
+		uint8 Buffer[64 * 1024];
+		const ssize_t Read = pread(SourceFd, Buffer, (size_t)FMath::Min<uint64>(Count, sizeof(Buffer)), SourceOffset);
+		if (Read <= 0)
+		{
+			return Read;
+		}
+		for (ssize_t Written = 0; Written < Read;)
+		{
+			const ssize_t Result = write(DestinationFd, Buffer + Written, Read - Written);
+			if (Result < 0 && errno != EINTR)
+			{
+				return -1;
+			}
+			Written += FMath::Max<ssize_t>(Result, 0);
+		}
+		SourceOffset += Read;
+		return Read;
+	}
+
+	bool CopyRange(int SourceFd, uint64 SourceOffset, uint64 Size, int DestinationFd)
+	{
+		if (Size == 0 || CloneRange(SourceFd, SourceOffset, Size, DestinationFd))
+		{
+			return true;
+		}
+
+		//Each route is given up on only before it copied anything, e.g. across file systems on older kernels
+		int64 (*const Routes[3])(int, loff_t&, int, uint64) = { &CopyFileRange, &SendFile, &ReadWrite };
+		loff_t Offset = SourceOffset;
+		uint64 Copied = 0;
+		for (int32 Route = 0; Route < 3 && Copied < Size;)
+		{
+			const int64 Result = Routes[Route](SourceFd, Offset, DestinationFd, Size - Copied);
+			if (Result > 0)
+			{
+				Copied += Result;
+			}
+			else if (Result < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			else if (Result < 0 && Copied == 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+			{
+				Route++;
+			}
+			else
+			{
+				//End of the source before the range was done, or a real error
+				return false;
+			}
+		}
+		return Copied == Size;
+	}
+}
+
+bool ZUFileRangeCopy::Copy(const FString& SourcePath, uint64 SourceOffset, uint64 Size, const FString& DestinationPath)
+{
+	const int SourceFd = open(TCHAR_TO_UTF8(*SourcePath), O_RDONLY | O_CLOEXEC);
+	if (SourceFd < 0)
+	{
+		return false;
+	}
+
+	const int DestinationFd = open(TCHAR_TO_UTF8(*DestinationPath), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (DestinationFd < 0)
+	{
+		close(SourceFd);
+		return false;
+	}
+
+	bool bSuccess = CopyRange(SourceFd, SourceOffset, Size, DestinationFd);
+	bSuccess &= close(DestinationFd) == 0;
+	close(SourceFd);
+	return bSuccess;
+}
+
+#else
+
+bool ZUFileRangeCopy::Copy(const FString& SourcePath, uint64 SourceOffset, uint64 Size, const FString& DestinationPath)
+{
+	//CopyFileW has no ranged form, a plain chunked copy still skips the decoder
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IFileHandle> Source(PlatformFile.OpenRead(*SourcePath));
+	if (!Source || !Source->Seek(SourceOffset))
+	{
+		return false;
+	}
+	TUniquePtr<IFileHandle> Destination(PlatformFile.OpenWrite(*DestinationPath));
+	if (!Destination)
+	{
+		return false;
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(FMath::Min<uint64>(Size, 1024 * 1024));
+	for (uint64 Copied = 0; Copied < Size;)
+	{
+		const int64 Chunk = FMath::Min<uint64>(Size - Copied, Buffer.Num());
+		if (!Source->Read(Buffer.GetData(), Chunk) || !Destination->Write(Buffer.GetData(), Chunk))
+		{
+			return false;
+		}
+		Copied += Chunk;
+	}
+	return Destination->Flush();
+}
+
+#endif
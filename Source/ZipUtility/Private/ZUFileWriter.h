@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A finished output file waiting to be written. */
+struct FZUFileWrite
+{
+	FString Path;
+	TArray<uint8> Data;
+};
+
+/**
+ * Collects small output files and writes them out in batches, each batch spread over the task graph
+ * workers. On Linux the open/write/fsync/close sequence of a whole batch can be submitted through
+ * io_uring instead, see SetUseIoUring.
+ */
+class ZUBatchedFileWriter
+{
+public:
+	ZUBatchedFileWriter(bool bInFsync = false, int32 InMaxBatchFiles = 256, int64 InMaxBatchBytes = 64 * 1024 * 1024);
+	~ZUBatchedFileWriter();
+
+	// Queues a file, flushing the batch once it reaches either limit. Returns false if a flush failed.
+	bool Enqueue(const FString& Path, TArray<uint8>&& Data);
+
+	// Writes out everything queued. Returns false if any file in the batch failed.
+	bool Flush();
+
+	// Linux only, off by default. The ring needs far fewer syscalls than the pool but measured slower in wall
+	// time, so it only pays off where syscalls are expensive. Returns false if the kernel refuses a ring.
+	bool SetUseIoUring(bool bInUseIoUring);
+
+	// Called on the enqueueing thread for each file once it is on disk
+	TFunction<void(const FString& Path, uint64 Bytes)> OnFileWritten;
+
+	const TArray<FString>& GetFailedPaths() const { return FailedPaths; }
+
+private:
+	void FinishFile(const FZUFileWrite& File, bool bSuccess);
+
+	void FlushWithThreadPool();
+#if PLATFORM_LINUX
+	void FlushWithIoUring();
+
+	class FZUIoUring* Ring;
+#endif
+
+	TArray<FZUFileWrite> Pending;
+	TArray<FString> FailedPaths;
+	int64 PendingBytes;
+
+	bool bFsync;
+	int32 MaxBatchFiles;
+	int64 MaxBatchBytes;
+};
+
+/**
+ * Streams a single large file to disk. The file is preallocated to its final size up front and
+ * written through one big aligned staging buffer, so codec sized chunks never reach the filesystem.
+ * Unbuffered files skip the page cache (O_DIRECT / FILE_FLAG_NO_BUFFERING).
+ */
+class ZULargeFileWriter
+{
+public:
+	ZULargeFileWriter(int64 InBufferSize = 4 * 1024 * 1024);
+	~ZULargeFileWriter();
+
+	bool Open(const FString& Path, int64 FinalSize, bool bInUnbuffered);
+	bool Append(const uint8* Data, int64 Size);
+
+	// Writes the staged tail and trims the file to the bytes actually written
+	bool Close(bool bFsync);
+
+	bool IsOpen() const;
+
+private:
+	bool WriteStaged();
+	bool WriteAt(const uint8* Data, int64 Size, int64 Offset);
+	bool SetEndOfFile(int64 Size);
+	void ReleaseHandle();
+
+	uint8* Buffer;
+	int64 BufferSize;
+	int64 BufferUsed;
+	int64 FileOffset;
+	bool bUnbuffered;
+
+#if PLATFORM_LINUX
+	int Fd;
+#elif PLATFORM_WINDOWS
+	void* FileHandle;
+#else
+	IFileHandle* Handle;
+#endif
+};
+
+/**
+ * Copies a byte range of one file into a new file without passing it through user space where the
+ * platform allows. On Linux a block aligned range is reflinked, anything else goes through
+ * copy_file_range, then sendfile, and only then a read/write loop. Other platforms copy in chunks.
+ */
+class ZUFileRangeCopy
+{
+public:
+	// Creates or truncates DestinationPath. A failed copy can leave a partial file behind.
+	static bool Copy(const FString& SourcePath, uint64 SourceOffset, uint64 Size, const FString& DestinationPath);
+};
@@ -0,0 +1,284 @@
+#include "ZUFormatSniffer.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	const int64 HeadSize = 4096;
+	const int64 TrailerSize = 4096;
+	const int64 IsoDescriptorOffset = 0x8001;
+	const int32 TarHeaderSize = 512;
+	const int32 EndOfCentralDirectorySize = 22;
+
+	struct FSignature
+	{
+		EZipUtilityCompressionFormat Format;
+		int32 Offset;
+		int32 Length;
+		const char* Bytes;
+	};
+
+	//Formats without a 7zpp counterpart map to unknown, they're only listed so they can't be mistaken for something else
+	const FSignature HeadSignatures[] =
+	{
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_SEVEN_ZIP, 0, 6, "7z\xBC\xAF\x27\x1C" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP, 0, 4, "PK\x03\x04" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP, 0, 4, "PK\x05\x06" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP, 0, 4, "PK\x07\x08" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_RAR, 0, 7, "Rar!\x1A\x07\x00" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_RAR, 0, 8, "Rar!\x1A\x07\x01\x00" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_CAB, 0, 8, "MSCF\0\0\0\0" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_GZIP, 0, 3, "\x1F\x8B\x08" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_BZIP2, 0, 3, "BZh" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR, 257, 5, "ustar" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN, 0, 6, "\xFD" "7zXZ\0" },
+		{ EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN, 0, 4, "\x28\xB5\x2F\xFD" }
+	};
+
+	struct FCachedFormat
+	{
+		EZipUtilityCompressionFormat Format;
+		int64 Size;
+		FDateTime TimeStamp;
+	};
+
+	FCriticalSection CacheLock;
+	TMap<FString, FCachedFormat> Cache;
+
+	void AddToCache(const FString& FullPath, EZipUtilityCompressionFormat Format, int64 Size, const FDateTime& TimeStamp)
+	{
+		FCachedFormat Cached;
+		Cached.Format = Format;
+		Cached.Size = Size;
+		Cached.TimeStamp = TimeStamp;
+
+		FScopeLock Lock(&CacheLock);
+		Cache.Add(FullPath, Cached);
+	}
+
+	bool ReadAt(IFileHandle& Handle, int64 Offset, TArray<uint8>& OutData, int64 Count)
+	{
+		OutData.SetNumUninitialized(Count);
+		return Handle.Seek(Offset) && Handle.Read(OutData.GetData(), Count);
+	}
+
+	bool Matches(const TArray<uint8>& Data, int64 Offset, const char* Bytes, int32 Length)
+	{
+		return Offset + Length <= Data.Num() && FMemory::Memcmp(Data.GetData() + Offset, Bytes, Length) == 0;
+	}
+
+	//Pre-posix tar headers have no magic, only a checksum over the header with its own field counted as spaces
+	bool HasTarChecksum(const TArray<uint8>& Head)
+	{
+		if (Head.Num() < TarHeaderSize)
+		{
+			return false;
+		}
+
+		uint32 Stored = 0;
+		bool bHasDigits = false;
+		for (int32 Index = 148; Index < 156; Index++)
+		{
+			const uint8 Character = Head[Index];
+			if (Character >= '0' && Character <= '7')
+			{
+				Stored = Stored * 8 + (Character - '0');
+				bHasDigits = true;
+			}
+			else if (Character == ' ' || Character == 0)
+			{
+				if (bHasDigits)
+				{
+					break;
+				}
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		uint32 Sum = 0;
+		for (int32 Index = 0; Index < TarHeaderSize; Index++)
+		{
+			Sum += (Index >= 148 && Index < 156) ? ' ' : Head[Index];
+		}
+		return bHasDigits && Sum == Stored;
+	}
+
+	//A gzip stream is a tarball if its first inflated record is a tar header
+	bool IsGzippedTar(const TArray<uint8>& Head)
+	{
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+		if (inflateInit2(&Stream, MAX_WBITS + 16) != Z_OK)
+		{
+			return false;
+		}
+
+		TArray<uint8> Record;
+		Record.SetNumZeroed(TarHeaderSize);
+		Stream.next_in = (Bytef*)Head.GetData();
+		Stream.avail_in = (uInt)Head.Num();
+		Stream.next_out = Record.GetData();
+		Stream.avail_out = (uInt)Record.Num();
+
+		inflate(&Stream, Z_SYNC_FLUSH);
+		const bool bFullRecord = Stream.avail_out == 0;
+		inflateEnd(&Stream);
+
+		return bFullRecord && (Matches(Record, 257, "ustar", 5) || HasTarChecksum(Record));
+	}
+
+	//Self extracting and otherwise prefixed zips only show up in the end of central directory record
+	bool HasZipTrailer(IFileHandle& Handle, int64 Size)
+	{
+		if (Size < EndOfCentralDirectorySize)
+		{
+			return false;
+		}
+
+		const int64 TailSize = FMath::Min(Size, TrailerSize);
+		TArray<uint8> Tail;
+		if (!ReadAt(Handle, Size - TailSize, Tail, TailSize))
+		{
+			return false;
+		}
+
+		for (int64 Index = TailSize - EndOfCentralDirectorySize; Index >= 0; Index--)
+		{
+			if (Matches(Tail, Index, "PK\x05\x06", 4))
+			{
+				//The comment has to run exactly to the end of the file
+				const uint16 CommentLength = Tail[Index + 20] | (Tail[Index + 21] << 8);
+				return Index + EndOfCentralDirectorySize + CommentLength == TailSize;
+			}
+		}
+		return false;
+	}
+
+	//Raw lzma streams have no magic, only a properties byte (lc + lp * 9 + pb * 45) and a dictionary size
+	bool HasLzmaHeader(const TArray<uint8>& Head, int64 Offset)
+	{
+		if (Head.Num() < Offset + 13 || Head[Offset] >= 9 * 5 * 5)
+		{
+			return false;
+		}
+		const uint32 DictionarySize = Head[Offset + 1] | (Head[Offset + 2] << 8) | (Head[Offset + 3] << 16) | ((uint32)Head[Offset + 4] << 24);
+		return DictionarySize >= 4096;
+	}
+
+	EZipUtilityCompressionFormat Sniff(IFileHandle& Handle, int64 Size, const FString& Path)
+	{
+		const FString Extension = FPaths::GetExtension(Path).ToLower();
+
+		TArray<uint8> Head;
+		if (!ReadAt(Handle, 0, Head, FMath::Min(Size, HeadSize)))
+		{
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN;
+		}
+
+		for (const FSignature& Signature : HeadSignatures)
+		{
+			if (Matches(Head, Signature.Offset, Signature.Bytes, Signature.Length))
+			{
+				if (Signature.Format == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is an xz or zstd stream, which 7zip isn't set up to read here"), *Path);
+				}
+				if (Signature.Format == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_GZIP && IsGzippedTar(Head))
+				{
+					return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP;
+				}
+				return Signature.Format;
+			}
+		}
+
+		if (HasZipTrailer(Handle, Size))
+		{
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP;
+		}
+
+		TArray<uint8> Descriptor;
+		if (Size >= IsoDescriptorOffset + 5 && ReadAt(Handle, IsoDescriptorOffset, Descriptor, 5) && Matches(Descriptor, 0, "CD001", 5))
+		{
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ISO;
+		}
+
+		if (HasTarChecksum(Head))
+		{
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR;
+		}
+
+		//Too weak to go on without the extension agreeing
+		if (Extension == TEXT("lzma") && HasLzmaHeader(Head, 0))
+		{
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_LZMA;
+		}
+		if (Extension == TEXT("lzma86") && Head.Num() > 0 && Head[0] <= 1 && HasLzmaHeader(Head, 1))
+		{
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_LZMA86;
+		}
+
+		return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN;
+	}
+}
+
+EZipUtilityCompressionFormat ZUFormatSniffer::Detect(const FString& ArchivePath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString FullPath = FPaths::ConvertRelativePathToFull(ArchivePath);
+
+	const int64 Size = PlatformFile.FileSize(*FullPath);
+	if (Size < 0)
+	{
+		return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN;
+	}
+	const FDateTime TimeStamp = PlatformFile.GetTimeStamp(*FullPath);
+
+	{
+		FScopeLock Lock(&CacheLock);
+		const FCachedFormat* Cached = Cache.Find(FullPath);
+		if (Cached != nullptr && Cached->Size == Size && Cached->TimeStamp == TimeStamp)
+		{
+			return Cached->Format;
+		}
+	}
+
+	IFileHandle* Handle = PlatformFile.OpenRead(*FullPath);
+	if (Handle == nullptr)
+	{
+		return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN;
+	}
+	const EZipUtilityCompressionFormat Format = Sniff(*Handle, Size, FullPath);
+	delete Handle;
+
+	if (Format != EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+	{
+		AddToCache(FullPath, Format, Size, TimeStamp);
+	}
+	return Format;
+}
+
+void ZUFormatSniffer::Remember(const FString& ArchivePath, EZipUtilityCompressionFormat Format)
+{
+	if (Format == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+	{
+		return;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString FullPath = FPaths::ConvertRelativePathToFull(ArchivePath);
+
+	const int64 Size = PlatformFile.FileSize(*FullPath);
+	if (Size < 0)
+	{
+		return;
+	}
+
+	AddToCache(FullPath, Format, Size, PlatformFile.GetTimeStamp(*FullPath));
+}
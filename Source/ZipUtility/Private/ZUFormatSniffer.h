@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ZipFileFunctionLibrary.h"
+
+/**
+ * Identifies archives from their signature bytes (the head, the tar header, the iso volume
+ * descriptor and the zip trailer) instead of 7zip's trial opens. Results are cached per path and
+ * dropped again when the file's size or timestamp changes.
+ */
+class ZUFormatSniffer
+{
+public:
+	// Returns COMPRESSION_FORMAT_UNKNOWN if no signature matched
+	static EZipUtilityCompressionFormat Detect(const FString& ArchivePath);
+
+	// Caches a format found another way, e.g. by a 7zip trial open
+	static void Remember(const FString& ArchivePath, EZipUtilityCompressionFormat Format);
+};
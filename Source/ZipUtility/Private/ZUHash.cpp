@@ -0,0 +1,197 @@
+#include "ZUHash.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+
+namespace
+{
+	const uint64 Prime1 = 0x9E3779B185EBCA87ULL;
+	const uint64 Prime2 = 0xC2B2AE3D27D4EB4FULL;
+	const uint64 Prime3 = 0x165667B19E3779F9ULL;
+	const uint64 Prime4 = 0x85EBCA77C2B2AE63ULL;
+	const uint64 Prime5 = 0x27D4EB2F165667C5ULL;
+
+	const int64 FileChunkSize = 1024 * 1024;
+
+	FORCEINLINE uint64 RotateLeft(uint64 Value, int32 Bits)
+	{
+		return (Value << Bits) | (Value >> (64 - Bits));
+	}
+
+	FORCEINLINE uint64 ReadLittleEndian64(const uint8* Data)
+	{
+#if PLATFORM_LITTLE_ENDIAN
+		uint64 Value;
+		FMemory::Memcpy(&Value, Data, sizeof(Value));
+		return Value;
+#else
+		uint64 Value = 0;
+		for (int32 Index = 7; Index >= 0; Index--)
+		{
+			Value = (Value << 8) | Data[Index];
+		}
+		return Value;
+#endif
+	}
+
+	FORCEINLINE uint32 ReadLittleEndian32(const uint8* Data)
+	{
+		return (uint32)Data[0] | ((uint32)Data[1] << 8) | ((uint32)Data[2] << 16) | ((uint32)Data[3] << 24);
+	}
+
+	FORCEINLINE uint64 Round(uint64 Lane, uint64 Input)
+	{
+		Lane += Input * Prime2;
+		Lane = RotateLeft(Lane, 31);
+		return Lane * Prime1;
+	}
+
+	FORCEINLINE uint64 MergeRound(uint64 Hash, uint64 Lane)
+	{
+		Hash ^= Round(0, Lane);
+		return Hash * Prime1 + Prime4;
+	}
+
+	//Four independent lanes of 8 bytes each, the part that runs at memory speed
+	FORCEINLINE const uint8* ConsumeStripes(uint64 Lanes[4], const uint8* Data, const uint8* End)
+	{
+		uint64 Lane0 = Lanes[0];
+		uint64 Lane1 = Lanes[1];
+		uint64 Lane2 = Lanes[2];
+		uint64 Lane3 = Lanes[3];
+		while (Data + 32 <= End)
+		{
+			Lane0 = Round(Lane0, ReadLittleEndian64(Data));
+			Lane1 = Round(Lane1, ReadLittleEndian64(Data + 8));
+			Lane2 = Round(Lane2, ReadLittleEndian64(Data + 16));
+			Lane3 = Round(Lane3, ReadLittleEndian64(Data + 24));
+			Data += 32;
+		}
+		Lanes[0] = Lane0;
+		Lanes[1] = Lane1;
+		Lanes[2] = Lane2;
+		Lanes[3] = Lane3;
+		return Data;
+	}
+}
+
+ZUHash::ZUHash(uint64 InSeed)
+{
+	Seed = InSeed;
+	Lanes[0] = Seed + Prime1 + Prime2;
+	Lanes[1] = Seed + Prime2;
+	Lanes[2] = Seed;
+	Lanes[3] = Seed - Prime1;
+	BufferSize = 0;
+	TotalSize = 0;
+}
+
+void ZUHash::Update(const void* Data, int64 Size)
+{
+	const uint8* Bytes = (const uint8*)Data;
+	const uint8* End = Bytes + Size;
+	TotalSize += Size;
+
+	//Top up a partial stripe left by the previous call first
+	if (BufferSize > 0)
+	{
+		const int32 Needed = FMath::Min<int64>(32 - BufferSize, Size);
+		FMemory::Memcpy(Buffer + BufferSize, Bytes, Needed);
+		BufferSize += Needed;
+		Bytes += Needed;
+		if (BufferSize < 32)
+		{
+			return;
+		}
+		ConsumeStripes(Lanes, Buffer, Buffer + 32);
+		BufferSize = 0;
+	}
+
+	Bytes = ConsumeStripes(Lanes, Bytes, End);
+
+	if (Bytes < End)
+	{
+		BufferSize = (int32)(End - Bytes);
+		FMemory::Memcpy(Buffer, Bytes, BufferSize);
+	}
+}
+
+uint64 ZUHash::Finalize() const
+{
+	uint64 Hash;
+	if (TotalSize >= 32)
+	{
+		Hash = RotateLeft(Lanes[0], 1) + RotateLeft(Lanes[1], 7) + RotateLeft(Lanes[2], 12) + RotateLeft(Lanes[3], 18);
+		for (int32 Lane = 0; Lane < 4; Lane++)
+		{
+			Hash = MergeRound(Hash, Lanes[Lane]);
+		}
+	}
+	else
+	{
+		Hash = Seed + Prime5;
+	}
+	Hash += TotalSize;
+
+	const uint8* Data = Buffer;
+	const uint8* End = Buffer + BufferSize;
+	while (Data + 8 <= End)
+	{
+		Hash ^= Round(0, ReadLittleEndian64(Data));
+		Hash = RotateLeft(Hash, 27) * Prime1 + Prime4;
+		Data += 8;
+	}
+	if (Data + 4 <= End)
+	{
+		Hash ^= (uint64)ReadLittleEndian32(Data) * Prime1;
+		Hash = RotateLeft(Hash, 23) * Prime2 + Prime3;
+		Data += 4;
+	}
+	while (Data < End)
+	{
+		Hash ^= (uint64)(*Data) * Prime5;
+		Hash = RotateLeft(Hash, 11) * Prime1;
+		Data++;
+	}
+
+	Hash ^= Hash >> 33;
+	Hash *= Prime2;
+	Hash ^= Hash >> 29;
+	Hash *= Prime3;
+	Hash ^= Hash >> 32;
+	return Hash;
+}
+
+uint64 ZUHash::HashBuffer(const void* Data, int64 Size, uint64 Seed)
+{
+	ZUHash Hash(Seed);
+	Hash.Update(Data, Size);
+	return Hash.Finalize();
+}
+
+bool ZUHash::HashFile(const FString& Path, uint64& OutHash)
+{
+	TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+	if (!Handle.IsValid())
+	{
+		return false;
+	}
+
+	ZUHash Hash;
+	TArray<uint8> Chunk;
+	int64 Remaining = Handle->Size();
+	Chunk.SetNumUninitialized(FMath::Min(Remaining, FileChunkSize));
+
+	while (Remaining > 0)
+	{
+		const int64 ChunkSize = FMath::Min(Remaining, FileChunkSize);
+		if (!Handle->Read(Chunk.GetData(), ChunkSize))
+		{
+			return false;
+		}
+		Hash.Update(Chunk.GetData(), ChunkSize);
+		Remaining -= ChunkSize;
+	}
+
+	OutHash = Hash.Finalize();
+	return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 64 bit xxHash (XXH64) for content fingerprints. Streams in pieces of any size and gives the same
+ * result as hashing the whole buffer at once, so entries can be hashed while they are decoded.
+ * Not a cryptographic hash, it tells apart changed content, not tampered content.
+ */
+class ZUHash
+{
+public:
+	explicit ZUHash(uint64 InSeed = 0);
+
+	void Update(const void* Data, int64 Size);
+
+	// Hash of everything passed to Update so far, more data can still follow
+	uint64 Finalize() const;
+
+	static uint64 HashBuffer(const void* Data, int64 Size, uint64 Seed = 0);
+
+	// Reads the file in chunks, false if it can't be opened or read
+	static bool HashFile(const FString& Path, uint64& OutHash);
+
+private:
+	uint64 Seed;
+	uint64 Lanes[4];
+	uint8 Buffer[32];
+	int32 BufferSize;
+	uint64 TotalSize;
+};
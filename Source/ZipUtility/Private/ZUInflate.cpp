@@ -0,0 +1,644 @@
+#include "ZUInflate.h"
+#include "ZipUtilityPrivatePCH.h"
+
+namespace
+{
+	const int32 MaxCodeBits = 15;
+	const int32 NumLitLenSymbols = 288;
+	const int32 NumDistSymbols = 32;
+	const int32 NumPrecodeSymbols = 19;
+
+	const int32 LitLenRootBits = 10;
+	const int32 DistRootBits = 8;
+	const int32 PrecodeRootBits = 7;
+
+	//Worst case table sizes for these root sizes are 1334 and 402 entries
+	const int32 LitLenCapacity = 1536;
+	const int32 DistCapacity = 512;
+	const int32 PrecodeCapacity = 1 << PrecodeRootBits;
+
+	/**
+	 * Table entries pack everything the decode loop needs into one word:
+	 * [31:16] literal / base value / subtable offset, [15:8] extra bits / subtable bits,
+	 * [7:5] entry type, [4:0] bits consumed by the codeword in this table.
+	 */
+	enum EEntryType : uint32
+	{
+		TypeLiteral = 0,
+		TypeMatch = 1,
+		TypeEndOfBlock = 2,
+		TypeSubtable = 3,
+		TypeInvalid = 4
+	};
+
+	FORCEINLINE uint32 MakeEntry(uint32 Value, uint32 Extra, uint32 Type)
+	{
+		return (Value << 16) | (Extra << 8) | (Type << 5);
+	}
+
+	FORCEINLINE uint32 EntryType(uint32 Entry)
+	{
+		return (Entry >> 5) & 7;
+	}
+
+	FORCEINLINE uint32 EntryBits(uint32 Entry)
+	{
+		return Entry & 31;
+	}
+
+	FORCEINLINE uint32 EntryExtra(uint32 Entry)
+	{
+		return (Entry >> 8) & 0xFF;
+	}
+
+	FORCEINLINE uint32 EntryValue(uint32 Entry)
+	{
+		return Entry >> 16;
+	}
+
+	const uint16 LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8 LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16 DistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8 DistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const uint8 PrecodeOrder[NumPrecodeSymbols] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	struct FSymbolEntries
+	{
+		uint32 LitLen[NumLitLenSymbols];
+		uint32 Dist[NumDistSymbols];
+		uint32 Precode[NumPrecodeSymbols];
+
+		FSymbolEntries()
+		{
+			for (int32 Symbol = 0; Symbol < NumLitLenSymbols; Symbol++)
+			{
+				if (Symbol < 256)
+				{
+					LitLen[Symbol] = MakeEntry(Symbol, 0, TypeLiteral);
+				}
+				else if (Symbol == 256)
+				{
+					LitLen[Symbol] = MakeEntry(0, 0, TypeEndOfBlock);
+				}
+				else if (Symbol < 286)
+				{
+					LitLen[Symbol] = MakeEntry(LengthBase[Symbol - 257], LengthExtra[Symbol - 257], TypeMatch);
+				}
+				else
+				{
+					LitLen[Symbol] = MakeEntry(0, 0, TypeInvalid);
+				}
+			}
+
+			for (int32 Symbol = 0; Symbol < NumDistSymbols; Symbol++)
+			{
+				Dist[Symbol] = (Symbol < 30) ? MakeEntry(DistBase[Symbol], DistExtra[Symbol], TypeMatch) : MakeEntry(0, 0, TypeInvalid);
+			}
+
+			for (int32 Symbol = 0; Symbol < NumPrecodeSymbols; Symbol++)
+			{
+				Precode[Symbol] = MakeEntry(Symbol, 0, TypeLiteral);
+			}
+		}
+	};
+
+	const FSymbolEntries& GetSymbolEntries()
+	{
+		static const FSymbolEntries Entries;
+		return Entries;
+	}
+
+	/**
+	 * Builds a canonical Huffman lookup table, root table first followed by its subtables
+	 * (same construction as zlib's inflate_table). An incomplete code is only accepted when it is a
+	 * single one bit code and bAllowSingleCode is set, unused slots decode as invalid.
+	 */
+	bool BuildTable(const uint8* Lengths, int32 NumSymbols, const uint32* SymbolEntries, uint32* Table, int32 RootBits, int32 Capacity, bool bAllowSingleCode)
+	{
+		uint16 Count[MaxCodeBits + 1] = { 0 };
+		for (int32 Symbol = 0; Symbol < NumSymbols; Symbol++)
+		{
+			Count[Lengths[Symbol]]++;
+		}
+		Count[0] = 0;
+
+		const int32 RootSize = 1 << RootBits;
+		const uint32 Invalid = MakeEntry(0, 0, TypeInvalid);
+
+		int32 Max = MaxCodeBits;
+		while (Max >= 1 && Count[Max] == 0)
+		{
+			Max--;
+		}
+
+		//No codes at all, any use of this table is an error
+		if (Max == 0)
+		{
+			for (int32 Index = 0; Index < RootSize; Index++)
+			{
+				Table[Index] = Invalid;
+			}
+			return true;
+		}
+
+		int32 Left = 1;
+		for (int32 Len = 1; Len <= MaxCodeBits; Len++)
+		{
+			Left <<= 1;
+			Left -= Count[Len];
+			if (Left < 0)
+			{
+				return false;
+			}
+		}
+
+		if (Left > 0)
+		{
+			if (!bAllowSingleCode || Max != 1)
+			{
+				return false;
+			}
+			for (int32 Index = 0; Index < RootSize; Index++)
+			{
+				Table[Index] = Invalid;
+			}
+		}
+
+		uint16 Offsets[MaxCodeBits + 2];
+		Offsets[1] = 0;
+		for (int32 Len = 1; Len <= MaxCodeBits; Len++)
+		{
+			Offsets[Len + 1] = Offsets[Len] + Count[Len];
+		}
+
+		uint16 Sorted[NumLitLenSymbols];
+		for (int32 Symbol = 0; Symbol < NumSymbols; Symbol++)
+		{
+			if (Lengths[Symbol] != 0)
+			{
+				Sorted[Offsets[Lengths[Symbol]]++] = (uint16)Symbol;
+			}
+		}
+
+		int32 Len = 1;
+		while (Count[Len] == 0)
+		{
+			Len++;
+		}
+
+		const uint32 RootMask = RootSize - 1;
+		uint32* Next = Table;
+		uint32 Huff = 0;
+		int32 SortedIndex = 0;
+		int32 Current = RootBits;
+		int32 Drop = 0;
+		int32 CurrentSize = RootSize;
+		int32 Used = RootSize;
+		int64 Low = -1;
+
+		for (;;)
+		{
+			//Fill every slot whose low bits match this (bit reversed) codeword
+			const uint32 Here = SymbolEntries[Sorted[SortedIndex]] | (uint32)(Len - Drop);
+			const uint32 Increment = 1u << (Len - Drop);
+			uint32 Fill = 1u << Current;
+			CurrentSize = Fill;
+			do
+			{
+				Fill -= Increment;
+				Next[(Huff >> Drop) + Fill] = Here;
+			} while (Fill != 0);
+
+			//Bit reversed increment of the codeword
+			uint32 Bit = 1u << (Len - 1);
+			while (Huff & Bit)
+			{
+				Bit >>= 1;
+			}
+			Huff = (Bit != 0) ? (Huff & (Bit - 1)) + Bit : 0;
+
+			SortedIndex++;
+			if (--Count[Len] == 0)
+			{
+				if (Len == Max)
+				{
+					break;
+				}
+				Len = Lengths[Sorted[SortedIndex]];
+			}
+
+			//Longer than the root, start a new subtable when the root prefix changes
+			if (Len > RootBits && (int64)(Huff & RootMask) != Low)
+			{
+				if (Drop == 0)
+				{
+					Drop = RootBits;
+				}
+				Next += CurrentSize;
+
+				Current = Len - Drop;
+				int32 Remaining = 1 << Current;
+				while (Current + Drop < Max)
+				{
+					Remaining -= Count[Current + Drop];
+					if (Remaining <= 0)
+					{
+						break;
+					}
+					Current++;
+					Remaining <<= 1;
+				}
+
+				Used += 1 << Current;
+				if (Used > Capacity)
+				{
+					return false;
+				}
+
+				Low = Huff & RootMask;
+				Table[Low] = ((uint32)(Next - Table) << 16) | ((uint32)Current << 8) | (TypeSubtable << 5) | (uint32)RootBits;
+			}
+		}
+		return true;
+	}
+
+	struct FTables
+	{
+		uint32 LitLen[LitLenCapacity];
+		uint32 Dist[DistCapacity];
+		uint32 Precode[PrecodeCapacity];
+	};
+
+	struct FFixedTables : public FTables
+	{
+		FFixedTables()
+		{
+			uint8 Lengths[NumLitLenSymbols + NumDistSymbols];
+			for (int32 Symbol = 0; Symbol < NumLitLenSymbols; Symbol++)
+			{
+				Lengths[Symbol] = (Symbol < 144) ? 8 : (Symbol < 256) ? 9 : (Symbol < 280) ? 7 : 8;
+			}
+			for (int32 Symbol = 0; Symbol < NumDistSymbols; Symbol++)
+			{
+				Lengths[NumLitLenSymbols + Symbol] = 5;
+			}
+
+			const FSymbolEntries& Entries = GetSymbolEntries();
+			BuildTable(Lengths, NumLitLenSymbols, Entries.LitLen, LitLen, LitLenRootBits, LitLenCapacity, false);
+			BuildTable(Lengths + NumLitLenSymbols, NumDistSymbols, Entries.Dist, Dist, DistRootBits, DistCapacity, false);
+		}
+	};
+
+	const FTables& GetFixedTables()
+	{
+		static const FFixedTables Tables;
+		return Tables;
+	}
+
+	/** LSB-first bit reader over the whole input, keeps 56-63 valid bits after every refill. */
+	struct FBitReader
+	{
+		const uint8* Next;
+		const uint8* End;
+		uint64 Buffer;
+		uint32 Count;
+
+		// Zero bytes fed in past the end of the input, only valid if never consumed
+		uint32 Overrun;
+
+		FORCEINLINE void Refill()
+		{
+			if (End - Next >= 8)
+			{
+				uint64 Word;
+				FMemory::Memcpy(&Word, Next, sizeof(Word));
+#if !PLATFORM_LITTLE_ENDIAN
+				Word = BYTESWAP_ORDER64(Word);
+#endif
+				//Bits above Count already hold the same input bytes, so the OR is harmless
+				Buffer |= Word << Count;
+				Next += (63 - Count) >> 3;
+				Count |= 56;
+			}
+			else
+			{
+				while (Count <= 56)
+				{
+					if (Next < End)
+					{
+						Buffer |= (uint64)*Next++ << Count;
+					}
+					else
+					{
+						Overrun++;
+					}
+					Count += 8;
+				}
+			}
+		}
+
+		FORCEINLINE uint32 Peek(uint32 Bits) const
+		{
+			return (uint32)(Buffer & ((1ull << Bits) - 1));
+		}
+
+		FORCEINLINE void Consume(uint32 Bits)
+		{
+			Buffer >>= Bits;
+			Count -= Bits;
+		}
+
+		FORCEINLINE uint32 Take(uint32 Bits)
+		{
+			const uint32 Value = Peek(Bits);
+			Consume(Bits);
+			return Value;
+		}
+
+		bool IsOverrun() const
+		{
+			return Overrun * 8 > Count;
+		}
+	};
+
+	FORCEINLINE uint32 DecodeSymbol(FBitReader& Bits, const uint32* Table, uint32 RootMask)
+	{
+		uint32 Entry = Table[Bits.Buffer & RootMask];
+		if (EntryType(Entry) == TypeSubtable)
+		{
+			Bits.Consume(EntryBits(Entry));
+			Entry = Table[EntryValue(Entry) + Bits.Peek(EntryExtra(Entry))];
+		}
+		Bits.Consume(EntryBits(Entry));
+		return Entry;
+	}
+
+	FORCEINLINE void CopyMatch(uint8* Out, uint32 Length, uint32 Distance, const uint8* OutEnd)
+	{
+		const uint8* Source = Out - Distance;
+		uint8* const MatchEnd = Out + Length;
+
+		//Wide copies may run up to 15 bytes past the match, only take them with room to spare
+		if (OutEnd - MatchEnd >= 16)
+		{
+			if (Distance >= 16)
+			{
+				do
+				{
+					FMemory::Memcpy(Out, Source, 16);
+					Out += 16;
+					Source += 16;
+				} while (Out < MatchEnd);
+				return;
+			}
+			if (Distance >= 8)
+			{
+				do
+				{
+					FMemory::Memcpy(Out, Source, 8);
+					Out += 8;
+					Source += 8;
+				} while (Out < MatchEnd);
+				return;
+			}
+			if (Distance == 1)
+			{
+				const uint64 Pattern = 0x0101010101010101ull * Source[0];
+				do
+				{
+					FMemory::Memcpy(Out, &Pattern, 8);
+					Out += 8;
+				} while (Out < MatchEnd);
+				return;
+			}
+		}
+
+		while (Out < MatchEnd)
+		{
+			*Out++ = *Source++;
+		}
+	}
+
+	bool DecodeHuffmanBlock(FBitReader& Bits, const FTables& Tables, uint8* Dest, uint8*& Out, uint8* OutEnd)
+	{
+		const uint32 LitLenMask = (1u << LitLenRootBits) - 1;
+		const uint32 DistMask = (1u << DistRootBits) - 1;
+
+		for (;;)
+		{
+			//One refill covers the worst case symbol: 15 + 5 length bits, 15 + 13 distance bits
+			Bits.Refill();
+
+			const uint32 Entry = DecodeSymbol(Bits, Tables.LitLen, LitLenMask);
+			const uint32 Type = EntryType(Entry);
+
+			if (Type == TypeLiteral)
+			{
+				if (Out == OutEnd)
+				{
+					return false;
+				}
+				*Out++ = (uint8)EntryValue(Entry);
+				continue;
+			}
+			if (Type == TypeEndOfBlock)
+			{
+				return true;
+			}
+			if (Type != TypeMatch)
+			{
+				return false;
+			}
+
+			const uint32 Length = EntryValue(Entry) + Bits.Take(EntryExtra(Entry));
+
+			const uint32 DistEntry = DecodeSymbol(Bits, Tables.Dist, DistMask);
+			if (EntryType(DistEntry) != TypeMatch)
+			{
+				return false;
+			}
+			const uint32 Distance = EntryValue(DistEntry) + Bits.Take(EntryExtra(DistEntry));
+
+			if (Distance > (uint64)(Out - Dest) || Length > (uint64)(OutEnd - Out))
+			{
+				return false;
+			}
+
+			CopyMatch(Out, Length, Distance, OutEnd);
+			Out += Length;
+		}
+	}
+
+	bool ReadDynamicTables(FBitReader& Bits, FTables& Tables)
+	{
+		Bits.Refill();
+		const int32 NumLitLen = Bits.Take(5) + 257;
+		const int32 NumDist = Bits.Take(5) + 1;
+		const int32 NumPrecode = Bits.Take(4) + 4;
+
+		if (NumLitLen > 286 || NumDist > 30)
+		{
+			return false;
+		}
+
+		const FSymbolEntries& Entries = GetSymbolEntries();
+
+		uint8 PrecodeLengths[NumPrecodeSymbols] = { 0 };
+		for (int32 Index = 0; Index < NumPrecode; Index++)
+		{
+			Bits.Refill();
+			PrecodeLengths[PrecodeOrder[Index]] = (uint8)Bits.Take(3);
+		}
+
+		if (!BuildTable(PrecodeLengths, NumPrecodeSymbols, Entries.Precode, Tables.Precode, PrecodeRootBits, PrecodeCapacity, false))
+		{
+			return false;
+		}
+
+		uint8 Lengths[NumLitLenSymbols + NumDistSymbols];
+		const int32 Total = NumLitLen + NumDist;
+		int32 Index = 0;
+
+		while (Index < Total)
+		{
+			Bits.Refill();
+
+			const uint32 Entry = Tables.Precode[Bits.Peek(PrecodeRootBits)];
+			if (EntryType(Entry) != TypeLiteral)
+			{
+				return false;
+			}
+			Bits.Consume(EntryBits(Entry));
+
+			const uint32 Symbol = EntryValue(Entry);
+			if (Symbol < 16)
+			{
+				Lengths[Index++] = (uint8)Symbol;
+				continue;
+			}
+
+			uint8 Value = 0;
+			int32 Repeat = 0;
+			if (Symbol == 16)
+			{
+				if (Index == 0)
+				{
+					return false;
+				}
+				Value = Lengths[Index - 1];
+				Repeat = 3 + Bits.Take(2);
+			}
+			else if (Symbol == 17)
+			{
+				Repeat = 3 + Bits.Take(3);
+			}
+			else
+			{
+				Repeat = 11 + Bits.Take(7);
+			}
+
+			if (Index + Repeat > Total)
+			{
+				return false;
+			}
+			while (Repeat-- > 0)
+			{
+				Lengths[Index++] = Value;
+			}
+		}
+
+		//A block without an end of block code can never finish
+		if (Lengths[256] == 0)
+		{
+			return false;
+		}
+
+		return BuildTable(Lengths, NumLitLen, Entries.LitLen, Tables.LitLen, LitLenRootBits, LitLenCapacity, true) &&
+			BuildTable(Lengths + NumLitLen, NumDist, Entries.Dist, Tables.Dist, DistRootBits, DistCapacity, true);
+	}
+
+	bool CopyStoredBlock(FBitReader& Bits, uint8*& Out, uint8* OutEnd)
+	{
+		//Stored data starts on the next byte boundary
+		Bits.Consume(Bits.Count & 7);
+		Bits.Refill();
+
+		const uint32 Length = Bits.Take(16);
+		const uint32 InvertedLength = Bits.Take(16);
+		if (Length != (~InvertedLength & 0xFFFF))
+		{
+			return false;
+		}
+
+		//Give back the whole bytes still sitting in the bit buffer
+		const uint32 Buffered = Bits.Count >> 3;
+		if (Bits.Overrun > Buffered)
+		{
+			return false;
+		}
+		Bits.Next -= Buffered - Bits.Overrun;
+		Bits.Buffer = 0;
+		Bits.Count = 0;
+		Bits.Overrun = 0;
+
+		if (Bits.End - Bits.Next < (int64)Length || OutEnd - Out < (int64)Length)
+		{
+			return false;
+		}
+
+		FMemory::Memcpy(Out, Bits.Next, Length);
+		Bits.Next += Length;
+		Out += Length;
+		return true;
+	}
+}
+
+bool ZUInflate::Decompress(const uint8* Source, int64 SourceSize, uint8* Dest, int64 DestSize)
+{
+	FBitReader Bits;
+	Bits.Next = Source;
+	Bits.End = Source + SourceSize;
+	Bits.Buffer = 0;
+	Bits.Count = 0;
+	Bits.Overrun = 0;
+
+	uint8* Out = Dest;
+	uint8* const OutEnd = Dest + DestSize;
+
+	//Heap allocated, the extraction pool threads only have small stacks
+	TUniquePtr<FTables> DynamicTables;
+
+	bool bFinalBlock = false;
+	while (!bFinalBlock)
+	{
+		Bits.Refill();
+		bFinalBlock = Bits.Take(1) != 0;
+		const uint32 BlockType = Bits.Take(2);
+
+		bool bSuccess = false;
+		switch (BlockType)
+		{
+		case 0:
+			bSuccess = CopyStoredBlock(Bits, Out, OutEnd);
+			break;
+		case 1:
+			bSuccess = DecodeHuffmanBlock(Bits, GetFixedTables(), Dest, Out, OutEnd);
+			break;
+		case 2:
+			if (!DynamicTables.IsValid())
+			{
+				DynamicTables = MakeUnique<FTables>();
+			}
+			bSuccess = ReadDynamicTables(Bits, *DynamicTables) && DecodeHuffmanBlock(Bits, *DynamicTables, Dest, Out, OutEnd);
+			break;
+		default:
+			break;
+		}
+
+		if (!bSuccess || Bits.IsOverrun())
+		{
+			return false;
+		}
+	}
+	return Out == OutEnd;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Whole-buffer raw deflate decoder for zip entries whose sizes are known up front.
+ * Uses a 64-bit bit buffer refilled with unaligned 8 byte loads, 10/8 bit root lookup tables
+ * with subtables (about 10KB, stays in L1) and 16 byte wide match copies away from the buffer end.
+ */
+class ZUInflate
+{
+public:
+	// Decodes a complete raw deflate stream. Fails unless it ends exactly at DestSize bytes of output.
+	static bool Decompress(const uint8* Source, int64 SourceSize, uint8* Dest, int64 DestSize);
+};
@@ -20,7 +20,7 @@ void UZULambdaDelegate::SetOnProgessCallback(TFunction<void(float)> InOnProgress
 	OnProgressCallback = InOnProgressCallback;
 }
 
-void UZULambdaDelegate::OnProgress_Implementation(const FString& archive, float percentage, int32 bytes)
+void UZULambdaDelegate::OnProgress_Implementation(const FString& archive, float percentage, int64 bytes)
 {
 	if (OnProgressCallback != nullptr)
 	{
@@ -36,7 +36,7 @@ void UZULambdaDelegate::OnDone_Implementation(const FString& archive, EZipUtilit
 	}
 }
 
-void UZULambdaDelegate::OnStartProcess_Implementation(const FString& archive, int32 bytes)
+void UZULambdaDelegate::OnStartProcess_Implementation(const FString& archive, int64 bytes)
 {
 
 }
@@ -46,7 +46,7 @@ void UZULambdaDelegate::OnFileDone_Implementation(const FString& archive, const
 
 }
 
-void UZULambdaDelegate::OnFileFound_Implementation(const FString& archive, const FString& file, int32 size)
+void UZULambdaDelegate::OnFileFound_Implementation(const FString& archive, const FString& file, int64 size)
 {
 
 }
@@ -16,11 +16,11 @@ public:
 
 protected:
 	//Zip utility interface
-	virtual void OnProgress_Implementation(const FString& archive, float percentage, int32 bytes) override;
+	virtual void OnProgress_Implementation(const FString& archive, float percentage, int64 bytes) override;
 	virtual void OnDone_Implementation(const FString& archive, EZipUtilityCompletionState CompletionState) override;
-	virtual void OnStartProcess_Implementation(const FString& archive, int32 bytes) override;
+	virtual void OnStartProcess_Implementation(const FString& archive, int64 bytes) override;
 	virtual void OnFileDone_Implementation(const FString& archive, const FString& file) override;
-	virtual void OnFileFound_Implementation(const FString& archive, const FString& file, int32 size) override;
+	virtual void OnFileFound_Implementation(const FString& archive, const FString& file, int64 size) override;
 
 	TFunction<void()> OnDoneCallback;
 	TFunction<void(float)> OnProgressCallback;
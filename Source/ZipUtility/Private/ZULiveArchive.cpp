@@ -0,0 +1,473 @@
+#include "ZULiveArchive.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUZipCompressor.h"
+#include "ZUZipReader.h"
+#include "ZUZipWriter.h"
+#include "WFUDirectoryWalker.h"
+#include "WFUWatchService.h"
+#include "WFULambdaRunnable.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/Event.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <stdio.h>
+#endif
+
+namespace
+{
+	//Swaps the finished archive in with a single rename, readers never see a partial file
+	bool ReplaceFile(const FString& From, const FString& To)
+	{
+#if PLATFORM_WINDOWS
+		return MoveFileExW(*From, *To, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return rename(TCHAR_TO_UTF8(*From), TCHAR_TO_UTF8(*To)) == 0;
+#endif
+	}
+
+	//Entry names of directories end in a slash, dirty paths don't
+	FString TrimDirectorySlash(const FString& Name)
+	{
+		FString Trimmed = Name.Replace(TEXT("\\"), TEXT("/"));
+		Trimmed.RemoveFromEnd(TEXT("/"));
+		return Trimmed;
+	}
+}
+
+ZULiveArchive::ZULiveArchive(const FString& InFolder, const FString& InArchivePath)
+{
+	Folder = InFolder.Replace(TEXT("\\"), TEXT("/"));
+	Folder.RemoveFromEnd(TEXT("/"));
+	ArchivePath = InArchivePath.Replace(TEXT("\\"), TEXT("/"));
+	TempPath = ArchivePath + TEXT(".tmp");
+	EntryPrefix = FPaths::GetCleanFilename(Folder);
+
+	FlushInterval = 10.f;
+	FlushThreshold = 0;
+	WakeUp = FPlatformProcess::GetSynchEventFromPool(false);
+	DirtyBytes = 0;
+	bNeedsFullRebuild = false;
+	bFlushRequested = false;
+	bStopping = false;
+	LastFlushTime = 0.0;
+	WatchHandle = INDEX_NONE;
+}
+
+ZULiveArchive::~ZULiveArchive()
+{
+	Stop();
+	FPlatformProcess::ReturnSynchEventToPool(WakeUp);
+}
+
+void ZULiveArchive::SetFlushInterval(float Seconds)
+{
+	FScopeLock ScopeLock(&Lock);
+	FlushInterval = FMath::Max(Seconds, 0.f);
+}
+
+void ZULiveArchive::SetFlushThreshold(int64 Bytes)
+{
+	FScopeLock ScopeLock(&Lock);
+	FlushThreshold = FMath::Max<int64>(Bytes, 0);
+}
+
+bool ZULiveArchive::Start()
+{
+	if (!FPlatformFileManager::Get().GetPlatformFile().DirectoryExists(*Folder))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Live archive source %s is not a folder"), *Folder);
+		return false;
+	}
+
+	//Watching first means nothing that changes while the archive is checked gets lost
+	WatchHandle = WFUWatchService::Get().AddWatch(Folder, [this](const TArray<FWFUFolderChange>& Changes)
+	{
+		OnChanges(Changes);
+	});
+
+	Thread = WFULambdaRunnable::RunLambdaOnBackGroundThread([this]
+	{
+		Run();
+	});
+	return true;
+}
+
+void ZULiveArchive::Stop()
+{
+	if (WatchHandle == INDEX_NONE)
+	{
+		return;
+	}
+
+	WFUWatchService::Get().RemoveWatch(WatchHandle);
+	WatchHandle = INDEX_NONE;
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		bStopping = true;
+	}
+	WakeUp->Trigger();
+	Thread.Wait();
+}
+
+void ZULiveArchive::RequestFlush()
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		bFlushRequested = true;
+	}
+	WakeUp->Trigger();
+}
+
+void ZULiveArchive::OnChanges(const TArray<FWFUFolderChange>& Changes)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		for (const FWFUFolderChange& Change : Changes)
+		{
+			if (IsIgnored(Change.RelativePath))
+			{
+				continue;
+			}
+
+			//Anything but an edit can take a whole folder's contents with it
+			if (Change.Type == EWFUFolderChangeType::Modified)
+			{
+				DirtyPaths.Add(Change.RelativePath);
+			}
+			else
+			{
+				DirtyTrees.Add(Change.RelativePath);
+			}
+			if (!Change.OldRelativePath.IsEmpty())
+			{
+				DirtyTrees.Add(Change.OldRelativePath);
+			}
+
+			if (!Change.bIsDirectory && Change.Type != EWFUFolderChangeType::Deleted)
+			{
+				DirtyBytes += FMath::Max<int64>(PlatformFile.FileSize(*(Folder / Change.RelativePath)), 0);
+			}
+		}
+	}
+
+	//The worker picks the next flush time, or flushes right away past the threshold
+	WakeUp->Trigger();
+}
+
+void ZULiveArchive::Run()
+{
+	Reconcile();
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		LastFlushTime = FPlatformTime::Seconds();
+		bFlushRequested |= bNeedsFullRebuild || DirtyPaths.Num() > 0 || DirtyTrees.Num() > 0;
+	}
+
+	while (true)
+	{
+		TSet<FString> Paths;
+		TSet<FString> Trees;
+		bool bFullRebuild = false;
+		uint32 WaitMilliseconds = MAX_uint32;
+
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (bStopping)
+			{
+				return;
+			}
+
+			const bool bPending = bNeedsFullRebuild || DirtyPaths.Num() > 0 || DirtyTrees.Num() > 0;
+			const double DueTime = LastFlushTime + FlushInterval;
+			const double Now = FPlatformTime::Seconds();
+
+			if (bPending && (bFlushRequested || (FlushThreshold > 0 && DirtyBytes >= FlushThreshold) || Now >= DueTime))
+			{
+				Swap(Paths, DirtyPaths);
+				Swap(Trees, DirtyTrees);
+				bFullRebuild = bNeedsFullRebuild;
+				bNeedsFullRebuild = false;
+				bFlushRequested = false;
+				DirtyBytes = 0;
+				WaitMilliseconds = 0;
+			}
+			else if (bPending)
+			{
+				WaitMilliseconds = (uint32)FMath::CeilToInt((DueTime - Now) * 1000.0);
+			}
+			else
+			{
+				bFlushRequested = false;
+			}
+		}
+
+		if (WaitMilliseconds > 0)
+		{
+			WakeUp->Wait(WaitMilliseconds);
+			continue;
+		}
+
+		const bool bFlushed = Flush(Paths, Trees, bFullRebuild);
+
+		FScopeLock ScopeLock(&Lock);
+		LastFlushTime = FPlatformTime::Seconds();
+		if (!bFlushed)
+		{
+			//Whatever changed since is already back in the sets, merge the rest in for the next try
+			DirtyPaths.Append(Paths);
+			DirtyTrees.Append(Trees);
+			bNeedsFullRebuild |= bFullRebuild;
+		}
+	}
+}
+
+void ZULiveArchive::Reconcile()
+{
+	ZUZipReader Reader;
+	if (!Reader.Open(ArchivePath) || !Reader.IsSupported())
+	{
+		FScopeLock ScopeLock(&Lock);
+		bNeedsFullRebuild = true;
+		return;
+	}
+
+	//Size and time as the archive has them, keyed by path relative to the folder
+	TMap<FString, TPair<uint64, uint32>> Archived;
+	for (const FZUZipEntry& Entry : Reader.GetEntries())
+	{
+		const FString Name = TrimDirectorySlash(Entry.GetName());
+		if (Name.StartsWith(EntryPrefix + TEXT("/")))
+		{
+			Archived.Add(Name.RightChop(EntryPrefix.Len() + 1), TPair<uint64, uint32>(Entry.UncompressedSize, Entry.DosTime));
+		}
+	}
+	Reader.Close();
+
+	TSet<FString> Paths;
+	WFUDirectoryWalker Walker;
+	if (Walker.Start(Folder))
+	{
+		TArray<FWFUDirectoryEntry> Batch;
+		while (Walker.NextBatch(Batch))
+		{
+			for (const FWFUDirectoryEntry& Entry : Batch)
+			{
+				if (IsIgnored(Entry.RelativePath))
+				{
+					continue;
+				}
+
+				const TPair<uint64, uint32>* Known = Archived.Find(Entry.RelativePath);
+				if (Known == nullptr || (!Entry.bIsDirectory && (Known->Key != (uint64)Entry.Size || Known->Value != ZUZipWriter::ToDosTime(Entry.ModifiedTime))))
+				{
+					Paths.Add(Entry.RelativePath);
+				}
+				Archived.Remove(Entry.RelativePath);
+			}
+		}
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	DirtyPaths.Append(Paths);
+
+	//Left over entries are gone from disk
+	for (const TPair<FString, TPair<uint64, uint32>>& Gone : Archived)
+	{
+		DirtyTrees.Add(Gone.Key);
+	}
+}
+
+bool ZULiveArchive::Flush(const TSet<FString>& Paths, const TSet<FString>& Trees, bool bFullRebuild)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	ZUZipReader Reader;
+	const bool bCopyFromOld = !bFullRebuild && Reader.Open(ArchivePath) && Reader.IsSupported();
+	if (!bFullRebuild && !bCopyFromOld)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Can't read %s, rebuilding it from %s"), *ArchivePath, *Folder);
+	}
+
+	ZUZipCompressor Compressor(TempPath);
+	if (!Compressor.OpenArchive())
+	{
+		return false;
+	}
+
+	auto IsDirty = [&Paths, &Trees](const FString& RelativePath)
+	{
+		if (Paths.Contains(RelativePath))
+		{
+			return true;
+		}
+
+		//The path itself or any folder above it
+		FString Ancestor = RelativePath;
+		while (true)
+		{
+			if (Trees.Contains(Ancestor))
+			{
+				return true;
+			}
+			int32 SlashIndex;
+			if (!Ancestor.FindLastChar(TEXT('/'), SlashIndex))
+			{
+				return false;
+			}
+			Ancestor.LeftInline(SlashIndex);
+		}
+	};
+
+	TSet<FString> Written;
+	int32 NumCopied = 0;
+	bool bSuccess = AddFromDisk(Compressor, FString(), !bCopyFromOld, Written);
+
+	if (bCopyFromOld)
+	{
+		//Everything untouched goes over as is, in its old order
+		const TArray<FZUZipEntry>& Entries = Reader.GetEntries();
+		for (int32 Index = 0; bSuccess && Index < Entries.Num(); Index++)
+		{
+			const FString Name = TrimDirectorySlash(Entries[Index].GetName());
+			if (!Name.StartsWith(EntryPrefix + TEXT("/")))
+			{
+				continue;
+			}
+
+			const FString RelativePath = Name.RightChop(EntryPrefix.Len() + 1);
+			if (Written.Contains(RelativePath) || IsDirty(RelativePath))
+			{
+				continue;
+			}
+
+			bSuccess = !ShouldStop() && Compressor.CopyEntry(Reader, Index);
+			Written.Add(RelativePath);
+			NumCopied++;
+		}
+
+		for (const FString& Path : Paths)
+		{
+			bSuccess = bSuccess && AddFromDisk(Compressor, Path, false, Written);
+		}
+		for (const FString& Tree : Trees)
+		{
+			bSuccess = bSuccess && AddFromDisk(Compressor, Tree, true, Written);
+		}
+	}
+	Reader.Close();
+
+	if (!bSuccess)
+	{
+		Compressor.AbortArchive();
+		return false;
+	}
+	if (!Compressor.CloseArchive())
+	{
+		return false;
+	}
+
+	if (!ReplaceFile(TempPath, ArchivePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Couldn't replace %s, keeping its changes for the next flush"), *ArchivePath);
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*TempPath);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("ZipUtility: Updated %s, %d entries copied, %d from disk in %.2fs"),
+		*ArchivePath, NumCopied, Written.Num() - NumCopied, FPlatformTime::Seconds() - StartTime);
+	return true;
+}
+
+bool ZULiveArchive::AddFromDisk(ZUZipCompressor& Compressor, const FString& RelativePath, bool bWithContents, TSet<FString>& Written)
+{
+	if (Written.Contains(RelativePath) || IsIgnored(RelativePath))
+	{
+		return true;
+	}
+
+	const FString FullPath = RelativePath.IsEmpty() ? Folder : Folder / RelativePath;
+	const FFileStatData StatData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*FullPath);
+	if (!StatData.bIsValid)
+	{
+		//Deleted, the entry simply isn't carried over
+		return true;
+	}
+
+	FZUSourceFile File;
+	File.Path = FullPath;
+	File.EntryName = RelativePath.IsEmpty() ? EntryPrefix : EntryPrefix / RelativePath;
+	File.Size = StatData.bIsDirectory ? 0 : StatData.FileSize;
+	File.ModifiedTime = StatData.ModificationTime;
+	File.bIsDirectory = StatData.bIsDirectory;
+
+	Written.Add(RelativePath);
+	if (!Compressor.AddSourceFile(File))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to add %s to %s"), *FullPath, *ArchivePath);
+		return false;
+	}
+	if (!StatData.bIsDirectory || !bWithContents)
+	{
+		return true;
+	}
+
+	WFUDirectoryWalker Walker;
+	if (!Walker.Start(FullPath))
+	{
+		return true;
+	}
+
+	TArray<FWFUDirectoryEntry> Batch;
+	while (Walker.NextBatch(Batch))
+	{
+		for (FWFUDirectoryEntry& Entry : Batch)
+		{
+			const FString EntryPath = RelativePath.IsEmpty() ? Entry.RelativePath : RelativePath / Entry.RelativePath;
+			if (ShouldStop())
+			{
+				Walker.Cancel();
+				return false;
+			}
+			if (Written.Contains(EntryPath) || IsIgnored(EntryPath))
+			{
+				continue;
+			}
+
+			File.Path = MoveTemp(Entry.Path);
+			File.EntryName = EntryPrefix / EntryPath;
+			File.Size = Entry.Size;
+			File.ModifiedTime = Entry.ModifiedTime;
+			File.bIsDirectory = Entry.bIsDirectory;
+
+			Written.Add(EntryPath);
+			if (!Compressor.AddSourceFile(File))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to add %s to %s"), *File.Path, *ArchivePath);
+				Walker.Cancel();
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool ZULiveArchive::IsIgnored(const FString& RelativePath) const
+{
+	//The archive may live inside the folder it mirrors
+	const FString FullPath = Folder / RelativePath;
+	return FullPath == ArchivePath || FullPath == TempPath;
+}
+
+bool ZULiveArchive::ShouldStop() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return bStopping;
+}
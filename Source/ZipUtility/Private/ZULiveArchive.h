@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "WFUFolderWatchInterface.h"
+
+class FEvent;
+class ZUZipCompressor;
+
+/**
+ * Keeps a .zip mirror of a folder up to date. Changes reported by the folder watch are collected as
+ * dirty paths, and each rewrite copies every untouched entry over still compressed, so only what
+ * changed is read from disk and compressed again.
+ *
+ * The new archive is written next to the old one and moved over it in one step. Readers see either
+ * the previous or the next version, never a half written one. A rewrite that fails keeps its paths
+ * dirty and is retried on the next flush.
+ */
+class ZULiveArchive
+{
+public:
+	ZULiveArchive(const FString& InFolder, const FString& InArchivePath);
+
+	//Stops following the folder, a rewrite in progress is abandoned
+	~ZULiveArchive();
+
+	//Seconds between rewrites while changes are pending
+	void SetFlushInterval(float Seconds);
+
+	//Rewrites as soon as this many bytes of changed files are pending, 0 only goes by the interval
+	void SetFlushThreshold(int64 Bytes);
+
+	//Brings the archive in line with the folder on a background thread and keeps following it from there
+	bool Start();
+	void Stop();
+
+	//Writes out pending changes without waiting for the interval
+	void RequestFlush();
+
+private:
+	void Run();
+	void OnChanges(const TArray<FWFUFolderChange>& Changes);
+
+	//Marks whatever differs between the existing archive and the folder, or asks for a full rebuild
+	void Reconcile();
+
+	bool Flush(const TSet<FString>& DirtyPaths, const TSet<FString>& DirtyTrees, bool bFullRebuild);
+
+	//Adds RelativePath from disk, with everything below it when bWithContents is set
+	bool AddFromDisk(ZUZipCompressor& Compressor, const FString& RelativePath, bool bWithContents, TSet<FString>& Written);
+
+	bool IsIgnored(const FString& RelativePath) const;
+	bool ShouldStop() const;
+
+	FString Folder;
+	FString ArchivePath;
+	FString TempPath;
+
+	//Entries live under the folder's own name, the same layout Zip() produces
+	FString EntryPrefix;
+
+	float FlushInterval;
+	int64 FlushThreshold;
+
+	mutable FCriticalSection Lock;
+	FEvent* WakeUp;
+
+	//Changed paths relative to Folder. Trees also cover everything below them, e.g. created, moved or deleted folders
+	TSet<FString> DirtyPaths;
+	TSet<FString> DirtyTrees;
+	int64 DirtyBytes;
+	bool bNeedsFullRebuild;
+	bool bFlushRequested;
+	bool bStopping;
+	double LastFlushTime;
+
+	int32 WatchHandle;
+	TFuture<void> Thread;
+};
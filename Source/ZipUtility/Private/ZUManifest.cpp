@@ -0,0 +1,310 @@
+#include "ZUManifest.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUHash.h"
+#include "WFUDirectoryWalker.h"
+#include "Misc/FileHelper.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	const uint8 ManifestMagic[4] = { 'Z', 'U', 'M', 'F' };
+	const uint8 ManifestVersion = 1;
+
+	//Files gathered from the walk before a hashing pass is started on them
+	const int32 MinFilesPerPass = 256;
+
+	void WriteVarInt(TArray<uint8>& Out, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add((uint8)Value);
+	}
+
+	bool ReadVarInt(const TArray<uint8>& Data, int64& Offset, uint64& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 64; Shift += 7)
+		{
+			if (Offset >= Data.Num())
+			{
+				return false;
+			}
+			const uint8 Byte = Data[Offset++];
+			OutValue |= (uint64)(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//Reads a count that has to fit in what's left of the file, which also keeps corrupt counts from allocating
+	bool ReadLength(const TArray<uint8>& Data, int64& Offset, int64& OutLength)
+	{
+		uint64 Value;
+		if (!ReadVarInt(Data, Offset, Value) || Value > (uint64)(Data.Num() - Offset))
+		{
+			return false;
+		}
+		OutLength = (int64)Value;
+		return true;
+	}
+}
+
+void ZUManifest::Reset()
+{
+	Entries.Reset();
+}
+
+void ZUManifest::Reserve(int32 Number)
+{
+	Entries.Reserve(Number);
+}
+
+void ZUManifest::Add(FZUManifestEntry&& Entry)
+{
+	Entries.Add(MoveTemp(Entry));
+}
+
+void ZUManifest::Sort()
+{
+	Entries.Sort([](const FZUManifestEntry& A, const FZUManifestEntry& B)
+	{
+		return IsPathLess(A.Path, B.Path);
+	});
+}
+
+bool ZUManifest::IsPathLess(const FString& A, const FString& B)
+{
+	return FCString::Strcmp(*A, *B) < 0;
+}
+
+bool ZUManifest::Save(const FString& ManifestPath) const
+{
+	TArray<uint8> Data;
+	Data.Append(ManifestMagic, sizeof(ManifestMagic));
+	Data.Add(ManifestVersion);
+	WriteVarInt(Data, Entries.Num());
+
+	TArray<uint8> PreviousPath;
+	for (const FZUManifestEntry& Entry : Entries)
+	{
+		FTCHARToUTF8 Converter(*Entry.Path);
+		const uint8* Path = (const uint8*)Converter.Get();
+		const int32 PathLength = Converter.Length();
+
+		//Sorted paths share long prefixes, only the rest is stored
+		int32 Shared = 0;
+		const int32 MaxShared = FMath::Min(PathLength, PreviousPath.Num());
+		while (Shared < MaxShared && Path[Shared] == PreviousPath[Shared])
+		{
+			Shared++;
+		}
+
+		WriteVarInt(Data, Shared);
+		WriteVarInt(Data, PathLength - Shared);
+		Data.Append(Path + Shared, PathLength - Shared);
+		WriteVarInt(Data, (uint64)Entry.Size);
+		WriteVarInt(Data, (uint64)Entry.ModifiedTime.GetTicks());
+		for (int32 Byte = 0; Byte < 8; Byte++)
+		{
+			Data.Add((uint8)(Entry.Hash >> (Byte * 8)));
+		}
+
+		PreviousPath.Reset();
+		PreviousPath.Append(Path, PathLength);
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Data, *ManifestPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to write manifest %s"), *ManifestPath);
+		return false;
+	}
+	return true;
+}
+
+bool ZUManifest::Load(const FString& ManifestPath)
+{
+	Reset();
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *ManifestPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to read manifest %s"), *ManifestPath);
+		return false;
+	}
+
+	if (Data.Num() < 5 || FMemory::Memcmp(Data.GetData(), ManifestMagic, sizeof(ManifestMagic)) != 0 || Data[4] != ManifestVersion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is not a manifest this version can read"), *ManifestPath);
+		return false;
+	}
+
+	int64 Offset = 5;
+	int64 Count;
+	if (!ReadLength(Data, Offset, Count))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Manifest %s is corrupt"), *ManifestPath);
+		return false;
+	}
+	Entries.Reserve(Count);
+
+	TArray<uint8> Path;
+	bool bSorted = true;
+	for (int64 Index = 0; Index < Count; Index++)
+	{
+		int64 Shared;
+		int64 SuffixLength;
+		uint64 Size;
+		uint64 Ticks;
+		if (!ReadLength(Data, Offset, Shared) || Shared > Path.Num() || !ReadLength(Data, Offset, SuffixLength))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Manifest %s is corrupt"), *ManifestPath);
+			Reset();
+			return false;
+		}
+
+		Path.SetNum(Shared, false);
+		Path.Append(Data.GetData() + Offset, SuffixLength);
+		Offset += SuffixLength;
+
+		if (!ReadVarInt(Data, Offset, Size) || !ReadVarInt(Data, Offset, Ticks) || Offset + 8 > Data.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Manifest %s is corrupt"), *ManifestPath);
+			Reset();
+			return false;
+		}
+
+		FZUManifestEntry& Entry = Entries[Entries.AddDefaulted()];
+		FUTF8ToTCHAR Converter((const ANSICHAR*)Path.GetData(), Path.Num());
+		Entry.Path = FString(Converter.Length(), Converter.Get());
+		Entry.Size = (int64)Size;
+		Entry.ModifiedTime = FDateTime((int64)Ticks);
+		for (int32 Byte = 0; Byte < 8; Byte++)
+		{
+			Entry.Hash |= (uint64)Data[Offset + Byte] << (Byte * 8);
+		}
+		Offset += 8;
+
+		bSorted &= Entries.Num() < 2 || !IsPathLess(Entry.Path, Entries[Entries.Num() - 2].Path);
+	}
+
+	//Written by something else, the diff still needs path order
+	if (!bSorted)
+	{
+		Sort();
+	}
+	return true;
+}
+
+bool ZUManifest::BuildFromFolder(const FString& Folder, TFunctionRef<bool(const FZUManifestEntry& Entry)> OnFileHashed)
+{
+	Reset();
+
+	WFUDirectoryWalker Walker;
+	if (!Walker.Start(Folder))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is not a folder, no manifest built"), *Folder);
+		return false;
+	}
+
+	bool bSuccess = true;
+	bool bCancelled = false;
+	bool bWalking = true;
+	TArray<FWFUDirectoryEntry> Batch;
+	TArray<FWFUDirectoryEntry> Files;
+	TArray<FZUManifestEntry> Hashed;
+	TArray<bool> Read;
+
+	while (bWalking && !bCancelled)
+	{
+		bWalking = Walker.NextBatch(Batch);
+		for (FWFUDirectoryEntry& Entry : Batch)
+		{
+			if (!Entry.bIsDirectory)
+			{
+				Files.Add(MoveTemp(Entry));
+			}
+		}
+
+		//The walk keeps going on its own workers while a pass hashes what it found so far
+		if (Files.Num() == 0 || (bWalking && Files.Num() < MinFilesPerPass))
+		{
+			continue;
+		}
+
+		Hashed.SetNum(Files.Num());
+		Read.SetNumZeroed(Files.Num());
+		ParallelFor(Files.Num(), [&Files, &Hashed, &Read](int32 Index)
+		{
+			FZUManifestEntry& Entry = Hashed[Index];
+			Entry.Path = MoveTemp(Files[Index].RelativePath);
+			Entry.Size = Files[Index].Size;
+			Entry.ModifiedTime = Files[Index].ModifiedTime;
+			Read[Index] = ZUHash::HashFile(Files[Index].Path, Entry.Hash);
+		});
+
+		for (int32 Index = 0; Index < Hashed.Num() && !bCancelled; Index++)
+		{
+			if (!Read[Index])
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to read %s for the manifest"), *Files[Index].Path);
+				bSuccess = false;
+				continue;
+			}
+
+			bCancelled = !OnFileHashed(Hashed[Index]);
+			Entries.Add(MoveTemp(Hashed[Index]));
+		}
+		Files.Reset();
+	}
+
+	if (bCancelled)
+	{
+		Walker.Cancel();
+	}
+	if (Walker.HadErrors())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Some folders in %s couldn't be listed, the manifest is incomplete"), *Folder);
+		bSuccess = false;
+	}
+
+	Sort();
+	return bSuccess && !bCancelled;
+}
+
+FZUManifestDiff ZUManifest::Diff(const ZUManifest& Old, const ZUManifest& New)
+{
+	FZUManifestDiff Result;
+	const TArray<FZUManifestEntry>& OldEntries = Old.Entries;
+	const TArray<FZUManifestEntry>& NewEntries = New.Entries;
+
+	//Both sides are in path order, one step through each
+	int32 OldIndex = 0;
+	int32 NewIndex = 0;
+	while (OldIndex < OldEntries.Num() || NewIndex < NewEntries.Num())
+	{
+		if (NewIndex >= NewEntries.Num() || (OldIndex < OldEntries.Num() && IsPathLess(OldEntries[OldIndex].Path, NewEntries[NewIndex].Path)))
+		{
+			Result.Removed.Add(OldEntries[OldIndex++].Path);
+		}
+		else if (OldIndex >= OldEntries.Num() || IsPathLess(NewEntries[NewIndex].Path, OldEntries[OldIndex].Path))
+		{
+			Result.Added.Add(NewEntries[NewIndex++].Path);
+		}
+		else
+		{
+			const FZUManifestEntry& OldEntry = OldEntries[OldIndex++];
+			const FZUManifestEntry& NewEntry = NewEntries[NewIndex++];
+			if (OldEntry.Size != NewEntry.Size || OldEntry.Hash != NewEntry.Hash)
+			{
+				Result.Changed.Add(NewEntry.Path);
+			}
+		}
+	}
+	return Result;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FZUManifestEntry
+{
+	//Relative to the folder or archive root, '/' separated
+	FString Path;
+
+	int64 Size = 0;
+	FDateTime ModifiedTime;
+
+	//ZUHash of the content
+	uint64 Hash = 0;
+};
+
+/** Paths that differ between two manifests, each list in path order. */
+struct FZUManifestDiff
+{
+	TArray<FString> Added;
+	TArray<FString> Removed;
+
+	//Same path, different size or content. Modification times alone don't count
+	TArray<FString> Changed;
+
+	bool IsEmpty() const
+	{
+		return Added.Num() == 0 && Removed.Num() == 0 && Changed.Num() == 0;
+	}
+};
+
+/**
+ * Path, size, modification time and content hash of every file in a folder or archive. Entries are
+ * kept sorted by path, so two manifests are compared in a single merge pass.
+ *
+ * The file format is a small header followed by the entries in path order. Each path only stores what
+ * differs from the one before it, and numbers are variable length, so a manifest of a large tree stays
+ * a fraction of the size of a plain listing.
+ */
+class ZUManifest
+{
+public:
+	void Reset();
+	void Reserve(int32 Number);
+
+	// Entries can come in any order, Sort before using the manifest
+	void Add(FZUManifestEntry&& Entry);
+	void Sort();
+
+	const TArray<FZUManifestEntry>& GetEntries() const { return Entries; }
+	int32 Num() const { return Entries.Num(); }
+
+	bool Save(const FString& ManifestPath) const;
+	bool Load(const FString& ManifestPath);
+
+	/**
+	 * Hashes every file below Folder. Walking and hashing overlap, and files are hashed on task graph
+	 * workers. OnFileHashed is called on the calling thread for each entry, returning false cancels.
+	 */
+	bool BuildFromFolder(const FString& Folder, TFunctionRef<bool(const FZUManifestEntry& Entry)> OnFileHashed);
+
+	static FZUManifestDiff Diff(const ZUManifest& Old, const ZUManifest& New);
+
+	// The order entries are kept in, case sensitive on every platform so manifests compare the same anywhere
+	static bool IsPathLess(const FString& A, const FString& B);
+
+private:
+	TArray<FZUManifestEntry> Entries;
+};
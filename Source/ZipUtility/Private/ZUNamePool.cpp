@@ -0,0 +1,61 @@
+#include "ZUNamePool.h"
+#include "ZipUtilityPrivatePCH.h"
+
+ZUNamePool::ZUNamePool(int32 InBlockSize)
+	: BlockSize(InBlockSize)
+	, BlockUsed(0)
+	, BlockCapacity(0)
+	, bFirstBlockRegular(false)
+{
+}
+
+FStringView ZUNamePool::AddUtf8(const ANSICHAR* Name, int32 Length)
+{
+	//The converter decodes typical names into its inline buffer, the pool is the only allocation
+	FUTF8ToTCHAR Converter(Name, Length);
+	return Add(FStringView(Converter.Get(), Converter.Length()));
+}
+
+FStringView ZUNamePool::Add(FStringView Name)
+{
+	TCHAR* Dest = Allocate(Name.Len());
+	FMemory::Memcpy(Dest, Name.GetData(), Name.Len() * sizeof(TCHAR));
+	Dest[Name.Len()] = TEXT('\0');
+	return FStringView(Dest, Name.Len());
+}
+
+void ZUNamePool::Reset()
+{
+	//A regular first block is kept, so a pool reset per page doesn't allocate again
+	if (Blocks.Num() > 0 && bFirstBlockRegular)
+	{
+		Blocks.SetNum(1);
+		BlockUsed = 0;
+		BlockCapacity = BlockSize;
+		return;
+	}
+
+	Blocks.Reset();
+	BlockUsed = 0;
+	BlockCapacity = 0;
+}
+
+TCHAR* ZUNamePool::Allocate(int32 Length)
+{
+	const int32 Needed = Length + 1;
+	if (BlockUsed + Needed > BlockCapacity)
+	{
+		//Names longer than a block get a block of their own
+		BlockCapacity = FMath::Max(BlockSize, Needed);
+		BlockUsed = 0;
+		if (Blocks.Num() == 0)
+		{
+			bFirstBlockRegular = BlockCapacity == BlockSize;
+		}
+		Blocks.Add(MakeUnique<TCHAR[]>(BlockCapacity));
+	}
+
+	TCHAR* Dest = Blocks.Last().Get() + BlockUsed;
+	BlockUsed += Needed;
+	return Dest;
+}
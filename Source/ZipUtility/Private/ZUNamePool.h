@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+/**
+ * Arena for entry names. Names are decoded straight into large shared blocks, so a listing of a million
+ * entries costs a handful of allocations instead of one or more per name. Views stay valid until Reset or
+ * until the pool is destroyed, blocks never move once allocated. Every name is followed by a terminator,
+ * so GetData() of a view can be used wherever a TCHAR* is expected.
+ */
+class ZUNamePool
+{
+public:
+	explicit ZUNamePool(int32 InBlockSize = 64 * 1024);
+
+	// Decodes a UTF-8 name, zip names without the UTF-8 flag are cp437 and read the same in their ASCII range
+	FStringView AddUtf8(const ANSICHAR* Name, int32 Length);
+
+	FStringView Add(FStringView Name);
+
+	// Drops every name, views handed out so far are invalid afterwards. The first block is reused.
+	void Reset();
+
+	int32 GetNumBlocks() const { return Blocks.Num(); }
+
+private:
+	TCHAR* Allocate(int32 Length);
+
+	TArray<TUniquePtr<TCHAR[]>> Blocks;
+	int32 BlockSize;
+
+	//Characters used and available in the last block
+	int32 BlockUsed;
+	int32 BlockCapacity;
+	bool bFirstBlockRegular;
+};
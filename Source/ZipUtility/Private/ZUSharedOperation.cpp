@@ -0,0 +1,258 @@
+#include "ZUSharedOperation.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZipOperation.h"
+#include "ZipFileFunctionLibrary.h"
+
+namespace
+{
+	typedef TWeakPtr<ZUSharedOperation, ESPMode::ThreadSafe> FRunningOperation;
+
+	//Paths that only differ in case are different archives on most platforms
+	struct FCaseSensitiveKeyFuncs : TDefaultMapKeyFuncs<FString, FRunningOperation, false>
+	{
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+
+		static uint32 GetKeyHash(const FString& Key)
+		{
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+
+	//Finished runs drop out once the last of their queued events is delivered, their keys are pruned on the next Begin
+	TMap<FString, FRunningOperation, FDefaultSetAllocator, FCaseSensitiveKeyFuncs> RunningOperations;
+	FCriticalSection RunningOperationsLock;
+
+	//A listing of a huge archive isn't worth holding on to for a caller that may never come
+	const int32 MaxReplayedEvents = 65536;
+
+	FString NormalizePath(const FString& Path)
+	{
+		if (Path.IsEmpty())
+		{
+			return Path;
+		}
+
+		FString Normalized = FPaths::ConvertRelativePathToFull(Path);
+		FPaths::NormalizeFilename(Normalized);
+		Normalized.RemoveFromEnd(TEXT("/"));
+		return Normalized;
+	}
+}
+
+FString ZUSharedOperation::MakeKey(const TCHAR* Kind, const FString& ArchivePath, const FString& DestinationPath, const FString& Parameters)
+{
+	//Separated by a character no path can hold
+	return FString::Printf(TEXT("%s|%s|%s|%s"), Kind, *NormalizePath(ArchivePath), *NormalizePath(DestinationPath), *Parameters);
+}
+
+TSharedPtr<ZUSharedOperation, ESPMode::ThreadSafe> ZUSharedOperation::Join(const FString& Key, UObject* Listener)
+{
+	TSharedPtr<ZUSharedOperation, ESPMode::ThreadSafe> Running;
+	{
+		FScopeLock ScopeLock(&RunningOperationsLock);
+		FRunningOperation* Found = RunningOperations.Find(Key);
+		if (Found == nullptr)
+		{
+			return nullptr;
+		}
+		Running = Found->Pin();
+	}
+
+	if (!Running.IsValid())
+	{
+		return nullptr;
+	}
+
+	{
+		FScopeLock ScopeLock(&Running->Lock);
+		if (!Running->CanJoin())
+		{
+			return nullptr;
+		}
+		Running->Listeners.Add({ Listener, false });
+	}
+
+	//Broadcast skips the listener until its replay is done, so nothing newer can overtake the history
+	if (IsInGameThread())
+	{
+		Running->Replay(Listener);
+	}
+	else
+	{
+		TWeakObjectPtr<UObject> WeakListener = Listener;
+		UZipFileFunctionLibrary::RunLambdaOnGameThread([Running, WeakListener]
+		{
+			if (UObject* Object = WeakListener.Get())
+			{
+				Running->Replay(Object);
+			}
+		});
+	}
+	return Running;
+}
+
+TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> ZUSharedOperation::Begin(const FString& Key, UObject* Listener, UZipOperation* InOperation)
+{
+	TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> Running = MakeShared<ZUSharedOperation, ESPMode::ThreadSafe>();
+	Running->Listeners.Add({ Listener, true });
+
+	//Set before the run is registered so nobody joins it without an operation to hand out
+	if (InOperation != nullptr)
+	{
+		Running->Operation = InOperation;
+		Running->bHasOperation = true;
+	}
+
+	FScopeLock ScopeLock(&RunningOperationsLock);
+	for (auto It = RunningOperations.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	//Replaces a run that can't be joined anymore, which keeps going for its own listeners
+	RunningOperations.Add(Key, Running);
+	return Running;
+}
+
+UZipOperation* ZUSharedOperation::GetOperation() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Operation.Get();
+}
+
+void ZUSharedOperation::Broadcast(FEvent&& Event, EZUSharedEvent Type)
+{
+	check(IsInGameThread());
+
+	const bool bEnding = Type == EZUSharedEvent::Done || (Type == EZUSharedEvent::Regular && History.Num() >= MaxReplayedEvents);
+
+	//Taken before sending, a listener that joins from one of these events gets this event in its replay instead
+	TArray<TWeakObjectPtr<UObject>, TInlineAllocator<8>> Targets;
+	TArray<UObject*> WaitingForReplay;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Listeners.RemoveAll([](const FListener& Listener)
+		{
+			return !Listener.Object.IsValid();
+		});
+
+		for (FListener& Listener : Listeners)
+		{
+			if (Listener.bReplayed)
+			{
+				Targets.Add(Listener.Object);
+			}
+			else if (bEnding)
+			{
+				Listener.bReplayed = true;
+				WaitingForReplay.Add(Listener.Object.Get());
+			}
+		}
+
+		if (bEnding)
+		{
+			bJoinable = false;
+		}
+	}
+
+	if (bEnding)
+	{
+		//Listeners that joined from another thread and are still waiting get the history before it's dropped
+		for (UObject* Listener : WaitingForReplay)
+		{
+			SendHistory(Listener);
+			Targets.Add(Listener);
+		}
+		History.Empty();
+		LastProgress = nullptr;
+
+		for (const TWeakObjectPtr<UObject>& Target : Targets)
+		{
+			if (UObject* Listener = Target.Get())
+			{
+				Event(Listener);
+			}
+		}
+		return;
+	}
+
+	//Once ended, the run only passes events on
+	if (!bJoinable)
+	{
+		for (const TWeakObjectPtr<UObject>& Target : Targets)
+		{
+			if (UObject* Listener = Target.Get())
+			{
+				Event(Listener);
+			}
+		}
+		return;
+	}
+
+	if (Type == EZUSharedEvent::Progress)
+	{
+		LastProgress = MoveTemp(Event);
+	}
+	else
+	{
+		History.Add(MoveTemp(Event));
+	}
+
+	const FEvent& Stored = Type == EZUSharedEvent::Progress ? LastProgress : History.Last();
+	for (const TWeakObjectPtr<UObject>& Target : Targets)
+	{
+		if (UObject* Listener = Target.Get())
+		{
+			Stored(Listener);
+		}
+	}
+}
+
+void ZUSharedOperation::Replay(UObject* Listener)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		FListener* Waiting = Listeners.FindByPredicate([Listener](const FListener& Candidate)
+		{
+			return !Candidate.bReplayed && Candidate.Object.Get() == Listener;
+		});
+
+		//The run ended first and already sent it the history
+		if (Waiting == nullptr)
+		{
+			return;
+		}
+		Waiting->bReplayed = true;
+	}
+
+	SendHistory(Listener);
+}
+
+void ZUSharedOperation::SendHistory(UObject* Listener) const
+{
+	for (int32 Index = 0; Index < History.Num(); Index++)
+	{
+		History[Index](Listener);
+	}
+	if (LastProgress)
+	{
+		LastProgress(Listener);
+	}
+}
+
+bool ZUSharedOperation::CanJoin() const
+{
+	if (!bJoinable)
+	{
+		return false;
+	}
+
+	//A stopped operation still sends what it finished, but a new request wants the whole result
+	return !bHasOperation || (Operation.IsValid() && !Operation->IsStopped());
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UZipOperation;
+
+enum class EZUSharedEvent : uint8
+{
+	// Only the latest one is replayed to late listeners
+	Progress,
+	Regular,
+	// Ends the run, requests made from here on start a new one
+	Done
+};
+
+/**
+ * One run of a read operation that identical requests can join while it is in flight, e.g. several systems listing or
+ * unzipping the same archive at startup. The first request starts the work, later ones are handed the same UZipOperation,
+ * get the events they missed replayed in order and then receive every event up to the same OnDone. Stopping the operation
+ * stops it for all of them.
+ *
+ * Runs can be begun and joined from any thread, the registry and each run's listener list are locked. Events are only
+ * ever delivered on the game thread, where the callback handler sends them, and never while a lock is held so listeners
+ * can start or join operations from inside them. A listener joining from another thread gets its replay on the next
+ * game thread tick, ahead of any later event.
+ */
+class ZUSharedOperation
+{
+public:
+	typedef TFunction<void(UObject* Listener)> FEvent;
+
+	// Kind names the operation, Parameters holds anything besides the paths that changes its result
+	static FString MakeKey(const TCHAR* Kind, const FString& ArchivePath, const FString& DestinationPath, const FString& Parameters);
+
+	// Adds Listener to the run for Key and replays what it missed, returns nullptr if there's no run it can still join
+	static TSharedPtr<ZUSharedOperation, ESPMode::ThreadSafe> Join(const FString& Key, UObject* Listener);
+
+	// Registers a new run for Key with Listener as its first listener. Runs with an operation can only be joined while
+	// it is still referenced and hasn't been stopped
+	static TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> Begin(const FString& Key, UObject* Listener, UZipOperation* InOperation = nullptr);
+
+	UZipOperation* GetOperation() const;
+
+	// Game thread only
+	void Broadcast(FEvent&& Event, EZUSharedEvent Type);
+
+private:
+	struct FListener
+	{
+		TWeakObjectPtr<UObject> Object;
+
+		// False until the listener has been sent the history it joined after
+		bool bReplayed;
+	};
+
+	bool CanJoin() const;
+
+	// Game thread only, sends the history to a listener still waiting for it
+	void Replay(UObject* Listener);
+	void SendHistory(UObject* Listener) const;
+
+	// Guards Listeners and bJoinable. History and LastProgress are only touched on the game thread.
+	mutable FCriticalSection Lock;
+	TArray<FListener> Listeners;
+
+	// Everything sent so far, for listeners that join late
+	TArray<FEvent> History;
+	FEvent LastProgress;
+
+	TWeakObjectPtr<UZipOperation> Operation;
+	bool bHasOperation = false;
+	bool bJoinable = true;
+};
@@ -0,0 +1,133 @@
+#include "ZUSourceScanner.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "SevenZipCallbackHandler.h"
+#include "HAL/PlatformFilemanager.h"
+
+ZUSourceScanner::ZUSourceScanner(SevenZip::ProgressCallback* InCallback, const FString& InArchivePath)
+{
+	Callback = InCallback;
+	ArchivePath = InArchivePath;
+	bWalking = false;
+	QueuedIndex = 0;
+	BatchIndex = 0;
+	ExtraBytes = 0;
+	bStartReported = false;
+}
+
+bool ZUSourceScanner::StartDirectory(const FString& Directory)
+{
+	FString Root = Directory.Replace(TEXT("\\"), TEXT("/"));
+	Root.RemoveFromEnd(TEXT("/"));
+	EntryPrefix = FPaths::GetCleanFilename(Root);
+
+	if (!Walker.Start(Root))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to scan %s"), *Root);
+		return false;
+	}
+	bWalking = true;
+
+	FZUSourceFile& RootEntry = Queued[Queued.AddDefaulted()];
+	RootEntry.Path = Root;
+	RootEntry.EntryName = EntryPrefix;
+	RootEntry.ModifiedTime = FPlatformFileManager::Get().GetPlatformFile().GetTimeStamp(*Root);
+	RootEntry.bIsDirectory = true;
+	return true;
+}
+
+bool ZUSourceScanner::StartFile(const FString& FilePath)
+{
+	const FFileStatData StatData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*FilePath);
+	if (!StatData.bIsValid || StatData.bIsDirectory)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is not a file"), *FilePath);
+		return false;
+	}
+
+	FZUSourceFile& File = Queued[Queued.AddDefaulted()];
+	File.Path = FilePath;
+	File.EntryName = FPaths::GetCleanFilename(FilePath);
+	File.Size = StatData.FileSize;
+	File.ModifiedTime = StatData.ModificationTime;
+
+	//Nothing left to find, the total is known right away
+	ExtraBytes = StatData.FileSize;
+	ReportStart();
+	return true;
+}
+
+bool ZUSourceScanner::Next(FZUSourceFile& OutFile)
+{
+	ReportStartIfComplete();
+
+	if (QueuedIndex < Queued.Num())
+	{
+		OutFile = MoveTemp(Queued[QueuedIndex++]);
+		return true;
+	}
+
+	if (BatchIndex == Batch.Num())
+	{
+		if (!bWalking || !Walker.NextBatch(Batch))
+		{
+			return false;
+		}
+		BatchIndex = 0;
+	}
+
+	FWFUDirectoryEntry& Entry = Batch[BatchIndex++];
+	OutFile.Path = MoveTemp(Entry.Path);
+	OutFile.EntryName = EntryPrefix / Entry.RelativePath;
+	OutFile.Size = Entry.Size;
+	OutFile.ModifiedTime = Entry.ModifiedTime;
+	OutFile.bIsDirectory = Entry.bIsDirectory;
+	return true;
+}
+
+void ZUSourceScanner::OnFileDone(const FZUSourceFile& File)
+{
+	ReportStartIfComplete();
+
+	if (bStartReported)
+	{
+		Callback->OnFileDone(*ArchivePath, *File.Path, File.Size);
+	}
+	else
+	{
+		HeldBack.Emplace(File.Path, File.Size);
+	}
+}
+
+void ZUSourceScanner::Finish()
+{
+	if (!bStartReported)
+	{
+		ReportStart();
+	}
+}
+
+void ZUSourceScanner::Cancel()
+{
+	Walker.Cancel();
+}
+
+void ZUSourceScanner::ReportStartIfComplete()
+{
+	if (!bStartReported && bWalking && Walker.IsFinished())
+	{
+		ReportStart();
+	}
+}
+
+void ZUSourceScanner::ReportStart()
+{
+	const TString ArchiveName = *ArchivePath;
+	Callback->OnStartWithTotal(ArchiveName, ExtraBytes + (bWalking ? Walker.GetTotalBytes() : 0));
+	bStartReported = true;
+
+	for (const TPair<FString, uint64>& File : HeldBack)
+	{
+		Callback->OnFileDone(ArchiveName, *File.Key, File.Value);
+	}
+	HeldBack.Empty();
+}
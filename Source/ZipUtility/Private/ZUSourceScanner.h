@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WFUDirectoryWalker.h"
+
+namespace SevenZip
+{
+	class ProgressCallback;
+}
+
+/** A file or directory picked up for compression. */
+struct FZUSourceFile
+{
+	FString Path;
+	FString EntryName;
+	int64 Size = 0;
+	FDateTime ModifiedTime;
+	bool bIsDirectory = false;
+};
+
+/**
+ * Feeds the native compressors their input while it is still being scanned. Directories are walked
+ * in parallel by WFUDirectoryWalker and files come out as they are found, each directory ahead of its
+ * contents, so compression starts with the first listed folder instead of after the whole tree.
+ *
+ * Progress needs the total up front, so per file progress is held back until the walk is complete.
+ * OnStartWithTotal then goes out with the real total and the held back files are replayed.
+ */
+class ZUSourceScanner
+{
+public:
+	ZUSourceScanner(SevenZip::ProgressCallback* InCallback, const FString& InArchivePath);
+
+	// Adds the directory itself as the archive's root folder, like SevenZipCompressor
+	bool StartDirectory(const FString& Directory);
+	bool StartFile(const FString& FilePath);
+
+	// Next file or directory in archive order, false once everything has been handed out
+	bool Next(FZUSourceFile& OutFile);
+
+	void OnFileDone(const FZUSourceFile& File);
+
+	// Reports the start if the walk never got to, e.g. when it was cancelled
+	void Finish();
+
+	void Cancel();
+
+private:
+	void ReportStartIfComplete();
+	void ReportStart();
+
+	SevenZip::ProgressCallback* Callback;
+	FString ArchivePath;
+
+	WFUDirectoryWalker Walker;
+	bool bWalking;
+	FString EntryPrefix;
+
+	// The root folder or single file, handed out before anything the walker finds
+	TArray<FZUSourceFile> Queued;
+	int32 QueuedIndex;
+	TArray<FWFUDirectoryEntry> Batch;
+	int32 BatchIndex;
+
+	uint64 ExtraBytes;
+	bool bStartReported;
+	TArray<TPair<FString, uint64>> HeldBack;
+};
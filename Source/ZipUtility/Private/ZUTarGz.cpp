@@ -0,0 +1,1103 @@
+#include "ZUTarGz.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUFileWriter.h"
+#include "ZUDirectoryCache.h"
+#include "ZUEntryFilter.h"
+#include "SevenZipCallbackHandler.h"
+#include "WFULambdaRunnable.h"
+#include "HAL/PlatformFilemanager.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	const int32 RecordSize = 512;
+
+	//tar writes in 20 record units, readers that check the tail expect the archive padded to one
+	const int64 TarBlockingSize = 20 * RecordSize;
+
+	//Size of the blocks handed between the tar and gzip stages
+	const int64 PipeBlockSize = 1024 * 1024;
+
+	const int64 NameFieldLength = 100;
+	const int64 PrefixFieldLength = 155;
+
+	//Entries at least this big are streamed to disk instead of going through the batched writer
+	const int64 LargeEntrySize = 16 * 1024 * 1024;
+
+	//Entries at least this big bypass the page cache
+	const int64 UnbufferedEntrySize = 512 * 1024 * 1024;
+
+	const int64 LargeEntryProgressInterval = 32 * 1024 * 1024;
+
+	//Pax records and GNU long names only ever hold a path and a few numbers
+	const int64 MaxMetadataSize = 64 * 1024;
+
+	//Deflate can't expand data by more than this, so no entry is bigger than the archive times it
+	const uint64 MaxDeflateRatio = 1032;
+
+	//Octal fields hold Length - 1 digits and a terminating NUL
+	bool FitsOctal(uint64 Value, int32 Length)
+	{
+		return Value < (1ull << (3 * (Length - 1)));
+	}
+
+	void WriteOctal(uint8* Field, int32 Length, uint64 Value)
+	{
+		Field[Length - 1] = 0;
+		for (int32 Index = Length - 2; Index >= 0; Index--)
+		{
+			Field[Index] = '0' + (Value & 7);
+			Value >>= 3;
+		}
+	}
+
+	//Octal, or the GNU base-256 form with the high bit of the first byte set. Negative base-256 values and ones that
+	//don't fit an int64 come back as MAX_uint64 so size checks reject them
+	uint64 ReadNumber(const uint8* Field, int32 Length)
+	{
+		uint64 Value = 0;
+		if (Field[0] & 0x80)
+		{
+			if (Field[0] & 0x40)
+			{
+				return MAX_uint64;
+			}
+
+			Value = Field[0] & 0x3F;
+			for (int32 Index = 1; Index < Length; Index++)
+			{
+				if (Value > (uint64)(MAX_int64 >> 8))
+				{
+					return MAX_uint64;
+				}
+				Value = (Value << 8) | Field[Index];
+			}
+			return Value;
+		}
+
+		int32 Index = 0;
+		while (Index < Length && Field[Index] == ' ')
+		{
+			Index++;
+		}
+		for (; Index < Length && Field[Index] >= '0' && Field[Index] <= '7'; Index++)
+		{
+			Value = (Value << 3) | (Field[Index] - '0');
+		}
+		return Value;
+	}
+
+	//The checksum field itself counts as spaces
+	uint32 HeaderChecksum(const uint8* Header)
+	{
+		uint32 Sum = 0;
+		for (int32 Index = 0; Index < RecordSize; Index++)
+		{
+			Sum += (Index >= 148 && Index < 156) ? ' ' : Header[Index];
+		}
+		return Sum;
+	}
+
+	int32 FieldLength(const uint8* Field, int32 Length)
+	{
+		int32 Index = 0;
+		while (Index < Length && Field[Index] != 0)
+		{
+			Index++;
+		}
+		return Index;
+	}
+
+	FString DecodeName(const uint8* Data, int32 Length)
+	{
+		FUTF8ToTCHAR Converter((const ANSICHAR*)Data, Length);
+		return FString(Converter.Length(), Converter.Get());
+	}
+
+	int32 CountDigits(uint64 Value)
+	{
+		int32 Count = 1;
+		for (; Value >= 10; Value /= 10)
+		{
+			Count++;
+		}
+		return Count;
+	}
+
+	void AppendDecimal(TArray<uint8>& Out, uint64 Value)
+	{
+		uint8 Digits[20];
+		int32 Count = 0;
+		do
+		{
+			Digits[Count++] = '0' + (Value % 10);
+			Value /= 10;
+		} while (Value > 0);
+
+		while (Count > 0)
+		{
+			Out.Add(Digits[--Count]);
+		}
+	}
+
+	//"<length> <key>=<value>\n" where length counts its own digits too
+	void AppendPaxRecord(TArray<uint8>& Out, const char* Key, const uint8* Value, int32 ValueLength)
+	{
+		const int32 KeyLength = FCStringAnsi::Strlen(Key);
+		const int64 Payload = 1 + KeyLength + 1 + ValueLength + 1;
+
+		int64 Length = Payload + 1;
+		while (Length != Payload + CountDigits(Length))
+		{
+			Length = Payload + CountDigits(Length);
+		}
+
+		AppendDecimal(Out, Length);
+		Out.Add(' ');
+		Out.Append((const uint8*)Key, KeyLength);
+		Out.Add('=');
+		Out.Append(Value, ValueLength);
+		Out.Add('\n');
+	}
+
+	int64 ToUnixTime(const FDateTime& Time)
+	{
+		return FMath::Max<int64>(Time.ToUnixTimestamp(), 0);
+	}
+
+	int64 PaddingFor(int64 Size, int64 Unit)
+	{
+		return (Unit - Size % Unit) % Unit;
+	}
+
+	//Second pipeline stage of the compressor, gzips whatever the tar stage pushes
+	bool GzipBlocks(ZUBlockPipe& Pipe, IFileHandle& Output, int32 Level)
+	{
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+
+		//16 over the window bits asks zlib for a gzip header and trailer
+		if (deflateInit2(&Stream, Level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			Pipe.Cancel();
+			return false;
+		}
+
+		TArray<uint8> Input;
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(PipeBlockSize);
+		bool bSuccess = true;
+
+		while (bSuccess)
+		{
+			const bool bHasInput = Pipe.Pop(Input);
+			if (!bHasInput && Pipe.IsCancelled())
+			{
+				bSuccess = false;
+				break;
+			}
+
+			Stream.next_in = Input.GetData();
+			Stream.avail_in = bHasInput ? (uInt)Input.Num() : 0;
+			const int Flush = bHasInput ? Z_NO_FLUSH : Z_FINISH;
+
+			int Result = Z_OK;
+			do
+			{
+				Stream.next_out = Compressed.GetData();
+				Stream.avail_out = (uInt)Compressed.Num();
+				Result = deflate(&Stream, Flush);
+
+				const int64 Produced = Compressed.Num() - Stream.avail_out;
+				if (Result == Z_STREAM_ERROR || (Produced > 0 && !Output.Write(Compressed.GetData(), Produced)))
+				{
+					bSuccess = false;
+					break;
+				}
+			} while (Stream.avail_out == 0 || (Flush == Z_FINISH && Result != Z_STREAM_END));
+
+			if (!bHasInput)
+			{
+				break;
+			}
+		}
+
+		deflateEnd(&Stream);
+		if (!bSuccess)
+		{
+			Pipe.Cancel();
+		}
+		return bSuccess;
+	}
+
+	//First pipeline stage of the reader, inflates the archive into blocks for the tar stage
+	bool GunzipBlocks(IFileHandle& Input, ZUBlockPipe& Pipe)
+	{
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+
+		if (inflateInit2(&Stream, MAX_WBITS + 16) != Z_OK)
+		{
+			Pipe.Cancel();
+			return false;
+		}
+
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(PipeBlockSize);
+		TArray<uint8> Output;
+		Output.SetNumUninitialized(PipeBlockSize);
+		int64 Filled = 0;
+
+		int64 Remaining = Input.Size();
+		int Result = Z_OK;
+		bool bSuccess = true;
+
+		while (true)
+		{
+			if (Stream.avail_in == 0 && Remaining > 0)
+			{
+				const int64 Count = FMath::Min(Remaining, PipeBlockSize);
+				if (!Input.Read(Compressed.GetData(), Count))
+				{
+					bSuccess = false;
+					break;
+				}
+				Remaining -= Count;
+				Stream.next_in = Compressed.GetData();
+				Stream.avail_in = (uInt)Count;
+			}
+
+			//Running out of input anywhere but at the end of a member means the archive is truncated
+			if (Stream.avail_in == 0 && Remaining == 0)
+			{
+				bSuccess = Result == Z_STREAM_END;
+				break;
+			}
+
+			Stream.next_out = Output.GetData() + Filled;
+			Stream.avail_out = (uInt)(PipeBlockSize - Filled);
+			Result = inflate(&Stream, Z_NO_FLUSH);
+			Filled = PipeBlockSize - Stream.avail_out;
+
+			if (Result == Z_STREAM_END)
+			{
+				//Concatenated gzip members continue the same tar stream
+				if ((Stream.avail_in > 0 || Remaining > 0) && inflateReset(&Stream) == Z_OK)
+				{
+					Result = Z_OK;
+				}
+			}
+			else if (Result != Z_OK && Result != Z_BUF_ERROR)
+			{
+				bSuccess = false;
+				break;
+			}
+
+			if (Filled == PipeBlockSize)
+			{
+				if (!Pipe.Push(MoveTemp(Output)))
+				{
+					bSuccess = false;
+					break;
+				}
+				Output.SetNumUninitialized(PipeBlockSize);
+				Filled = 0;
+			}
+		}
+
+		if (bSuccess && Filled > 0)
+		{
+			Output.SetNum(Filled, false);
+			bSuccess = Pipe.Push(MoveTemp(Output));
+		}
+
+		inflateEnd(&Stream);
+		if (bSuccess)
+		{
+			Pipe.Close();
+		}
+		else
+		{
+			Pipe.Cancel();
+		}
+		return bSuccess;
+	}
+}
+
+ZUTarGzCompressor::ZUTarGzCompressor(const FString& InArchivePath)
+{
+	ArchivePath = InArchivePath;
+	Level = 6;
+	StreamOffset = 0;
+}
+
+void ZUTarGzCompressor::SetCompressionLevel(int32 InLevel)
+{
+	Level = FMath::Clamp(InLevel, 0, 9);
+}
+
+bool ZUTarGzCompressor::CompressDirectory(const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	ZUSourceScanner Sources(Callback, ArchivePath);
+	return Sources.StartDirectory(Directory) && CompressFiles(Sources, Callback);
+}
+
+bool ZUTarGzCompressor::CompressFile(const FString& FilePath, SevenZip::ProgressCallback* Callback)
+{
+	ZUSourceScanner Sources(Callback, ArchivePath);
+	return Sources.StartFile(FilePath) && CompressFiles(Sources, Callback);
+}
+
+bool ZUTarGzCompressor::CompressFiles(ZUSourceScanner& Sources, SevenZip::ProgressCallback* Callback)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	IFileHandle* Output = PlatformFile.OpenWrite(*ArchivePath);
+	if (Output == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open %s for writing"), *ArchivePath);
+		return false;
+	}
+
+	Pipe = MakeUnique<ZUBlockPipe>();
+	Block.Reset(PipeBlockSize);
+	StreamOffset = 0;
+
+	//The gzip stage runs on its own thread for the whole archive and is joined below
+	bool bGzipSuccess = false;
+	TFuture<void> GzipStage = WFULambdaRunnable::RunLambdaOnBackGroundThread([this, Output, &bGzipSuccess]
+	{
+		bGzipSuccess = GzipBlocks(*Pipe, *Output, Level);
+	});
+
+	bool bSuccess = true;
+	FZUSourceFile File;
+	while (Sources.Next(File))
+	{
+		if (Callback->OnCheckBreak())
+		{
+			bSuccess = false;
+			break;
+		}
+
+		bSuccess = File.bIsDirectory ? AddHeader(File.EntryName, 0, File.ModifiedTime, true) : AddFile(File);
+		if (!bSuccess)
+		{
+			//A cancelled pipe means the gzip stage failed first, it logs nothing of its own
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to add %s to %s"), *File.Path, *ArchivePath);
+			break;
+		}
+
+		if (!File.bIsDirectory)
+		{
+			Sources.OnFileDone(File);
+		}
+	}
+
+	//Two zero records end the archive
+	if (bSuccess)
+	{
+		bSuccess = AppendZeros(2 * RecordSize) && PadTo(TarBlockingSize) && FlushBlock();
+	}
+
+	if (bSuccess)
+	{
+		Pipe->Close();
+	}
+	else
+	{
+		Sources.Cancel();
+		Pipe->Cancel();
+	}
+	GzipStage.Wait();
+	delete Output;
+	Pipe.Reset();
+
+	bSuccess = bSuccess && bGzipSuccess;
+	if (!bSuccess)
+	{
+		PlatformFile.DeleteFile(*ArchivePath);
+	}
+
+	Sources.Finish();
+	return bSuccess;
+}
+
+bool ZUTarGzCompressor::AddFile(const FZUSourceFile& File)
+{
+	TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*File.Path));
+	if (!Handle.IsValid() || !AddHeader(File.EntryName, File.Size, File.ModifiedTime, false))
+	{
+		return false;
+	}
+
+	//Read straight into the pipe block, the size in the header is binding so a file that shrank fails here
+	int64 Remaining = File.Size;
+	while (Remaining > 0)
+	{
+		if (Block.Num() == PipeBlockSize && !FlushBlock())
+		{
+			return false;
+		}
+
+		const int64 Count = FMath::Min(Remaining, PipeBlockSize - Block.Num());
+		const int32 Start = Block.AddUninitialized((int32)Count);
+		if (!Handle->Read(Block.GetData() + Start, Count))
+		{
+			return false;
+		}
+		StreamOffset += Count;
+		Remaining -= Count;
+	}
+
+	return PadTo(RecordSize);
+}
+
+bool ZUTarGzCompressor::AddHeader(const FString& Name, int64 Size, const FDateTime& ModifiedTime, bool bIsDirectory)
+{
+	const FString PathName = bIsDirectory ? Name + TEXT("/") : Name;
+	FTCHARToUTF8 Converter(*PathName);
+	const uint8* Path = (const uint8*)Converter.Get();
+	const int32 PathLength = Converter.Length();
+
+	//Long names are split into ustar's prefix and name fields at a slash, only names that can't be fall back to pax
+	int32 Split = INDEX_NONE;
+	bool bNameFits = PathLength <= NameFieldLength;
+	if (!bNameFits)
+	{
+		for (int32 Index = FMath::Min<int32>(PathLength - 1, PrefixFieldLength); Index > 0; Index--)
+		{
+			if (Path[Index] == '/')
+			{
+				if (PathLength - Index - 1 <= NameFieldLength)
+				{
+					Split = Index;
+					bNameFits = true;
+				}
+				break;
+			}
+		}
+	}
+	const bool bSizeFits = FitsOctal(Size, 12);
+	const int64 UnixTime = ToUnixTime(ModifiedTime);
+
+	uint8 Header[RecordSize];
+
+	if (!bNameFits || !bSizeFits)
+	{
+		TArray<uint8> Records;
+		if (!bNameFits)
+		{
+			AppendPaxRecord(Records, "path", Path, PathLength);
+		}
+		if (!bSizeFits)
+		{
+			TArray<uint8> SizeDigits;
+			AppendDecimal(SizeDigits, Size);
+			AppendPaxRecord(Records, "size", SizeDigits.GetData(), SizeDigits.Num());
+		}
+
+		FMemory::Memzero(Header);
+		FMemory::Memcpy(Header, "././@PaxHeader", 14);
+		WriteOctal(Header + 100, 8, 0644);
+		WriteOctal(Header + 108, 8, 0);
+		WriteOctal(Header + 116, 8, 0);
+		WriteOctal(Header + 124, 12, Records.Num());
+		WriteOctal(Header + 136, 12, UnixTime);
+		Header[156] = 'x';
+		FMemory::Memcpy(Header + 257, "ustar\0" "00", 8);
+		WriteOctal(Header + 148, 7, HeaderChecksum(Header));
+		Header[155] = ' ';
+
+		if (!Append(Header, RecordSize) || !Append(Records.GetData(), Records.Num()) || !PadTo(RecordSize))
+		{
+			return false;
+		}
+	}
+
+	FMemory::Memzero(Header);
+	if (Split != INDEX_NONE)
+	{
+		FMemory::Memcpy(Header + 345, Path, Split);
+		FMemory::Memcpy(Header, Path + Split + 1, PathLength - Split - 1);
+	}
+	else
+	{
+		//Truncated names are overridden by the pax path record
+		FMemory::Memcpy(Header, Path, FMath::Min<int32>(PathLength, NameFieldLength));
+	}
+
+	WriteOctal(Header + 100, 8, bIsDirectory ? 0755 : 0644);
+	WriteOctal(Header + 108, 8, 0);
+	WriteOctal(Header + 116, 8, 0);
+	WriteOctal(Header + 124, 12, bSizeFits ? Size : 0);
+	WriteOctal(Header + 136, 12, UnixTime);
+	Header[156] = bIsDirectory ? '5' : '0';
+	FMemory::Memcpy(Header + 257, "ustar\0" "00", 8);
+	WriteOctal(Header + 148, 7, HeaderChecksum(Header));
+	Header[155] = ' ';
+
+	return Append(Header, RecordSize);
+}
+
+bool ZUTarGzCompressor::Append(const uint8* Data, int64 Size)
+{
+	while (Size > 0)
+	{
+		if (Block.Num() == PipeBlockSize && !FlushBlock())
+		{
+			return false;
+		}
+
+		const int64 Count = FMath::Min(Size, PipeBlockSize - Block.Num());
+		Block.Append(Data, (int32)Count);
+		StreamOffset += Count;
+		Data += Count;
+		Size -= Count;
+	}
+	return true;
+}
+
+bool ZUTarGzCompressor::AppendZeros(int64 Size)
+{
+	while (Size > 0)
+	{
+		if (Block.Num() == PipeBlockSize && !FlushBlock())
+		{
+			return false;
+		}
+
+		const int64 Count = FMath::Min(Size, PipeBlockSize - Block.Num());
+		Block.AddZeroed((int32)Count);
+		StreamOffset += Count;
+		Size -= Count;
+	}
+	return true;
+}
+
+bool ZUTarGzCompressor::PadTo(int64 Unit)
+{
+	return AppendZeros(PaddingFor(StreamOffset, Unit));
+}
+
+bool ZUTarGzCompressor::FlushBlock()
+{
+	if (Block.Num() == 0)
+	{
+		return true;
+	}
+
+	if (!Pipe->Push(MoveTemp(Block)))
+	{
+		return false;
+	}
+	Block.Reset(PipeBlockSize);
+	return true;
+}
+
+ZUTarGzReader::ZUTarGzReader()
+{
+	EstimatedSize = 0;
+	Handle = nullptr;
+	bInflateSuccess = false;
+	BlockOffset = 0;
+	EntryRemaining = 0;
+}
+
+ZUTarGzReader::~ZUTarGzReader()
+{
+	Close();
+}
+
+bool ZUTarGzReader::Open(const FString& InArchivePath)
+{
+	Close();
+
+	ArchivePath = InArchivePath;
+	Handle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*ArchivePath);
+	if (Handle == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open %s"), *ArchivePath);
+		return false;
+	}
+
+	//ISIZE, the last four bytes of the last member
+	const int64 ArchiveSize = Handle->Size();
+	uint8 Trailer[4];
+	if (ArchiveSize < 18 || !Handle->Seek(ArchiveSize - 4) || !Handle->Read(Trailer, 4) || !Handle->Seek(0))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is not a gzip stream"), *ArchivePath);
+		Close();
+		return false;
+	}
+	EstimatedSize = Trailer[0] | (Trailer[1] << 8) | (Trailer[2] << 16) | ((uint32)Trailer[3] << 24);
+	MaxEntrySize = (uint64)ArchiveSize < (uint64)MAX_int64 / MaxDeflateRatio ? (uint64)ArchiveSize * MaxDeflateRatio : (uint64)MAX_int64;
+
+	Pipe = MakeUnique<ZUBlockPipe>();
+	Block.Reset();
+	BlockOffset = 0;
+	EntryRemaining = 0;
+	bInflateSuccess = false;
+
+	InflateStage = WFULambdaRunnable::RunLambdaOnBackGroundThread([this]
+	{
+		bInflateSuccess = GunzipBlocks(*Handle, *Pipe);
+	});
+	return true;
+}
+
+void ZUTarGzReader::Close()
+{
+	if (Pipe.IsValid())
+	{
+		Pipe->Cancel();
+		InflateStage.Wait();
+		Pipe.Reset();
+	}
+
+	if (Handle != nullptr)
+	{
+		delete Handle;
+		Handle = nullptr;
+	}
+	Block.Empty();
+}
+
+bool ZUTarGzReader::ForEachEntry(TFunctionRef<bool(const FZUTarEntry& Entry)> Visitor)
+{
+	if (!Pipe.IsValid())
+	{
+		return false;
+	}
+
+	uint8 Header[RecordSize];
+
+	//Set by pax and GNU long name headers for the entry that follows
+	FString PendingName;
+	int64 PendingSize = INDEX_NONE;
+
+	while (true)
+	{
+		const int64 HeaderRead = Read(Header, RecordSize);
+		if (HeaderRead == 0)
+		{
+			//Some writers leave out the end of archive records
+			break;
+		}
+		if (HeaderRead != RecordSize)
+		{
+			return StreamError();
+		}
+
+		bool bIsZero = true;
+		for (int32 Index = 0; Index < RecordSize && bIsZero; Index++)
+		{
+			bIsZero = Header[Index] == 0;
+		}
+		if (bIsZero)
+		{
+			break;
+		}
+
+		if (ReadNumber(Header + 148, 8) != HeaderChecksum(Header))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Corrupt tar header in %s"), *ArchivePath);
+			return false;
+		}
+
+		const uint8 TypeFlag = Header[156];
+		const uint64 DeclaredSize = ReadNumber(Header + 124, 12);
+		const bool bIsMetadata = TypeFlag == 'x' || TypeFlag == 'L';
+		if (DeclaredSize > MaxEntrySize || (bIsMetadata && DeclaredSize > (uint64)MaxMetadataSize))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Tar header in %s declares a size the archive can't hold"), *ArchivePath);
+			return false;
+		}
+
+		const int64 HeaderSize = (int64)DeclaredSize;
+		const int64 Padding = PaddingFor(HeaderSize, RecordSize);
+
+		if (TypeFlag == 'x')
+		{
+			//Reports its own errors
+			if (!ReadPaxRecords(HeaderSize, PendingName, PendingSize))
+			{
+				return false;
+			}
+			if (!Skip(Padding))
+			{
+				return StreamError();
+			}
+			continue;
+		}
+		if (TypeFlag == 'L')
+		{
+			if (!ReadString(HeaderSize, PendingName) || !Skip(Padding))
+			{
+				return StreamError();
+			}
+			continue;
+		}
+
+		FZUTarEntry Entry;
+		Entry.Size = (PendingSize != INDEX_NONE) ? PendingSize : HeaderSize;
+		Entry.ModifiedTime = FDateTime::FromUnixTimestamp(ReadNumber(Header + 136, 12));
+		Entry.bIsDirectory = TypeFlag == '5';
+
+		if (!PendingName.IsEmpty())
+		{
+			Entry.Name = PendingName;
+		}
+		else
+		{
+			Entry.Name = DecodeName(Header, FieldLength(Header, NameFieldLength));
+
+			const bool bIsUstar = FMemory::Memcmp(Header + 257, "ustar", 5) == 0;
+			const int32 PrefixLength = bIsUstar ? FieldLength(Header + 345, PrefixFieldLength) : 0;
+			if (PrefixLength > 0)
+			{
+				Entry.Name = DecodeName(Header + 345, PrefixLength) + TEXT("/") + Entry.Name;
+			}
+		}
+		Entry.Name.RemoveFromEnd(TEXT("/"));
+		PendingName.Empty();
+		PendingSize = INDEX_NONE;
+
+		//Global pax headers, GNU long link names, links and devices carry nothing to extract
+		const bool bIsFile = TypeFlag == '0' || TypeFlag == 0 || TypeFlag == '7';
+		if (!bIsFile && !Entry.bIsDirectory)
+		{
+			if (TypeFlag != 'g' && TypeFlag != 'K')
+			{
+				UE_LOG(LogTemp, Log, TEXT("ZipUtility: Skipping %s in %s, tar entry type '%c' isn't extracted"), *Entry.Name, *ArchivePath, (TCHAR)TypeFlag);
+			}
+			if (!Skip(Entry.Size + PaddingFor(Entry.Size, RecordSize)))
+			{
+				return StreamError();
+			}
+			continue;
+		}
+
+		if (Entry.bIsDirectory)
+		{
+			//Directories have no data, whatever their size field says
+			Entry.Size = 0;
+		}
+
+		EntryRemaining = Entry.Size;
+		const bool bContinue = Visitor(Entry);
+
+		const int64 Unread = EntryRemaining;
+		EntryRemaining = 0;
+		if (!bContinue)
+		{
+			return true;
+		}
+		if (!Skip(Unread + PaddingFor(Entry.Size, RecordSize)))
+		{
+			return StreamError();
+		}
+	}
+
+	//Drain the zero padding so the gzip trailer, and with it the checksum, gets checked
+	while (Pipe->Pop(Block))
+	{
+	}
+	BlockOffset = Block.Num();
+	InflateStage.Wait();
+
+	return bInflateSuccess || StreamError();
+}
+
+bool ZUTarGzReader::ReadData(uint8* Dest, int64 Count)
+{
+	if (Count > EntryRemaining)
+	{
+		return false;
+	}
+
+	EntryRemaining -= Count;
+	return Read(Dest, Count) == Count || StreamError();
+}
+
+int64 ZUTarGzReader::Read(uint8* Dest, int64 Count)
+{
+	int64 Total = 0;
+	while (Total < Count)
+	{
+		if (BlockOffset == Block.Num())
+		{
+			if (!Pipe->Pop(Block))
+			{
+				break;
+			}
+			BlockOffset = 0;
+			continue;
+		}
+
+		const int64 Chunk = FMath::Min(Count - Total, Block.Num() - BlockOffset);
+		if (Dest != nullptr)
+		{
+			FMemory::Memcpy(Dest + Total, Block.GetData() + BlockOffset, Chunk);
+		}
+		BlockOffset += Chunk;
+		Total += Chunk;
+	}
+	return Total;
+}
+
+bool ZUTarGzReader::StreamError() const
+{
+	UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is truncated or not a valid gzip stream"), *ArchivePath);
+	return false;
+}
+
+bool ZUTarGzReader::Skip(int64 Count)
+{
+	return Read(nullptr, Count) == Count;
+}
+
+bool ZUTarGzReader::ReadString(int64 Size, FString& OutString)
+{
+	TArray<uint8> Data;
+	Data.SetNumUninitialized(Size);
+	if (Read(Data.GetData(), Size) != Size)
+	{
+		return false;
+	}
+
+	OutString = DecodeName(Data.GetData(), FieldLength(Data.GetData(), Data.Num()));
+	return true;
+}
+
+bool ZUTarGzReader::ReadPaxRecords(int64 Size, FString& OutName, int64& OutSize)
+{
+	TArray<uint8> Data;
+	Data.SetNumUninitialized(Size);
+	if (Read(Data.GetData(), Size) != Size)
+	{
+		return StreamError();
+	}
+
+	int64 Offset = 0;
+	while (Offset < Size)
+	{
+		int64 Length = 0;
+		int64 Cursor = Offset;
+		while (Cursor < Size && Data[Cursor] >= '0' && Data[Cursor] <= '9')
+		{
+			Length = Length * 10 + (Data[Cursor++] - '0');
+		}
+
+		const int64 End = Offset + Length;
+		if (Length == 0 || End > Size || Cursor >= End || Data[Cursor] != ' ' || Data[End - 1] != '\n')
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Corrupt pax header in %s"), *ArchivePath);
+			return false;
+		}
+
+		const int64 KeyStart = Cursor + 1;
+		int64 Equals = KeyStart;
+		while (Equals < End && Data[Equals] != '=')
+		{
+			Equals++;
+		}
+
+		const int64 ValueStart = Equals + 1;
+		const int32 ValueLength = (int32)(End - 1 - ValueStart);
+		if (Equals < End && ValueLength >= 0)
+		{
+			const int64 KeyLength = Equals - KeyStart;
+			if (KeyLength == 4 && FMemory::Memcmp(&Data[KeyStart], "path", 4) == 0)
+			{
+				OutName = DecodeName(&Data[ValueStart], ValueLength);
+			}
+			else if (KeyLength == 4 && FMemory::Memcmp(&Data[KeyStart], "size", 4) == 0)
+			{
+				uint64 Value = 0;
+				bool bValid = ValueLength > 0;
+				for (int64 Index = ValueStart; Index < End - 1 && bValid; Index++)
+				{
+					bValid = Data[Index] >= '0' && Data[Index] <= '9' && Value <= (MaxEntrySize - (Data[Index] - '0')) / 10;
+					Value = Value * 10 + (Data[Index] - '0');
+				}
+				if (!bValid)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Corrupt pax size in %s"), *ArchivePath);
+					return false;
+				}
+				OutSize = (int64)Value;
+			}
+		}
+		Offset = End;
+	}
+	return true;
+}
+
+bool ZUTarGzExtractor::Open(const FString& ArchivePath)
+{
+	return Reader.Open(ArchivePath);
+}
+
+bool ZUTarGzExtractor::ExtractArchive(const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	return ExtractEntries(nullptr, nullptr, Directory, Callback);
+}
+
+bool ZUTarGzExtractor::ExtractFilesFromArchive(const TArray<int32>& FileIndices, const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	const TSet<int32> Selected(FileIndices);
+	return ExtractEntries(&Selected, nullptr, Directory, Callback);
+}
+
+bool ZUTarGzExtractor::ExtractMatching(const ZUEntryFilter& Filter, const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	return ExtractEntries(nullptr, &Filter, Directory, Callback);
+}
+
+bool ZUTarGzExtractor::ExtractEntries(const TSet<int32>* Selected, const ZUEntryFilter* Filter, const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	const TString ArchiveName = *Reader.GetArchivePath();
+
+	//Nothing short of reading the whole stream gives the real total
+	Callback->OnStartWithTotal(ArchiveName, Reader.GetEstimatedSize());
+
+	ZUDirectoryCache Directories(Directory);
+	ZUBatchedFileWriter Writer;
+	Writer.OnFileWritten = [Callback, &ArchiveName](const FString& Path, uint64 Bytes)
+	{
+		Callback->OnFileDone(ArchiveName, *Path, Bytes);
+	};
+
+	bool bSuccess = true;
+	int32 Index = 0;
+
+	const bool bRead = Reader.ForEachEntry([&](const FZUTarEntry& Entry)
+	{
+		const int32 EntryIndex = Index++;
+		if (Callback->OnCheckBreak())
+		{
+			bSuccess = false;
+			return false;
+		}
+
+		if ((Selected != nullptr && !Selected->Contains(EntryIndex)) || (Filter != nullptr && !Filter->Matches(Entry.Name)))
+		{
+			return true;
+		}
+
+		FString RelativePath;
+		if (!ZUDirectoryCache::MakeRelativePath(Entry.Name, RelativePath))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Skipping unsafe entry name %s in %s"), *Entry.Name, *Reader.GetArchivePath());
+			bSuccess = false;
+			return true;
+		}
+
+		//The stream can't be listed up front, so directories are created as entries come in, each only once
+		Directories.AddEntry(RelativePath, Entry.bIsDirectory);
+		if (!Directories.Materialize())
+		{
+			bSuccess = false;
+			return false;
+		}
+
+		if (Entry.bIsDirectory)
+		{
+			return true;
+		}
+
+		const FString OutputPath = FPaths::Combine(Directory, RelativePath);
+		if (Entry.Size >= LargeEntrySize)
+		{
+			bSuccess &= ExtractLargeEntry(Entry, OutputPath, Callback);
+			return true;
+		}
+
+		TArray<uint8> Data;
+		Data.SetNumUninitialized(Entry.Size);
+		if (!Reader.ReadData(Data.GetData(), Entry.Size))
+		{
+			bSuccess = false;
+			return false;
+		}
+
+		bSuccess &= Writer.Enqueue(OutputPath, MoveTemp(Data));
+		return true;
+	});
+
+	bSuccess &= bRead;
+	bSuccess &= Writer.Flush();
+
+	//Indices past the last entry only show up once the whole stream has been read
+	if (bSuccess && Selected != nullptr)
+	{
+		for (int32 SelectedIndex : *Selected)
+		{
+			if (SelectedIndex < 0 || SelectedIndex >= Index)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: File index %d out of range for %s"), SelectedIndex, *Reader.GetArchivePath());
+				bSuccess = false;
+			}
+		}
+	}
+
+	return bSuccess;
+}
+
+bool ZUTarGzExtractor::ExtractLargeEntry(const FZUTarEntry& Entry, const FString& OutputPath, SevenZip::ProgressCallback* Callback)
+{
+	const TString ArchiveName = *Reader.GetArchivePath();
+
+	ZULargeFileWriter FileWriter;
+	if (!FileWriter.Open(OutputPath, Entry.Size, Entry.Size >= UnbufferedEntrySize))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open %s for writing"), *OutputPath);
+		return false;
+	}
+
+	TArray<uint8> Chunk;
+	Chunk.SetNumUninitialized(PipeBlockSize);
+
+	int64 Written = 0;
+	int64 LastReported = 0;
+	bool bSuccess = true;
+
+	while (bSuccess && Written < Entry.Size)
+	{
+		const int64 Count = FMath::Min(Entry.Size - Written, PipeBlockSize);
+		bSuccess = !Callback->OnCheckBreak() && Reader.ReadData(Chunk.GetData(), Count) && FileWriter.Append(Chunk.GetData(), Count);
+		Written += Count;
+
+		if (Written - LastReported >= LargeEntryProgressInterval)
+		{
+			Callback->OnProgress(ArchiveName, Written);
+			LastReported = Written;
+		}
+	}
+
+	const bool bClosed = FileWriter.Close(false);
+	if (!bSuccess || !bClosed)
+	{
+		return false;
+	}
+
+	Callback->OnFileDone(ArchiveName, *OutputPath, Written);
+	return true;
+}
+
+bool ZUTarGzExtractor::ListArchive(SevenZipCallbackHandler* Callback)
+{
+	const TString ArchiveName = *Reader.GetArchivePath();
+
+	const bool bRead = Reader.ForEachEntry([&](const FZUTarEntry& Entry)
+	{
+		Callback->OnEntryFound(ArchiveName, Entry.Name, Entry.Size);
+		return true;
+	});
+
+	Callback->OnListingDone(ArchiveName);
+	return bRead;
+}
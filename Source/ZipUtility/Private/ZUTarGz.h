@@ -0,0 +1,141 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "ZUSourceScanner.h"
+#include "ZUBlockPipe.h"
+
+namespace SevenZip
+{
+	class ProgressCallback;
+}
+class SevenZipCallbackHandler;
+class IFileHandle;
+class ZUEntryFilter;
+
+/** A file or directory as described by its tar header(s). */
+struct FZUTarEntry
+{
+	FString Name;
+	int64 Size = 0;
+	FDateTime ModifiedTime;
+	bool bIsDirectory = false;
+};
+
+/**
+ * Writes .tar.gz in a single pass. The calling thread packs files into a ustar stream while a
+ * background thread gzips the packed blocks into the archive, so there is no intermediate .tar and
+ * packing overlaps compression.
+ */
+class ZUTarGzCompressor
+{
+public:
+	ZUTarGzCompressor(const FString& InArchivePath);
+
+	// zlib level, 0 still writes a valid gzip stream of stored blocks
+	void SetCompressionLevel(int32 InLevel);
+
+	// Adds the directory itself as the archive's root folder, like SevenZipCompressor.
+	// OnDone is left to the caller, which knows from the result whether it succeeded.
+	bool CompressDirectory(const FString& Directory, SevenZip::ProgressCallback* Callback);
+	bool CompressFile(const FString& FilePath, SevenZip::ProgressCallback* Callback);
+
+private:
+	bool CompressFiles(ZUSourceScanner& Sources, SevenZip::ProgressCallback* Callback);
+
+	bool AddFile(const FZUSourceFile& File);
+
+	// Writes a ustar header, preceded by a pax header if the name or size don't fit ustar
+	bool AddHeader(const FString& Name, int64 Size, const FDateTime& ModifiedTime, bool bIsDirectory);
+
+	bool Append(const uint8* Data, int64 Size);
+	bool AppendZeros(int64 Size);
+	bool PadTo(int64 RecordSize);
+	bool FlushBlock();
+
+	FString ArchivePath;
+	int32 Level;
+
+	TUniquePtr<ZUBlockPipe> Pipe;
+	TArray<uint8> Block;
+	int64 StreamOffset;
+};
+
+/**
+ * Reads .tar.gz in a single pass. A background thread inflates the archive into a pipe while the
+ * calling thread walks the tar headers and takes entry data straight out of the inflated blocks.
+ */
+class ZUTarGzReader
+{
+public:
+	ZUTarGzReader();
+	~ZUTarGzReader();
+
+	bool Open(const FString& InArchivePath);
+	void Close();
+
+	// Visits entries in stream order, return false to stop. The visitor may consume the entry's data
+	// with ReadData, whatever it leaves is skipped. Returns false if the stream is corrupt.
+	bool ForEachEntry(TFunctionRef<bool(const FZUTarEntry& Entry)> Visitor);
+
+	// Only valid inside the visitor, for at most the bytes left in the current entry
+	bool ReadData(uint8* Dest, int64 Count);
+
+	// From the gzip trailer, which only keeps the size modulo 4GB
+	uint64 GetEstimatedSize() const { return EstimatedSize; }
+
+	const FString& GetArchivePath() const { return ArchivePath; }
+
+private:
+	// Returns the number of bytes read, short only at the end of the stream
+	int64 Read(uint8* Dest, int64 Count);
+	bool Skip(int64 Count);
+
+	// Logs that the inflate stage gave up and returns false
+	bool StreamError() const;
+
+	bool ReadString(int64 Size, FString& OutString);
+	bool ReadPaxRecords(int64 Size, FString& OutName, int64& OutSize);
+
+	FString ArchivePath;
+	uint64 EstimatedSize;
+
+	//Sizes read from headers above this are corrupt
+	uint64 MaxEntrySize;
+
+	IFileHandle* Handle;
+	TUniquePtr<ZUBlockPipe> Pipe;
+	TFuture<void> InflateStage;
+	bool bInflateSuccess;
+
+	TArray<uint8> Block;
+	int64 BlockOffset;
+	int64 EntryRemaining;
+};
+
+/**
+ * Native extraction and listing of .tar.gz archives through ZUTarGzReader. Indices count entries in
+ * stream order, the same numbering ListArchive reports.
+ */
+class ZUTarGzExtractor
+{
+public:
+	bool Open(const FString& ArchivePath);
+
+	// The extract calls leave OnDone to the caller, like the compressors
+	bool ExtractArchive(const FString& Directory, SevenZip::ProgressCallback* Callback);
+	bool ExtractFilesFromArchive(const TArray<int32>& FileIndices, const FString& Directory, SevenZip::ProgressCallback* Callback);
+
+	// Entries Filter doesn't match are skipped over in the stream without being written
+	bool ExtractMatching(const ZUEntryFilter& Filter, const FString& Directory, SevenZip::ProgressCallback* Callback);
+
+	bool ListArchive(SevenZipCallbackHandler* Callback);
+
+private:
+	// Null Selected and Filter extract everything
+	bool ExtractEntries(const TSet<int32>* Selected, const ZUEntryFilter* Filter, const FString& Directory, SevenZip::ProgressCallback* Callback);
+
+	bool ExtractLargeEntry(const FZUTarEntry& Entry, const FString& OutputPath, SevenZip::ProgressCallback* Callback);
+
+	ZUTarGzReader Reader;
+};
@@ -0,0 +1,336 @@
+#include "ZUVolumeFile.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	//Keeps a fast producer from queueing a whole volume set in memory
+	const int64 MaxInFlightBytes = 64 * 1024 * 1024;
+
+	//Anything smaller would mostly produce file handles
+	const int64 MinVolumeSize = 64 * 1024;
+}
+
+FString ZUVolumeSet::GetVolumePath(const FString& BasePath, int32 Index)
+{
+	return FString::Printf(TEXT("%s.%03d"), *BasePath, Index + 1);
+}
+
+bool ZUVolumeSet::IsFirstVolume(const FString& Path)
+{
+	return Path.EndsWith(TEXT(".001"));
+}
+
+FString ZUVolumeSet::ResolveArchivePath(const FString& ArchivePath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (PlatformFile.FileExists(*ArchivePath))
+	{
+		return ArchivePath;
+	}
+
+	const FString FirstVolume = GetVolumePath(ArchivePath, 0);
+	return PlatformFile.FileExists(*FirstVolume) ? FirstVolume : ArchivePath;
+}
+
+ZUVolumeWriter::ZUVolumeWriter()
+{
+	VolumeSize = 0;
+	InFlightBytes = 0;
+	bIsOpen = false;
+	bFailed = false;
+}
+
+ZUVolumeWriter::~ZUVolumeWriter()
+{
+	if (bIsOpen)
+	{
+		Abort();
+	}
+}
+
+bool ZUVolumeWriter::Open(const FString& InBasePath, int64 InVolumeSize)
+{
+	BasePath = InBasePath;
+	VolumeSize = FMath::Max(InVolumeSize, MinVolumeSize);
+	Volumes.Empty();
+	Pending.Empty();
+	InFlightBytes = 0;
+	bIsOpen = true;
+	bFailed = false;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.DeleteFile(*BasePath);
+	for (int32 Index = 0; PlatformFile.FileExists(*ZUVolumeSet::GetVolumePath(BasePath, Index)); Index++)
+	{
+		PlatformFile.DeleteFile(*ZUVolumeSet::GetVolumePath(BasePath, Index));
+	}
+
+	return OpenNextVolume();
+}
+
+bool ZUVolumeWriter::Write(TArray<uint8>&& Data)
+{
+	if (bFailed || !bIsOpen)
+	{
+		return false;
+	}
+
+	//Shared by every volume the block ends up spanning
+	const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> Block = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Data));
+	FThreadSafeBool* Failed = &bFailed;
+
+	int64 Consumed = 0;
+	while (Consumed < Block->Num())
+	{
+		if (Volumes.Last().Written == VolumeSize && !OpenNextVolume())
+		{
+			return false;
+		}
+
+		const int32 Index = Volumes.Num() - 1;
+		FVolume& Volume = Volumes[Index];
+		IFileHandle* Handle = Volume.Handle;
+		const int64 Start = Consumed;
+		const int64 Size = FMath::Min(Block->Num() - Consumed, VolumeSize - Volume.Written);
+
+		FGraphEventArray Prerequisites;
+		if (Volume.LastWrite.IsValid())
+		{
+			Prerequisites.Add(Volume.LastWrite);
+		}
+
+		Volume.LastWrite = FFunctionGraphTask::CreateAndDispatchWhenReady([Block, Start, Size, Handle, Failed]
+		{
+			if (!*Failed && !Handle->Write(Block->GetData() + Start, Size))
+			{
+				*Failed = true;
+			}
+		}, TStatId(), &Prerequisites, ENamedThreads::AnyThread);
+
+		Pending.Add({ Volume.LastWrite, Size });
+		InFlightBytes += Size;
+		Volume.Written += Size;
+		Consumed += Size;
+
+		if (Volume.Written == VolumeSize)
+		{
+			CloseVolume(Index);
+		}
+	}
+
+	WaitForWrites(MaxInFlightBytes);
+	return !bFailed;
+}
+
+bool ZUVolumeWriter::Close()
+{
+	FGraphEventArray Events;
+	for (int32 Index = 0; Index < Volumes.Num(); Index++)
+	{
+		CloseVolume(Index);
+		if (Volumes[Index].LastWrite.IsValid())
+		{
+			Events.Add(Volumes[Index].LastWrite);
+		}
+	}
+
+	FTaskGraphInterface::Get().WaitUntilTasksComplete(Events);
+	Pending.Empty();
+	InFlightBytes = 0;
+	bIsOpen = false;
+
+	if (bFailed)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to write volumes of %s"), *BasePath);
+	}
+	return !bFailed;
+}
+
+void ZUVolumeWriter::Abort()
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	for (int32 Index = 0; Index < Volumes.Num(); Index++)
+	{
+		PlatformFile.DeleteFile(*ZUVolumeSet::GetVolumePath(BasePath, Index));
+	}
+	Volumes.Empty();
+}
+
+bool ZUVolumeWriter::OpenNextVolume()
+{
+	const FString VolumePath = ZUVolumeSet::GetVolumePath(BasePath, Volumes.Num());
+
+	FVolume Volume;
+	Volume.Handle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*VolumePath);
+	if (Volume.Handle == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open volume %s for writing"), *VolumePath);
+		bFailed = true;
+		return false;
+	}
+
+	Volumes.Add(Volume);
+	return true;
+}
+
+void ZUVolumeWriter::CloseVolume(int32 Index)
+{
+	FVolume& Volume = Volumes[Index];
+	if (Volume.Handle == nullptr)
+	{
+		return;
+	}
+
+	//The handle goes away on a worker too, once the last block for this volume is out
+	IFileHandle* Handle = Volume.Handle;
+	Volume.Handle = nullptr;
+
+	FGraphEventArray Prerequisites;
+	if (Volume.LastWrite.IsValid())
+	{
+		Prerequisites.Add(Volume.LastWrite);
+	}
+
+	Volume.LastWrite = FFunctionGraphTask::CreateAndDispatchWhenReady([Handle]
+	{
+		delete Handle;
+	}, TStatId(), &Prerequisites, ENamedThreads::AnyThread);
+}
+
+void ZUVolumeWriter::WaitForWrites(int64 MaxInFlight)
+{
+	int32 Finished = 0;
+	while (Finished < Pending.Num() && (InFlightBytes > MaxInFlight || Pending[Finished].Event->IsComplete()))
+	{
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(Pending[Finished].Event);
+		InFlightBytes -= Pending[Finished].Size;
+		Finished++;
+	}
+	Pending.RemoveAt(0, Finished, false);
+}
+
+ZUVolumeReader::ZUVolumeReader()
+{
+	Handle = nullptr;
+	HandleIndex = INDEX_NONE;
+}
+
+ZUVolumeReader::~ZUVolumeReader()
+{
+	Close();
+}
+
+bool ZUVolumeReader::Open(const FString& Path)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const bool bIsSet = ZUVolumeSet::IsFirstVolume(Path);
+	const FString BasePath = bIsSet ? Path.LeftChop(4) : Path;
+
+	int64 Offset = 0;
+	for (int32 Index = 0; Index == 0 || bIsSet; Index++)
+	{
+		const FString VolumePath = bIsSet ? ZUVolumeSet::GetVolumePath(BasePath, Index) : Path;
+		const int64 VolumeSize = PlatformFile.FileSize(*VolumePath);
+		if (VolumeSize < 0)
+		{
+			break;
+		}
+
+		Paths.Add(VolumePath);
+		Starts.Add(Offset);
+		Offset += VolumeSize;
+	}
+
+	if (Paths.Num() == 0)
+	{
+		return false;
+	}
+	Starts.Add(Offset);
+
+	if (!SelectVolume(0))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void ZUVolumeReader::Close()
+{
+	if (Handle != nullptr)
+	{
+		delete Handle;
+		Handle = nullptr;
+	}
+	HandleIndex = INDEX_NONE;
+	Paths.Empty();
+	Starts.Empty();
+}
+
+bool ZUVolumeReader::ReadAt(uint64 Offset, uint8* Dest, uint64 Count)
+{
+	if (!IsOpen() || Offset + Count > (uint64)Size())
+	{
+		return false;
+	}
+
+	//Last volume starting at or before the offset, empty volumes are skipped by the loop below
+	int32 Index = Algo::UpperBound(Starts, (int64)Offset) - 1;
+
+	while (Count > 0)
+	{
+		const uint64 Available = FMath::Min<uint64>(Count, Starts[Index + 1] - Offset);
+		if (Available > 0)
+		{
+			if (!SelectVolume(Index) || !Handle->Seek(Offset - Starts[Index]) || !Handle->Read(Dest, Available))
+			{
+				return false;
+			}
+			Offset += Available;
+			Dest += Available;
+			Count -= Available;
+		}
+		Index++;
+	}
+	return true;
+}
+
+bool ZUVolumeReader::Locate(uint64 Offset, uint64 Count, FString& OutPath, uint64& OutLocalOffset) const
+{
+	if (!IsOpen() || Count == 0 || Offset + Count > (uint64)Size())
+	{
+		return false;
+	}
+
+	const int32 Index = Algo::UpperBound(Starts, (int64)Offset) - 1;
+	if (Offset + Count > (uint64)Starts[Index + 1])
+	{
+		return false;
+	}
+
+	OutPath = Paths[Index];
+	OutLocalOffset = Offset - Starts[Index];
+	return true;
+}
+
+bool ZUVolumeReader::SelectVolume(int32 Index)
+{
+	if (Index == HandleIndex && Handle != nullptr)
+	{
+		return true;
+	}
+
+	if (Handle != nullptr)
+	{
+		delete Handle;
+	}
+	Handle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Paths[Index]);
+	HandleIndex = Handle != nullptr ? Index : INDEX_NONE;
+	return Handle != nullptr;
+}
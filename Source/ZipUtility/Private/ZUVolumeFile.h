@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+
+class IFileHandle;
+
+/**
+ * Volume sets are plain byte splits of one archive named <archive>.001, <archive>.002, ... like 7zip
+ * writes them, so concatenating the volumes gives back the original file.
+ */
+namespace ZUVolumeSet
+{
+	// Path of the volume with the given zero based index
+	FString GetVolumePath(const FString& BasePath, int32 Index);
+
+	// True for the .001 volume that addresses a whole set
+	bool IsFirstVolume(const FString& Path);
+
+	// Returns the path as is if it exists, otherwise its first volume if that exists
+	FString ResolveArchivePath(const FString& ArchivePath);
+}
+
+/**
+ * Writes a single archive stream split into fixed size volumes. Data is handed over in blocks that
+ * are written by task graph workers, chained per volume so each file is still written in order while
+ * different volumes (and the producer) run in parallel. The producer only blocks once too much is
+ * in flight.
+ */
+class ZUVolumeWriter
+{
+public:
+	ZUVolumeWriter();
+	~ZUVolumeWriter();
+
+	// Also removes a previous single file or volume set under the same name, so no stale volume can join the set
+	bool Open(const FString& InBasePath, int64 InVolumeSize);
+
+	bool Write(TArray<uint8>&& Data);
+
+	// Waits for every pending write and closes the last volume. Returns false if any write failed.
+	bool Close();
+
+	// Waits for pending writes and deletes every volume written so far
+	void Abort();
+
+	int32 GetNumVolumes() const { return Volumes.Num(); }
+
+private:
+	struct FVolume
+	{
+		IFileHandle* Handle = nullptr;
+		int64 Written = 0;
+		FGraphEventRef LastWrite;
+	};
+
+	struct FPendingBlock
+	{
+		FGraphEventRef Event;
+		int64 Size;
+	};
+
+	bool OpenNextVolume();
+	void CloseVolume(int32 Index);
+	void WaitForWrites(int64 MaxInFlight);
+
+	FString BasePath;
+	int64 VolumeSize;
+
+	TArray<FVolume> Volumes;
+	TArray<FPendingBlock> Pending;
+	int64 InFlightBytes;
+	bool bIsOpen;
+	FThreadSafeBool bFailed;
+};
+
+/** Random access reads over a single file or a whole volume set, as if it were one file. */
+class ZUVolumeReader
+{
+public:
+	ZUVolumeReader();
+	~ZUVolumeReader();
+
+	// Opens Path on its own, or the whole set if Path is a first volume
+	bool Open(const FString& Path);
+	void Close();
+
+	bool IsOpen() const { return Paths.Num() > 0; }
+	int64 Size() const { return IsOpen() ? Starts.Last() : 0; }
+	int32 GetNumVolumes() const { return Paths.Num(); }
+
+	bool ReadAt(uint64 Offset, uint8* Dest, uint64 Count);
+
+	// The volume file holding a range and where in it the range starts, false if the range crosses into the next volume
+	bool Locate(uint64 Offset, uint64 Count, FString& OutPath, uint64& OutLocalOffset) const;
+
+private:
+	// Only one volume is kept open at a time, large sets would otherwise eat a handle per volume per reader
+	bool SelectVolume(int32 Index);
+
+	TArray<FString> Paths;
+
+	// Start offset of each volume, plus the total size at the end
+	TArray<int64> Starts;
+
+	IFileHandle* Handle;
+	int32 HandleIndex;
+};
@@ -0,0 +1,307 @@
+#include "ZUZipCompressor.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUCrc32.h"
+#include "SevenZipCallbackHandler.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	//Files at least this big are streamed instead of loaded whole
+	const int64 LargeFileSize = 16 * 1024 * 1024;
+
+	const int64 StreamChunkSize = 1024 * 1024;
+
+	bool DeflateBuffer(const uint8* Data, int64 Size, int32 Level, TArray<uint8>& OutCompressed)
+	{
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+
+		if (deflateInit2(&Stream, Level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			return false;
+		}
+
+		OutCompressed.SetNumUninitialized(deflateBound(&Stream, (uLong)Size));
+		Stream.next_in = (Bytef*)Data;
+		Stream.avail_in = (uInt)Size;
+		Stream.next_out = OutCompressed.GetData();
+		Stream.avail_out = (uInt)OutCompressed.Num();
+
+		const bool bSuccess = deflate(&Stream, Z_FINISH) == Z_STREAM_END;
+		OutCompressed.SetNum(Stream.total_out, false);
+		deflateEnd(&Stream);
+		return bSuccess;
+	}
+
+	bool ReadAt(IFileHandle& Handle, int64 Offset, uint8* Dest, int64 Count)
+	{
+		return Handle.Seek(Offset) && Handle.Read(Dest, Count);
+	}
+}
+
+ZUZipCompressor::ZUZipCompressor(const FString& InArchivePath)
+{
+	ArchivePath = InArchivePath;
+	Level = 6;
+	VolumeSize = 0;
+}
+
+void ZUZipCompressor::SetCompressionLevel(int32 InLevel)
+{
+	Level = FMath::Clamp(InLevel, 0, 9);
+}
+
+void ZUZipCompressor::SetVolumeSize(int64 InVolumeSize)
+{
+	VolumeSize = FMath::Max<int64>(InVolumeSize, 0);
+}
+
+bool ZUZipCompressor::CompressDirectory(const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	ZUSourceScanner Sources(Callback, ArchivePath);
+	return Sources.StartDirectory(Directory) && CompressFiles(Sources, Callback);
+}
+
+bool ZUZipCompressor::CompressFile(const FString& FilePath, SevenZip::ProgressCallback* Callback)
+{
+	ZUSourceScanner Sources(Callback, ArchivePath);
+	return Sources.StartFile(FilePath) && CompressFiles(Sources, Callback);
+}
+
+bool ZUZipCompressor::OpenArchive()
+{
+	return (VolumeSize > 0) ? Writer.OpenVolumes(ArchivePath, VolumeSize) : Writer.Open(ArchivePath);
+}
+
+bool ZUZipCompressor::AddSourceFile(const FZUSourceFile& File)
+{
+	if (File.bIsDirectory)
+	{
+		return Writer.AddDirectory(File.EntryName, File.ModifiedTime);
+	}
+
+	FZUCompressionStats& FileStats = Stats[(int32)ZUCompressionProbe::Classify(File.Path)];
+	const double StartTime = FPlatformTime::Seconds();
+
+	const bool bSuccess = (File.Size >= LargeFileSize) ? AddLargeFile(File, FileStats) : AddSmallFile(File, FileStats);
+
+	FileStats.Files++;
+	FileStats.BytesIn += File.Size;
+	FileStats.Seconds += FPlatformTime::Seconds() - StartTime;
+	return bSuccess;
+}
+
+bool ZUZipCompressor::CopyEntry(ZUZipReader& Reader, int32 EntryIndex)
+{
+	return Writer.CopyEntry(Reader, EntryIndex);
+}
+
+bool ZUZipCompressor::CloseArchive()
+{
+	LogStats();
+	return Writer.Close();
+}
+
+void ZUZipCompressor::AbortArchive()
+{
+	Writer.Abort();
+}
+
+bool ZUZipCompressor::CompressFiles(ZUSourceScanner& Sources, SevenZip::ProgressCallback* Callback)
+{
+	if (!OpenArchive())
+	{
+		return false;
+	}
+
+	//Files come in while the tree is still being walked, the scanner reports the start once it has the total
+	bool bSuccess = true;
+	FZUSourceFile File;
+	while (Sources.Next(File))
+	{
+		if (Callback->OnCheckBreak())
+		{
+			bSuccess = false;
+			break;
+		}
+
+		bSuccess = AddSourceFile(File);
+		if (!bSuccess)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to add %s to %s"), *File.Path, *ArchivePath);
+			break;
+		}
+
+		if (!File.bIsDirectory)
+		{
+			Sources.OnFileDone(File);
+		}
+	}
+
+	if (bSuccess)
+	{
+		bSuccess = CloseArchive();
+	}
+	else
+	{
+		Sources.Cancel();
+		LogStats();
+		AbortArchive();
+	}
+
+	Sources.Finish();
+	return bSuccess;
+}
+
+bool ZUZipCompressor::AddSmallFile(const FZUSourceFile& File, FZUCompressionStats& FileStats)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *File.Path))
+	{
+		return false;
+	}
+
+	const uint32 Crc = ZUCrc32::Update(0, Data.GetData(), Data.Num());
+
+	bool bCompress = Level > 0 && !ZUCompressionProbe::IsPrecompressed(File.Path) &&
+		ZUCompressionProbe::IsWorthCompressing(Data.GetData(), FMath::Min<int64>(Data.Num(), ZUCompressionProbe::SampleBlockSize));
+
+	TArray<uint8> Compressed;
+	if (bCompress)
+	{
+		//The sample can be wrong, never keep output that grew
+		bCompress = DeflateBuffer(Data.GetData(), Data.Num(), Level, Compressed) && Compressed.Num() < Data.Num();
+	}
+
+	if (!bCompress)
+	{
+		FileStats.Stored++;
+		FileStats.BytesOut += Data.Num();
+		return Writer.AddEncodedEntry(File.EntryName, ZUZipWriter::MethodStore, Crc, Data.Num(), Data.GetData(), Data.Num(), File.ModifiedTime);
+	}
+
+	FileStats.BytesOut += Compressed.Num();
+	return Writer.AddEncodedEntry(File.EntryName, ZUZipWriter::MethodDeflate, Crc, Data.Num(), Compressed.GetData(), Compressed.Num(), File.ModifiedTime);
+}
+
+bool ZUZipCompressor::AddLargeFile(const FZUSourceFile& File, FZUCompressionStats& FileStats)
+{
+	TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*File.Path));
+	if (!Handle.IsValid())
+	{
+		return false;
+	}
+
+	bool bCompress = Level > 0 && !ZUCompressionProbe::IsPrecompressed(File.Path);
+
+	//Headers alone are often compressible when the payload isn't, so the sample also takes a block from the middle
+	if (bCompress)
+	{
+		const int64 BlockSize = ZUCompressionProbe::SampleBlockSize;
+
+		TArray<uint8> Sample;
+		Sample.SetNumUninitialized(BlockSize * 2);
+		if (!ReadAt(*Handle, 0, Sample.GetData(), BlockSize) || !ReadAt(*Handle, File.Size / 2, Sample.GetData() + BlockSize, BlockSize))
+		{
+			return false;
+		}
+		bCompress = ZUCompressionProbe::IsWorthCompressing(Sample.GetData(), Sample.Num());
+	}
+
+	if (!Handle->Seek(0) || !Writer.BeginEntry(File.EntryName, bCompress ? ZUZipWriter::MethodDeflate : ZUZipWriter::MethodStore, File.ModifiedTime, File.Size))
+	{
+		return false;
+	}
+
+	TArray<uint8> Input;
+	Input.SetNumUninitialized(StreamChunkSize);
+	TArray<uint8> Output;
+
+	z_stream Stream;
+	FMemory::Memzero(Stream);
+	if (bCompress)
+	{
+		if (deflateInit2(&Stream, Level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			return false;
+		}
+		Output.SetNumUninitialized(StreamChunkSize);
+	}
+
+	uint32 Crc = 0;
+	int64 Remaining = File.Size;
+	bool bSuccess = true;
+
+	while (bSuccess && Remaining > 0)
+	{
+		const int64 Count = FMath::Min(Remaining, StreamChunkSize);
+		if (!Handle->Read(Input.GetData(), Count))
+		{
+			bSuccess = false;
+			break;
+		}
+		Crc = ZUCrc32::Update(Crc, Input.GetData(), Count);
+		Remaining -= Count;
+
+		if (!bCompress)
+		{
+			bSuccess = Writer.AppendEntryData(Input.GetData(), Count);
+			FileStats.BytesOut += Count;
+			continue;
+		}
+
+		Stream.next_in = Input.GetData();
+		Stream.avail_in = (uInt)Count;
+		const int Flush = (Remaining == 0) ? Z_FINISH : Z_NO_FLUSH;
+
+		//Drain until deflate has taken all input (and, at the end, emitted the final block)
+		int Result = Z_OK;
+		do
+		{
+			Stream.next_out = Output.GetData();
+			Stream.avail_out = (uInt)Output.Num();
+			Result = deflate(&Stream, Flush);
+
+			const int64 Produced = Output.Num() - Stream.avail_out;
+			if (Result == Z_STREAM_ERROR || (Produced > 0 && !Writer.AppendEntryData(Output.GetData(), Produced)))
+			{
+				bSuccess = false;
+				break;
+			}
+			FileStats.BytesOut += Produced;
+		} while (Stream.avail_out == 0 || (Flush == Z_FINISH && Result != Z_STREAM_END));
+	}
+
+	if (bCompress)
+	{
+		deflateEnd(&Stream);
+	}
+	else
+	{
+		FileStats.Stored++;
+	}
+
+	return bSuccess && Writer.FinishEntry(Crc, File.Size);
+}
+
+void ZUZipCompressor::LogStats() const
+{
+	for (int32 ClassIndex = 0; ClassIndex < (int32)EZUFileClass::Count; ClassIndex++)
+	{
+		const FZUCompressionStats& ClassStats = Stats[ClassIndex];
+		if (ClassStats.Files == 0)
+		{
+			continue;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("ZipUtility: %s: %d files, %d stored, %.1f MB -> %.1f MB, %.1f MB/s"),
+			ZUCompressionProbe::GetClassName((EZUFileClass)ClassIndex), ClassStats.Files, ClassStats.Stored,
+			ClassStats.BytesIn / (1024.0 * 1024.0), ClassStats.BytesOut / (1024.0 * 1024.0),
+			ClassStats.BytesIn / (1024.0 * 1024.0) / FMath::Max(ClassStats.Seconds, 0.001));
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ZUZipWriter.h"
+#include "ZUZipReader.h"
+#include "ZUCompressionProbe.h"
+#include "ZUSourceScanner.h"
+
+namespace SevenZip
+{
+	class ProgressCallback;
+}
+
+/** Per file class totals, logged when an archive is finished. */
+struct FZUCompressionStats
+{
+	int32 Files = 0;
+	int32 Stored = 0;
+	uint64 BytesIn = 0;
+	uint64 BytesOut = 0;
+	double Seconds = 0.0;
+};
+
+/**
+ * Native counterpart of SevenZipCompressor for .zip output. Each file is either deflated or stored
+ * depending on what ZUCompressionProbe makes of it, so already compressed content doesn't cost a
+ * full deflate pass only to come out larger.
+ */
+class ZUZipCompressor
+{
+public:
+	ZUZipCompressor(const FString& InArchivePath);
+
+	// zlib level, 0 stores everything
+	void SetCompressionLevel(int32 InLevel);
+
+	// Splits the output into <archive>.001, .002, ... of this many bytes, 0 writes a single file
+	void SetVolumeSize(int64 InVolumeSize);
+
+	// Adds the directory itself as the archive's root folder, like SevenZipCompressor.
+	// OnDone is left to the caller, which knows from the result whether it succeeded.
+	bool CompressDirectory(const FString& Directory, SevenZip::ProgressCallback* Callback);
+	bool CompressFile(const FString& FilePath, SevenZip::ProgressCallback* Callback);
+
+	// Building an archive one entry at a time, e.g. to update an existing one
+	bool OpenArchive();
+	bool AddSourceFile(const FZUSourceFile& File);
+	bool CopyEntry(ZUZipReader& Reader, int32 EntryIndex);
+	bool CloseArchive();
+	void AbortArchive();
+
+	const FZUCompressionStats& GetStats(EZUFileClass FileClass) const { return Stats[(int32)FileClass]; }
+
+private:
+	bool CompressFiles(ZUSourceScanner& Sources, SevenZip::ProgressCallback* Callback);
+
+	// Whole file in memory, falls back to storing if deflate doesn't shrink it
+	bool AddSmallFile(const FZUSourceFile& File, FZUCompressionStats& FileStats);
+
+	// Streams the file through deflate, the sampled head and middle decide up front
+	bool AddLargeFile(const FZUSourceFile& File, FZUCompressionStats& FileStats);
+
+	void LogStats() const;
+
+	FString ArchivePath;
+	int32 Level;
+	int64 VolumeSize;
+	ZUZipWriter Writer;
+	FZUCompressionStats Stats[(int32)EZUFileClass::Count];
+};
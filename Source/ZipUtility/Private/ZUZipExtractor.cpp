@@ -0,0 +1,417 @@
+#include "ZUZipExtractor.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUFileWriter.h"
+#include "ZUDirectoryCache.h"
+#include "ZUManifest.h"
+#include "ZUHash.h"
+#include "ZUCrc32.h"
+#include "ZUEntryFilter.h"
+#include "SevenZipCallbackHandler.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	//Entries at least this big are streamed to disk instead of going through the batched writer
+	const uint64 LargeEntrySize = 16 * 1024 * 1024;
+
+	//Entries at least this big bypass the page cache
+	const uint64 UnbufferedEntrySize = 512 * 1024 * 1024;
+
+	const uint64 LargeEntryProgressInterval = 32 * 1024 * 1024;
+
+	//Stored entries at least this big are copied file to file, smaller ones are cheaper through the batched writer
+	const uint64 DirectCopyEntrySize = 64 * 1024;
+
+	const int64 ReadBackChunkSize = 1024 * 1024;
+}
+
+bool ZUZipExtractor::Open(const FString& ArchivePath)
+{
+	return Reader.Open(ArchivePath) && Reader.IsSupported();
+}
+
+bool ZUZipExtractor::ExtractArchive(const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	TArray<int32> EntryIndices;
+	EntryIndices.Reserve(Reader.GetEntries().Num());
+
+	for (int32 Index = 0; Index < Reader.GetEntries().Num(); Index++)
+	{
+		EntryIndices.Add(Index);
+	}
+	return ExtractEntries(EntryIndices, Directory, Callback);
+}
+
+bool ZUZipExtractor::ExtractFilesFromArchive(const TArray<int32>& FileIndices, const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	for (int32 Index : FileIndices)
+	{
+		if (!Reader.GetEntries().IsValidIndex(Index))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: File index %d out of range for %s"), Index, *Reader.GetArchivePath());
+			return false;
+		}
+	}
+	return ExtractEntries(FileIndices, Directory, Callback);
+}
+
+bool ZUZipExtractor::ExtractMatching(const ZUEntryFilter& Filter, const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	TArray<int32> EntryIndices;
+	for (int32 Index = 0; Index < Reader.GetEntries().Num(); Index++)
+	{
+		if (Filter.Matches(Reader.GetEntries()[Index].Name))
+		{
+			EntryIndices.Add(Index);
+		}
+	}
+	return ExtractEntries(EntryIndices, Directory, Callback);
+}
+
+bool ZUZipExtractor::ExtractEntries(const TArray<int32>& EntryIndices, const FString& Directory, SevenZip::ProgressCallback* Callback)
+{
+	const TString ArchiveName = *Reader.GetArchivePath();
+	const TArray<FZUZipEntry>& Entries = Reader.GetEntries();
+
+	uint64 TotalBytes = 0;
+	for (int32 Index : EntryIndices)
+	{
+		TotalBytes += Entries[Index].UncompressedSize;
+	}
+	Callback->OnStartWithTotal(ArchiveName, TotalBytes);
+
+	bool bSuccess = true;
+
+	//Resolve every output path first so the directory tree can be created in one go
+	TArray<FString> OutputPaths;
+	TArray<FString> RelativePaths;
+	OutputPaths.SetNum(EntryIndices.Num());
+	RelativePaths.SetNum(EntryIndices.Num());
+
+	ZUDirectoryCache Directories(Directory);
+	for (int32 Position = 0; Position < EntryIndices.Num(); Position++)
+	{
+		const FZUZipEntry& Entry = Entries[EntryIndices[Position]];
+
+		FString RelativePath;
+		if (!ZUDirectoryCache::MakeRelativePath(Entry.GetName(), RelativePath))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Skipping unsafe entry name %s in %s"), Entry.Name.GetData(), *Reader.GetArchivePath());
+			bSuccess = false;
+			continue;
+		}
+
+		Directories.AddEntry(RelativePath, Entry.bIsDirectory);
+		OutputPaths[Position] = FPaths::Combine(Directory, RelativePath);
+		RelativePaths[Position] = MoveTemp(RelativePath);
+	}
+	bSuccess &= Directories.Materialize();
+
+	ZUBatchedFileWriter Writer;
+	Writer.OnFileWritten = [Callback, &ArchiveName](const FString& Path, uint64 Bytes)
+	{
+		Callback->OnFileDone(ArchiveName, *Path, Bytes);
+	};
+
+	TArray<uint8> Data;
+	FString StoredPath;
+	uint64 StoredOffset = 0;
+
+	for (int32 Position = 0; Position < EntryIndices.Num(); Position++)
+	{
+		if (Callback->OnCheckBreak())
+		{
+			bSuccess = false;
+			break;
+		}
+
+		const int32 Index = EntryIndices[Position];
+		const FZUZipEntry& Entry = Entries[Index];
+		const FString& OutputPath = OutputPaths[Position];
+
+		if (Entry.bIsDirectory || OutputPath.IsEmpty())
+		{
+			continue;
+		}
+
+		if (Entry.UncompressedSize >= DirectCopyEntrySize && Reader.GetStoredRange(Index, StoredPath, StoredOffset))
+		{
+			bSuccess &= ExtractStoredEntry(Index, StoredPath, StoredOffset, OutputPath, RelativePaths[Position], Callback);
+			continue;
+		}
+
+		if (Entry.UncompressedSize >= LargeEntrySize)
+		{
+			bSuccess &= ExtractLargeEntry(Index, OutputPath, RelativePaths[Position], Callback);
+			continue;
+		}
+
+		if (!Reader.ReadEntry(Index, Data))
+		{
+			bSuccess = false;
+			continue;
+		}
+
+		//Hashed while still in memory, the manifest never reads the written files back
+		if (Manifest)
+		{
+			AddToManifest(Entry, RelativePaths[Position], ZUHash::HashBuffer(Data.GetData(), Data.Num()));
+		}
+
+		bSuccess &= Writer.Enqueue(OutputPath, MoveTemp(Data));
+	}
+
+	bSuccess &= Writer.Flush();
+
+	if (Manifest)
+	{
+		Manifest->Sort();
+		bSuccess &= ManifestSavePath.IsEmpty() || Manifest->Save(ManifestSavePath);
+	}
+
+	return bSuccess;
+}
+
+bool ZUZipExtractor::ExtractLargeEntry(int32 EntryIndex, const FString& OutputPath, const FString& RelativePath, SevenZip::ProgressCallback* Callback)
+{
+	const TString ArchiveName = *Reader.GetArchivePath();
+	const FZUZipEntry& Entry = Reader.GetEntries()[EntryIndex];
+
+	ZULargeFileWriter FileWriter;
+	if (!FileWriter.Open(OutputPath, Entry.UncompressedSize, Entry.UncompressedSize >= UnbufferedEntrySize))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open %s for writing"), *OutputPath);
+		return false;
+	}
+
+	uint64 Written = 0;
+	uint64 LastReported = 0;
+	ZUHash Hash;
+
+	const bool bRead = Reader.ReadEntryStreamed(EntryIndex, [&](const uint8* Data, int64 Size)
+	{
+		if (Callback->OnCheckBreak() || !FileWriter.Append(Data, Size))
+		{
+			return false;
+		}
+
+		if (Manifest)
+		{
+			Hash.Update(Data, Size);
+		}
+
+		Written += Size;
+		if (Written - LastReported >= LargeEntryProgressInterval)
+		{
+			Callback->OnProgress(ArchiveName, Written);
+			LastReported = Written;
+		}
+		return true;
+	});
+
+	const bool bClosed = FileWriter.Close(false);
+	if (!bRead || !bClosed)
+	{
+		return false;
+	}
+
+	if (Manifest)
+	{
+		AddToManifest(Entry, RelativePath, Hash.Finalize());
+	}
+
+	Callback->OnFileDone(ArchiveName, *OutputPath, Written);
+	return true;
+}
+
+bool ZUZipExtractor::ExtractStoredEntry(int32 EntryIndex, const FString& SourcePath, uint64 SourceOffset, const FString& OutputPath, const FString& RelativePath, SevenZip::ProgressCallback* Callback)
+{
+	const TString ArchiveName = *Reader.GetArchivePath();
+	const FZUZipEntry& Entry = Reader.GetEntries()[EntryIndex];
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!ZUFileRangeCopy::Copy(SourcePath, SourceOffset, Entry.UncompressedSize, OutputPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to copy %s out of %s"), Entry.Name.GetData(), *Reader.GetArchivePath());
+		PlatformFile.DeleteFile(*OutputPath);
+		return false;
+	}
+
+	//The copy never passed through here, so checking it or hashing it for the manifest means reading it back
+	if (bVerifyStoredEntries || Manifest)
+	{
+		TUniquePtr<IFileHandle> Handle(PlatformFile.OpenRead(*OutputPath));
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(FMath::Min<uint64>(Entry.UncompressedSize, ReadBackChunkSize));
+
+		uint32 Crc = 0;
+		ZUHash Hash;
+		uint64 Read = 0;
+		while (Handle && Read < Entry.UncompressedSize)
+		{
+			const int64 Chunk = FMath::Min<uint64>(Entry.UncompressedSize - Read, Buffer.Num());
+			if (Callback->OnCheckBreak() || !Handle->Read(Buffer.GetData(), Chunk))
+			{
+				break;
+			}
+			if (bVerifyStoredEntries)
+			{
+				Crc = ZUCrc32::Update(Crc, Buffer.GetData(), Chunk);
+			}
+			if (Manifest)
+			{
+				Hash.Update(Buffer.GetData(), Chunk);
+			}
+			Read += Chunk;
+		}
+		Handle.Reset();
+
+		if (Read != Entry.UncompressedSize || (bVerifyStoredEntries && Crc != Entry.Crc32))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Size or CRC mismatch for %s in %s"), Entry.Name.GetData(), *Reader.GetArchivePath());
+			PlatformFile.DeleteFile(*OutputPath);
+			return false;
+		}
+
+		if (Manifest)
+		{
+			AddToManifest(Entry, RelativePath, Hash.Finalize());
+		}
+	}
+
+	Callback->OnFileDone(ArchiveName, *OutputPath, Entry.UncompressedSize);
+	return true;
+}
+
+void ZUZipExtractor::SetManifest(ZUManifest* InManifest, const FString& InSavePath)
+{
+	Manifest = InManifest;
+	ManifestSavePath = InSavePath;
+}
+
+void ZUZipExtractor::AddToManifest(const FZUZipEntry& Entry, const FString& RelativePath, uint64 Hash)
+{
+	FZUManifestEntry ManifestEntry;
+	ManifestEntry.Path = RelativePath;
+	ManifestEntry.Size = Entry.UncompressedSize;
+	ManifestEntry.ModifiedTime = ZUZipReader::FromDosTime(Entry.DosTime);
+	ManifestEntry.Hash = Hash;
+	Manifest->Add(MoveTemp(ManifestEntry));
+}
+
+bool ZUZipExtractor::TestArchive(SevenZipCallbackHandler* Callback)
+{
+	const TString ArchiveName = *Reader.GetArchivePath();
+	const TArray<FZUZipEntry>& Entries = Reader.GetEntries();
+
+	TArray<int32> Order;
+	uint64 TotalBytes = 0;
+	for (int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		if (!Entries[Index].bIsDirectory)
+		{
+			Order.Add(Index);
+			TotalBytes += Entries[Index].UncompressedSize;
+		}
+	}
+
+	//Biggest first so a large entry doesn't end up running alone at the tail
+	Order.Sort([&Entries](int32 A, int32 B)
+	{
+		return Entries[A].UncompressedSize > Entries[B].UncompressedSize;
+	});
+
+	Callback->OnStartWithTotal(ArchiveName, TotalBytes);
+
+	const int32 NumWorkers = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, 1, FMath::Max(Order.Num(), 1));
+	const double StartTime = FPlatformTime::Seconds();
+
+	FThreadSafeCounter NextPosition;
+	FThreadSafeCounter NumTested;
+	FThreadSafeCounter NumFailed;
+	FThreadSafeBool bStopped = false;
+	FCriticalSection CallbackLock;
+	uint64 TestedBytes = 0;
+
+	ParallelFor(NumWorkers, [&](int32 Worker)
+	{
+		//The reader seeks on a single handle, so every worker gets its own
+		ZUZipReader WorkerReader;
+		if (!WorkerReader.OpenFrom(Reader))
+		{
+			return;
+		}
+
+		TArray<uint8> Data;
+		for (;;)
+		{
+			const int32 Position = NextPosition.Increment() - 1;
+			if (Position >= Order.Num())
+			{
+				return;
+			}
+			if (Callback->OnCheckBreak())
+			{
+				bStopped = true;
+				return;
+			}
+
+			const int32 Index = Order[Position];
+			const FZUZipEntry& Entry = Entries[Index];
+
+			bool bValid = false;
+			if (Entry.UncompressedSize >= LargeEntrySize)
+			{
+				bValid = WorkerReader.ReadEntryStreamed(Index, [Callback](const uint8* Chunk, int64 Size)
+				{
+					return !Callback->OnCheckBreak();
+				});
+			}
+			else
+			{
+				bValid = WorkerReader.ReadEntry(Index, Data);
+			}
+
+			//A streamed read cut short by a stop isn't a corrupt entry, it just wasn't tested
+			if (!bValid && Callback->OnCheckBreak())
+			{
+				bStopped = true;
+				return;
+			}
+			NumTested.Increment();
+
+			//The handler keeps a running byte count, so events are serialized
+			FScopeLock Lock(&CallbackLock);
+			TestedBytes += Entry.UncompressedSize;
+			if (bValid)
+			{
+				Callback->OnFileDone(ArchiveName, Entry.Name.GetData(), Entry.UncompressedSize);
+			}
+			else
+			{
+				NumFailed.Increment();
+				Callback->OnFileFailed(ArchiveName, Entry.Name.GetData());
+			}
+		}
+	});
+
+	const double Elapsed = FMath::Max(FPlatformTime::Seconds() - StartTime, 0.001);
+
+	FZipUtilityTestResult Result;
+	Result.TotalFiles = Order.Num();
+	Result.TestedFiles = NumTested.GetValue();
+	Result.FailedFiles = NumFailed.GetValue();
+	Result.TestedBytes = (int64)TestedBytes;
+	Result.Seconds = (float)Elapsed;
+	Result.MegabytesPerSecond = (float)(TestedBytes / (1024.0 * 1024.0) / Elapsed);
+	Result.bAborted = bStopped;
+
+	UE_LOG(LogTemp, Log, TEXT("ZipUtility: Tested %d of %d entries in %s, %d failed, %.1f MB/s%s"),
+		Result.TestedFiles, Result.TotalFiles, *Reader.GetArchivePath(), Result.FailedFiles, Result.MegabytesPerSecond, Result.bAborted ? TEXT(", stopped") : TEXT(""));
+	Callback->OnTestResult(ArchiveName, Result);
+
+	const bool bSuccess = NumFailed.GetValue() == 0 && NumTested.GetValue() == Order.Num();
+	Callback->OnDoneWithState(ArchiveName, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+	return bSuccess;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ZUZipReader.h"
+
+namespace SevenZip
+{
+	class ProgressCallback;
+}
+class SevenZipCallbackHandler;
+class ZUManifest;
+class ZUEntryFilter;
+
+/**
+ * Native counterpart of SevenZipExtractor for .zip archives. Decodes entries with ZUZipReader and
+ * hands the output to a ZUBatchedFileWriter, reporting through the same 7zpp ProgressCallback.
+ */
+class ZUZipExtractor
+{
+public:
+	// Returns true if the archive is a zip that can be extracted natively, otherwise use 7zpp
+	bool Open(const FString& ArchivePath);
+
+	// OnDone is left to the caller, which knows from the result whether it succeeded
+	bool ExtractArchive(const FString& Directory, SevenZip::ProgressCallback* Callback);
+	bool ExtractFilesFromArchive(const TArray<int32>& FileIndices, const FString& Directory, SevenZip::ProgressCallback* Callback);
+
+	// Extracts only the entries Filter matches, the others are never read
+	bool ExtractMatching(const ZUEntryFilter& Filter, const FString& Directory, SevenZip::ProgressCallback* Callback);
+
+	// Decodes and verifies every entry in parallel without writing anything. Failed entries go to OnFileFailed.
+	bool TestArchive(SevenZipCallbackHandler* Callback);
+
+	// Set before extracting. Every extracted file is hashed while it is decoded and added to the manifest, which is
+	// sorted once done and, with a SavePath, written there before OnDone is reported
+	void SetManifest(ZUManifest* InManifest, const FString& InSavePath = FString());
+
+	// Stored entries are copied from the archive file by the kernel without being decoded. On by default, turning
+	// it off skips reading the copies back to check their CRC
+	void SetVerifyStoredEntries(bool bInVerify) { bVerifyStoredEntries = bInVerify; }
+
+private:
+	bool ExtractEntries(const TArray<int32>& EntryIndices, const FString& Directory, SevenZip::ProgressCallback* Callback);
+
+	// Streams one large entry straight into a preallocated output file
+	bool ExtractLargeEntry(int32 EntryIndex, const FString& OutputPath, const FString& RelativePath, SevenZip::ProgressCallback* Callback);
+
+	// Copies one stored entry's bytes straight from the archive, see ZUFileRangeCopy
+	bool ExtractStoredEntry(int32 EntryIndex, const FString& SourcePath, uint64 SourceOffset, const FString& OutputPath, const FString& RelativePath, SevenZip::ProgressCallback* Callback);
+
+	void AddToManifest(const FZUZipEntry& Entry, const FString& RelativePath, uint64 Hash);
+
+	ZUZipReader Reader;
+	ZUManifest* Manifest = nullptr;
+	FString ManifestSavePath;
+	bool bVerifyStoredEntries = true;
+};
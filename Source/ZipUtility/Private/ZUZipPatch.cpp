@@ -0,0 +1,1100 @@
+#include "ZUZipPatch.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUZipReader.h"
+#include "ZUZipWriter.h"
+#include "ZUCrc32.h"
+#include "ZUHash.h"
+#include "SevenZipCallbackHandler.h"
+#include "HAL/PlatformFilemanager.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	const uint8 PatchMagic[4] = { 'Z', 'U', 'P', 'T' };
+	const uint8 PatchVersion = 1;
+
+	enum class EPatchRecord : uint8
+	{
+		Directory,
+		Copy,
+		Delta,
+		Full
+	};
+
+	const int64 StreamChunkSize = 1024 * 1024;
+
+	//Both versions of an entry are held in memory while its delta is worked out, bigger entries go in full
+	const uint64 MaxDeltaEntrySize = 256 * 1024 * 1024;
+
+	//Old content a delta refers to is kept in memory up to this size, beyond that it is read back from a temporary file
+	const uint64 MaxInMemoryOldSize = 64 * 1024 * 1024;
+
+	//Shortest run of old content looked up for a copy instruction
+	const int32 DeltaBlockSize = 32;
+	const uint32 HashMultiplier = 0x01000193;
+
+	const int64 MaxNameLength = 64 * 1024;
+
+	void WriteVarInt(TArray<uint8>& Out, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add((uint8)Value);
+	}
+
+	uint64 ContentKey(const FZUZipEntry& Entry)
+	{
+		return ((uint64)Entry.Crc32 << 32) ^ Entry.UncompressedSize;
+	}
+
+	bool IsSameContent(const FZUZipEntry& A, const FZUZipEntry& B)
+	{
+		return !A.bIsDirectory && !B.bIsDirectory && A.Crc32 == B.Crc32 && A.UncompressedSize == B.UncompressedSize;
+	}
+
+	/** Buffered sequential output of a patch file. */
+	class FPatchWriter
+	{
+	public:
+		bool Open(const FString& Path)
+		{
+			Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path));
+			return Handle.IsValid();
+		}
+
+		void Write(const void* Data, int64 Size)
+		{
+			Buffer.Append((const uint8*)Data, Size);
+			Written += Size;
+			if (Buffer.Num() >= StreamChunkSize)
+			{
+				Flush();
+			}
+		}
+
+		void WriteU8(uint8 Value)
+		{
+			Write(&Value, 1);
+		}
+
+		void WriteU32(uint32 Value)
+		{
+			const uint8 Bytes[4] = { (uint8)Value, (uint8)(Value >> 8), (uint8)(Value >> 16), (uint8)(Value >> 24) };
+			Write(Bytes, 4);
+		}
+
+		void WriteVarInt(uint64 Value)
+		{
+			uint8 Bytes[10];
+			int32 Count = 0;
+			while (Value >= 0x80)
+			{
+				Bytes[Count++] = (uint8)(Value | 0x80);
+				Value >>= 7;
+			}
+			Bytes[Count++] = (uint8)Value;
+			Write(Bytes, Count);
+		}
+
+		void WriteString(FStringView Value)
+		{
+			FTCHARToUTF8 Converter(Value.GetData(), Value.Len());
+			WriteVarInt(Converter.Length());
+			Write(Converter.Get(), Converter.Length());
+		}
+
+		//Ends the patch with a hash of everything before it
+		bool Close()
+		{
+			Flush();
+
+			const uint64 Value = Hash.Finalize();
+			uint8 Bytes[8];
+			for (int32 Byte = 0; Byte < 8; Byte++)
+			{
+				Bytes[Byte] = (uint8)(Value >> (Byte * 8));
+			}
+			bFailed |= !Handle.IsValid() || !Handle->Write(Bytes, sizeof(Bytes));
+			Written += sizeof(Bytes);
+
+			Handle.Reset();
+			return !bFailed;
+		}
+
+		int64 GetSize() const
+		{
+			return Written;
+		}
+
+	private:
+		void Flush()
+		{
+			Hash.Update(Buffer.GetData(), Buffer.Num());
+			if (Buffer.Num() > 0 && (!Handle.IsValid() || !Handle->Write(Buffer.GetData(), Buffer.Num())))
+			{
+				bFailed = true;
+			}
+			Buffer.Reset();
+		}
+
+		TUniquePtr<IFileHandle> Handle;
+		TArray<uint8> Buffer;
+		ZUHash Hash;
+		int64 Written = 0;
+		bool bFailed = false;
+	};
+
+	/** Buffered sequential input of a patch file. */
+	class FPatchReader
+	{
+	public:
+		bool Open(const FString& Path)
+		{
+			Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+			if (!Handle.IsValid())
+			{
+				return false;
+			}
+			Remaining = Handle->Size() - 8;
+			Buffer.SetNumUninitialized(StreamChunkSize);
+			return Remaining >= 0;
+		}
+
+		bool Read(void* Dest, int64 Count)
+		{
+			uint8* Out = (uint8*)Dest;
+			while (Count > 0)
+			{
+				if (Position == Filled && !Refill())
+				{
+					return false;
+				}
+				const int64 Step = FMath::Min(Count, Filled - Position);
+				FMemory::Memcpy(Out, Buffer.GetData() + Position, Step);
+				Position += Step;
+				Out += Step;
+				Count -= Step;
+			}
+			return true;
+		}
+
+		bool ReadU8(uint8& OutValue)
+		{
+			return Read(&OutValue, 1);
+		}
+
+		bool ReadU32(uint32& OutValue)
+		{
+			uint8 Bytes[4];
+			if (!Read(Bytes, 4))
+			{
+				return false;
+			}
+			OutValue = Bytes[0] | (Bytes[1] << 8) | (Bytes[2] << 16) | ((uint32)Bytes[3] << 24);
+			return true;
+		}
+
+		bool ReadVarInt(uint64& OutValue)
+		{
+			OutValue = 0;
+			for (int32 Shift = 0; Shift < 64; Shift += 7)
+			{
+				uint8 Byte;
+				if (!Read(&Byte, 1))
+				{
+					return false;
+				}
+				OutValue |= (uint64)(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool ReadString(FString& OutValue)
+		{
+			uint64 Length;
+			if (!ReadVarInt(Length) || Length > MaxNameLength)
+			{
+				return false;
+			}
+
+			TArray<uint8> Bytes;
+			Bytes.SetNumUninitialized(Length);
+			if (!Read(Bytes.GetData(), Length))
+			{
+				return false;
+			}
+			FUTF8ToTCHAR Converter((const ANSICHAR*)Bytes.GetData(), Bytes.Num());
+			OutValue = FString(Converter.Length(), Converter.Get());
+			return true;
+		}
+
+		//True once everything was read and matches the hash the patch ends with
+		bool Verify()
+		{
+			uint8 Bytes[8];
+			if (Position != Filled || Remaining != 0 || !Handle->Read(Bytes, sizeof(Bytes)))
+			{
+				return false;
+			}
+
+			uint64 Expected = 0;
+			for (int32 Byte = 0; Byte < 8; Byte++)
+			{
+				Expected |= (uint64)Bytes[Byte] << (Byte * 8);
+			}
+			return Expected == Hash.Finalize();
+		}
+
+	private:
+		bool Refill()
+		{
+			const int64 Count = FMath::Min<int64>(Remaining, Buffer.Num());
+			if (Count == 0 || !Handle->Read(Buffer.GetData(), Count))
+			{
+				return false;
+			}
+			Hash.Update(Buffer.GetData(), Count);
+			Remaining -= Count;
+			Position = 0;
+			Filled = Count;
+			return true;
+		}
+
+		TUniquePtr<IFileHandle> Handle;
+		TArray<uint8> Buffer;
+		ZUHash Hash;
+		int64 Position = 0;
+		int64 Filled = 0;
+		int64 Remaining = 0;
+	};
+
+	uint32 HashBlock(const uint8* Data)
+	{
+		uint32 Hash = 0;
+		for (int32 Index = 0; Index < DeltaBlockSize; Index++)
+		{
+			Hash = Hash * HashMultiplier + Data[Index];
+		}
+		return Hash;
+	}
+
+	void EmitInsert(TArray<uint8>& Out, const uint8* Data, int64 Size)
+	{
+		if (Size > 0)
+		{
+			WriteVarInt(Out, (uint64)Size << 1);
+			Out.Append(Data, Size);
+		}
+	}
+
+	void EmitCopy(TArray<uint8>& Out, int64 Offset, int64 Size, int64& LastCopyEnd)
+	{
+		WriteVarInt(Out, ((uint64)Size << 1) | 1);
+
+		//Zigzag, a copy usually starts close behind the previous one
+		const int64 Step = Offset - LastCopyEnd;
+		WriteVarInt(Out, ((uint64)Step << 1) ^ (uint64)(Step >> 63));
+		LastCopyEnd = Offset + Size;
+	}
+
+	/*
+	Instructions that turn Old into New: copies of old ranges and inserted bytes. Every block of Old is indexed
+	by a rolling hash, New is scanned byte by byte and each hit is grown in both directions as far as it matches.
+	*/
+	void EncodeDelta(const TArray<uint8>& Old, const TArray<uint8>& New, TArray<uint8>& OutInstructions)
+	{
+		OutInstructions.Reset();
+
+		const int64 NumBlocks = Old.Num() / DeltaBlockSize;
+		int32 TableBits = 10;
+		while ((1LL << TableBits) < NumBlocks * 2 && TableBits < 28)
+		{
+			TableBits++;
+		}
+
+		auto Slot = [TableBits](uint32 Hash)
+		{
+			return (int32)((Hash * 0x9E3779B1u) >> (32 - TableBits));
+		};
+
+		//Walked backwards so the first of several identical blocks wins
+		TArray<int32> Table;
+		Table.Init(INDEX_NONE, 1 << TableBits);
+		for (int64 Block = NumBlocks - 1; Block >= 0; Block--)
+		{
+			Table[Slot(HashBlock(Old.GetData() + Block * DeltaBlockSize))] = (int32)(Block * DeltaBlockSize);
+		}
+
+		//Weight of the byte leaving the window
+		uint32 OutgoingFactor = 1;
+		for (int32 Index = 1; Index < DeltaBlockSize; Index++)
+		{
+			OutgoingFactor *= HashMultiplier;
+		}
+
+		const uint8* OldData = Old.GetData();
+		const uint8* NewData = New.GetData();
+		const int64 OldSize = Old.Num();
+		const int64 NewSize = New.Num();
+
+		int64 Position = 0;
+		int64 InsertStart = 0;
+		int64 LastCopyEnd = 0;
+		uint32 Hash = NewSize >= DeltaBlockSize ? HashBlock(NewData) : 0;
+
+		while (NumBlocks > 0 && Position + DeltaBlockSize <= NewSize)
+		{
+			const int32 Candidate = Table[Slot(Hash)];
+			if (Candidate != INDEX_NONE && FMemory::Memcmp(OldData + Candidate, NewData + Position, DeltaBlockSize) == 0)
+			{
+				int64 Start = Position;
+				int64 OldStart = Candidate;
+				while (Start > InsertStart && OldStart > 0 && NewData[Start - 1] == OldData[OldStart - 1])
+				{
+					Start--;
+					OldStart--;
+				}
+
+				int64 End = Position + DeltaBlockSize;
+				int64 OldEnd = Candidate + DeltaBlockSize;
+				while (End < NewSize && OldEnd < OldSize && NewData[End] == OldData[OldEnd])
+				{
+					End++;
+					OldEnd++;
+				}
+
+				EmitInsert(OutInstructions, NewData + InsertStart, Start - InsertStart);
+				EmitCopy(OutInstructions, OldStart, End - Start, LastCopyEnd);
+
+				Position = End;
+				InsertStart = End;
+				if (Position + DeltaBlockSize <= NewSize)
+				{
+					Hash = HashBlock(NewData + Position);
+				}
+				continue;
+			}
+
+			if (Position + DeltaBlockSize < NewSize)
+			{
+				Hash = (Hash - NewData[Position] * OutgoingFactor) * HashMultiplier + NewData[Position + DeltaBlockSize];
+			}
+			Position++;
+		}
+
+		EmitInsert(OutInstructions, NewData + InsertStart, NewSize - InsertStart);
+	}
+
+	bool DeflateBuffer(const uint8* Data, int64 Size, TArray<uint8>& OutCompressed)
+	{
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+
+		if (deflateInit2(&Stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			return false;
+		}
+
+		OutCompressed.SetNumUninitialized(deflateBound(&Stream, (uLong)Size));
+		Stream.next_in = (Bytef*)Data;
+		Stream.avail_in = (uInt)Size;
+		Stream.next_out = OutCompressed.GetData();
+		Stream.avail_out = (uInt)OutCompressed.Num();
+
+		const bool bSuccess = deflate(&Stream, Z_FINISH) == Z_STREAM_END;
+		OutCompressed.SetNum(Stream.total_out, false);
+		deflateEnd(&Stream);
+		return bSuccess;
+	}
+
+	//False if the delta wouldn't be smaller than the entry as encoded in the new archive
+	bool MakeDelta(ZUZipReader& OldReader, int32 OldIndex, ZUZipReader& NewReader, int32 NewIndex, TArray<uint8>& OutDelta)
+	{
+		const FZUZipEntry& OldEntry = OldReader.GetEntries()[OldIndex];
+		const FZUZipEntry& NewEntry = NewReader.GetEntries()[NewIndex];
+		if (OldEntry.UncompressedSize > MaxDeltaEntrySize || NewEntry.UncompressedSize > MaxDeltaEntrySize)
+		{
+			return false;
+		}
+
+		TArray<uint8> OldData;
+		TArray<uint8> NewData;
+		if (!OldReader.ReadEntry(OldIndex, OldData) || !NewReader.ReadEntry(NewIndex, NewData))
+		{
+			return false;
+		}
+
+		TArray<uint8> Instructions;
+		EncodeDelta(OldData, NewData, Instructions);
+		return DeflateBuffer(Instructions.GetData(), Instructions.Num(), OutDelta) && (uint64)OutDelta.Num() < NewEntry.CompressedSize;
+	}
+
+	/** Inflates the instructions of one delta record as they are consumed. */
+	class FDeltaReader
+	{
+	public:
+		FDeltaReader(FPatchReader& InPatch, int64 InCompressedSize)
+			: Patch(InPatch)
+			, CompressedLeft(InCompressedSize)
+		{
+			FMemory::Memzero(Stream);
+			bValid = inflateInit2(&Stream, -MAX_WBITS) == Z_OK;
+			Input.SetNumUninitialized(StreamChunkSize);
+			Output.SetNumUninitialized(StreamChunkSize);
+		}
+
+		~FDeltaReader()
+		{
+			if (bValid)
+			{
+				inflateEnd(&Stream);
+			}
+		}
+
+		bool Read(uint8* Dest, int64 Count)
+		{
+			while (Count > 0)
+			{
+				if (Position == Filled && !Inflate())
+				{
+					return false;
+				}
+				const int64 Step = FMath::Min(Count, Filled - Position);
+				FMemory::Memcpy(Dest, Output.GetData() + Position, Step);
+				Position += Step;
+				Dest += Step;
+				Count -= Step;
+			}
+			return true;
+		}
+
+		bool ReadVarInt(uint64& OutValue)
+		{
+			OutValue = 0;
+			for (int32 Shift = 0; Shift < 64; Shift += 7)
+			{
+				uint8 Byte;
+				if (!Read(&Byte, 1))
+				{
+					return false;
+				}
+				OutValue |= (uint64)(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//Consumes whatever is left of the record so the next one starts in the right place
+		bool Finish()
+		{
+			while (CompressedLeft > 0)
+			{
+				const int64 Count = FMath::Min<int64>(CompressedLeft, Input.Num());
+				if (!Patch.Read(Input.GetData(), Count))
+				{
+					return false;
+				}
+				CompressedLeft -= Count;
+			}
+			return true;
+		}
+
+	private:
+		bool Inflate()
+		{
+			if (!bValid || bEnded)
+			{
+				return false;
+			}
+
+			Stream.next_out = Output.GetData();
+			Stream.avail_out = (uInt)Output.Num();
+			while (Stream.avail_out == (uInt)Output.Num())
+			{
+				if (Stream.avail_in == 0)
+				{
+					const int64 Count = FMath::Min<int64>(CompressedLeft, Input.Num());
+					if (Count == 0 || !Patch.Read(Input.GetData(), Count))
+					{
+						return false;
+					}
+					CompressedLeft -= Count;
+					Stream.next_in = Input.GetData();
+					Stream.avail_in = (uInt)Count;
+				}
+
+				const int Result = inflate(&Stream, Z_NO_FLUSH);
+				if (Result == Z_STREAM_END)
+				{
+					bEnded = true;
+					break;
+				}
+				if (Result != Z_OK)
+				{
+					return false;
+				}
+			}
+
+			Position = 0;
+			Filled = Output.Num() - Stream.avail_out;
+			return Filled > 0;
+		}
+
+		FPatchReader& Patch;
+		int64 CompressedLeft;
+		z_stream Stream;
+		TArray<uint8> Input;
+		TArray<uint8> Output;
+		int64 Position = 0;
+		int64 Filled = 0;
+		bool bValid = false;
+		bool bEnded = false;
+	};
+
+	/** Encodes a rebuilt entry into the output archive as it is produced. */
+	class FEntryEncoder
+	{
+	public:
+		FEntryEncoder(ZUZipWriter& InWriter)
+			: Writer(InWriter)
+		{
+			FMemory::Memzero(Stream);
+		}
+
+		~FEntryEncoder()
+		{
+			if (bDeflating)
+			{
+				deflateEnd(&Stream);
+			}
+		}
+
+		bool Begin(const FString& Name, uint16 Method, const FDateTime& ModifiedTime, uint64 Size)
+		{
+			if (Method == ZUZipWriter::MethodDeflate)
+			{
+				if (deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				{
+					return false;
+				}
+				bDeflating = true;
+				Output.SetNumUninitialized(StreamChunkSize);
+			}
+			else if (Method != ZUZipWriter::MethodStore)
+			{
+				return false;
+			}
+			return Writer.BeginEntry(Name, Method, ModifiedTime, Size);
+		}
+
+		bool Append(const uint8* Data, int64 Size)
+		{
+			Crc = ZUCrc32::Update(Crc, Data, Size);
+			Written += Size;
+
+			if (!bDeflating)
+			{
+				return Writer.AppendEntryData(Data, Size);
+			}
+			Stream.next_in = (Bytef*)Data;
+			Stream.avail_in = (uInt)Size;
+			return Drain(Z_NO_FLUSH);
+		}
+
+		bool Finish()
+		{
+			return (!bDeflating || Drain(Z_FINISH)) && Writer.FinishEntry(Crc, Written);
+		}
+
+		uint32 GetCrc() const { return Crc; }
+		uint64 GetSize() const { return Written; }
+
+	private:
+		bool Drain(int Flush)
+		{
+			int Result = Z_OK;
+			do
+			{
+				Stream.next_out = Output.GetData();
+				Stream.avail_out = (uInt)Output.Num();
+				Result = deflate(&Stream, Flush);
+
+				const int64 Produced = Output.Num() - Stream.avail_out;
+				if (Result == Z_STREAM_ERROR || (Produced > 0 && !Writer.AppendEntryData(Output.GetData(), Produced)))
+				{
+					return false;
+				}
+			} while (Stream.avail_out == 0 || (Flush == Z_FINISH && Result != Z_STREAM_END));
+			return true;
+		}
+
+		ZUZipWriter& Writer;
+		z_stream Stream;
+		TArray<uint8> Output;
+		uint32 Crc = 0;
+		uint64 Written = 0;
+		bool bDeflating = false;
+	};
+
+	/** Decoded content of the old entry a delta refers to, in memory or in a temporary file. */
+	class FOldContent
+	{
+	public:
+		~FOldContent()
+		{
+			Release();
+		}
+
+		bool Load(ZUZipReader& Reader, int32 EntryIndex, const FString& TempPath)
+		{
+			Release();
+
+			const FZUZipEntry& Entry = Reader.GetEntries()[EntryIndex];
+			Size = Entry.UncompressedSize;
+			if (Entry.UncompressedSize <= MaxInMemoryOldSize)
+			{
+				return Reader.ReadEntry(EntryIndex, Data);
+			}
+
+			IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+			TUniquePtr<IFileHandle> Out(PlatformFile.OpenWrite(*TempPath));
+			if (!Out.IsValid())
+			{
+				return false;
+			}
+			TempFile = TempPath;
+
+			const bool bDecoded = Reader.ReadEntryStreamed(EntryIndex, [&Out](const uint8* Chunk, int64 ChunkSize)
+			{
+				return Out->Write(Chunk, ChunkSize);
+			});
+			Out.Reset();
+
+			File.Reset(bDecoded ? PlatformFile.OpenRead(*TempPath) : nullptr);
+			return File.IsValid();
+		}
+
+		bool Read(uint64 Offset, uint8* Dest, int64 Count) const
+		{
+			if (Offset > Size || (uint64)Count > Size - Offset)
+			{
+				return false;
+			}
+			if (!File.IsValid())
+			{
+				FMemory::Memcpy(Dest, Data.GetData() + Offset, Count);
+				return true;
+			}
+			return File->Seek(Offset) && File->Read(Dest, Count);
+		}
+
+		void Release()
+		{
+			Data.Empty();
+			File.Reset();
+			if (!TempFile.IsEmpty())
+			{
+				FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*TempFile);
+				TempFile.Empty();
+			}
+		}
+
+	private:
+		TArray<uint8> Data;
+		TUniquePtr<IFileHandle> File;
+		FString TempFile;
+		uint64 Size = 0;
+	};
+
+	bool ApplyDelta(FDeltaReader& Delta, const FOldContent& Old, FEntryEncoder& Encoder, uint64 NewSize)
+	{
+		TArray<uint8> Chunk;
+		Chunk.SetNumUninitialized(StreamChunkSize);
+
+		int64 LastCopyEnd = 0;
+		uint64 Produced = 0;
+		while (Produced < NewSize)
+		{
+			uint64 Instruction;
+			if (!Delta.ReadVarInt(Instruction))
+			{
+				return false;
+			}
+
+			const uint64 Length = Instruction >> 1;
+			if (Length == 0 || Length > NewSize - Produced)
+			{
+				return false;
+			}
+
+			uint64 Offset = 0;
+			const bool bCopy = (Instruction & 1) != 0;
+			if (bCopy)
+			{
+				uint64 Step;
+				if (!Delta.ReadVarInt(Step))
+				{
+					return false;
+				}
+				Offset = LastCopyEnd + ((int64)(Step >> 1) ^ -(int64)(Step & 1));
+				LastCopyEnd = Offset + Length;
+			}
+
+			for (uint64 Done = 0; Done < Length;)
+			{
+				const int64 Count = FMath::Min<uint64>(Length - Done, StreamChunkSize);
+				const bool bRead = bCopy ? Old.Read(Offset + Done, Chunk.GetData(), Count) : Delta.Read(Chunk.GetData(), Count);
+				if (!bRead || !Encoder.Append(Chunk.GetData(), Count))
+				{
+					return false;
+				}
+				Done += Count;
+			}
+			Produced += Length;
+		}
+		return true;
+	}
+
+	bool CopyRaw(FPatchReader& Patch, ZUZipWriter& Writer, uint64 Size)
+	{
+		TArray<uint8> Chunk;
+		Chunk.SetNumUninitialized(FMath::Min<uint64>(Size, StreamChunkSize));
+		for (uint64 Done = 0; Done < Size;)
+		{
+			const int64 Count = FMath::Min<uint64>(Size - Done, StreamChunkSize);
+			if (!Patch.Read(Chunk.GetData(), Count) || !Writer.AppendEntryData(Chunk.GetData(), Count))
+			{
+				return false;
+			}
+			Done += Count;
+		}
+		return true;
+	}
+}
+
+bool ZUZipPatch::Create(const FString& OldArchivePath, const FString& NewArchivePath, const FString& PatchPath, SevenZip::ProgressCallback* Callback)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	ZUZipReader OldReader;
+	ZUZipReader NewReader;
+	if (!OldReader.Open(OldArchivePath) || !OldReader.IsSupported() || !NewReader.Open(NewArchivePath) || !NewReader.IsSupported())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Patches need two readable zip archives without encryption, can't patch %s to %s"), *OldArchivePath, *NewArchivePath);
+		return false;
+	}
+
+	const TArray<FZUZipEntry>& OldEntries = OldReader.GetEntries();
+	const TArray<FZUZipEntry>& NewEntries = NewReader.GetEntries();
+
+	//Old files by name, and by content so a moved file is still found
+	TMap<FString, int32> OldByName;
+	TMap<uint64, int32> OldByContent;
+	for (int32 Index = 0; Index < OldEntries.Num(); Index++)
+	{
+		if (OldEntries[Index].bIsDirectory)
+		{
+			continue;
+		}
+		if (!OldByName.Contains(OldEntries[Index].GetName()))
+		{
+			OldByName.Add(OldEntries[Index].GetName(), Index);
+		}
+		if (!OldByContent.Contains(ContentKey(OldEntries[Index])))
+		{
+			OldByContent.Add(ContentKey(OldEntries[Index]), Index);
+		}
+	}
+
+	FPatchWriter Patch;
+	if (!Patch.Open(PatchPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open %s for writing"), *PatchPath);
+		return false;
+	}
+
+	Patch.Write(PatchMagic, sizeof(PatchMagic));
+	Patch.WriteU8(PatchVersion);
+	Patch.WriteVarInt(NewEntries.Num());
+	Patch.WriteVarInt(NewReader.GetTotalUncompressedSize());
+
+	const TString PatchName = *PatchPath;
+	Callback->OnStartWithTotal(PatchName, NewReader.GetTotalUncompressedSize());
+
+	int32 NumCopied = 0;
+	int32 NumDelta = 0;
+	int32 NumFull = 0;
+	uint64 NewEncodedBytes = 0;
+	bool bSuccess = true;
+	TArray<uint8> Delta;
+
+	for (int32 Index = 0; bSuccess && Index < NewEntries.Num(); Index++)
+	{
+		if (Callback->OnCheckBreak())
+		{
+			bSuccess = false;
+			break;
+		}
+
+		const FZUZipEntry& Entry = NewEntries[Index];
+		NewEncodedBytes += Entry.CompressedSize;
+
+		if (Entry.bIsDirectory)
+		{
+			Patch.WriteU8((uint8)EPatchRecord::Directory);
+			Patch.WriteString(Entry.Name);
+			Patch.WriteU32(Entry.DosTime);
+			continue;
+		}
+
+		const int32* SameName = OldByName.Find(Entry.GetName());
+		const int32* SameContent = OldByContent.Find(ContentKey(Entry));
+
+		int32 Unchanged = INDEX_NONE;
+		if (SameName && IsSameContent(OldEntries[*SameName], Entry))
+		{
+			Unchanged = *SameName;
+		}
+		else if (SameContent && IsSameContent(OldEntries[*SameContent], Entry))
+		{
+			Unchanged = *SameContent;
+		}
+
+		if (Unchanged != INDEX_NONE)
+		{
+			Patch.WriteU8((uint8)EPatchRecord::Copy);
+			Patch.WriteString(Entry.Name);
+			Patch.WriteU32(Entry.DosTime);
+			Patch.WriteString(OldEntries[Unchanged].Name);
+			Patch.WriteU32(Entry.Crc32);
+			Patch.WriteVarInt(Entry.UncompressedSize);
+			NumCopied++;
+		}
+		else if (SameName && MakeDelta(OldReader, *SameName, NewReader, Index, Delta))
+		{
+			//Content deflate barely shrank isn't worth compressing again when the entry is rebuilt
+			const FZUZipEntry& OldEntry = OldEntries[*SameName];
+			const bool bStore = Entry.Method != ZUZipWriter::MethodDeflate || Entry.CompressedSize >= Entry.UncompressedSize - Entry.UncompressedSize / 32;
+
+			Patch.WriteU8((uint8)EPatchRecord::Delta);
+			Patch.WriteString(Entry.Name);
+			Patch.WriteU32(Entry.DosTime);
+			Patch.WriteVarInt(bStore ? ZUZipWriter::MethodStore : ZUZipWriter::MethodDeflate);
+			Patch.WriteU32(Entry.Crc32);
+			Patch.WriteVarInt(Entry.UncompressedSize);
+			Patch.WriteString(OldEntry.Name);
+			Patch.WriteU32(OldEntry.Crc32);
+			Patch.WriteVarInt(OldEntry.UncompressedSize);
+			Patch.WriteVarInt(Delta.Num());
+			Patch.Write(Delta.GetData(), Delta.Num());
+			NumDelta++;
+		}
+		else
+		{
+			Patch.WriteU8((uint8)EPatchRecord::Full);
+			Patch.WriteString(Entry.Name);
+			Patch.WriteU32(Entry.DosTime);
+			Patch.WriteVarInt(Entry.Method);
+			Patch.WriteU32(Entry.Crc32);
+			Patch.WriteVarInt(Entry.UncompressedSize);
+			Patch.WriteVarInt(Entry.CompressedSize);
+
+			uint64 Copied = 0;
+			bSuccess = NewReader.ReadRawEntry(Index, [&Patch, &Copied](const uint8* Data, int64 Size)
+			{
+				Patch.Write(Data, Size);
+				Copied += Size;
+				return true;
+			}) && Copied == Entry.CompressedSize;
+			NumFull++;
+		}
+
+		Callback->OnFileDone(PatchName, Entry.Name.GetData(), Entry.UncompressedSize);
+	}
+
+	bSuccess &= Patch.Close();
+	if (!bSuccess)
+	{
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*PatchPath);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("ZipUtility: Patch %s: %d entries copied, %d as delta, %d in full, %lld bytes (%.1f%% of the new entry data) in %.2fs"),
+		*PatchPath, NumCopied, NumDelta, NumFull, Patch.GetSize(), NewEncodedBytes > 0 ? 100.0 * Patch.GetSize() / NewEncodedBytes : 0.0, FPlatformTime::Seconds() - StartTime);
+	return true;
+}
+
+bool ZUZipPatch::Apply(const FString& OldArchivePath, const FString& PatchPath, const FString& OutputArchivePath, SevenZip::ProgressCallback* Callback)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (FPaths::ConvertRelativePathToFull(OldArchivePath) == FPaths::ConvertRelativePathToFull(OutputArchivePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: A patch can't be applied onto the archive it reads from, %s"), *OldArchivePath);
+		return false;
+	}
+
+	ZUZipReader OldReader;
+	if (!OldReader.Open(OldArchivePath) || !OldReader.IsSupported())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s isn't a zip archive a patch can be applied to"), *OldArchivePath);
+		return false;
+	}
+
+	FPatchReader Patch;
+	uint8 Magic[4];
+	uint8 Version = 0;
+	uint64 NumEntries = 0;
+	uint64 TotalSize = 0;
+	if (!Patch.Open(PatchPath) || !Patch.Read(Magic, sizeof(Magic)) || FMemory::Memcmp(Magic, PatchMagic, sizeof(Magic)) != 0 ||
+		!Patch.ReadU8(Version) || Version != PatchVersion || !Patch.ReadVarInt(NumEntries) || !Patch.ReadVarInt(TotalSize))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is not a patch this version can read"), *PatchPath);
+		return false;
+	}
+
+	const TArray<FZUZipEntry>& OldEntries = OldReader.GetEntries();
+	TMap<FString, int32> OldByName;
+	for (int32 Index = 0; Index < OldEntries.Num(); Index++)
+	{
+		if (!OldEntries[Index].bIsDirectory && !OldByName.Contains(OldEntries[Index].GetName()))
+		{
+			OldByName.Add(OldEntries[Index].GetName(), Index);
+		}
+	}
+
+	//The patch only stays valid against the exact content it was made from
+	auto FindOld = [&OldByName, &OldEntries](const FString& Name, uint32 Crc, uint64 Size)
+	{
+		const int32* Index = OldByName.Find(Name);
+		return (Index && OldEntries[*Index].Crc32 == Crc && OldEntries[*Index].UncompressedSize == Size) ? *Index : INDEX_NONE;
+	};
+
+	ZUZipWriter Writer;
+	if (!Writer.Open(OutputArchivePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open %s for writing"), *OutputArchivePath);
+		return false;
+	}
+
+	const TString PatchName = *PatchPath;
+	Callback->OnStartWithTotal(PatchName, TotalSize);
+
+	const FString TempPath = OutputArchivePath + TEXT(".old.tmp");
+	FOldContent OldContent;
+	int32 NumDelta = 0;
+	bool bSuccess = true;
+
+	for (uint64 Index = 0; bSuccess && Index < NumEntries; Index++)
+	{
+		if (Callback->OnCheckBreak())
+		{
+			bSuccess = false;
+			break;
+		}
+
+		uint8 Type;
+		FString Name;
+		uint32 DosTime;
+		if (!Patch.ReadU8(Type) || !Patch.ReadString(Name) || !Patch.ReadU32(DosTime))
+		{
+			bSuccess = false;
+			break;
+		}
+		const FDateTime ModifiedTime = ZUZipReader::FromDosTime(DosTime);
+
+		uint64 Method = 0;
+		uint32 Crc = 0;
+		uint64 Size = 0;
+		if (Type == (uint8)EPatchRecord::Directory)
+		{
+			bSuccess = Writer.AddDirectory(Name, ModifiedTime);
+		}
+		else if (Type == (uint8)EPatchRecord::Copy)
+		{
+			FString OldName;
+			bSuccess = Patch.ReadString(OldName) && Patch.ReadU32(Crc) && Patch.ReadVarInt(Size);
+
+			//Copied still encoded, under the new name and time
+			const int32 OldIndex = bSuccess ? FindOld(OldName, Crc, Size) : INDEX_NONE;
+			bSuccess = OldIndex != INDEX_NONE && Writer.BeginEntry(Name, OldEntries[OldIndex].Method, ModifiedTime, Size) &&
+				OldReader.ReadRawEntry(OldIndex, [&Writer](const uint8* Data, int64 DataSize)
+				{
+					return Writer.AppendEntryData(Data, DataSize);
+				}) && Writer.FinishEntry(Crc, Size);
+		}
+		else if (Type == (uint8)EPatchRecord::Delta)
+		{
+			FString OldName;
+			uint32 OldCrc;
+			uint64 OldSize;
+			uint64 DeltaSize;
+			bSuccess = Patch.ReadVarInt(Method) && Patch.ReadU32(Crc) && Patch.ReadVarInt(Size) &&
+				Patch.ReadString(OldName) && Patch.ReadU32(OldCrc) && Patch.ReadVarInt(OldSize) && Patch.ReadVarInt(DeltaSize);
+
+			const int32 OldIndex = bSuccess ? FindOld(OldName, OldCrc, OldSize) : INDEX_NONE;
+			bSuccess = OldIndex != INDEX_NONE && OldContent.Load(OldReader, OldIndex, TempPath);
+
+			if (bSuccess)
+			{
+				FDeltaReader Delta(Patch, DeltaSize);
+				FEntryEncoder Encoder(Writer);
+				bSuccess = Encoder.Begin(Name, (uint16)Method, ModifiedTime, Size) && ApplyDelta(Delta, OldContent, Encoder, Size) &&
+					Encoder.Finish() && Delta.Finish() && Encoder.GetCrc() == Crc && Encoder.GetSize() == Size;
+			}
+			OldContent.Release();
+			NumDelta++;
+		}
+		else if (Type == (uint8)EPatchRecord::Full)
+		{
+			uint64 CompressedSize;
+			bSuccess = Patch.ReadVarInt(Method) && Patch.ReadU32(Crc) && Patch.ReadVarInt(Size) && Patch.ReadVarInt(CompressedSize) &&
+				(Method == ZUZipWriter::MethodStore || Method == ZUZipWriter::MethodDeflate) &&
+				Writer.BeginEntry(Name, (uint16)Method, ModifiedTime, Size) && CopyRaw(Patch, Writer, CompressedSize) && Writer.FinishEntry(Crc, Size);
+		}
+		else
+		{
+			bSuccess = false;
+		}
+
+		if (!bSuccess)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to rebuild %s from %s, is %s the archive the patch was made against?"), *Name, *PatchPath, *OldArchivePath);
+			break;
+		}
+		Callback->OnFileDone(PatchName, *Name, Size);
+	}
+
+	//Entries carried in full are copied without being decoded, only the hash tells if they arrived intact
+	if (bSuccess && !Patch.Verify())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is damaged, its content doesn't match its hash"), *PatchPath);
+		bSuccess = false;
+	}
+	if (!bSuccess)
+	{
+		Writer.Abort();
+		return false;
+	}
+	if (!Writer.Close())
+	{
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("ZipUtility: Applied %s to %s, %d entries rebuilt from deltas, in %.2fs"),
+		*PatchPath, *OldArchivePath, NumDelta, FPlatformTime::Seconds() - StartTime);
+	return true;
+}
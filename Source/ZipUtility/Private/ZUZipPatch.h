@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace SevenZip
+{
+	class ProgressCallback;
+}
+
+/**
+ * Binary patches between two versions of a zip archive. Entries whose content didn't change are copied
+ * from the old archive as they are, also when they were renamed. A changed entry is stored as a delta
+ * against the old entry of the same name: ranges copied from the old content and inserted new bytes,
+ * deflated. Anything else is carried in full, still encoded as in the new archive.
+ *
+ * Applying reads the patch front to back and writes the new archive entry by entry, so memory stays
+ * bounded whatever the archive size. Old entries too big to hold are decoded to a temporary file next to
+ * the output and read back from there. Entries rebuilt from a delta are compressed again, so the result
+ * has the entries, contents and order of the new archive but not necessarily its exact bytes. The patch
+ * ends with a hash of its content, a damaged patch never leaves an output archive behind.
+ */
+class ZUZipPatch
+{
+public:
+	// Progress is reported against the uncompressed size of the new archive, one OnFileDone per entry
+	static bool Create(const FString& OldArchivePath, const FString& NewArchivePath, const FString& PatchPath, SevenZip::ProgressCallback* Callback);
+
+	// Fails without leaving an output archive if OldArchivePath isn't the archive the patch was made against
+	static bool Apply(const FString& OldArchivePath, const FString& PatchPath, const FString& OutputArchivePath, SevenZip::ProgressCallback* Callback);
+};
@@ -0,0 +1,679 @@
+#include "ZUZipReader.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUCrc32.h"
+#include "ZUInflate.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	const uint32 LocalHeaderSignature = 0x04034b50;
+	const uint32 CentralHeaderSignature = 0x02014b50;
+	const uint32 EndOfCentralDirectorySignature = 0x06054b50;
+	const uint32 Zip64EndOfCentralDirectorySignature = 0x06064b50;
+	const uint32 Zip64LocatorSignature = 0x07064b50;
+
+	const int32 LocalHeaderSize = 30;
+	const int32 CentralHeaderSize = 46;
+	const int32 EndOfCentralDirectorySize = 22;
+	const int32 Zip64EndOfCentralDirectorySize = 56;
+	const int32 Zip64LocatorSize = 20;
+	const int32 MaxCommentSize = 0xFFFF;
+
+	const uint16 MethodStore = 0;
+	const uint16 MethodDeflate = 8;
+
+	const uint16 FlagEncrypted = 1 << 0;
+
+	const uint16 Zip64ExtraId = 0x0001;
+
+	const int64 StreamChunkSize = 1024 * 1024;
+
+	//Central directory read per refill when listing page by page, always more than the largest possible record
+	const uint64 ListingChunkSize = 256 * 1024;
+
+	uint16 ReadU16(const uint8* Data)
+	{
+		return (uint16)(Data[0] | (Data[1] << 8));
+	}
+
+	uint32 ReadU32(const uint8* Data)
+	{
+		return (uint32)Data[0] | ((uint32)Data[1] << 8) | ((uint32)Data[2] << 16) | ((uint32)Data[3] << 24);
+	}
+
+	uint64 ReadU64(const uint8* Data)
+	{
+		return (uint64)ReadU32(Data) | ((uint64)ReadU32(Data + 4) << 32);
+	}
+
+	//The zip64 extra field only carries the values whose 32 bit header fields are saturated, in this order
+	bool ReadZip64Extra(const uint8* Extra, uint16 ExtraLength, FZUZipEntry& Entry)
+	{
+		uint32 Cursor = 0;
+		while (Cursor + 4 <= ExtraLength)
+		{
+			const uint16 Id = ReadU16(Extra + Cursor);
+			const uint16 Size = ReadU16(Extra + Cursor + 2);
+			const uint8* Field = Extra + Cursor + 4;
+			const uint8* FieldEnd = Field + Size;
+
+			if (Cursor + 4 + Size > ExtraLength)
+			{
+				return false;
+			}
+
+			if (Id == Zip64ExtraId)
+			{
+				uint64* Values[] = { &Entry.UncompressedSize, &Entry.CompressedSize, &Entry.LocalHeaderOffset };
+				for (uint64* Value : Values)
+				{
+					if (*Value != MAX_uint32)
+					{
+						continue;
+					}
+					if (Field + 8 > FieldEnd)
+					{
+						return false;
+					}
+					*Value = ReadU64(Field);
+					Field += 8;
+				}
+				return true;
+			}
+			Cursor += 4 + Size;
+		}
+		return false;
+	}
+
+	//Size of the central directory record starting at Header, which needs only its fixed part readable. 0 if it isn't one
+	uint64 GetCentralRecordSize(const uint8* Header)
+	{
+		if (ReadU32(Header) != CentralHeaderSignature)
+		{
+			return 0;
+		}
+		return CentralHeaderSize + ReadU16(Header + 28) + ReadU16(Header + 30) + ReadU16(Header + 32);
+	}
+
+	//Header has to hold the whole record, see GetCentralRecordSize
+	bool ParseCentralRecord(const uint8* Header, ZUNamePool& Names, FZUZipEntry& Entry)
+	{
+		const uint16 NameLength = ReadU16(Header + 28);
+		const uint16 ExtraLength = ReadU16(Header + 30);
+
+		Entry.Flags = ReadU16(Header + 8);
+		Entry.Method = ReadU16(Header + 10);
+		Entry.DosTime = ReadU32(Header + 12);
+		Entry.Crc32 = ReadU32(Header + 16);
+		Entry.CompressedSize = ReadU32(Header + 20);
+		Entry.UncompressedSize = ReadU32(Header + 24);
+		Entry.LocalHeaderOffset = ReadU32(Header + 42);
+
+		if ((Entry.CompressedSize == MAX_uint32 || Entry.UncompressedSize == MAX_uint32 || Entry.LocalHeaderOffset == MAX_uint32) &&
+			!ReadZip64Extra(Header + CentralHeaderSize + NameLength, ExtraLength, Entry))
+		{
+			return false;
+		}
+
+		Entry.Name = Names.AddUtf8((const ANSICHAR*)Header + CentralHeaderSize, NameLength);
+		Entry.bIsDirectory = Entry.Name.EndsWith(TEXT("/")) || Entry.Name.EndsWith(TEXT("\\"));
+		return true;
+	}
+}
+
+ZUZipReader::ZUZipReader()
+{
+	ArchiveSize = 0;
+}
+
+ZUZipReader::~ZUZipReader()
+{
+	Close();
+}
+
+bool ZUZipReader::Open(const FString& InArchivePath)
+{
+	Close();
+
+	ArchivePath = InArchivePath;
+	if (!Volumes.Open(ArchivePath))
+	{
+		return false;
+	}
+	ArchiveSize = Volumes.Size();
+	Names = MakeShared<ZUNamePool>();
+
+	uint64 DirectoryOffset = 0;
+	uint64 DirectorySize = 0;
+	uint64 EntryCount = 0;
+
+	if (!ReadEndOfCentralDirectory(DirectoryOffset, DirectorySize, EntryCount) ||
+		!ReadCentralDirectory(DirectoryOffset, DirectorySize, EntryCount))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool ZUZipReader::OpenFrom(const ZUZipReader& Other)
+{
+	Close();
+
+	if (!Other.Volumes.IsOpen())
+	{
+		return false;
+	}
+
+	ArchivePath = Other.ArchivePath;
+	if (!Volumes.Open(ArchivePath))
+	{
+		return false;
+	}
+	ArchiveSize = Other.ArchiveSize;
+	Entries = Other.Entries;
+	Names = Other.Names;
+	return true;
+}
+
+void ZUZipReader::Close()
+{
+	Volumes.Close();
+	ArchiveSize = 0;
+	Entries.Empty();
+	Names.Reset();
+
+	ListingDirectoryOffset = 0;
+	ListingDirectorySize = 0;
+	ListingEntryCount = 0;
+	ListingEntriesRead = 0;
+	ListingCursor = 0;
+	ListingChunkStart = 0;
+	ListingChunk.Empty();
+}
+
+bool ZUZipReader::IsSupported() const
+{
+	for (const FZUZipEntry& Entry : Entries)
+	{
+		if (!IsEntrySupported(Entry))
+		{
+			return false;
+		}
+	}
+	return Volumes.IsOpen();
+}
+
+bool ZUZipReader::IsEntrySupported(const FZUZipEntry& Entry) const
+{
+	if (Entry.Flags & FlagEncrypted)
+	{
+		return false;
+	}
+	return Entry.bIsDirectory || Entry.Method == MethodStore || Entry.Method == MethodDeflate;
+}
+
+uint64 ZUZipReader::GetTotalUncompressedSize() const
+{
+	uint64 Total = 0;
+	for (const FZUZipEntry& Entry : Entries)
+	{
+		Total += Entry.UncompressedSize;
+	}
+	return Total;
+}
+
+FDateTime ZUZipReader::FromDosTime(uint32 DosTime)
+{
+	const int32 Year = 1980 + (DosTime >> 25);
+	const int32 Month = (DosTime >> 21) & 0xF;
+	const int32 Day = (DosTime >> 16) & 0x1F;
+	const int32 Hour = (DosTime >> 11) & 0x1F;
+	const int32 Minute = (DosTime >> 5) & 0x3F;
+	const int32 Second = (DosTime & 0x1F) * 2;
+
+	//Some writers leave the field zeroed or fill it with garbage
+	if (!FDateTime::Validate(Year, Month, Day, Hour, Minute, Second, 0))
+	{
+		return FDateTime(1980, 1, 1);
+	}
+	return FDateTime(Year, Month, Day, Hour, Minute, Second);
+}
+
+bool ZUZipReader::ReadEntry(int32 EntryIndex, TArray<uint8>& OutData)
+{
+	OutData.Reset();
+
+	if (!Entries.IsValidIndex(EntryIndex))
+	{
+		return false;
+	}
+
+	FZUZipEntry& Entry = Entries[EntryIndex];
+	if (Entry.bIsDirectory)
+	{
+		return true;
+	}
+	//Whole entry decoding is limited to what a TArray can hold, larger entries have to be streamed
+	if (!IsEntrySupported(Entry) || Entry.UncompressedSize > MAX_int32 || Entry.CompressedSize > MAX_int32 || !ResolveDataOffset(Entry))
+	{
+		return false;
+	}
+
+	OutData.SetNumUninitialized(Entry.UncompressedSize);
+
+	if (Entry.Method == MethodStore)
+	{
+		if (Entry.CompressedSize != Entry.UncompressedSize || !ReadAt(Entry.DataOffset, OutData.GetData(), Entry.UncompressedSize))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(Entry.CompressedSize);
+
+		if (!ReadAt(Entry.DataOffset, Compressed.GetData(), Entry.CompressedSize) ||
+			!ZUInflate::Decompress(Compressed.GetData(), Entry.CompressedSize, OutData.GetData(), Entry.UncompressedSize))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to inflate %s in %s"), Entry.Name.GetData(), *ArchivePath);
+			return false;
+		}
+	}
+
+	const uint32 Crc = ZUCrc32::Update(0, OutData.GetData(), OutData.Num());
+	if (Crc != Entry.Crc32)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: CRC mismatch for %s in %s"), Entry.Name.GetData(), *ArchivePath);
+		return false;
+	}
+	return true;
+}
+
+bool ZUZipReader::ReadEntryStreamed(int32 EntryIndex, TFunctionRef<bool(const uint8* Data, int64 Size)> Sink)
+{
+	if (!Entries.IsValidIndex(EntryIndex))
+	{
+		return false;
+	}
+
+	FZUZipEntry& Entry = Entries[EntryIndex];
+	if (Entry.bIsDirectory)
+	{
+		return true;
+	}
+	if (!IsEntrySupported(Entry) || !ResolveDataOffset(Entry))
+	{
+		return false;
+	}
+
+	TArray<uint8> Input;
+	Input.SetNumUninitialized(StreamChunkSize);
+
+	uint32 Crc = 0;
+	uint64 Consumed = 0;
+	uint64 Produced = 0;
+	bool bSuccess = true;
+
+	if (Entry.Method == MethodStore)
+	{
+		if (Entry.CompressedSize != Entry.UncompressedSize)
+		{
+			return false;
+		}
+
+		while (bSuccess && Consumed < Entry.CompressedSize)
+		{
+			const int64 Count = FMath::Min<uint64>(StreamChunkSize, Entry.CompressedSize - Consumed);
+			bSuccess = ReadAt(Entry.DataOffset + Consumed, Input.GetData(), Count);
+
+			if (bSuccess)
+			{
+				Crc = ZUCrc32::Update(Crc, Input.GetData(), Count);
+				bSuccess = Sink(Input.GetData(), Count);
+				Consumed += Count;
+			}
+		}
+		Produced = Consumed;
+	}
+	else
+	{
+		TArray<uint8> Output;
+		Output.SetNumUninitialized(StreamChunkSize);
+
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+
+		if (inflateInit2(&Stream, -MAX_WBITS) != Z_OK)
+		{
+			return false;
+		}
+
+		int Result = Z_OK;
+		while (bSuccess && Result != Z_STREAM_END)
+		{
+			if (Stream.avail_in == 0)
+			{
+				const int64 Count = FMath::Min<uint64>(StreamChunkSize, Entry.CompressedSize - Consumed);
+				if (Count == 0 || !ReadAt(Entry.DataOffset + Consumed, Input.GetData(), Count))
+				{
+					bSuccess = false;
+					break;
+				}
+				Stream.next_in = Input.GetData();
+				Stream.avail_in = (uInt)Count;
+				Consumed += Count;
+			}
+
+			Stream.next_out = Output.GetData();
+			Stream.avail_out = (uInt)StreamChunkSize;
+
+			Result = inflate(&Stream, Z_NO_FLUSH);
+			if (Result != Z_OK && Result != Z_STREAM_END)
+			{
+				bSuccess = false;
+				break;
+			}
+
+			const int64 Count = StreamChunkSize - Stream.avail_out;
+			if (Count > 0)
+			{
+				Crc = ZUCrc32::Update(Crc, Output.GetData(), Count);
+				Produced += Count;
+				bSuccess = Sink(Output.GetData(), Count);
+			}
+		}
+		inflateEnd(&Stream);
+	}
+
+	if (!bSuccess)
+	{
+		return false;
+	}
+	if (Produced != Entry.UncompressedSize || Crc != Entry.Crc32)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Size or CRC mismatch for %s in %s"), Entry.Name.GetData(), *ArchivePath);
+		return false;
+	}
+	return true;
+}
+
+bool ZUZipReader::GetStoredRange(int32 EntryIndex, FString& OutPath, uint64& OutOffset)
+{
+	if (!Entries.IsValidIndex(EntryIndex))
+	{
+		return false;
+	}
+
+	FZUZipEntry& Entry = Entries[EntryIndex];
+	if (Entry.bIsDirectory || Entry.Method != MethodStore || Entry.CompressedSize != Entry.UncompressedSize || !IsEntrySupported(Entry) || !ResolveDataOffset(Entry))
+	{
+		return false;
+	}
+	return Volumes.Locate(Entry.DataOffset, Entry.UncompressedSize, OutPath, OutOffset);
+}
+
+bool ZUZipReader::ReadRawEntry(int32 EntryIndex, TFunctionRef<bool(const uint8* Data, int64 Size)> Sink)
+{
+	if (!Entries.IsValidIndex(EntryIndex))
+	{
+		return false;
+	}
+
+	FZUZipEntry& Entry = Entries[EntryIndex];
+	if (!ResolveDataOffset(Entry))
+	{
+		return false;
+	}
+
+	TArray<uint8> Input;
+	Input.SetNumUninitialized(FMath::Min<uint64>(StreamChunkSize, Entry.CompressedSize));
+
+	uint64 Consumed = 0;
+	while (Consumed < Entry.CompressedSize)
+	{
+		const int64 Count = FMath::Min<uint64>(StreamChunkSize, Entry.CompressedSize - Consumed);
+		if (!ReadAt(Entry.DataOffset + Consumed, Input.GetData(), Count) || !Sink(Input.GetData(), Count))
+		{
+			return false;
+		}
+		Consumed += Count;
+	}
+	return true;
+}
+
+bool ZUZipReader::ReadEndOfCentralDirectory(uint64& OutDirectoryOffset, uint64& OutDirectorySize, uint64& OutEntryCount)
+{
+	if (ArchiveSize < EndOfCentralDirectorySize)
+	{
+		return false;
+	}
+
+	//The record sits at the very end, followed only by an optional comment
+	const int64 TailSize = FMath::Min<int64>(ArchiveSize, EndOfCentralDirectorySize + MaxCommentSize);
+	TArray<uint8> Tail;
+	Tail.SetNumUninitialized(TailSize);
+
+	if (!ReadAt(ArchiveSize - TailSize, Tail.GetData(), TailSize))
+	{
+		return false;
+	}
+
+	for (int64 Index = TailSize - EndOfCentralDirectorySize; Index >= 0; Index--)
+	{
+		const uint8* Record = Tail.GetData() + Index;
+		if (ReadU32(Record) != EndOfCentralDirectorySignature)
+		{
+			continue;
+		}
+
+		const uint16 DiskNumber = ReadU16(Record + 4);
+		const uint16 DirectoryDisk = ReadU16(Record + 6);
+		const uint16 EntriesOnDisk = ReadU16(Record + 8);
+		const uint16 TotalEntries = ReadU16(Record + 10);
+
+		OutEntryCount = TotalEntries;
+		OutDirectorySize = ReadU32(Record + 12);
+		OutDirectoryOffset = ReadU32(Record + 16);
+
+		//Saturated fields mean the real values are in the zip64 record, found through the locator right before this one
+		if (DiskNumber == MAX_uint16 || DirectoryDisk == MAX_uint16 || TotalEntries == MAX_uint16 ||
+			OutDirectorySize == MAX_uint32 || OutDirectoryOffset == MAX_uint32)
+		{
+			const int64 LocatorOffset = ArchiveSize - TailSize + Index - Zip64LocatorSize;
+			if (!ReadZip64EndOfCentralDirectory(LocatorOffset, OutDirectoryOffset, OutDirectorySize, OutEntryCount))
+			{
+				return false;
+			}
+		}
+		//Spanned archives are left to 7zip
+		else if (DiskNumber != 0 || DirectoryDisk != 0 || EntriesOnDisk != TotalEntries)
+		{
+			return false;
+		}
+
+		//Both come from the archive, every entry takes at least a fixed header and the directory has to fit in the file
+		if (OutEntryCount > OutDirectorySize / CentralHeaderSize ||
+			OutDirectorySize > (uint64)ArchiveSize || OutDirectoryOffset > (uint64)ArchiveSize - OutDirectorySize)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Central directory of %s doesn't fit its entry count or the archive"), *ArchivePath);
+			return false;
+		}
+		return true;
+	}
+	return false;
+}
+
+bool ZUZipReader::ReadZip64EndOfCentralDirectory(int64 LocatorOffset, uint64& OutDirectoryOffset, uint64& OutDirectorySize, uint64& OutEntryCount)
+{
+	uint8 Locator[Zip64LocatorSize];
+	if (LocatorOffset < 0 || !ReadAt(LocatorOffset, Locator, Zip64LocatorSize) || ReadU32(Locator) != Zip64LocatorSignature)
+	{
+		return false;
+	}
+
+	const uint32 RecordDisk = ReadU32(Locator + 4);
+	const uint64 RecordOffset = ReadU64(Locator + 8);
+	const uint32 TotalDisks = ReadU32(Locator + 16);
+
+	uint8 Record[Zip64EndOfCentralDirectorySize];
+	if (RecordDisk != 0 || TotalDisks > 1 || RecordOffset + Zip64EndOfCentralDirectorySize > (uint64)LocatorOffset ||
+		!ReadAt(RecordOffset, Record, Zip64EndOfCentralDirectorySize) || ReadU32(Record) != Zip64EndOfCentralDirectorySignature)
+	{
+		return false;
+	}
+
+	const uint32 DiskNumber = ReadU32(Record + 16);
+	const uint32 DirectoryDisk = ReadU32(Record + 20);
+	const uint64 EntriesOnDisk = ReadU64(Record + 24);
+	OutEntryCount = ReadU64(Record + 32);
+	OutDirectorySize = ReadU64(Record + 40);
+	OutDirectoryOffset = ReadU64(Record + 48);
+
+	return DiskNumber == 0 && DirectoryDisk == 0 && EntriesOnDisk == OutEntryCount && OutEntryCount <= MAX_int32;
+}
+
+bool ZUZipReader::ReadCentralDirectory(uint64 DirectoryOffset, uint64 DirectorySize, uint64 EntryCount)
+{
+	//Read in one piece, bigger directories can still be listed page by page with OpenForListing
+	if (DirectorySize > (uint64)MAX_int32)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Central directory of %s is too large to read at once"), *ArchivePath);
+		return false;
+	}
+
+	TArray<uint8> Directory;
+	Directory.SetNumUninitialized((int32)DirectorySize);
+
+	if (!ReadAt(DirectoryOffset, Directory.GetData(), DirectorySize))
+	{
+		return false;
+	}
+
+	//Bounded by the directory size when the end record was read
+	Entries.Reserve((int32)EntryCount);
+
+	uint64 Cursor = 0;
+	for (uint64 EntryIndex = 0; EntryIndex < EntryCount; EntryIndex++)
+	{
+		if (Cursor + CentralHeaderSize > DirectorySize)
+		{
+			return false;
+		}
+
+		const uint8* Header = Directory.GetData() + Cursor;
+		const uint64 RecordSize = GetCentralRecordSize(Header);
+
+		FZUZipEntry Entry;
+		if (RecordSize == 0 || Cursor + RecordSize > DirectorySize || !ParseCentralRecord(Header, *Names, Entry))
+		{
+			return false;
+		}
+
+		Entries.Add(MoveTemp(Entry));
+		Cursor += RecordSize;
+	}
+	return true;
+}
+
+bool ZUZipReader::OpenForListing(const FString& InArchivePath)
+{
+	Close();
+
+	ArchivePath = InArchivePath;
+	if (!Volumes.Open(ArchivePath))
+	{
+		return false;
+	}
+	ArchiveSize = Volumes.Size();
+	Names = MakeShared<ZUNamePool>();
+
+	if (!ReadEndOfCentralDirectory(ListingDirectoryOffset, ListingDirectorySize, ListingEntryCount))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool ZUZipReader::ReadEntryPage(int32 MaxEntries, TArray<FZUZipEntry>& OutPage)
+{
+	OutPage.Reset();
+	if (!Names.IsValid())
+	{
+		return false;
+	}
+
+	//Only one page of names is ever kept
+	Names->Reset();
+
+	while (OutPage.Num() < MaxEntries && ListingEntriesRead < ListingEntryCount)
+	{
+		//Refills from the current record whenever the rest of it isn't in the chunk yet
+		uint64 ChunkEnd = ListingChunkStart + ListingChunk.Num();
+		uint64 RecordSize = 0;
+		for (int32 Attempt = 0; Attempt < 2; Attempt++)
+		{
+			if (ListingCursor + CentralHeaderSize <= ChunkEnd)
+			{
+				RecordSize = GetCentralRecordSize(ListingChunk.GetData() + (ListingCursor - ListingChunkStart));
+				if (RecordSize == 0 || ListingCursor + RecordSize <= ChunkEnd)
+				{
+					break;
+				}
+			}
+
+			const uint64 Count = FMath::Min(ListingChunkSize, ListingDirectorySize - ListingCursor);
+			ListingChunk.SetNumUninitialized(Count, false);
+			ListingChunkStart = ListingCursor;
+			ChunkEnd = ListingChunkStart + Count;
+			if (!ReadAt(ListingDirectoryOffset + ListingCursor, ListingChunk.GetData(), Count))
+			{
+				return false;
+			}
+			RecordSize = 0;
+		}
+
+		FZUZipEntry Entry;
+		if (RecordSize == 0 || ListingCursor + RecordSize > ChunkEnd || !ParseCentralRecord(ListingChunk.GetData() + (ListingCursor - ListingChunkStart), *Names, Entry))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Corrupt central directory in %s"), *ArchivePath);
+			return false;
+		}
+
+		OutPage.Add(MoveTemp(Entry));
+		ListingCursor += RecordSize;
+		ListingEntriesRead++;
+	}
+	return true;
+}
+
+bool ZUZipReader::ResolveDataOffset(FZUZipEntry& Entry)
+{
+	if (Entry.DataOffset != 0)
+	{
+		return true;
+	}
+
+	uint8 Header[LocalHeaderSize];
+	if (!ReadAt(Entry.LocalHeaderOffset, Header, LocalHeaderSize) || ReadU32(Header) != LocalHeaderSignature)
+	{
+		return false;
+	}
+
+	//Local extra fields may differ from the central ones, so the local lengths decide where data starts
+	const uint16 NameLength = ReadU16(Header + 26);
+	const uint16 ExtraLength = ReadU16(Header + 28);
+	Entry.DataOffset = Entry.LocalHeaderOffset + LocalHeaderSize + NameLength + ExtraLength;
+
+	return Entry.DataOffset + Entry.CompressedSize <= (uint64)ArchiveSize;
+}
+
+bool ZUZipReader::ReadAt(uint64 Offset, uint8* Dest, uint64 Count)
+{
+	return Volumes.ReadAt(Offset, Dest, Count);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ZUVolumeFile.h"
+#include "ZUNamePool.h"
+
+/** A single entry as described by the zip central directory. */
+struct FZUZipEntry
+{
+	//Points into the name pool of the reader that parsed it, see ZUNamePool
+	FStringView Name;
+
+	uint64 CompressedSize = 0;
+	uint64 UncompressedSize = 0;
+	uint64 LocalHeaderOffset = 0;
+
+	//Resolved lazily from the local header, 0 until then
+	uint64 DataOffset = 0;
+
+	uint32 Crc32 = 0;
+	uint32 DosTime = 0;
+	uint16 Method = 0;
+	uint16 Flags = 0;
+	bool bIsDirectory = false;
+
+	// Copy of the name for when it has to outlive the reader or is handed out, e.g. to Blueprint
+	FString GetName() const { return FString(Name.Len(), Name.GetData()); }
+};
+
+/**
+ * Native reader for .zip archives. Parses the central directory once and decodes stored and
+ * deflated entries without going through 7z.dll. Anything it can't handle (encryption, other
+ * methods) is reported through IsSupported() so callers can fall back to the 7zpp path.
+ * Opening the first volume of a split archive (.001) reads the whole volume set.
+ */
+class ZUZipReader
+{
+public:
+	ZUZipReader();
+	~ZUZipReader();
+
+	// Opens the archive and reads its central directory. Returns false if this isn't a readable zip.
+	bool Open(const FString& InArchivePath);
+	void Close();
+
+	// Opens a second handle on an archive Other already parsed, so both readers can be used from different threads
+	bool OpenFrom(const ZUZipReader& Other);
+
+	// True if every entry in the archive can be decoded natively
+	bool IsSupported() const;
+	bool IsEntrySupported(const FZUZipEntry& Entry) const;
+
+	const TArray<FZUZipEntry>& GetEntries() const { return Entries; }
+	const FString& GetArchivePath() const { return ArchivePath; }
+	uint64 GetTotalUncompressedSize() const;
+
+	// Modification time of an entry, 1980-01-01 if the stored value isn't a valid date
+	static FDateTime FromDosTime(uint32 DosTime);
+
+	// Reads and decodes the whole entry into OutData, verifying size and CRC.
+	bool ReadEntry(int32 EntryIndex, TArray<uint8>& OutData);
+
+	// Decodes the entry in chunks, handing each to Sink as it is produced. Sink returns false to abort.
+	bool ReadEntryStreamed(int32 EntryIndex, TFunctionRef<bool(const uint8* Data, int64 Size)> Sink);
+
+	// Hands the entry's data to Sink as stored in the archive, still compressed, e.g. to copy it into another archive
+	bool ReadRawEntry(int32 EntryIndex, TFunctionRef<bool(const uint8* Data, int64 Size)> Sink);
+
+	/**
+	 * Opens the archive for listing only. The central directory isn't parsed up front, ReadEntryPage reads it
+	 * in bounded chunks instead, so an archive with millions of entries never has them all in memory.
+	 * GetEntries stays empty and nothing can be extracted through this reader.
+	 */
+	bool OpenForListing(const FString& InArchivePath);
+
+	// Next MaxEntries entries in central directory order, fewer at the end and none once all were read.
+	// Their names stay valid until the next call.
+	bool ReadEntryPage(int32 MaxEntries, TArray<FZUZipEntry>& OutPage);
+
+	uint64 GetListingEntryCount() const { return ListingEntryCount; }
+	uint64 GetListingEntriesRead() const { return ListingEntriesRead; }
+
+	// File and offset holding the content of a stored entry in one piece, so it can be copied without decoding.
+	// False for compressed entries and ones split across volumes.
+	bool GetStoredRange(int32 EntryIndex, FString& OutPath, uint64& OutOffset);
+
+private:
+	bool ReadEndOfCentralDirectory(uint64& OutDirectoryOffset, uint64& OutDirectorySize, uint64& OutEntryCount);
+	bool ReadZip64EndOfCentralDirectory(int64 LocatorOffset, uint64& OutDirectoryOffset, uint64& OutDirectorySize, uint64& OutEntryCount);
+	bool ReadCentralDirectory(uint64 DirectoryOffset, uint64 DirectorySize, uint64 EntryCount);
+	bool ResolveDataOffset(FZUZipEntry& Entry);
+	bool ReadAt(uint64 Offset, uint8* Dest, uint64 Count);
+
+	FString ArchivePath;
+	ZUVolumeReader Volumes;
+	int64 ArchiveSize;
+	TArray<FZUZipEntry> Entries;
+
+	//Shared with readers opened through OpenFrom, whose entries point into it as well
+	TSharedPtr<ZUNamePool> Names;
+
+	//Page by page listing state, see OpenForListing
+	uint64 ListingDirectoryOffset = 0;
+	uint64 ListingDirectorySize = 0;
+	uint64 ListingEntryCount = 0;
+	uint64 ListingEntriesRead = 0;
+	uint64 ListingCursor = 0;
+	uint64 ListingChunkStart = 0;
+	TArray<uint8> ListingChunk;
+};
@@ -0,0 +1,610 @@
+#include "ZUZipWriter.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUZipReader.h"
+#include "ZUVolumeFile.h"
+#include "HAL/PlatformFilemanager.h"
+
+namespace
+{
+	const uint32 LocalHeaderSignature = 0x04034b50;
+	const uint32 CentralHeaderSignature = 0x02014b50;
+	const uint32 EndOfCentralDirectorySignature = 0x06054b50;
+	const uint32 Zip64EndOfCentralDirectorySignature = 0x06064b50;
+	const uint32 Zip64LocatorSignature = 0x07064b50;
+	const uint32 DataDescriptorSignature = 0x08074b50;
+
+	const int32 LocalHeaderSize = 30;
+	const int32 CentralHeaderSize = 46;
+	const int32 EndOfCentralDirectorySize = 22;
+	const int32 Zip64EndOfCentralDirectorySize = 56;
+	const int32 Zip64LocatorSize = 20;
+
+	//Offset of the crc and size fields inside the local header, patched for streamed entries
+	const int32 LocalHeaderCrcOffset = 14;
+
+	//Local zip64 extras always carry both sizes
+	const uint16 Zip64ExtraId = 0x0001;
+	const int32 LocalZip64ExtraSize = 4 + 16;
+
+	//Streamed entries expected this close to 4GB reserve a zip64 extra, deflate can grow incompressible input a little
+	const uint64 Zip64StreamThreshold = 0xF0000000;
+
+	const uint16 VersionNeeded = 20;
+	const uint16 VersionNeededZip64 = 45;
+	const uint16 FlagDataDescriptor = 1 << 3;
+	const uint16 FlagUtf8Name = 1 << 11;
+	const uint32 DosDirectoryAttribute = 0x10;
+
+	const int64 StagingBufferSize = 1024 * 1024;
+
+	void WriteU16(uint8* Dest, uint16 Value)
+	{
+		Dest[0] = (uint8)Value;
+		Dest[1] = (uint8)(Value >> 8);
+	}
+
+	void WriteU32(uint8* Dest, uint32 Value)
+	{
+		Dest[0] = (uint8)Value;
+		Dest[1] = (uint8)(Value >> 8);
+		Dest[2] = (uint8)(Value >> 16);
+		Dest[3] = (uint8)(Value >> 24);
+	}
+
+	void WriteU64(uint8* Dest, uint64 Value)
+	{
+		WriteU32(Dest, (uint32)Value);
+		WriteU32(Dest + 4, (uint32)(Value >> 32));
+	}
+
+	bool IsAscii(const FString& Name)
+	{
+		for (const TCHAR* Character = *Name; *Character; Character++)
+		{
+			if (*Character > 0x7F)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//A field holding exactly MAX_uint32 already means "see the zip64 extra" to readers
+	bool FitsClassicZip(uint64 Value)
+	{
+		return Value < MAX_uint32;
+	}
+
+	uint16 EntryFlags(const FZUZipWrittenEntry& Entry)
+	{
+		return (IsAscii(Entry.Name) ? 0 : FlagUtf8Name) | (Entry.bHasDataDescriptor ? FlagDataDescriptor : 0);
+	}
+}
+
+ZUZipWriter::ZUZipWriter()
+{
+	Handle = nullptr;
+	Offset = 0;
+	bSequential = false;
+	bEntryOpen = false;
+	bFailed = false;
+}
+
+ZUZipWriter::~ZUZipWriter()
+{
+	if (IsOpen())
+	{
+		Abort();
+	}
+}
+
+bool ZUZipWriter::Open(const FString& InArchivePath, bool bInSequential)
+{
+	ArchivePath = InArchivePath;
+	bSequential = bInSequential;
+	Handle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*ArchivePath);
+	if (Handle == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to open %s for writing"), *ArchivePath);
+		return false;
+	}
+
+	Buffer.Reserve(StagingBufferSize);
+	Offset = 0;
+	Entries.Empty();
+	bEntryOpen = false;
+	bFailed = false;
+	return true;
+}
+
+bool ZUZipWriter::OpenVolumes(const FString& InArchivePath, int64 VolumeSize)
+{
+	ArchivePath = InArchivePath;
+	bSequential = true;
+
+	Volumes = MakeUnique<ZUVolumeWriter>();
+	if (!Volumes->Open(ArchivePath, VolumeSize))
+	{
+		Volumes.Reset();
+		return false;
+	}
+
+	Buffer.Reserve(StagingBufferSize);
+	Offset = 0;
+	Entries.Empty();
+	bEntryOpen = false;
+	bFailed = false;
+	return true;
+}
+
+bool ZUZipWriter::IsOpen() const
+{
+	return Handle != nullptr || Volumes.IsValid();
+}
+
+bool ZUZipWriter::Close()
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	bool bSuccess = !bFailed && !bEntryOpen && WriteCentralDirectory() && FlushBuffer();
+
+	if (Volumes.IsValid())
+	{
+		bSuccess = Volumes->Close() && bSuccess;
+		if (!bSuccess)
+		{
+			Volumes->Abort();
+		}
+		Volumes.Reset();
+	}
+	else
+	{
+		delete Handle;
+		Handle = nullptr;
+	}
+
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Failed to write %s"), *ArchivePath);
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*ArchivePath);
+	}
+	return bSuccess;
+}
+
+void ZUZipWriter::Abort()
+{
+	if (Volumes.IsValid())
+	{
+		Volumes->Abort();
+		Volumes.Reset();
+	}
+	if (Handle != nullptr)
+	{
+		delete Handle;
+		Handle = nullptr;
+	}
+	Buffer.Reset();
+	FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*ArchivePath);
+}
+
+uint32 ZUZipWriter::ToDosTime(const FDateTime& Time)
+{
+	//Dos dates start in 1980 and count seconds in steps of two
+	if (Time.GetYear() < 1980)
+	{
+		return (1 << 21) | (1 << 16);
+	}
+	return ((uint32)(Time.GetYear() - 1980) << 25) | ((uint32)Time.GetMonth() << 21) | ((uint32)Time.GetDay() << 16) |
+		((uint32)Time.GetHour() << 11) | ((uint32)Time.GetMinute() << 5) | ((uint32)Time.GetSecond() >> 1);
+}
+
+bool ZUZipWriter::AddDirectory(const FString& Name, const FDateTime& ModifiedTime)
+{
+	FZUZipWrittenEntry Entry;
+	Entry.Name = Name.EndsWith(TEXT("/")) ? Name : Name + TEXT("/");
+	Entry.LocalHeaderOffset = Offset;
+	Entry.DosTime = ToDosTime(ModifiedTime);
+	Entry.Method = MethodStore;
+	Entry.bIsDirectory = true;
+
+	if (!WriteLocalHeader(Entry))
+	{
+		return false;
+	}
+	Entries.Add(MoveTemp(Entry));
+	return true;
+}
+
+bool ZUZipWriter::AddEncodedEntry(const FString& Name, uint16 Method, uint32 Crc32, uint64 UncompressedSize, const uint8* Data, uint64 DataSize, const FDateTime& ModifiedTime)
+{
+	FZUZipWrittenEntry Entry;
+	Entry.Name = Name;
+	Entry.CompressedSize = DataSize;
+	Entry.UncompressedSize = UncompressedSize;
+	Entry.LocalHeaderOffset = Offset;
+	Entry.Crc32 = Crc32;
+	Entry.DosTime = ToDosTime(ModifiedTime);
+	Entry.Method = Method;
+	Entry.bLocalZip64 = !FitsClassicZip(UncompressedSize) || !FitsClassicZip(DataSize);
+
+	if (!WriteLocalHeader(Entry) || !Write(Data, DataSize))
+	{
+		return false;
+	}
+	Entries.Add(MoveTemp(Entry));
+	return true;
+}
+
+bool ZUZipWriter::BeginEntry(const FString& Name, uint16 Method, const FDateTime& ModifiedTime, uint64 ExpectedSize)
+{
+	if (bEntryOpen)
+	{
+		bFailed = true;
+		return false;
+	}
+
+	FZUZipWrittenEntry Entry;
+	Entry.Name = Name;
+	Entry.LocalHeaderOffset = Offset;
+	Entry.DosTime = ToDosTime(ModifiedTime);
+	Entry.Method = Method;
+	Entry.bLocalZip64 = ExpectedSize >= Zip64StreamThreshold;
+	Entry.bHasDataDescriptor = bSequential;
+
+	if (!WriteLocalHeader(Entry))
+	{
+		return false;
+	}
+	Entries.Add(MoveTemp(Entry));
+	bEntryOpen = true;
+	return true;
+}
+
+bool ZUZipWriter::AppendEntryData(const uint8* Data, int64 Size)
+{
+	if (!bEntryOpen)
+	{
+		return false;
+	}
+	Entries.Last().CompressedSize += Size;
+	return Write(Data, Size);
+}
+
+bool ZUZipWriter::FinishEntry(uint32 Crc32, uint64 UncompressedSize)
+{
+	if (!bEntryOpen)
+	{
+		return false;
+	}
+	bEntryOpen = false;
+
+	FZUZipWrittenEntry& Entry = Entries.Last();
+	Entry.Crc32 = Crc32;
+	Entry.UncompressedSize = UncompressedSize;
+
+	//Without a reserved extra there is nowhere to put 64 bit sizes in the local header
+	if (!Entry.bLocalZip64 && (!FitsClassicZip(Entry.CompressedSize) || !FitsClassicZip(Entry.UncompressedSize)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s grew past 4GB without being announced as a zip64 entry"), *Entry.Name);
+		bFailed = true;
+		return false;
+	}
+
+	if (Entry.bHasDataDescriptor)
+	{
+		uint8 Descriptor[24];
+		WriteU32(Descriptor, DataDescriptorSignature);
+		WriteU32(Descriptor + 4, Entry.Crc32);
+		if (Entry.bLocalZip64)
+		{
+			WriteU64(Descriptor + 8, Entry.CompressedSize);
+			WriteU64(Descriptor + 16, Entry.UncompressedSize);
+			return Write(Descriptor, 24);
+		}
+		WriteU32(Descriptor + 8, (uint32)Entry.CompressedSize);
+		WriteU32(Descriptor + 12, (uint32)Entry.UncompressedSize);
+		return Write(Descriptor, 16);
+	}
+
+	uint8 Fields[12];
+	WriteU32(Fields, Entry.Crc32);
+	WriteU32(Fields + 4, Entry.bLocalZip64 ? MAX_uint32 : (uint32)Entry.CompressedSize);
+	WriteU32(Fields + 8, Entry.bLocalZip64 ? MAX_uint32 : (uint32)Entry.UncompressedSize);
+
+	if (!PatchAt(Entry.LocalHeaderOffset + LocalHeaderCrcOffset, Fields, sizeof(Fields)))
+	{
+		return false;
+	}
+	if (!Entry.bLocalZip64)
+	{
+		return true;
+	}
+
+	uint8 Sizes[16];
+	WriteU64(Sizes, Entry.UncompressedSize);
+	WriteU64(Sizes + 8, Entry.CompressedSize);
+	return PatchAt(Entry.LocalHeaderOffset + LocalHeaderSize + FTCHARToUTF8(*Entry.Name).Length() + 4, Sizes, sizeof(Sizes));
+}
+
+bool ZUZipWriter::PatchAt(uint64 PatchOffset, const uint8* Data, int32 Size)
+{
+	//The bytes may still be staged, otherwise seek back and patch them on disk
+	const uint64 BufferStart = Offset - Buffer.Num();
+	if (PatchOffset >= BufferStart)
+	{
+		FMemory::Memcpy(Buffer.GetData() + (PatchOffset - BufferStart), Data, Size);
+		return true;
+	}
+
+	//Volume output is sequential and never gets here
+	if (Handle == nullptr || !FlushBuffer() || !Handle->Seek(PatchOffset) || !Handle->Write(Data, Size) || !Handle->Seek(Offset))
+	{
+		bFailed = true;
+		return false;
+	}
+	return true;
+}
+
+bool ZUZipWriter::CopyEntry(ZUZipReader& Reader, int32 EntryIndex)
+{
+	if (bEntryOpen || !Reader.GetEntries().IsValidIndex(EntryIndex))
+	{
+		return false;
+	}
+
+	const FZUZipEntry& Source = Reader.GetEntries()[EntryIndex];
+	if (!Reader.IsEntrySupported(Source))
+	{
+		return false;
+	}
+
+	FZUZipWrittenEntry Entry;
+	Entry.Name = Source.GetName();
+	Entry.CompressedSize = Source.CompressedSize;
+	Entry.UncompressedSize = Source.UncompressedSize;
+	Entry.LocalHeaderOffset = Offset;
+	Entry.Crc32 = Source.Crc32;
+	Entry.DosTime = Source.DosTime;
+	Entry.Method = Source.Method;
+	Entry.bIsDirectory = Source.bIsDirectory;
+	Entry.bLocalZip64 = !FitsClassicZip(Source.UncompressedSize) || !FitsClassicZip(Source.CompressedSize);
+
+	if (!WriteLocalHeader(Entry))
+	{
+		return false;
+	}
+	if (!Reader.ReadRawEntry(EntryIndex, [this](const uint8* Data, int64 Size)
+	{
+		return Write(Data, Size);
+	}))
+	{
+		bFailed = true;
+		return false;
+	}
+	Entries.Add(MoveTemp(Entry));
+	return true;
+}
+
+bool ZUZipWriter::WriteLocalHeader(const FZUZipWrittenEntry& Entry)
+{
+	FTCHARToUTF8 Name(*Entry.Name);
+
+	uint8 Header[LocalHeaderSize];
+	WriteU32(Header, LocalHeaderSignature);
+	WriteU16(Header + 4, Entry.bLocalZip64 ? VersionNeededZip64 : VersionNeeded);
+	WriteU16(Header + 6, EntryFlags(Entry));
+	WriteU16(Header + 8, Entry.Method);
+	WriteU32(Header + 10, Entry.DosTime);
+	WriteU32(Header + 14, Entry.Crc32);
+	WriteU32(Header + 18, Entry.bLocalZip64 ? MAX_uint32 : (uint32)Entry.CompressedSize);
+	WriteU32(Header + 22, Entry.bLocalZip64 ? MAX_uint32 : (uint32)Entry.UncompressedSize);
+	WriteU16(Header + 26, (uint16)Name.Length());
+	WriteU16(Header + 28, Entry.bLocalZip64 ? LocalZip64ExtraSize : 0);
+
+	if (!Write(Header, LocalHeaderSize) || !Write(Name.Get(), Name.Length()))
+	{
+		return false;
+	}
+	if (!Entry.bLocalZip64)
+	{
+		return true;
+	}
+
+	uint8 Extra[LocalZip64ExtraSize];
+	WriteU16(Extra, Zip64ExtraId);
+	WriteU16(Extra + 2, 16);
+	WriteU64(Extra + 4, Entry.UncompressedSize);
+	WriteU64(Extra + 12, Entry.CompressedSize);
+	return Write(Extra, LocalZip64ExtraSize);
+}
+
+bool ZUZipWriter::WriteCentralDirectory()
+{
+	const uint64 DirectoryOffset = Offset;
+
+	for (const FZUZipWrittenEntry& Entry : Entries)
+	{
+		FTCHARToUTF8 Name(*Entry.Name);
+
+		//Only the fields that don't fit go into the extra, in the order the format fixes
+		uint8 Extra[4 + 24];
+		int32 ExtraSize = 4;
+		const bool bLargeUncompressed = !FitsClassicZip(Entry.UncompressedSize);
+		const bool bLargeCompressed = !FitsClassicZip(Entry.CompressedSize);
+		const bool bLargeOffset = !FitsClassicZip(Entry.LocalHeaderOffset);
+		if (bLargeUncompressed)
+		{
+			WriteU64(Extra + ExtraSize, Entry.UncompressedSize);
+			ExtraSize += 8;
+		}
+		if (bLargeCompressed)
+		{
+			WriteU64(Extra + ExtraSize, Entry.CompressedSize);
+			ExtraSize += 8;
+		}
+		if (bLargeOffset)
+		{
+			WriteU64(Extra + ExtraSize, Entry.LocalHeaderOffset);
+			ExtraSize += 8;
+		}
+		WriteU16(Extra, Zip64ExtraId);
+		WriteU16(Extra + 2, (uint16)(ExtraSize - 4));
+
+		const bool bZip64 = ExtraSize > 4;
+		const uint16 Version = (bZip64 || Entry.bLocalZip64) ? VersionNeededZip64 : VersionNeeded;
+
+		uint8 Header[CentralHeaderSize];
+		WriteU32(Header, CentralHeaderSignature);
+		WriteU16(Header + 4, Version);
+		WriteU16(Header + 6, Version);
+		WriteU16(Header + 8, EntryFlags(Entry));
+		WriteU16(Header + 10, Entry.Method);
+		WriteU32(Header + 12, Entry.DosTime);
+		WriteU32(Header + 16, Entry.Crc32);
+		WriteU32(Header + 20, bLargeCompressed ? MAX_uint32 : (uint32)Entry.CompressedSize);
+		WriteU32(Header + 24, bLargeUncompressed ? MAX_uint32 : (uint32)Entry.UncompressedSize);
+		WriteU16(Header + 28, (uint16)Name.Length());
+		WriteU16(Header + 30, bZip64 ? (uint16)ExtraSize : 0);
+		WriteU16(Header + 32, 0);
+		WriteU16(Header + 34, 0);
+		WriteU16(Header + 36, 0);
+		WriteU32(Header + 38, Entry.bIsDirectory ? DosDirectoryAttribute : 0);
+		WriteU32(Header + 42, bLargeOffset ? MAX_uint32 : (uint32)Entry.LocalHeaderOffset);
+
+		if (!Write(Header, CentralHeaderSize) || !Write(Name.Get(), Name.Length()) || (bZip64 && !Write(Extra, ExtraSize)))
+		{
+			return false;
+		}
+	}
+
+	const uint64 DirectorySize = Offset - DirectoryOffset;
+	const uint64 EntryCount = Entries.Num();
+	const bool bZip64 = EntryCount >= MAX_uint16 || !FitsClassicZip(DirectoryOffset) || !FitsClassicZip(DirectorySize);
+
+	if (bZip64)
+	{
+		const uint64 RecordOffset = Offset;
+
+		uint8 Record64[Zip64EndOfCentralDirectorySize];
+		WriteU32(Record64, Zip64EndOfCentralDirectorySignature);
+		WriteU64(Record64 + 4, Zip64EndOfCentralDirectorySize - 12);
+		WriteU16(Record64 + 12, VersionNeededZip64);
+		WriteU16(Record64 + 14, VersionNeededZip64);
+		WriteU32(Record64 + 16, 0);
+		WriteU32(Record64 + 20, 0);
+		WriteU64(Record64 + 24, EntryCount);
+		WriteU64(Record64 + 32, EntryCount);
+		WriteU64(Record64 + 40, DirectorySize);
+		WriteU64(Record64 + 48, DirectoryOffset);
+
+		uint8 Locator[Zip64LocatorSize];
+		WriteU32(Locator, Zip64LocatorSignature);
+		WriteU32(Locator + 4, 0);
+		WriteU64(Locator + 8, RecordOffset);
+		WriteU32(Locator + 16, 1);
+
+		if (!Write(Record64, Zip64EndOfCentralDirectorySize) || !Write(Locator, Zip64LocatorSize))
+		{
+			return false;
+		}
+	}
+
+	//Saturated fields send readers to the zip64 record
+	const uint16 ClassicCount = bZip64 ? MAX_uint16 : (uint16)EntryCount;
+
+	uint8 Record[EndOfCentralDirectorySize];
+	WriteU32(Record, EndOfCentralDirectorySignature);
+	WriteU16(Record + 4, 0);
+	WriteU16(Record + 6, 0);
+	WriteU16(Record + 8, ClassicCount);
+	WriteU16(Record + 10, ClassicCount);
+	WriteU32(Record + 12, bZip64 ? MAX_uint32 : (uint32)DirectorySize);
+	WriteU32(Record + 16, bZip64 ? MAX_uint32 : (uint32)DirectoryOffset);
+	WriteU16(Record + 20, 0);
+
+	return Write(Record, EndOfCentralDirectorySize);
+}
+
+bool ZUZipWriter::Write(const void* Data, int64 Size)
+{
+	if (bFailed || !IsOpen())
+	{
+		return false;
+	}
+
+	//Large blocks go straight through once whatever is staged ahead of them is out
+	if (Size >= StagingBufferSize)
+	{
+		if (!FlushBuffer())
+		{
+			return false;
+		}
+
+		if (!Volumes.IsValid())
+		{
+			if (!Handle->Write((const uint8*)Data, Size))
+			{
+				bFailed = true;
+				return false;
+			}
+			Offset += Size;
+			return true;
+		}
+
+		//Volume blocks are TArrays, anything past what an int32 can count goes in several
+		const uint8* Block = (const uint8*)Data;
+		for (int64 Remaining = Size; Remaining > 0;)
+		{
+			const int32 BlockSize = (int32)FMath::Min<int64>(Remaining, MAX_int32);
+			if (!Volumes->Write(TArray<uint8>(Block, BlockSize)))
+			{
+				bFailed = true;
+				return false;
+			}
+			Block += BlockSize;
+			Remaining -= BlockSize;
+			Offset += BlockSize;
+		}
+		return true;
+	}
+
+	if (Buffer.Num() + Size > StagingBufferSize && !FlushBuffer())
+	{
+		return false;
+	}
+	//Smaller than StagingBufferSize here, so it fits the buffer's int32 count
+	Buffer.Append((const uint8*)Data, (int32)Size);
+	Offset += Size;
+	return true;
+}
+
+bool ZUZipWriter::FlushBuffer()
+{
+	if (Buffer.Num() == 0)
+	{
+		return !bFailed;
+	}
+
+	//Volumes take the staged block as is and get a fresh one, the old block is written out in the background
+	if (Volumes.IsValid())
+	{
+		if (!Volumes->Write(MoveTemp(Buffer)))
+		{
+			bFailed = true;
+			return false;
+		}
+		Buffer.Reserve(StagingBufferSize);
+		return true;
+	}
+
+	if (Handle == nullptr || !Handle->Write(Buffer.GetData(), Buffer.Num()))
+	{
+		bFailed = true;
+		return false;
+	}
+	Buffer.Reset();
+	return true;
+}
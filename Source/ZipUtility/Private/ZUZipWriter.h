@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+class ZUVolumeWriter;
+class ZUZipReader;
+
+/** Central directory record kept for every entry written so far. */
+struct FZUZipWrittenEntry
+{
+	FString Name;
+
+	uint64 CompressedSize = 0;
+	uint64 UncompressedSize = 0;
+	uint64 LocalHeaderOffset = 0;
+
+	uint32 Crc32 = 0;
+	uint32 DosTime = 0;
+	uint16 Method = 0;
+	bool bIsDirectory = false;
+
+	// Local header carries a zip64 extra with both sizes
+	bool bLocalZip64 = false;
+
+	// Sizes and crc follow the data instead of being patched into the local header
+	bool bHasDataDescriptor = false;
+};
+
+/**
+ * Sequential .zip writer. Entries are either handed over already encoded (stored or raw deflate)
+ * or streamed between BeginEntry and FinishEntry, in which case the local header is patched once
+ * the sizes are known, or a data descriptor follows the entry when the writer never seeks back.
+ * Output goes through a staging buffer so small headers don't each hit disk. Zip64 records are
+ * added as soon as a size, offset or the entry count outgrows the classic fields.
+ */
+class ZUZipWriter
+{
+public:
+	static const uint16 MethodStore = 0;
+	static const uint16 MethodDeflate = 8;
+
+	ZUZipWriter();
+	~ZUZipWriter();
+
+	// Sequential archives never seek back, every streamed entry ends in a data descriptor instead
+	bool Open(const FString& InArchivePath, bool bInSequential = false);
+
+	// Writes the archive as <InArchivePath>.001, .002, ... of VolumeSize bytes each. Always sequential.
+	bool OpenVolumes(const FString& InArchivePath, int64 VolumeSize);
+
+	bool IsOpen() const;
+
+	// Writes the central directory and closes the file. Returns false if anything along the way failed.
+	bool Close();
+
+	// Closes and deletes a partially written archive
+	void Abort();
+
+	bool AddDirectory(const FString& Name, const FDateTime& ModifiedTime);
+	bool AddEncodedEntry(const FString& Name, uint16 Method, uint32 Crc32, uint64 UncompressedSize, const uint8* Data, uint64 DataSize, const FDateTime& ModifiedTime);
+
+	// ExpectedSize is the uncompressed size as far as it is known, close to 4GB or more reserves zip64 fields
+	bool BeginEntry(const FString& Name, uint16 Method, const FDateTime& ModifiedTime, uint64 ExpectedSize = 0);
+	bool AppendEntryData(const uint8* Data, int64 Size);
+	bool FinishEntry(uint32 Crc32, uint64 UncompressedSize);
+
+	// Copies an entry of another archive as is, without decoding or compressing it again
+	bool CopyEntry(ZUZipReader& Reader, int32 EntryIndex);
+
+	static uint32 ToDosTime(const FDateTime& Time);
+
+	const FString& GetArchivePath() const { return ArchivePath; }
+
+private:
+	bool WriteLocalHeader(const FZUZipWrittenEntry& Entry);
+	bool WriteCentralDirectory();
+
+	// Overwrites bytes already written, staged or not
+	bool PatchAt(uint64 PatchOffset, const uint8* Data, int32 Size);
+
+	bool Write(const void* Data, int64 Size);
+	bool FlushBuffer();
+
+	FString ArchivePath;
+	IFileHandle* Handle;
+	TUniquePtr<ZUVolumeWriter> Volumes;
+	TArray<uint8> Buffer;
+
+	// Logical write position, including what is still staged
+	uint64 Offset;
+
+	TArray<FZUZipWrittenEntry> Entries;
+	bool bSequential;
+	bool bEntryOpen;
+	bool bFailed;
+};
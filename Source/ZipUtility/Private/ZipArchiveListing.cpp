@@ -0,0 +1,62 @@
+#include "ZipArchiveListing.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZUZipReader.h"
+
+bool UZipArchiveListing::Open(const FString& ArchivePath, int32 InPageSize)
+{
+	CloseListing();
+
+	Reader = MakeShareable(new ZUZipReader());
+	if (!Reader->OpenForListing(ArchivePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s is not a zip archive that can be listed by page"), *ArchivePath);
+		Reader.Reset();
+		return false;
+	}
+	PageSize = FMath::Max(InPageSize, 1);
+	return true;
+}
+
+bool UZipArchiveListing::NextPage(TArray<FString>& Names, TArray<int64>& Sizes, int32& FirstIndex)
+{
+	Names.Reset();
+	Sizes.Reset();
+	if (!Reader.IsValid())
+	{
+		return false;
+	}
+
+	FirstIndex = (int32)Reader->GetListingEntriesRead();
+
+	TArray<FZUZipEntry> Page;
+	if (!Reader->ReadEntryPage(PageSize, Page) || Page.Num() == 0)
+	{
+		CloseListing();
+		return false;
+	}
+
+	Names.Reserve(Page.Num());
+	Sizes.Reserve(Page.Num());
+	for (const FZUZipEntry& Entry : Page)
+	{
+		Names.Add(Entry.GetName());
+		Sizes.Add((int64)Entry.UncompressedSize);
+	}
+	return true;
+}
+
+int64 UZipArchiveListing::GetTotalEntries() const
+{
+	return Reader.IsValid() ? (int64)Reader->GetListingEntryCount() : 0;
+}
+
+void UZipArchiveListing::CloseListing()
+{
+	Reader.Reset();
+}
+
+void UZipArchiveListing::BeginDestroy()
+{
+	CloseListing();
+	Super::BeginDestroy();
+}
@@ -10,7 +10,7 @@ UZipFileFunctionInternalCallback::UZipFileFunctionInternalCallback()
 	Callback = NULL;
 }
 
-void UZipFileFunctionInternalCallback::OnFileFound_Implementation(const FString& archive, const FString& fileIn, int32 size)
+void UZipFileFunctionInternalCallback::OnFileFound_Implementation(const FString& archive, const FString& fileIn, int64 size)
 {
 	if (!bFileFound && fileIn.ToLower().Contains(File.ToLower()))
 	{
@@ -45,17 +45,17 @@ public:
 	UZipFileFunctionInternalCallback();
 
 	//IZipUtilityInterface overrides
-	virtual void OnProgress_Implementation(const FString& archive, float percentage, int32 bytes) override {};
+	virtual void OnProgress_Implementation(const FString& archive, float percentage, int64 bytes) override {};
 
 	virtual void OnDone_Implementation(const FString& archive, EZipUtilityCompletionState CompletionState) override {};
 
-	virtual void OnStartProcess_Implementation(const FString& archive, int32 bytes) override {};
+	virtual void OnStartProcess_Implementation(const FString& archive, int64 bytes) override {};
 
 	virtual void OnFileDone_Implementation(const FString& archive, const FString& file) override {
 		UE_LOG(LogTemp, Log, TEXT("OnFileDone_Implementation")); 
 	};
 
-	virtual void OnFileFound_Implementation(const FString& archive, const FString& fileIn, int32 size) override;
+	virtual void OnFileFound_Implementation(const FString& archive, const FString& fileIn, int64 size) override;
 
 	void SetCallback(const FString& FileName, UObject* CallbackIn, EZipUtilityCompressionFormat CompressionFormatIn = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN);
 	void SetCallback(const FString& FileName, const FString& DestinationFolder, UObject* CallbackIn, EZipUtilityCompressionFormat CompressionFormatIn = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN);
@@ -9,8 +9,19 @@
 #include "ZULambdaDelegate.h"
 #include "SevenZipCallbackHandler.h"
 #include "WindowsFileUtilityFunctionLibrary.h"
-
+#include "ZUZipExtractor.h"
+#include "ZUFormatSniffer.h"
+#include "ZUZipCompressor.h"
+#include "ZUVolumeFile.h"
+#include "ZUTarGz.h"
+#include "ZUManifest.h"
+#include "ZUZipPatch.h"
+#include "ZUEntryFilter.h"
+#include "ZUSharedOperation.h"
+
+#if WITH_SEVENZIP
 #include "7zpp.h"
+#endif
 
 using namespace SevenZip;
 
@@ -35,6 +46,7 @@ namespace{
 		return WFULambdaRunnable::AddLambdaToQueue(InFunction);
 	}
 
+#if WITH_SEVENZIP
 	//Private static vars
 	SevenZipLibrary SZLib;
 
@@ -66,6 +78,7 @@ namespace{
 	{
 		return forwardPath.Replace(TEXT("/"), TEXT("\\"));
 	}
+#endif
 
 	bool IsValidDirectory(FString& Directory, FString& FileName, const FString& Path)
 	{
@@ -83,6 +96,7 @@ namespace{
 			return true;
 	}
 
+#if WITH_SEVENZIP
 	SevenZip::CompressionLevelEnum libZipLevelFromUELevel(ZipUtilityCompressionLevel ueLevel) {
 		switch (ueLevel)
 		{
@@ -96,7 +110,23 @@ namespace{
 			return SevenZip::CompressionLevel::None;
 		}
 	}
+#endif
+
+	int32 zlibLevelFromUELevel(ZipUtilityCompressionLevel ueLevel) {
+		switch (ueLevel)
+		{
+		case COMPRESSION_LEVEL_NONE:
+			return 0;
+		case COMPRESSION_LEVEL_FAST:
+			return 1;
+		case COMPRESSION_LEVEL_NORMAL:
+			return 6;
+		default:
+			return 0;
+		}
+	}
 
+#if WITH_SEVENZIP
 	SevenZip::CompressionFormatEnum libZipFormatFromUEFormat(EZipUtilityCompressionFormat UeFormat) {
 		switch (UeFormat)
 		{
@@ -122,10 +152,13 @@ namespace{
 			return CompressionFormat::Lzma;
 		case EZipUtilityCompressionFormat::COMPRESSION_FORMAT_LZMA86:
 			return CompressionFormat::Lzma86;
+		case EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP:
+			return CompressionFormat::GZip;
 		default:
 			return CompressionFormat::Unknown;
 		}
 	}
+#endif
 
 	FString defaultExtensionFromUEFormat(EZipUtilityCompressionFormat ueFormat) 
 	{
@@ -153,42 +186,154 @@ namespace{
 			return FString(TEXT(".lzma"));
 		case EZipUtilityCompressionFormat::COMPRESSION_FORMAT_LZMA86:
 			return FString(TEXT(".lzma86"));
+		case EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP:
+			return FString(TEXT(".tar.gz"));
 		default:
 			return FString(TEXT(".dat"));
 		}
 	}
 
+#if WITH_SEVENZIP
+	EZipUtilityCompressionFormat UEFormatFromLibZipFormat(SevenZip::CompressionFormatEnum LibFormat)
+	{
+		switch (LibFormat)
+		{
+		case CompressionFormat::SevenZip:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_SEVEN_ZIP;
+		case CompressionFormat::Zip:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP;
+		case CompressionFormat::GZip:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_GZIP;
+		case CompressionFormat::BZip2:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_BZIP2;
+		case CompressionFormat::Rar:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_RAR;
+		case CompressionFormat::Tar:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR;
+		case CompressionFormat::Iso:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ISO;
+		case CompressionFormat::Cab:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_CAB;
+		case CompressionFormat::Lzma:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_LZMA;
+		case CompressionFormat::Lzma86:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_LZMA86;
+		default:
+			return EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN;
+		}
+	}
+#endif
+
+	//Signature sniffing is cheap and cached, so unknown formats are resolved before anything opens the archive
+	EZipUtilityCompressionFormat ResolveFormat(const FString& ArchivePath, EZipUtilityCompressionFormat Format)
+	{
+		if (Format != EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+		{
+			return Format;
+		}
+		return ZUFormatSniffer::Detect(ArchivePath);
+	}
+
+#if WITH_SEVENZIP
+	void SetArchiveFormat(SevenZipArchive& Archive, const FString& ArchivePath, EZipUtilityCompressionFormat Format)
+	{
+		if (Format != EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+		{
+			Archive.SetCompressionFormat(libZipFormatFromUEFormat(Format));
+			return;
+		}
+
+		//No signature matched, fall back to 7zip trying every format
+		if (Archive.DetectCompressionFormat())
+		{
+			ZUFormatSniffer::Remember(ArchivePath, UEFormatFromLibZipFormat(Archive.GetCompressionFormat()));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("auto-compression detection did not succeed, passing in unknown format to 7zip library."));
+		}
+	}
+#else
+	//Without 7z.dll only the formats with a native path can be read or written
+	void ReportSevenZipUnavailable(SevenZipCallbackHandler& Callback, const FString& ArchivePath)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ZipUtility: %s needs 7zip, which is only available on Windows. Zip and tar.gz archives are supported everywhere."), *ArchivePath);
+		Callback.OnDoneWithState(*ArchivePath, EZipUtilityCompletionState::FAILURE_UNKNOWN);
+	}
+#endif
+
 	using namespace std;
 
-	
+	//Hands out an identical operation that's already in flight instead of starting the work again
+	UZipOperation* JoinRunningOperation(const FString& Key, const UObject* Listener)
+	{
+		TSharedPtr<ZUSharedOperation, ESPMode::ThreadSafe> Running = ZUSharedOperation::Join(Key, (UObject*)Listener);
+		return Running.IsValid() ? Running->GetOperation() : nullptr;
+	}
+
+	//Starts a run others can join, the first listener being the one that asked for it
+	TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> BeginSharedOperation(const FString& Key, const UObject* Listener, UZipOperation* ZipOperation)
+	{
+		return ZUSharedOperation::Begin(Key, (UObject*)Listener, ZipOperation);
+	}
 
 	//Background Thread convenience functions
 	UZipOperation* UnzipFilesOnBGThreadWithFormat(const TArray<int32> FileIndices, const FString& ArchivePath, const FString& DestinationDirectory, const UObject* ProgressDelegate, EZipUtilityCompressionFormat Format)
 	{
+		FString Parameters = FString::FromInt((int32)Format);
+		for (int32 FileIndex : FileIndices)
+		{
+			Parameters += TEXT(",") + FString::FromInt(FileIndex);
+		}
+
+		const FString Key = ZUSharedOperation::MakeKey(TEXT("UnzipFiles"), ArchivePath, DestinationDirectory, Parameters);
+		if (UZipOperation* Running = JoinRunningOperation(Key, ProgressDelegate))
+		{
+			return Running;
+		}
+
 		UZipOperation* ZipOperation = NewObject<UZipOperation>();
+		TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> Shared = BeginSharedOperation(Key, ProgressDelegate, ZipOperation);
 
-		IQueuedWork* Work = RunLambdaOnThreadPool([ProgressDelegate, FileIndices, ArchivePath, DestinationDirectory, Format, ZipOperation] 
+		IQueuedWork* Work = RunLambdaOnThreadPool([Shared, FileIndices, ArchivePath, DestinationDirectory, Format, ZipOperation] 
 		{
 			SevenZipCallbackHandler PrivateCallback;
-			PrivateCallback.ProgressDelegate = (UObject*)ProgressDelegate;
+			PrivateCallback.SharedOperation = Shared;
 			ZipOperation->SetCallbackHandler(&PrivateCallback);
 
-			//UE_LOG(LogClass, Log, TEXT("path is: %s"), *path);
-			SevenZipExtractor Extractor(SZLib, *ArchivePath);
-
+			const EZipUtilityCompressionFormat ArchiveFormat = ResolveFormat(ArchivePath, Format);
 
-			if (Format == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+			//Zip archives we can fully decode skip 7z.dll and write through the batched writer
+			if (ArchiveFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP)
 			{
-				if (!Extractor.DetectCompressionFormat())
+				ZUZipExtractor NativeExtractor;
+				if (NativeExtractor.Open(ArchivePath))
 				{
-					UE_LOG(LogTemp, Log, TEXT("auto-compression detection did not succeed, passing in unknown format to 7zip library."));
+					const bool bSuccess = NativeExtractor.ExtractFilesFromArchive(FileIndices, DestinationDirectory, &PrivateCallback);
+					PrivateCallback.OnDoneWithState(*ArchivePath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+					ZipOperation->SetCallbackHandler(nullptr);
+					return;
 				}
 			}
-			else
+
+			//Tarballs are inflated and unpacked in one streaming pass instead of 7zip's two
+			if (ArchiveFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP)
 			{
-				Extractor.SetCompressionFormat(libZipFormatFromUEFormat(Format));
+				ZUTarGzExtractor NativeExtractor;
+				if (NativeExtractor.Open(ArchivePath))
+				{
+					const bool bSuccess = NativeExtractor.ExtractFilesFromArchive(FileIndices, DestinationDirectory, &PrivateCallback);
+					PrivateCallback.OnDoneWithState(*ArchivePath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+					ZipOperation->SetCallbackHandler(nullptr);
+					return;
+				}
 			}
 
+#if WITH_SEVENZIP
+			//UE_LOG(LogClass, Log, TEXT("path is: %s"), *path);
+			SevenZipExtractor Extractor(SZLib, *ArchivePath);
+			SetArchiveFormat(Extractor, ArchivePath, ArchiveFormat);
+
 			// Extract indices
 			const int32 NumberFiles = FileIndices.Num(); 
 			unsigned int* Indices = new unsigned int[NumberFiles]; 
@@ -203,6 +348,9 @@ namespace{
 
 			// Clean up the indices
 			delete Indices;
+#else
+			ReportSevenZipUnavailable(PrivateCallback, ArchivePath);
+#endif
 
 			// Null out the callback handler now that we're exiting
 			ZipOperation->SetCallbackHandler(nullptr);
@@ -212,33 +360,169 @@ namespace{
 		return ZipOperation;
 	}
 
-	//Background Thread convenience functions
-	UZipOperation* UnzipOnBGThreadWithFormat(const FString& ArchivePath, const FString& DestinationDirectory, const UObject* ProgressDelegate, EZipUtilityCompressionFormat Format)
+#if WITH_SEVENZIP
+	//Indices of the entries a filter matches, gathered from a 7zip listing on the calling thread
+	class FMatchingEntryCollector : public ListCallback
+	{
+	public:
+		FMatchingEntryCollector(const ZUEntryFilter& InFilter) : Filter(InFilter), NextIndex(0) {}
+
+		virtual void OnFileFound(const TString& ArchivePath, const TString& FilePath, int Size) override
+		{
+			if (Filter.Matches(FString(FilePath.c_str())))
+			{
+				Indices.Add(NextIndex);
+			}
+			NextIndex++;
+		}
+
+		TArray<unsigned int> Indices;
+
+	private:
+		const ZUEntryFilter& Filter;
+		unsigned int NextIndex;
+	};
+#endif
+
+	UZipOperation* UnzipMatchingOnBGThread(const FString& ArchivePath, const TArray<FString>& IncludeGlobs, const TArray<FString>& ExcludeGlobs, const FString& DestinationDirectory, const UObject* ProgressDelegate, EZipUtilityCompressionFormat Format)
 	{
+		const FString Parameters = FString::Printf(TEXT("%d|%s|%s"), (int32)Format, *FString::Join(IncludeGlobs, TEXT("\n")), *FString::Join(ExcludeGlobs, TEXT("\n")));
+		const FString Key = ZUSharedOperation::MakeKey(TEXT("UnzipMatching"), ArchivePath, DestinationDirectory, Parameters);
+		if (UZipOperation* Running = JoinRunningOperation(Key, ProgressDelegate))
+		{
+			return Running;
+		}
+
 		UZipOperation* ZipOperation = NewObject<UZipOperation>();
+		TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> Shared = BeginSharedOperation(Key, ProgressDelegate, ZipOperation);
 
-		IQueuedWork* Work = RunLambdaOnThreadPool([ProgressDelegate, ArchivePath, DestinationDirectory, Format, ZipOperation] 
+		IQueuedWork* Work = RunLambdaOnThreadPool([Shared, ArchivePath, IncludeGlobs, ExcludeGlobs, DestinationDirectory, Format, ZipOperation]
 		{
 			SevenZipCallbackHandler PrivateCallback;
-			PrivateCallback.ProgressDelegate = (UObject*)ProgressDelegate;
+			PrivateCallback.SharedOperation = Shared;
 			ZipOperation->SetCallbackHandler(&PrivateCallback);
 
-			//UE_LOG(LogClass, Log, TEXT("path is: %s"), *path);
+			//Compiled once here, then tested against every entry name on this worker
+			const ZUEntryFilter Filter(IncludeGlobs, ExcludeGlobs);
+			const EZipUtilityCompressionFormat ArchiveFormat = ResolveFormat(ArchivePath, Format);
+
+			if (ArchiveFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP)
+			{
+				ZUZipExtractor NativeExtractor;
+				if (NativeExtractor.Open(ArchivePath))
+				{
+					const bool bSuccess = NativeExtractor.ExtractMatching(Filter, DestinationDirectory, &PrivateCallback);
+					PrivateCallback.OnDoneWithState(*ArchivePath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+					ZipOperation->SetCallbackHandler(nullptr);
+					return;
+				}
+			}
+
+			if (ArchiveFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP)
+			{
+				ZUTarGzExtractor NativeExtractor;
+				if (NativeExtractor.Open(ArchivePath))
+				{
+					const bool bSuccess = NativeExtractor.ExtractMatching(Filter, DestinationDirectory, &PrivateCallback);
+					PrivateCallback.OnDoneWithState(*ArchivePath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+					ZipOperation->SetCallbackHandler(nullptr);
+					return;
+				}
+			}
+
+#if WITH_SEVENZIP
+			//7zip only filters by index, so its listing is matched here first without sending any events
+			SevenZipLister Lister(SZLib, *ArchivePath);
+			SetArchiveFormat(Lister, ArchivePath, ArchiveFormat);
+
+			FMatchingEntryCollector Collector(Filter);
+			if (!Lister.ListArchive(&Collector))
+			{
+				UE_LOG(LogClass, Warning, TEXT("ZipUtility: Unknown failure for list operation on %s"), *ArchivePath);
+				PrivateCallback.OnDoneWithState(*ArchivePath, EZipUtilityCompletionState::FAILURE_UNKNOWN);
+				ZipOperation->SetCallbackHandler(nullptr);
+				return;
+			}
+
+			//Nothing matched, finish the way the native extractors do instead of handing 7zip an empty index list
+			if (Collector.Indices.Num() == 0)
+			{
+				PrivateCallback.OnStartWithTotal(*ArchivePath, 0);
+				PrivateCallback.OnDone(*ArchivePath);
+				ZipOperation->SetCallbackHandler(nullptr);
+				return;
+			}
+
 			SevenZipExtractor Extractor(SZLib, *ArchivePath);
+			SetArchiveFormat(Extractor, ArchivePath, ArchiveFormat);
+			Extractor.ExtractFilesFromArchive(Collector.Indices.GetData(), Collector.Indices.Num(), *DestinationDirectory, &PrivateCallback);
+#else
+			ReportSevenZipUnavailable(PrivateCallback, ArchivePath);
+#endif
+
+			ZipOperation->SetCallbackHandler(nullptr);
+		});
 
-			if (Format == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+		ZipOperation->SetThreadPoolWorker(Work);
+		return ZipOperation;
+	}
+
+	//Background Thread convenience functions
+	UZipOperation* UnzipOnBGThreadWithFormat(const FString& ArchivePath, const FString& DestinationDirectory, const UObject* ProgressDelegate, EZipUtilityCompressionFormat Format, bool bVerifyStoredFiles = true)
+	{
+		const FString Key = ZUSharedOperation::MakeKey(TEXT("Unzip"), ArchivePath, DestinationDirectory, FString::Printf(TEXT("%d|%d"), (int32)Format, bVerifyStoredFiles ? 1 : 0));
+		if (UZipOperation* Running = JoinRunningOperation(Key, ProgressDelegate))
+		{
+			return Running;
+		}
+
+		UZipOperation* ZipOperation = NewObject<UZipOperation>();
+		TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> Shared = BeginSharedOperation(Key, ProgressDelegate, ZipOperation);
+
+		IQueuedWork* Work = RunLambdaOnThreadPool([Shared, ArchivePath, DestinationDirectory, Format, bVerifyStoredFiles, ZipOperation] 
+		{
+			SevenZipCallbackHandler PrivateCallback;
+			PrivateCallback.SharedOperation = Shared;
+			ZipOperation->SetCallbackHandler(&PrivateCallback);
+
+			const EZipUtilityCompressionFormat ArchiveFormat = ResolveFormat(ArchivePath, Format);
+
+			//Zip archives we can fully decode skip 7z.dll and write through the batched writer
+			if (ArchiveFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP)
 			{
-				if (!Extractor.DetectCompressionFormat())
+				ZUZipExtractor NativeExtractor;
+				if (NativeExtractor.Open(ArchivePath))
 				{
-					UE_LOG(LogTemp, Log, TEXT("auto-compression detection did not succeed, passing in unknown format to 7zip library."));
+					NativeExtractor.SetVerifyStoredEntries(bVerifyStoredFiles);
+					const bool bSuccess = NativeExtractor.ExtractArchive(DestinationDirectory, &PrivateCallback);
+					PrivateCallback.OnDoneWithState(*ArchivePath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+					ZipOperation->SetCallbackHandler(nullptr);
+					return;
 				}
 			}
-			else
+
+			//Tarballs are inflated and unpacked in one streaming pass instead of 7zip's two
+			if (ArchiveFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP)
 			{
-				Extractor.SetCompressionFormat(libZipFormatFromUEFormat(Format));
+				ZUTarGzExtractor NativeExtractor;
+				if (NativeExtractor.Open(ArchivePath))
+				{
+					const bool bSuccess = NativeExtractor.ExtractArchive(DestinationDirectory, &PrivateCallback);
+					PrivateCallback.OnDoneWithState(*ArchivePath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+					ZipOperation->SetCallbackHandler(nullptr);
+					return;
+				}
 			}
 
+#if WITH_SEVENZIP
+			//UE_LOG(LogClass, Log, TEXT("path is: %s"), *path);
+			SevenZipExtractor Extractor(SZLib, *ArchivePath);
+			SetArchiveFormat(Extractor, ArchivePath, ArchiveFormat);
+
 			Extractor.ExtractArchive(*DestinationDirectory, &PrivateCallback);
+#else
+			ReportSevenZipUnavailable(PrivateCallback, ArchivePath);
+#endif
 
 			// Null out the callback handler now that we're exiting
 			ZipOperation->SetCallbackHandler(nullptr);
@@ -248,47 +532,199 @@ namespace{
 		return ZipOperation;
 	}
 
+	UZipOperation* TestOnBGThreadWithFormat(const FString& ArchivePath, const UObject* ProgressDelegate, EZipUtilityCompressionFormat Format)
+	{
+		const FString Key = ZUSharedOperation::MakeKey(TEXT("Test"), ArchivePath, FString(), FString::FromInt((int32)Format));
+		if (UZipOperation* Running = JoinRunningOperation(Key, ProgressDelegate))
+		{
+			return Running;
+		}
+
+		UZipOperation* ZipOperation = NewObject<UZipOperation>();
+		TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> Shared = BeginSharedOperation(Key, ProgressDelegate, ZipOperation);
+
+		IQueuedWork* Work = RunLambdaOnThreadPool([Shared, ArchivePath, Format, ZipOperation]
+		{
+			SevenZipCallbackHandler PrivateCallback;
+			PrivateCallback.SharedOperation = Shared;
+			ZipOperation->SetCallbackHandler(&PrivateCallback);
+
+			//7zpp can only test by extracting to disk, so only archives the native reader handles are supported
+			ZUZipExtractor NativeExtractor;
+			const bool bCanTest = ResolveFormat(ArchivePath, Format) == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP;
+
+			if (bCanTest && NativeExtractor.Open(ArchivePath))
+			{
+				NativeExtractor.TestArchive(&PrivateCallback);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Testing is only supported for zip archives, can't test %s"), *ArchivePath);
+				PrivateCallback.OnDoneWithState(*ArchivePath, EZipUtilityCompletionState::FAILURE_UNKNOWN);
+			}
+
+			ZipOperation->SetCallbackHandler(nullptr);
+		});
+
+		ZipOperation->SetThreadPoolWorker(Work);
+		return ZipOperation;
+	}
+
+	UZipOperation* UnzipWithManifestOnBGThread(const FString& ArchivePath, const FString& DestinationDirectory, const FString& ManifestPath, const UObject* ProgressDelegate)
+	{
+		UZipOperation* ZipOperation = NewObject<UZipOperation>();
+
+		IQueuedWork* Work = RunLambdaOnThreadPool([ProgressDelegate, ArchivePath, DestinationDirectory, ManifestPath, ZipOperation]
+		{
+			SevenZipCallbackHandler PrivateCallback;
+			PrivateCallback.ProgressDelegate = (UObject*)ProgressDelegate;
+			ZipOperation->SetCallbackHandler(&PrivateCallback);
+
+			//Entries are hashed as they are decoded, which only the native reader can do
+			ZUZipExtractor NativeExtractor;
+			const bool bCanHash = ResolveFormat(ArchivePath, EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN) == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP;
+
+			if (bCanHash && NativeExtractor.Open(ArchivePath))
+			{
+				ZUManifest Manifest;
+				NativeExtractor.SetManifest(&Manifest, ManifestPath);
+				const bool bSuccess = NativeExtractor.ExtractArchive(DestinationDirectory, &PrivateCallback);
+				PrivateCallback.OnDoneWithState(*ArchivePath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Manifests while extracting are only supported for zip archives, can't extract %s"), *ArchivePath);
+				PrivateCallback.OnDoneWithState(*ArchivePath, EZipUtilityCompletionState::FAILURE_UNKNOWN);
+			}
+
+			ZipOperation->SetCallbackHandler(nullptr);
+		});
+
+		ZipOperation->SetThreadPoolWorker(Work);
+		return ZipOperation;
+	}
+
+	UZipOperation* CreateManifestOnBGThread(const FString& FolderPath, const FString& ManifestPath, const UObject* ProgressDelegate)
+	{
+		UZipOperation* ZipOperation = NewObject<UZipOperation>();
+
+		IQueuedWork* Work = RunLambdaOnThreadPool([ProgressDelegate, FolderPath, ManifestPath, ZipOperation]
+		{
+			SevenZipCallbackHandler PrivateCallback;
+			PrivateCallback.ProgressDelegate = (UObject*)ProgressDelegate;
+			ZipOperation->SetCallbackHandler(&PrivateCallback);
+
+			const TString ManifestName = *ManifestPath;
+
+			//The total isn't known until the walk is done, so files are reported without progress
+			PrivateCallback.OnStartWithTotal(ManifestName, 0);
+
+			ZUManifest Manifest;
+			const bool bBuilt = Manifest.BuildFromFolder(FolderPath, [&PrivateCallback, &ManifestName, &FolderPath](const FZUManifestEntry& Entry)
+			{
+				PrivateCallback.OnFileDone(ManifestName, *FPaths::Combine(FolderPath, Entry.Path), 0);
+				return !PrivateCallback.OnCheckBreak();
+			});
+
+			//A partial manifest would report files as removed, so nothing is written unless every file was hashed
+			if (bBuilt && Manifest.Save(ManifestPath))
+			{
+				PrivateCallback.OnDone(ManifestName);
+			}
+			else
+			{
+				PrivateCallback.OnDoneWithState(ManifestName, EZipUtilityCompletionState::FAILURE_UNKNOWN);
+			}
+
+			ZipOperation->SetCallbackHandler(nullptr);
+		});
+
+		ZipOperation->SetThreadPoolWorker(Work);
+		return ZipOperation;
+	}
+
+	UZipOperation* PatchOnBGThread(const FString& SourcePath, const FString& InputPath, const FString& OutputPath, bool bApply, const UObject* ProgressDelegate)
+	{
+		UZipOperation* ZipOperation = NewObject<UZipOperation>();
+
+		IQueuedWork* Work = RunLambdaOnThreadPool([ProgressDelegate, SourcePath, InputPath, OutputPath, bApply, ZipOperation]
+		{
+			SevenZipCallbackHandler PrivateCallback;
+			PrivateCallback.ProgressDelegate = (UObject*)ProgressDelegate;
+			ZipOperation->SetCallbackHandler(&PrivateCallback);
+
+			const bool bSuccess = bApply ? ZUZipPatch::Apply(SourcePath, InputPath, OutputPath, &PrivateCallback) : ZUZipPatch::Create(SourcePath, InputPath, OutputPath, &PrivateCallback);
+			const FString PatchPath = bApply ? InputPath : OutputPath;
+			PrivateCallback.OnDoneWithState(*PatchPath, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+
+			ZipOperation->SetCallbackHandler(nullptr);
+		});
+
+		ZipOperation->SetThreadPoolWorker(Work);
+		return ZipOperation;
+	}
+
 	void ListOnBGThread(const FString& Path, const FString& Directory, const UObject* ListDelegate, EZipUtilityCompressionFormat Format)
 	{
+		//Listings have no operation to hand back, a duplicate only needs to be added to the run's listeners
+		const FString Key = ZUSharedOperation::MakeKey(TEXT("List"), Path, FString(), FString::FromInt((int32)Format));
+		if (ZUSharedOperation::Join(Key, (UObject*)ListDelegate).IsValid())
+		{
+			return;
+		}
+
+		TSharedRef<ZUSharedOperation, ESPMode::ThreadSafe> Shared = ZUSharedOperation::Begin(Key, (UObject*)ListDelegate);
+
 		//RunLongLambdaOnAnyThread - this shouldn't take long, but if it lags, swap the lambda methods
-		RunLambdaOnAnyThread([ListDelegate, Path, Format, Directory] {
+		RunLambdaOnAnyThread([Shared, Path, Format, Directory] {
 			SevenZipCallbackHandler PrivateCallback;
-			PrivateCallback.ProgressDelegate = (UObject*)ListDelegate;
-			SevenZipLister Lister(SZLib, *Path);
+			PrivateCallback.SharedOperation = Shared;
+			const EZipUtilityCompressionFormat ResolvedFormat = ResolveFormat(Path, Format);
 
-			if (Format == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN)
+			//Zips are listed natively, which keeps 64 bit sizes intact. Entries come in central directory order, same as 7zip's indices.
+			ZUZipReader NativeReader;
+			if (ResolvedFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP && NativeReader.Open(Path))
 			{
-				if (!Lister.DetectCompressionFormat())
+				//Names are handed over as views into the reader's pool, the event copy is the only one
+				const TString ArchiveName = *Path;
+				for (const FZUZipEntry& Entry : NativeReader.GetEntries())
 				{
-					UE_LOG(LogTemp, Log, TEXT("auto-compression detection did not succeed, passing in unknown format to 7zip library."));
+					PrivateCallback.OnEntryFound(ArchiveName, Entry.Name, Entry.UncompressedSize);
 				}
+				PrivateCallback.OnListingDone(ArchiveName);
+				return;
 			}
-			else
+
+			//Tarballs have no index, the listing walks the whole stream
+			ZUTarGzExtractor TarExtractor;
+			if (ResolvedFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP && TarExtractor.Open(Path))
 			{
-				Lister.SetCompressionFormat(libZipFormatFromUEFormat(Format));
+				TarExtractor.ListArchive(&PrivateCallback);
+				return;
 			}
 
+#if WITH_SEVENZIP
+			SevenZipLister Lister(SZLib, *Path);
+			SetArchiveFormat(Lister, Path, ResolvedFormat);
+
 			if (!Lister.ListArchive(&PrivateCallback))
 			{
 				// If ListArchive returned false, it was most likely because the compression format was unsupported
-				// Call OnDone with a failure message, make sure to call this on the game thread.
-				if (IZipUtilityInterface* ZipInterface = Cast<IZipUtilityInterface>((UObject*)ListDelegate))
-				{
-					UE_LOG(LogClass, Warning, TEXT("ZipUtility: Unknown failure for list operation on %s"), *Path);
-					UZipFileFunctionLibrary::RunLambdaOnGameThread([ZipInterface, ListDelegate, Path] 
-					{
-						ZipInterface->Execute_OnDone((UObject*)ListDelegate, *Path, EZipUtilityCompletionState::FAILURE_UNKNOWN);
-					});
-				}
+				// Call OnDone with a failure message, the handler sends it to every listener on the game thread.
+				UE_LOG(LogClass, Warning, TEXT("ZipUtility: Unknown failure for list operation on %s"), *Path);
+				PrivateCallback.OnDoneWithState(*Path, EZipUtilityCompletionState::FAILURE_UNKNOWN);
 			}
+#else
+			ReportSevenZipUnavailable(PrivateCallback, Path);
+#endif
 		});
 	}
 
-	UZipOperation* ZipOnBGThread(const FString& Path, const FString& FileName, const FString& Directory, const UObject* ProgressDelegate, EZipUtilityCompressionFormat UeCompressionformat, ZipUtilityCompressionLevel UeCompressionlevel)
+	UZipOperation* ZipOnBGThread(const FString& Path, const FString& FileName, const FString& Directory, const UObject* ProgressDelegate, EZipUtilityCompressionFormat UeCompressionformat, ZipUtilityCompressionLevel UeCompressionlevel, int64 VolumeSize)
 	{
 		UZipOperation* ZipOperation = NewObject<UZipOperation>();
 
-		IQueuedWork* Work = RunLambdaOnThreadPool([ProgressDelegate, FileName, Path, UeCompressionformat, UeCompressionlevel, Directory, ZipOperation] 
+		IQueuedWork* Work = RunLambdaOnThreadPool([ProgressDelegate, FileName, Path, UeCompressionformat, UeCompressionlevel, VolumeSize, Directory, ZipOperation] 
 		{
 			SevenZipCallbackHandler PrivateCallback;
 			PrivateCallback.ProgressDelegate = (UObject*)ProgressDelegate;
@@ -311,12 +747,61 @@ namespace{
 			//concatenate the output filename
 			FString OutputFileName = FString::Printf(TEXT("%s/%s%s"), *Directory, *FileName, *defaultExtensionFromUEFormat(UeFormat));
 			//UE_LOG(LogClass, Log, TEXT("\noutputfile is: <%s>\n path is: <%s>"), *outputFileName, *path);
-			
+
+			//Zip output is written natively so every file can be stored or deflated on its own merits
+			if (UeFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_ZIP)
+			{
+				ZUZipCompressor NativeCompressor(OutputFileName);
+				NativeCompressor.SetCompressionLevel(zlibLevelFromUELevel(UeCompressionlevel));
+				NativeCompressor.SetVolumeSize(VolumeSize);
+
+				bool bSuccess = false;
+				if (FPaths::DirectoryExists(Path))
+				{
+					bSuccess = NativeCompressor.CompressDirectory(Path, &PrivateCallback);
+				}
+				else
+				{
+					bSuccess = NativeCompressor.CompressFile(Path, &PrivateCallback);
+				}
+				PrivateCallback.OnDoneWithState(*OutputFileName, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+
+				ZipOperation->SetCallbackHandler(nullptr);
+				return;
+			}
+
+			if (VolumeSize > 0)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("ZipUtility: Split volumes are only written for zip archives, writing %s as a single file."), *OutputFileName);
+			}
+
+			//Packing and gzip run as two concurrent stages of one pass, no intermediate .tar
+			if (UeFormat == EZipUtilityCompressionFormat::COMPRESSION_FORMAT_TAR_GZIP)
+			{
+				ZUTarGzCompressor NativeCompressor(OutputFileName);
+				NativeCompressor.SetCompressionLevel(zlibLevelFromUELevel(UeCompressionlevel));
+
+				bool bSuccess = false;
+				if (FPaths::DirectoryExists(Path))
+				{
+					bSuccess = NativeCompressor.CompressDirectory(Path, &PrivateCallback);
+				}
+				else
+				{
+					bSuccess = NativeCompressor.CompressFile(Path, &PrivateCallback);
+				}
+				PrivateCallback.OnDoneWithState(*OutputFileName, bSuccess ? EZipUtilityCompletionState::SUCCESS : EZipUtilityCompletionState::FAILURE_UNKNOWN);
+
+				ZipOperation->SetCallbackHandler(nullptr);
+				return;
+			}
+
+#if WITH_SEVENZIP
 			SevenZipCompressor compressor(SZLib, *ReversePathSlashes(OutputFileName));
 			compressor.SetCompressionFormat(libZipFormatFromUEFormat(UeFormat));
 			compressor.SetCompressionLevel(libZipLevelFromUELevel(UeCompressionlevel));
 
-			if (PathIsDirectory(*Path))
+			if (FPaths::DirectoryExists(Path))
 			{
 				//UE_LOG(LogClass, Log, TEXT("Compressing Folder"));
 				compressor.CompressDirectory(*ReversePathSlashes(Path), &PrivateCallback);
@@ -326,6 +811,9 @@ namespace{
 				//UE_LOG(LogClass, Log, TEXT("Compressing File"));
 				compressor.CompressFile(*ReversePathSlashes(Path), &PrivateCallback);
 			}
+#else
+			ReportSevenZipUnavailable(PrivateCallback, OutputFileName);
+#endif
 
 			// Null out the callback handler
 			ZipOperation->SetCallbackHandler(nullptr);
@@ -341,13 +829,17 @@ namespace{
 UZipFileFunctionLibrary::UZipFileFunctionLibrary(const class FObjectInitializer& PCIP)
 	: Super(PCIP)
 {
+#if WITH_SEVENZIP
 	UE_LOG(LogTemp, Log, TEXT("DLLPath is: %s"), *DLLPath());
 	SZLib.Load(*DLLPath());
+#endif
 }
 
 UZipFileFunctionLibrary::~UZipFileFunctionLibrary()
 {
+#if WITH_SEVENZIP
 	SZLib.Free();
+#endif
 }
 
 bool UZipFileFunctionLibrary::UnzipFileNamed(const FString& archivePath, const FString& Name, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat format /*= COMPRESSION_FORMAT_UNKNOWN*/)
@@ -382,7 +874,7 @@ UZipOperation* UZipFileFunctionLibrary::UnzipFilesTo(const TArray<int32> fileInd
 		return nullptr;
 	}
 
-	return UnzipFilesOnBGThreadWithFormat(fileIndices, archivePath, destinationPath, ZipUtilityInterfaceDelegate, format);
+	return UnzipFilesOnBGThreadWithFormat(fileIndices, ZUVolumeSet::ResolveArchivePath(archivePath), destinationPath, ZipUtilityInterfaceDelegate, format);
 }
 
 UZipOperation* UZipFileFunctionLibrary::UnzipFiles(const TArray<int32> fileIndices, const FString & ArchivePath, UObject * ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat format)
@@ -410,8 +902,11 @@ UZipOperation* UZipFileFunctionLibrary::Unzip(const FString& ArchivePath, UObjec
 	FString Directory;
 	FString FileName;
 
+	//Split archives can be given by their own name, their first volume is picked up instead
+	const FString SourcePath = ZUVolumeSet::ResolveArchivePath(ArchivePath);
+
 	//Check Directory validity
-	if (!IsValidDirectory(Directory, FileName, ArchivePath) || !UWindowsFileUtilityFunctionLibrary::DoesFileExist(ArchivePath))
+	if (!IsValidDirectory(Directory, FileName, SourcePath) || !UWindowsFileUtilityFunctionLibrary::DoesFileExist(SourcePath))
 	{
 		bool bObjectIsValid = ZipUtilityInterfaceDelegate && ZipUtilityInterfaceDelegate->GetClass()->ImplementsInterface(UZipUtilityInterface::StaticClass());
 
@@ -425,7 +920,7 @@ UZipOperation* UZipFileFunctionLibrary::Unzip(const FString& ArchivePath, UObjec
 		return nullptr;
 	}
 
-	return UnzipTo(ArchivePath, Directory, ZipUtilityInterfaceDelegate, Format);
+	return UnzipTo(SourcePath, Directory, ZipUtilityInterfaceDelegate, Format);
 }
 
 UZipOperation* UZipFileFunctionLibrary::UnzipWithLambda(const FString& ArchivePath, TFunction<void()> OnDoneCallback, TFunction<void(float)> OnProgressCallback, EZipUtilityCompressionFormat Format)
@@ -443,12 +938,25 @@ UZipOperation* UZipFileFunctionLibrary::UnzipWithLambda(const FString& ArchivePa
 }
 
 
-UZipOperation* UZipFileFunctionLibrary::UnzipTo(const FString& ArchivePath, const FString& DestinationPath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format)
+UZipOperation* UZipFileFunctionLibrary::UnzipTo(const FString& ArchivePath, const FString& DestinationPath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format, bool bVerifyStoredFiles)
 {
-	return UnzipOnBGThreadWithFormat(ArchivePath, DestinationPath, ZipUtilityInterfaceDelegate, Format);
+	return UnzipOnBGThreadWithFormat(ZUVolumeSet::ResolveArchivePath(ArchivePath), DestinationPath, ZipUtilityInterfaceDelegate, Format, bVerifyStoredFiles);
 }
 
-UZipOperation* UZipFileFunctionLibrary::Zip(const FString& ArchivePath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format, TEnumAsByte<ZipUtilityCompressionLevel> Level)
+UZipOperation* UZipFileFunctionLibrary::UnzipMatching(const FString& ArchivePath, const TArray<FString>& IncludeGlobs, const TArray<FString>& ExcludeGlobs, const FString& DestinationPath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format)
+{
+	bool bObjectIsValid = ZipUtilityInterfaceDelegate && ZipUtilityInterfaceDelegate->GetClass()->ImplementsInterface(UZipUtilityInterface::StaticClass());
+
+	if (!bObjectIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Object passed as Delegate does not respond to IZipUtilityInterface"));
+		return nullptr;
+	}
+
+	return UnzipMatchingOnBGThread(ZUVolumeSet::ResolveArchivePath(ArchivePath), IncludeGlobs, ExcludeGlobs, DestinationPath, ZipUtilityInterfaceDelegate, Format);
+}
+
+UZipOperation* UZipFileFunctionLibrary::Zip(const FString& ArchivePath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format, TEnumAsByte<ZipUtilityCompressionLevel> Level, int64 VolumeSize)
 {
 	FString Directory;
 	FString FileName;
@@ -469,10 +977,10 @@ UZipOperation* UZipFileFunctionLibrary::Zip(const FString& ArchivePath, UObject*
 		return nullptr;
 	}
 
-	return ZipOnBGThread(ArchivePath, FileName, Directory, ZipUtilityInterfaceDelegate, Format, Level);
+	return ZipOnBGThread(ArchivePath, FileName, Directory, ZipUtilityInterfaceDelegate, Format, Level, VolumeSize);
 }
 
-UZipOperation* UZipFileFunctionLibrary::ZipWithLambda(const FString& ArchivePath, TFunction<void()> OnDoneCallback, TFunction<void(float)> OnProgressCallback /*= nullptr*/, EZipUtilityCompressionFormat Format /*= COMPRESSION_FORMAT_UNKNOWN*/, TEnumAsByte<ZipUtilityCompressionLevel> Level /*=COMPRESSION_LEVEL_NORMAL*/)
+UZipOperation* UZipFileFunctionLibrary::ZipWithLambda(const FString& ArchivePath, TFunction<void()> OnDoneCallback, TFunction<void(float)> OnProgressCallback /*= nullptr*/, EZipUtilityCompressionFormat Format /*= COMPRESSION_FORMAT_UNKNOWN*/, TEnumAsByte<ZipUtilityCompressionLevel> Level /*=COMPRESSION_LEVEL_NORMAL*/, int64 VolumeSize /*= 0*/)
 {
 	UZULambdaDelegate* LambdaDelegate = NewObject<UZULambdaDelegate>();
 	LambdaDelegate->AddToRoot();
@@ -483,7 +991,147 @@ UZipOperation* UZipFileFunctionLibrary::ZipWithLambda(const FString& ArchivePath
 	});
 	LambdaDelegate->SetOnProgessCallback(OnProgressCallback);
 
-	return Zip(ArchivePath, LambdaDelegate, Format);
+	return Zip(ArchivePath, LambdaDelegate, Format, Level, VolumeSize);
+}
+
+UZipOperation* UZipFileFunctionLibrary::TestArchive(const FString& ArchivePath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format)
+{
+	bool bObjectIsValid = ZipUtilityInterfaceDelegate && ZipUtilityInterfaceDelegate->GetClass()->ImplementsInterface(UZipUtilityInterface::StaticClass());
+
+	if (!bObjectIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Object passed as Delegate does not respond to IZipUtilityInterface"));
+		return nullptr;
+	}
+
+	const FString SourcePath = ZUVolumeSet::ResolveArchivePath(ArchivePath);
+
+	if (!UWindowsFileUtilityFunctionLibrary::DoesFileExist(SourcePath))
+	{
+		((IZipUtilityInterface*)ZipUtilityInterfaceDelegate)->Execute_OnDone((UObject*)ZipUtilityInterfaceDelegate, ArchivePath, EZipUtilityCompletionState::FAILURE_NOT_FOUND);
+		return nullptr;
+	}
+
+	return TestOnBGThreadWithFormat(SourcePath, ZipUtilityInterfaceDelegate, Format);
+}
+
+UZipOperation* UZipFileFunctionLibrary::CreateManifest(const FString& FolderPath, const FString& ManifestPath, UObject* ZipUtilityInterfaceDelegate)
+{
+	bool bObjectIsValid = ZipUtilityInterfaceDelegate && ZipUtilityInterfaceDelegate->GetClass()->ImplementsInterface(UZipUtilityInterface::StaticClass());
+
+	if (!bObjectIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Object passed as Delegate does not respond to IZipUtilityInterface"));
+		return nullptr;
+	}
+
+	if (!UWindowsFileUtilityFunctionLibrary::DoesFileExist(FolderPath))
+	{
+		((IZipUtilityInterface*)ZipUtilityInterfaceDelegate)->Execute_OnDone((UObject*)ZipUtilityInterfaceDelegate, ManifestPath, EZipUtilityCompletionState::FAILURE_NOT_FOUND);
+		return nullptr;
+	}
+
+	return CreateManifestOnBGThread(FolderPath, ManifestPath, ZipUtilityInterfaceDelegate);
+}
+
+UZipOperation* UZipFileFunctionLibrary::UnzipToWithManifest(const FString& ArchivePath, const FString& DestinationPath, const FString& ManifestPath, UObject* ZipUtilityInterfaceDelegate)
+{
+	bool bObjectIsValid = ZipUtilityInterfaceDelegate && ZipUtilityInterfaceDelegate->GetClass()->ImplementsInterface(UZipUtilityInterface::StaticClass());
+
+	if (!bObjectIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Object passed as Delegate does not respond to IZipUtilityInterface"));
+		return nullptr;
+	}
+
+	const FString SourcePath = ZUVolumeSet::ResolveArchivePath(ArchivePath);
+
+	if (!UWindowsFileUtilityFunctionLibrary::DoesFileExist(SourcePath))
+	{
+		((IZipUtilityInterface*)ZipUtilityInterfaceDelegate)->Execute_OnDone((UObject*)ZipUtilityInterfaceDelegate, ArchivePath, EZipUtilityCompletionState::FAILURE_NOT_FOUND);
+		return nullptr;
+	}
+
+	return UnzipWithManifestOnBGThread(SourcePath, DestinationPath, ManifestPath, ZipUtilityInterfaceDelegate);
+}
+
+bool UZipFileFunctionLibrary::DiffManifests(const FString& OldManifestPath, const FString& NewManifestPath, TArray<FString>& Added, TArray<FString>& Removed, TArray<FString>& Changed)
+{
+	ZUManifest OldManifest;
+	ZUManifest NewManifest;
+	if (!OldManifest.Load(OldManifestPath) || !NewManifest.Load(NewManifestPath))
+	{
+		return false;
+	}
+
+	FZUManifestDiff Diff = ZUManifest::Diff(OldManifest, NewManifest);
+	Added = MoveTemp(Diff.Added);
+	Removed = MoveTemp(Diff.Removed);
+	Changed = MoveTemp(Diff.Changed);
+	return true;
+}
+
+UZipOperation* UZipFileFunctionLibrary::CreatePatch(const FString& OldArchivePath, const FString& NewArchivePath, const FString& PatchPath, UObject* ZipUtilityInterfaceDelegate)
+{
+	bool bObjectIsValid = ZipUtilityInterfaceDelegate && ZipUtilityInterfaceDelegate->GetClass()->ImplementsInterface(UZipUtilityInterface::StaticClass());
+
+	if (!bObjectIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Object passed as Delegate does not respond to IZipUtilityInterface"));
+		return nullptr;
+	}
+
+	const FString OldSourcePath = ZUVolumeSet::ResolveArchivePath(OldArchivePath);
+	const FString NewSourcePath = ZUVolumeSet::ResolveArchivePath(NewArchivePath);
+
+	if (!UWindowsFileUtilityFunctionLibrary::DoesFileExist(OldSourcePath) || !UWindowsFileUtilityFunctionLibrary::DoesFileExist(NewSourcePath))
+	{
+		((IZipUtilityInterface*)ZipUtilityInterfaceDelegate)->Execute_OnDone((UObject*)ZipUtilityInterfaceDelegate, PatchPath, EZipUtilityCompletionState::FAILURE_NOT_FOUND);
+		return nullptr;
+	}
+
+	return PatchOnBGThread(OldSourcePath, NewSourcePath, PatchPath, false, ZipUtilityInterfaceDelegate);
+}
+
+UZipOperation* UZipFileFunctionLibrary::ApplyPatch(const FString& OldArchivePath, const FString& PatchPath, const FString& OutputArchivePath, UObject* ZipUtilityInterfaceDelegate)
+{
+	bool bObjectIsValid = ZipUtilityInterfaceDelegate && ZipUtilityInterfaceDelegate->GetClass()->ImplementsInterface(UZipUtilityInterface::StaticClass());
+
+	if (!bObjectIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Object passed as Delegate does not respond to IZipUtilityInterface"));
+		return nullptr;
+	}
+
+	const FString OldSourcePath = ZUVolumeSet::ResolveArchivePath(OldArchivePath);
+
+	if (!UWindowsFileUtilityFunctionLibrary::DoesFileExist(OldSourcePath) || !UWindowsFileUtilityFunctionLibrary::DoesFileExist(PatchPath))
+	{
+		((IZipUtilityInterface*)ZipUtilityInterfaceDelegate)->Execute_OnDone((UObject*)ZipUtilityInterfaceDelegate, PatchPath, EZipUtilityCompletionState::FAILURE_NOT_FOUND);
+		return nullptr;
+	}
+
+	return PatchOnBGThread(OldSourcePath, PatchPath, OutputArchivePath, true, ZipUtilityInterfaceDelegate);
+}
+
+UZipLiveArchive* UZipFileFunctionLibrary::StartLiveArchive(const FString& FolderPath, const FString& ArchivePath, float FlushIntervalSeconds, int64 FlushThresholdBytes)
+{
+	UZipLiveArchive* LiveArchive = NewObject<UZipLiveArchive>();
+	if (!LiveArchive->Start(FolderPath, ArchivePath, FlushIntervalSeconds, FlushThresholdBytes))
+	{
+		return nullptr;
+	}
+	return LiveArchive;
+}
+
+UZipArchiveListing* UZipFileFunctionLibrary::OpenArchiveListing(const FString& ArchivePath, int32 PageSize)
+{
+	UZipArchiveListing* Listing = NewObject<UZipArchiveListing>();
+	if (!Listing->Open(ZUVolumeSet::ResolveArchivePath(ArchivePath), PageSize))
+	{
+		return nullptr;
+	}
+	return Listing;
 }
 
 bool UZipFileFunctionLibrary::ListFilesInArchive(const FString& path, UObject* ListDelegate, EZipUtilityCompressionFormat format)
@@ -497,7 +1145,7 @@ bool UZipFileFunctionLibrary::ListFilesInArchive(const FString& path, UObject* L
 		return false;
 	}
 
-	ListOnBGThread(path, Directory, ListDelegate, format);
+	ListOnBGThread(ZUVolumeSet::ResolveArchivePath(path), Directory, ListDelegate, format);
 	return true;
 }
 
@@ -0,0 +1,42 @@
+#include "ZipLiveArchive.h"
+#include "ZipUtilityPrivatePCH.h"
+#include "ZULiveArchive.h"
+
+bool UZipLiveArchive::Start(const FString& FolderPath, const FString& ArchivePath, float FlushIntervalSeconds, int64 FlushThresholdBytes)
+{
+	StopLiveArchive();
+
+	LiveArchive = MakeShareable(new ZULiveArchive(FolderPath, ArchivePath));
+	LiveArchive->SetFlushInterval(FlushIntervalSeconds);
+	LiveArchive->SetFlushThreshold(FlushThresholdBytes);
+
+	if (!LiveArchive->Start())
+	{
+		LiveArchive.Reset();
+		return false;
+	}
+	return true;
+}
+
+void UZipLiveArchive::FlushNow()
+{
+	if (LiveArchive.IsValid())
+	{
+		LiveArchive->RequestFlush();
+	}
+}
+
+void UZipLiveArchive::StopLiveArchive()
+{
+	if (LiveArchive.IsValid())
+	{
+		LiveArchive->Stop();
+		LiveArchive.Reset();
+	}
+}
+
+void UZipLiveArchive::BeginDestroy()
+{
+	StopLiveArchive();
+	Super::BeginDestroy();
+}
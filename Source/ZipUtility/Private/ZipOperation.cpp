@@ -6,10 +6,13 @@
 UZipOperation::UZipOperation()
 {
 	CallbackHandler = nullptr;
+	bStopped = false;
 }
 
 void UZipOperation::StopOperation()
 {
+	bStopped = true;
+
 	if (ThreadPoolWork != nullptr)
 	{
 		WFULambdaRunnable::RemoveLambdaFromQueue(ThreadPoolWork);
@@ -32,3 +35,7 @@ void UZipOperation::SetThreadPoolWorker(IQueuedWork* Work)
 	ThreadPoolWork = Work;
 }
 
+bool UZipOperation::IsStopped() const
+{
+	return bStopped;
+}
@@ -1,11 +1,47 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "ZipUtilityInterface.h"
+
+#if WITH_SEVENZIP
 #include "7zpp.h"
 #include "ListCallback.h"
 #include "ProgressCallback.h"
+#else
+#include <string>
+
+// 7zpp is only built for Windows. Elsewhere the native zip and tar.gz paths report through the same interface.
+namespace SevenZip
+{
+	typedef std::basic_string<TCHAR> TString;
+
+	class ListCallback
+	{
+	public:
+		virtual ~ListCallback() {}
+		virtual void OnFileFound(const TString& archivePath, const TString& filePath, int size) {}
+		virtual void OnListingDone(const TString& archivePath) {}
+	};
+
+	class ProgressCallback
+	{
+	public:
+		virtual ~ProgressCallback() {}
+		virtual void OnStartWithTotal(const TString& archivePath, uint64 totalBytes) = 0;
+		virtual void OnProgress(const TString& archivePath, uint64 bytesCompleted) = 0;
+		virtual void OnDone(const TString& archivePath) = 0;
+		virtual void OnFileDone(const TString& archivePath, const TString& filePath, uint64 bytesCompleted) = 0;
+		virtual bool OnCheckBreak() = 0;
+	};
+}
+#endif
 
 using namespace SevenZip;
+
+class ZUSharedOperation;
+enum class EZUSharedEvent : uint8;
+
 /**
  * Forwards events from the 7zpp library to the UE4 listener.
  */
@@ -16,13 +52,26 @@ public:
 	virtual void OnProgress(const TString& archivePath, uint64 bytes) override;
 	virtual void OnDone(const TString& archivePath) override;
 	virtual void OnFileDone(const TString& archivePath, const TString& filePath, uint64 bytes) override;
-	virtual void OnStartWithTotal(const TString& archivePath, unsigned __int64 totalBytes) override;
+	virtual void OnStartWithTotal(const TString& archivePath, uint64 totalBytes) override;
 	virtual void OnFileFound(const TString& archivePath, const TString& filePath, int size) override;
 	virtual void OnListingDone(const TString& archivePath) override;
 	virtual bool OnCheckBreak() override;
+
+	//Not part of 7zpp, used by the native zip paths
+	void OnFileFailed(const TString& archivePath, const TString& filePath);
+	void OnDoneWithState(const TString& archivePath, EZipUtilityCompletionState CompletionState);
+	void OnTestResult(const TString& archivePath, const FZipUtilityTestResult& result);
+	//The name is only copied into an FString for the game thread event
+	void OnEntryFound(const TString& archivePath, FStringView filePath, uint64 size);
 	
 	uint64 BytesLeft = 0;
 	uint64 TotalBytes = 0;
 	UObject* ProgressDelegate = nullptr;
 	FThreadSafeBool bCancelOperation = false;
+
+	//When set, events go to every listener of the shared run instead of ProgressDelegate
+	TSharedPtr<ZUSharedOperation, ESPMode::ThreadSafe> SharedOperation;
+
+private:
+	void SendEvent(TFunction<void(UObject*)>&& Event, EZUSharedEvent Type);
 };
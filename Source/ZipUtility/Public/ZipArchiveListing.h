@@ -0,0 +1,37 @@
+#pragma once
+#include "UObject/Object.h"
+#include "ZipArchiveListing.generated.h"
+
+class ZUZipReader;
+/**
+ * A cursor over the entries of a zip archive. Each NextPage call reads just enough of the central directory
+ * for one page, so listing an archive with millions of entries holds one page of names at a time. Stop at any
+ * point with CloseListing, or by letting the object be collected.
+ */
+UCLASS(BlueprintType)
+class ZIPUTILITY_API UZipArchiveListing : public UObject
+{
+	GENERATED_BODY()
+public:
+	// Returns false if the archive isn't a zip that can be listed natively
+	bool Open(const FString& ArchivePath, int32 InPageSize);
+
+	// Fills the next page of entry names and uncompressed sizes. FirstIndex is the archive index of the first one, the same
+	// index UnzipFiles takes. Returns false once every entry was listed, or if the archive turned out to be corrupt.
+	UFUNCTION(BlueprintCallable, Category = "Zip Archive Listing")
+	bool NextPage(TArray<FString>& Names, TArray<int64>& Sizes, int32& FirstIndex);
+
+	// Number of entries in the whole archive, known without listing them
+	UFUNCTION(BlueprintPure, Category = "Zip Archive Listing")
+	int64 GetTotalEntries() const;
+
+	// Releases the archive, NextPage returns false afterwards
+	UFUNCTION(BlueprintCallable, Category = "Zip Archive Listing")
+	void CloseListing();
+
+	virtual void BeginDestroy() override;
+
+private:
+	TSharedPtr<ZUZipReader> Reader;
+	int32 PageSize = 1000;
+};
@@ -2,6 +2,8 @@
 
 #include "ZipUtilityInterface.h"
 #include "ZipOperation.h"
+#include "ZipLiveArchive.h"
+#include "ZipArchiveListing.h"
 #include "ZipFileFunctionLibrary.generated.h"
 
 UENUM(BlueprintType)
@@ -17,7 +19,8 @@ enum class EZipUtilityCompressionFormat : uint8
 	COMPRESSION_FORMAT_ISO,
 	COMPRESSION_FORMAT_CAB,
 	COMPRESSION_FORMAT_LZMA,
-	COMPRESSION_FORMAT_LZMA86
+	COMPRESSION_FORMAT_LZMA86,
+	COMPRESSION_FORMAT_TAR_GZIP
 };
 
 
@@ -36,7 +39,8 @@ class UZipFileFunctionInternalCallback;
  A blueprint function library encapsulating all zip operations for both C++ and blueprint use. 
  For some operations a UZipOperation object may be returned, if you're interested in it, ensure
  you guard it from garbage collection by e.g. storing it as a UProperty, otherwise you may safely
- ignore it.
+ ignore it. Identical unzip, test and list requests made while one is still running join it and get the
+ same UZipOperation and events instead of repeating the work.
 */
 
 UCLASS(ClassGroup = ZipUtility, Blueprintable)
@@ -73,29 +77,80 @@ public:
 									TFunction<void(float)> OnProgressCallback = nullptr,
 									EZipUtilityCompressionFormat format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN);
 
-	/* Unzips archive at destination path. Automatically determines compression if unknown. Calls ZipUtilityInterface progress events. */
+	/* Unzips archive at destination path. Automatically determines compression if unknown. Calls ZipUtilityInterface progress events.
+	   Uncompressed zip entries are copied straight from the archive file; bVerifyStoredFiles false skips reading them back to check their CRC. */
 	UFUNCTION(BlueprintCallable, Category = ZipUtility)
-	static UZipOperation* UnzipTo(const FString& ArchivePath, const FString& DestinationPath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN);
+	static UZipOperation* UnzipTo(const FString& ArchivePath, const FString& DestinationPath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN, bool bVerifyStoredFiles = true);
 
-	/* Compresses the file or folder given at path and places the file in the same root folder. Calls ZipUtilityInterface progress events. Not all formats are supported for compression.*/
+	/* Unzips only the files matching IncludeGlobs and none of ExcludeGlobs to DestinationPath in one pass. '?' and '*' stay within a folder, '**' crosses
+	   folders and also matches no folder when followed by '/', and globs without '/' match file names anywhere, e.g. *.umap. Matching ignores case and
+	   happens on the worker, so unlike listing and calling UnzipFilesTo no event is sent per entry. No IncludeGlobs extracts everything not excluded.
+	   Calls ZipUtilityInterface progress events. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility, meta = (AutoCreateRefTerm = "IncludeGlobs,ExcludeGlobs"))
+	static UZipOperation* UnzipMatching(const FString& ArchivePath, const TArray<FString>& IncludeGlobs, const TArray<FString>& ExcludeGlobs, const FString& DestinationPath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN);
+
+	/* Compresses the file or folder given at path and places the file in the same root folder. Calls ZipUtilityInterface progress events. Not all formats are supported for compression.
+	   A VolumeSize in bytes above 0 splits zip output into <name>.zip.001, .002, ... volumes of that size, which Unzip accepts by either name.*/
 	UFUNCTION(BlueprintCallable, Category = ZipUtility)
 	static UZipOperation* Zip(	const FString& FileOrFolderPath,
 						UObject* ZipUtilityInterfaceDelegate, 
 						EZipUtilityCompressionFormat Format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_SEVEN_ZIP,
-						TEnumAsByte<ZipUtilityCompressionLevel> Level = COMPRESSION_LEVEL_NORMAL);
+						TEnumAsByte<ZipUtilityCompressionLevel> Level = COMPRESSION_LEVEL_NORMAL,
+						int64 VolumeSize = 0);
 
-	/* Lambda C++ simple variant*/
+	/* Lambda C++ simple variant, VolumeSize as in Zip*/
 	static UZipOperation* ZipWithLambda(	const FString& ArchivePath,
 								TFunction<void()> OnDoneCallback,
 								TFunction<void(float)> OnProgressCallback = nullptr,
 								EZipUtilityCompressionFormat Format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN,
-								TEnumAsByte<ZipUtilityCompressionLevel> Level = COMPRESSION_LEVEL_NORMAL);
+								TEnumAsByte<ZipUtilityCompressionLevel> Level = COMPRESSION_LEVEL_NORMAL,
+								int64 VolumeSize = 0);
+
+
+	/* Decodes every file in the archive and checks its size and CRC without writing anything to disk. Calls OnFileDone for good files, OnFileFailed for bad ones and OnDone with FAILURE_UNKNOWN if any failed. Currently supports zip archives only. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static UZipOperation* TestArchive(const FString& ArchivePath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat Format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN);
+
+	/* Hashes every file below FolderPath in parallel and writes a manifest of their paths, sizes, modification times and content hashes to ManifestPath.
+	   Calls OnFileDone for each hashed file and OnDone with FAILURE_UNKNOWN, without writing anything, if any file couldn't be read or the operation was stopped. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static UZipOperation* CreateManifest(const FString& FolderPath, const FString& ManifestPath, UObject* ZipUtilityInterfaceDelegate);
+
+	/* Same as UnzipTo, and writes a manifest of the extracted files to ManifestPath before OnDone. Files are hashed while they are decoded, so the
+	   output is never read back. Currently supports zip archives only. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static UZipOperation* UnzipToWithManifest(const FString& ArchivePath, const FString& DestinationPath, const FString& ManifestPath, UObject* ZipUtilityInterfaceDelegate);
 
+	/* Compares two manifests written by CreateManifest or UnzipToWithManifest. Changed lists files whose size or content differs, modification times
+	   alone don't count. Each list is sorted by path. Returns false if either manifest can't be read. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static bool DiffManifests(const FString& OldManifestPath, const FString& NewManifestPath, TArray<FString>& Added, TArray<FString>& Removed, TArray<FString>& Changed);
+
+	/* Writes a binary patch that turns the zip at OldArchivePath into the one at NewArchivePath. Unchanged entries are only referenced and changed ones
+	   are stored as a delta against their old version, so the patch is usually a small fraction of the new archive. OnFileDone is called per entry. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static UZipOperation* CreatePatch(const FString& OldArchivePath, const FString& NewArchivePath, const FString& PatchPath, UObject* ZipUtilityInterfaceDelegate);
+
+	/* Rebuilds the new archive from the old one and a patch made by CreatePatch, writing it to OutputArchivePath. Memory use stays bounded whatever the
+	   archive size. Calls OnDone with FAILURE_UNKNOWN, leaving no output, if OldArchivePath isn't the archive the patch was made against. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static UZipOperation* ApplyPatch(const FString& OldArchivePath, const FString& PatchPath, const FString& OutputArchivePath, UObject* ZipUtilityInterfaceDelegate);
 
 	/*Queries Archive content list, calls ZipUtilityInterface list events (OnFileFound)*/
 	UFUNCTION(BlueprintCallable, Category = ZipUtility)
 	static bool ListFilesInArchive(const FString& ArchivePath, UObject* ZipUtilityInterfaceDelegate, EZipUtilityCompressionFormat format = EZipUtilityCompressionFormat::COMPRESSION_FORMAT_UNKNOWN);
 
+	/* Opens a zip archive for listing in pages of PageSize entries, see UZipArchiveListing. Unlike ListFilesInArchive the entries are never all in memory
+	   at once and no event is sent per entry, which keeps archives with millions of entries cheap to browse. Returns nullptr if the archive isn't a zip. */
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static UZipArchiveListing* OpenArchiveListing(const FString& ArchivePath, int32 PageSize = 1000);
+
+	/* Keeps a zip of FolderPath at ArchivePath up to date while the returned object is referenced. Pending changes are written every FlushIntervalSeconds,
+	   or as soon as FlushThresholdBytes of changed files are pending when above 0. Only changed entries are compressed again, the rest are copied over
+	   as they are, and the archive is swapped in whole so it can be read at any time. Returns nullptr if FolderPath isn't a folder.*/
+	UFUNCTION(BlueprintCallable, Category = ZipUtility)
+	static UZipLiveArchive* StartLiveArchive(const FString& FolderPath, const FString& ArchivePath, float FlushIntervalSeconds = 10.f, int64 FlushThresholdBytes = 67108864);
+
 	static FGraphEventRef RunLambdaOnGameThread(TFunction< void()> InFunction);
 };
 
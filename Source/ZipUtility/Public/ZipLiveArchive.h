@@ -0,0 +1,31 @@
+#pragma once
+#include "UObject/Object.h"
+#include "ZipLiveArchive.generated.h"
+
+class ZULiveArchive;
+/**
+ * A zip archive kept in step with a folder for as long as this object lives. Changes to the folder are
+ * collected and written out every flush interval, or sooner once enough changed bytes are pending.
+ * Hold on to it, e.g. in a UPROPERTY, the archive stops following the folder when it is collected.
+ */
+UCLASS(BlueprintType)
+class ZIPUTILITY_API UZipLiveArchive : public UObject
+{
+	GENERATED_BODY()
+public:
+	// Starts following FolderPath, returns false if it isn't a folder
+	bool Start(const FString& FolderPath, const FString& ArchivePath, float FlushIntervalSeconds, int64 FlushThresholdBytes);
+
+	// Writes out pending changes now instead of at the next interval
+	UFUNCTION(BlueprintCallable, Category = "Zip Live Archive")
+	void FlushNow();
+
+	// Stops following the folder, a rewrite in progress is abandoned and the archive keeps its last complete state
+	UFUNCTION(BlueprintCallable, Category = "Zip Live Archive")
+	void StopLiveArchive();
+
+	virtual void BeginDestroy() override;
+
+private:
+	TSharedPtr<ZULiveArchive> LiveArchive;
+};
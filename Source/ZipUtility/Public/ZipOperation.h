@@ -31,6 +31,9 @@ public:
 
 	// Set the queued work
 	void SetThreadPoolWorker(IQueuedWork* Work);
+
+	// Whether StopOperation was called, identical requests don't join a stopped operation
+	bool IsStopped() const;
 	
 private:
 	// A pointer to the callback for this operation. Once the operation completes, this
@@ -39,4 +42,6 @@ private:
 
 	// The work that was queued on the async threadpool in WFULambdaRunnable
 	IQueuedWork* ThreadPoolWork;
+
+	bool bStopped;
 };
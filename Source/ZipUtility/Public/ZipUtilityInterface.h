@@ -12,6 +12,41 @@ enum EZipUtilityCompletionState
 	FAILURE_UNKNOWN
 };
 
+/**
+* Summary of a TestArchive run, sent right before its OnDone
+*/
+USTRUCT(BlueprintType)
+struct ZIPUTILITY_API FZipUtilityTestResult
+{
+	GENERATED_BODY()
+
+	//Files in the archive, directories aren't counted
+	UPROPERTY(BlueprintReadOnly, Category = ZipUtilityTest)
+	int32 TotalFiles = 0;
+
+	//Less than TotalFiles if the operation was stopped
+	UPROPERTY(BlueprintReadOnly, Category = ZipUtilityTest)
+	int32 TestedFiles = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = ZipUtilityTest)
+	int32 FailedFiles = 0;
+
+	//Uncompressed bytes of the tested files
+	UPROPERTY(BlueprintReadOnly, Category = ZipUtilityTest)
+	int64 TestedBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = ZipUtilityTest)
+	float Seconds = 0.f;
+
+	//Uncompressed megabytes decoded per second
+	UPROPERTY(BlueprintReadOnly, Category = ZipUtilityTest)
+	float MegabytesPerSecond = 0.f;
+
+	//True if the operation was stopped, the untested files aren't counted as failed
+	UPROPERTY(BlueprintReadOnly, Category = ZipUtilityTest)
+	bool bAborted = false;
+};
+
 
 UINTERFACE(MinimalAPI)
 class UZipUtilityInterface : public UInterface
@@ -30,7 +65,7 @@ public:
 	* @param percentage - percentage done
 	*/
 	UFUNCTION(BlueprintNativeEvent, Category = ZipUtilityProgressEvents)
-		void OnProgress(const FString& archive, float percentage, int32 bytes);
+		void OnProgress(const FString& archive, float percentage, int64 bytes);
 
 	/**
 	* Called when whole process is complete (e.g. unzipping completed on archive)
@@ -39,10 +74,11 @@ public:
 		void OnDone(const FString& archive, EZipUtilityCompletionState CompletionState);
 
 	/**
-	* Called at beginning of process (NB this only supports providing size information for up to 2gb) TODO: fix 32bit BP size issue
+	* Called at beginning of process
+	* @param bytes - total uncompressed size of what is being processed
 	*/
 	UFUNCTION(BlueprintNativeEvent, Category = ZipUtilityProgressEvents)
-		void OnStartProcess(const FString& archive, int32 bytes);
+		void OnStartProcess(const FString& archive, int64 bytes);
 
 	/**
 	* Called when file process is complete
@@ -51,12 +87,30 @@ public:
 	UFUNCTION(BlueprintNativeEvent, Category = ZipUtilityProgressEvents)
 		void OnFileDone(const FString& archive, const FString& file);
 
+	/**
+	* Called when a file in the archive fails to decode or doesn't match its stored size or CRC (e.g. while testing an archive)
+	* @param path - path of the file that failed
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = ZipUtilityProgressEvents)
+		void OnFileFailed(const FString& archive, const FString& file);
+
+	//Default so existing implementers don't have to add it
+	virtual void OnFileFailed_Implementation(const FString& archive, const FString& file) {};
+
+	/**
+	* Called when TestArchive finishes, right before OnDone
+	* @param result - how many files were tested and failed, and how fast they were decoded
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = ZipUtilityProgressEvents)
+		void OnTestResult(const FString& archive, const FZipUtilityTestResult& result);
+
+	virtual void OnTestResult_Implementation(const FString& archive, const FZipUtilityTestResult& result) {};
 
 	/**
 	* Called when a file is found in the archive (e.g. listing the entries in the archive)
 	* @param path - path of file
-	* @param size - compressed size
+	* @param size - uncompressed size in bytes
 	*/
 	UFUNCTION(BlueprintNativeEvent, Category = ZipUtilityListEvents)
-		void OnFileFound(const FString& archive, const FString& file, int32 size);
+		void OnFileFound(const FString& archive, const FString& file, int64 size);
 };
\ No newline at end of file
@@ -90,8 +90,6 @@ public ZipUtility(ReadOnlyTargetRules Target) : base(Target)
         PrivateIncludePaths.AddRange(
             new string[] {
 				Path.Combine(ModuleDirectory, "Private"),
-                Path.Combine(SevenZppPath, "Include"),
-				Path.Combine(ATLPath, "include"),
 				// ... add other private include paths required here ...
 			}
             );
@@ -127,6 +125,9 @@ public ZipUtility(ReadOnlyTargetRules Target) : base(Target)
 			}
             );
 
+        //Used by the native zip backend for raw deflate streams
+        AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+
         LoadLib(Target);
     }
 
@@ -148,8 +149,15 @@ public bool LoadLib(ReadOnlyTargetRules Target)
 
             PublicDelayLoadDLLs.Add("7z.dll");
             RuntimeDependencies.Add(Path.Combine(DLLPath, PlatformSubPath, "7z.dll"));
+
+            //7zpp and ATL only exist for Windows
+            PrivateIncludePaths.Add(Path.Combine(SevenZppPath, "Include"));
+            PrivateIncludePaths.Add(Path.Combine(ATLPath, "include"));
         }
 
+        //Without 7zpp, zip and tar.gz go through the native readers and writers and other formats report a failure
+        PublicDefinitions.Add("WITH_SEVENZIP=" + (isLibrarySupported ? "1" : "0"));
+
         if (isLibrarySupported)
         {
             // Include path